@@ -0,0 +1,207 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "astArena.h"
+
+#include "misc.h"
+
+#include <cstdlib>
+#include <cstring>
+
+//
+// Nodes are rounded up to a multiple of kGranule bytes, which also keeps
+// every node as aligned as malloc would.  The largest nodes (AggregateType,
+// FnSymbol) fit comfortably under kMaxSmall.
+//
+static const size_t kGranule    = 16;
+static const size_t kMaxSmall   = 1024;
+static const size_t kNumClasses = kMaxSmall / kGranule;
+static const size_t kChunkSize  = 1024 * 1024;
+
+struct FreeNode {
+  FreeNode*  next;
+};
+
+// Chunks and large nodes carry a kGranule-sized header linking them together
+// so astArenaRelease() can find them.
+struct Block {
+  Block*     prev;
+  Block*     next;
+};
+
+static bool          sInitialized = false;
+static bool          sEnabled     = true;
+
+static Block*        sChunks      = NULL;
+static char*         sBump        = NULL;
+static char*         sBumpEnd     = NULL;
+
+static FreeNode*     sFreeLists[kNumClasses];
+
+static Block*        sLarge       = NULL;
+
+static AstArenaStats sStats;
+
+static void initialize() {
+  const char* env = getenv("CHPL_AST_ARENA");
+
+  // CHPL_AST_ARENA=false gives every node its own malloc, so that tools
+  // like valgrind can spot uses of deleted nodes.
+  if (env != NULL && (strcmp(env, "0") == 0 || strcmp(env, "false") == 0))
+    sEnabled = false;
+
+  memset(sFreeLists, 0, sizeof(sFreeLists));
+  memset(&sStats,    0, sizeof(sStats));
+
+  sInitialized = true;
+}
+
+static void* allocBlock(Block** list, size_t size) {
+  Block* block = (Block*) malloc(kGranule + size);
+
+  if (block == NULL)
+    INT_FATAL("out of memory allocating AST nodes");
+
+  block->prev = NULL;
+  block->next = *list;
+
+  if (*list != NULL)
+    (*list)->prev = block;
+
+  *list = block;
+
+  return (char*) block + kGranule;
+}
+
+static void freeBlock(Block** list, void* ptr) {
+  Block* block = (Block*) ((char*) ptr - kGranule);
+
+  if (block->prev != NULL)
+    block->prev->next = block->next;
+  else
+    *list = block->next;
+
+  if (block->next != NULL)
+    block->next->prev = block->prev;
+
+  free(block);
+}
+
+static void noteLive(size_t bytes) {
+  sStats.liveBytes += bytes;
+
+  if (sStats.liveBytes > sStats.peakLiveBytes)
+    sStats.peakLiveBytes = sStats.liveBytes;
+}
+
+void* astArenaAlloc(size_t size) {
+  if (sInitialized == false)
+    initialize();
+
+  if (size == 0)
+    size = 1;
+
+  sStats.numAllocs++;
+
+  if (size > kMaxSmall || sEnabled == false) {
+    sStats.largeBytes += size;
+    noteLive(size);
+
+    return allocBlock(&sLarge, size);
+  }
+
+  size_t cls   = (size - 1) / kGranule;
+  size_t bytes = (cls + 1) * kGranule;
+
+  noteLive(bytes);
+
+  if (FreeNode* node = sFreeLists[cls]) {
+    sFreeLists[cls]   = node->next;
+    sStats.freeBytes -= bytes;
+    sStats.numRecycled++;
+
+    return node;
+  }
+
+  // The tail of the old chunk is abandoned; it is under kMaxSmall bytes.
+  if (sBump == NULL || (size_t) (sBumpEnd - sBump) < bytes) {
+    sBump       = (char*) allocBlock(&sChunks, kChunkSize - kGranule);
+    sBumpEnd    = sBump + kChunkSize - kGranule;
+
+    sStats.chunkBytes += kChunkSize;
+  }
+
+  void* retval = sBump;
+
+  sBump = sBump + bytes;
+
+  return retval;
+}
+
+void astArenaFree(void* ptr, size_t size) {
+  if (ptr == NULL)
+    return;
+
+  if (size == 0)
+    size = 1;
+
+  if (size > kMaxSmall || sEnabled == false) {
+    sStats.largeBytes -= size;
+    sStats.liveBytes  -= size;
+
+    freeBlock(&sLarge, ptr);
+
+  } else {
+    size_t    cls   = (size - 1) / kGranule;
+    size_t    bytes = (cls + 1) * kGranule;
+    FreeNode* node  = (FreeNode*) ptr;
+
+    node->next       = sFreeLists[cls];
+    sFreeLists[cls]  = node;
+
+    sStats.liveBytes -= bytes;
+    sStats.freeBytes += bytes;
+  }
+}
+
+void astArenaRelease() {
+  while (sChunks != NULL)
+    freeBlock(&sChunks, (char*) sChunks + kGranule);
+
+  while (sLarge != NULL)
+    freeBlock(&sLarge, (char*) sLarge + kGranule);
+
+  memset(sFreeLists, 0, sizeof(sFreeLists));
+
+  sBump               = NULL;
+  sBumpEnd            = NULL;
+
+  sStats.chunkBytes   = 0;
+  sStats.liveBytes    = 0;
+  sStats.freeBytes    = 0;
+  sStats.largeBytes   = 0;
+}
+
+void astArenaGetStats(AstArenaStats* stats) {
+  if (sInitialized == false)
+    initialize();
+
+  *stats = sStats;
+}
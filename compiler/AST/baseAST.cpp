@@ -20,6 +20,7 @@
 
 #include "baseAST.h"
 
+#include "astArena.h"
 #include "astutil.h"
 #include "CForLoop.h"
 #include "CatchStmt.h"
@@ -90,8 +91,14 @@ void printStatistics(const char* pass) {
 
   if (!strcmp(pass, "makeBinary")) {
     if (strstr(fPrintStatistics, "m")) {
+      AstArenaStats arena;
+
+      astArenaGetStats(&arena);
+
       fprintf(stderr, "Maximum # of ASTS: %d\n", maxN);
       fprintf(stderr, "Maximum Size (KB): %d\n", maxK);
+      fprintf(stderr, "Maximum Arena Size (KB): %d\n",
+              (int) (arena.peakLiveBytes / 1024));
     }
   }
 
@@ -127,6 +134,21 @@ void printStatistics(const char* pass) {
   if (kStmt+kExpr+kSymbol+kType > maxK)
     maxK = kStmt+kExpr+kSymbol+kType;
 
+  // The arena's view includes padding and nodes that await recycling
+  if (strstr(fPrintStatistics, "k")) {
+    AstArenaStats arena;
+
+    astArenaGetStats(&arena);
+
+    fprintf(stderr, "    Arena %6dK Live %6dK Free %6dK Large %6dK Recycled %9d of %9d\n",
+            (int) (arena.chunkBytes    / 1024),
+            (int) (arena.liveBytes     / 1024),
+            (int) (arena.freeBytes     / 1024),
+            (int) (arena.largeBytes    / 1024),
+            (int) arena.numRecycled,
+            (int) arena.numAllocs);
+  }
+
   if (strstr(fPrintStatistics, "n"))
     fprintf(stderr, "    Stmt %9d  Cond %9d  Block %9d  Goto  %9d\n",
             nStmt, nCondStmt, nBlockStmt, nGotoStmt);
@@ -295,12 +317,21 @@ void cleanAst() {
 
 
 void destroyAst() {
-  #define destroy_gvec(type)                    \
-    forv_Vec(type, ast, g##type##s) {           \
-      trace_remove(ast, 'z');                   \
-      delete ast;                               \
-    }
-  foreach_ast(destroy_gvec);
+  // Only delete the nodes one at a time when someone is watching them go;
+  // otherwise they are all released together with the arena.
+  if (deletedIdON() == true || breakOnRemoveID > 0) {
+    #define destroy_gvec(type)                    \
+      forv_Vec(type, ast, g##type##s) {           \
+        trace_remove(ast, 'z');                   \
+        delete ast;                               \
+      }
+    foreach_ast(destroy_gvec);
+  }
+
+  #define forget_gvec(type) g##type##s.clear()
+  foreach_ast(forget_gvec);
+
+  astArenaRelease();
 }
 
 
@@ -329,6 +360,10 @@ int lastNodeIDUsed() {
   return uid - 1;
 }
 
+void setLastNodeIDUsed(int id) {
+  uid = id + 1;
+}
+
 
 // This is here so that we can break on the creation of a particular
 // BaseAST instance in gdb.
@@ -365,6 +400,14 @@ BaseAST::BaseAST(AstTag type) :
 
 const std::string BaseAST::tabText = "   ";
 
+void* BaseAST::operator new(size_t size) {
+  return astArenaAlloc(size);
+}
+
+void BaseAST::operator delete(void* ptr, size_t size) {
+  astArenaFree(ptr, size);
+}
+
 
 BaseAST::~BaseAST() {
 }
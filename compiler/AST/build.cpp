@@ -36,6 +36,7 @@
 #include "LoopExpr.h"
 #include "optimizations.h"
 #include "ParamForLoop.h"
+#include "parseCache.h"
 #include "parser.h"
 #include "stringutil.h"
 #include "TryStmt.h"
@@ -414,6 +415,7 @@ bool processStringInRequireStmt(const char* str, bool parseTime,
   } else {
     if (isChplSource(str)) {
       if (parseTime) {
+        parseCacheSkipFile();
         addSourceFile(str, NULL);
         return true;
       } else {
@@ -900,9 +902,21 @@ CallExpr* buildPrimitiveExpr(CallExpr* exprs) {
 }
 
 
+// Counters used to give the functions built for some expressions unique
+// names.  The parse cache saves and restores them, see parseCache.cpp.
+static int buildCounters[NUM_BUILD_COUNTERS] = { 1, 1, 0, 0 };
+
+int buildCounterGet(BuildCounter counter) {
+  return buildCounters[counter];
+}
+
+void buildCounterSet(BuildCounter counter, int value) {
+  buildCounters[counter] = value;
+}
+
 CallExpr* buildLetExpr(BlockStmt* decls, Expr* expr) {
-  static int uid = 1;
-  FnSymbol* fn = new FnSymbol(astr("chpl_let_fn", istr(uid++)));
+  int uid = buildCounters[BUILD_COUNTER_LET_EXPR]++;
+  FnSymbol* fn = new FnSymbol(astr("chpl_let_fn", istr(uid)));
   fn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
   fn->addFlag(FLAG_INLINE);
   fn->insertAtTail(decls);
@@ -1126,6 +1140,74 @@ addByrefVars(BlockStmt* target, CallExpr* byrefVarsSource) {
 }
 
 
+// Is this locale expression one that cannot wait for an iteration that
+// has not been launched yet: a variable, a constant, an element of
+// Locales, a field such as x.locale, or arithmetic on those?
+static bool isSimpleLocaleExpr(Expr* expr) {
+  if (isSymExpr(expr) || isUnresolvedSymExpr(expr))
+    return true;
+
+  CallExpr* call = toCallExpr(expr);
+
+  if (call == NULL)
+    return false;
+
+  if (call->isPrimitive(PRIM_DEREF) ||
+      call->isPrimitive(PRIM_WIDE_GET_LOCALE) ||
+      call->isPrimitive(PRIM_ON_LOCALE_NUM) ||
+      call->isNamed(".") ||
+      call->isNamed("Locales") ||
+      call->isNamed("+") || call->isNamed("-") ||
+      call->isNamed("*") || call->isNamed("/") || call->isNamed("%")) {
+    for_actuals(actual, call) {
+      if (!isSimpleLocaleExpr(actual))
+        return false;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+// Is the on-statement found by findStmtWithTag() all there is to the body
+// of a coforall, so that the parent task does nothing per iteration but
+// evaluate its locale (see buildOnStmt()), and is that locale simple
+// enough that the iterations can be held back until the end of the loop?
+static bool isOnlyStmtInBody(BlockStmt* onBlock, BlockStmt* body) {
+  Symbol*    locale = toSymExpr(onBlock->blockInfoGet()->get(2))->symbol();
+  BlockStmt* block  = body;
+
+  // the blocks enclosing the on-statement hold nothing else
+  while (block->body.tail != onBlock) {
+    if (block->length() != 1)
+      return false;
+
+    block = toBlockStmt(block->body.tail);
+  }
+
+  for_alist(stmt, block->body) {
+    if (stmt == onBlock) {
+      continue;
+    } else if (DefExpr* def = toDefExpr(stmt)) {
+      if (def->sym != locale)
+        return false;
+    } else if (CallExpr* call = toCallExpr(stmt)) {
+      SymExpr* lhs = toSymExpr(call->get(1));
+
+      if (!call->isPrimitive(PRIM_MOVE) || lhs == NULL || lhs->symbol() != locale)
+        return false;
+
+      if (!isSimpleLocaleExpr(call->get(2)))
+        return false;
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 // Build up a "lowered" coforall loop. We lower coforalls into for-loops with
 // explicit fork-join task creation via an EndCount.
 static BlockStmt* buildLoweredCoforall(Expr* indices,
@@ -1145,10 +1227,15 @@ static BlockStmt* buildLoweredCoforall(Expr* indices,
   VarSymbol* countRunningTasks = gTrue;
 
   BlockStmt* onBlock = findStmtWithTag(PRIM_BLOCK_ON, body);
+  bool treeLaunch = false;
   // For remote coforalls (e..g. coforall indices in iterator do on indices) we
   // just do a remote fork instead of creating a task locally. Do not count
   // running tasks locally, and use network atomic EndCounts if available
   if (onBlock) {
+    // If the number of iterations is known and the parent has nothing to
+    // do but launch them, the runtime may collect them and launch them as
+    // a tree when the loop ends.  See chpl_coforallOnBegin().
+    treeLaunch = bounded && isOnlyStmtInBody(onBlock, body);
     onBlock->blockInfoGet()->primitive = primitives[PRIM_BLOCK_COFORALL_ON];
     // Note: gNil is here so error handling can be added by compiler
     // in parallel pass.
@@ -1167,6 +1254,20 @@ static BlockStmt* buildLoweredCoforall(Expr* indices,
                                                 new SymExpr(iterator),
                                                 taskBlk,
                                                 zippered);
+  // Every coforall+on loop starts a new (possibly disabled) collection of
+  // its iterations, so none are added to that of an enclosing loop.  The
+  // collection ends, launching what it holds, when the loop is left in
+  // any way, but before the parent waits for the iterations.
+  if (onBlock) {
+    VarSymbol* coforallOnSaved = newTemp("_coforallOnSaved");
+    Symbol* maxTasks = treeLaunch ? (Symbol*)numTasks : new_IntSymbol(0);
+    BlockStmt* loopBlock = block;
+    block = new BlockStmt(loopBlock);
+    loopBlock->insertAtHead(new DeferStmt(new CallExpr("chpl_coforallOnEnd", coforallOnSaved)));
+    loopBlock->insertAtHead(new CallExpr(PRIM_MOVE, coforallOnSaved, new CallExpr("chpl_coforallOnBegin", maxTasks)));
+    loopBlock->insertAtHead(new DefExpr(coforallOnSaved));
+  }
+
   if (bounded) {
     if (!onBlock) { block->insertAtHead(new CallExpr("chpl_resetTaskSpawn", numTasks)); }
     block->insertAtHead(new CallExpr("_upEndCount", coforallCount, countRunningTasks, numTasks));
@@ -1237,7 +1338,18 @@ static void removeWrappingBlock(BlockStmt*& block) {
 // there are some minor differences. We use network atomics for the EndCount if
 // they're available, we won't manipulate here.runningTaskCount, and we'll use
 // PRIM_BLOCK_COFORALL_ON instead of PRIM_BLOCK_COFORALL so that we just do
-// remote-forks instead of creating any tasks locally.
+// remote-forks instead of creating any tasks locally.  The loop itself is
+// also wrapped in a block that collects its iterations:
+//
+//     {
+//       var saved = chpl_coforallOnBegin(maxTasks);
+//       defer { chpl_coforallOnEnd(saved); }
+//       for indices in tmpIter { ... }
+//     }
+//
+// where maxTasks is numTasks when the bounded loop's body is nothing but
+// an on-statement with a simple locale (see isOnlyStmtInBody()), and 0,
+// which collects nothing, otherwise.
 BlockStmt* buildCoforallLoopStmt(Expr* indices,
                                  Expr* iterator,
                                  CallExpr* byref_vars,
@@ -1428,9 +1540,9 @@ CallExpr* buildReduceExpr(Expr* opExpr, Expr* dataExpr, bool zippered) {
 
 
 CallExpr* buildScanExpr(Expr* opExpr, Expr* dataExpr, bool zippered) {
-  static int uid = 1;
+  int uid = buildCounters[BUILD_COUNTER_SCAN_EXPR]++;
 
-  FnSymbol* fn = new FnSymbol(astr("chpl__scan", istr(uid++)));
+  FnSymbol* fn = new FnSymbol(astr("chpl__scan", istr(uid)));
   fn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
   fn->addFlag(FLAG_FN_RETURNS_ITERATOR);
 
@@ -1510,6 +1622,7 @@ std::set<Flag>* buildVarDeclFlags(Flag flag1, Flag flag2) {
 static Expr* lookupConfigValHelp(const char* cfgname, VarSymbol* var) {
   Expr* configInit = NULL;
   configInit = getCmdLineConfig(cfgname);
+  parseCacheNoteConfig(cfgname, configInit != NULL);
   if (configInit) {
     if (VarSymbol* conflictingVar = isUsedCmdLineConfig(cfgname)) {
       USR_FATAL_CONT(var, "ambiguous config name (%s)", cfgname);
@@ -1654,6 +1767,9 @@ AggregateType* installInternalType(AggregateType* ct, AggregateType* dt) {
   // Hook the string type in the modules
   // to avoid duplication with dtString created in initPrimitiveTypes().
   // gatherWellKnownTypes runs too late to help.
+  // This changes a type that exists outside of the file being parsed,
+  // so the parse can't be replayed from the parse cache.
+  parseCacheSkipFile();
 
   // grab the existing symbol from the placeholder "dtString"
   ct->addSymbol(dt->symbol);
@@ -1829,7 +1945,7 @@ destructureTupleGroupedArgs(FnSymbol* fn, BlockStmt* tuple, Expr* base) {
 }
 
 FnSymbol* buildLambda(FnSymbol *fn) {
-  static unsigned int nextId = 0;
+  int nextId = buildCounters[BUILD_COUNTER_LAMBDA]++;
   char buffer[100];
 
   /*
@@ -1839,7 +1955,7 @@ FnSymbol* buildLambda(FnSymbol *fn) {
    * is better to guard against this behavior then leaving someone wondering
    * why we didn't.
    */
-  if (snprintf(buffer, 100, "chpl_lambda_%i", nextId++) >= 100) {
+  if (snprintf(buffer, 100, "chpl_lambda_%i", nextId) >= 100) {
     INT_FATAL("Too many lambdas.");
   }
 
@@ -2007,8 +2123,8 @@ DefExpr* buildForwardingExprFnDef(Expr* expr) {
   // Put expr into a method and return the DefExpr for that method.
   // This way, we can work with the rest of the compiler that
   // assumes that 'this' is an ArgSymbol.
-  static int delegate_counter = 0;
-  const char* name = astr("chpl_forwarding_expr", istr(++delegate_counter));
+  int delegate_counter = ++buildCounters[BUILD_COUNTER_FORWARDING];
+  const char* name = astr("chpl_forwarding_expr", istr(delegate_counter));
   if (UnresolvedSymExpr* usex = toUnresolvedSymExpr(expr))
     name = astr(name, "_", usex->unresolved);
   FnSymbol* fn = new FnSymbol(name);
@@ -2439,6 +2555,9 @@ BlockStmt*
 buildAtomicStmt(Expr* stmt) {
   static bool atomic_warning = false;
 
+  // Whether the warning is issued depends on the files parsed before
+  parseCacheSkipFile();
+
   if (!atomic_warning) {
     atomic_warning = true;
     USR_WARN(stmt, "atomic statement is ignored (not implemented)");
@@ -31,6 +31,7 @@
 #include "docsDriver.h"
 #include "driver.h"
 #include "ForallStmt.h"
+#include "parseCache.h"
 #include "passes.h"
 #include "resolveIntents.h"
 #include "resolution.h"
@@ -1500,6 +1501,8 @@ VarSymbol *new_StringSymbol(const char *str) {
   imm.string_kind = STRING_KIND_STRING;
   imm.v_string = astr(str);
   VarSymbol *s = stringLiteralsHash.get(&imm);
+  ParseCacheLiteral record(s, CONST_KIND_STRING, STRING_KIND_STRING,
+                           imm.v_string, 0);
   if (s) {
     return s;
   }
@@ -1585,6 +1588,8 @@ VarSymbol *new_BytesSymbol(const char *str) {
   imm.string_kind = STRING_KIND_BYTES;
   imm.v_string = astr(str);
   VarSymbol *s = bytesLiteralsHash.get(&imm);
+  ParseCacheLiteral record(s, CONST_KIND_STRING, STRING_KIND_BYTES,
+                           imm.v_string, 0);
   if (s) {
     return s;
   }
@@ -1663,6 +1668,8 @@ VarSymbol *new_CStringSymbol(const char *str) {
   imm.string_kind = STRING_KIND_C_STRING;
   imm.v_string = astr(str);
   VarSymbol *s = uniqueConstantsHash.get(&imm);
+  ParseCacheLiteral record(s, CONST_KIND_STRING, STRING_KIND_C_STRING,
+                           imm.v_string, 0);
   PrimitiveType* dtRetType = dtStringC;
   if (s) {
     return s;
@@ -1717,6 +1724,7 @@ VarSymbol *new_IntSymbol(int64_t b, IF1_int_type size) {
   imm.const_kind = NUM_KIND_INT;
   imm.num_index = size;
   VarSymbol *s = uniqueConstantsHash.get(&imm);
+  ParseCacheLiteral record(s, NUM_KIND_INT, size, NULL, b);
   PrimitiveType* dtRetType = dtInt[size];
   if (s) {
     return s;
@@ -1743,6 +1751,7 @@ VarSymbol *new_UIntSymbol(uint64_t b, IF1_int_type size) {
   imm.const_kind = NUM_KIND_UINT;
   imm.num_index = size;
   VarSymbol *s = uniqueConstantsHash.get(&imm);
+  ParseCacheLiteral record(s, NUM_KIND_UINT, size, NULL, b);
   PrimitiveType* dtRetType = dtUInt[size];
   if (s) {
     return s;
@@ -1787,6 +1796,7 @@ static VarSymbol* new_FloatSymbol(const char* num,
   imm.num_index = size;
 
   VarSymbol *s = uniqueConstantsHash.get(&imm);
+  ParseCacheLiteral record(s, kind, size, num, 0);
   if (s) {
     return s;
   }
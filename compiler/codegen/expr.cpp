@@ -5945,7 +5945,10 @@ void CallExpr::codegenInvokeOnFun() {
   // get(3) is a the size of the buffer
   // get(4) is a dummy class type for the argument bundle
 
-  if (fn->hasFlag(FLAG_NON_BLOCKING))
+  if (fn->hasFlag(FLAG_COFORALL_ON))
+    fname = "chpl_executeOnCoforall";
+
+  else if (fn->hasFlag(FLAG_NON_BLOCKING))
     fname = "chpl_executeOnNB";
 
   else if (fn->hasFlag(FLAG_FAST_ON))
@@ -5976,7 +5979,7 @@ void CallExpr::codegenInvokeTaskFun(const char* name) {
   GenRet              taskBundle;
   GenRet              bundleSize;
 
-  std::vector<GenRet> args(8);
+  std::vector<GenRet> args(9);
 
   // get(1) is a ref/wide ref to a task list value
   // get(2) is the node ID owning the task list
@@ -5997,8 +6000,9 @@ void CallExpr::codegenInvokeTaskFun(const char* name) {
   args[3]      = bundleSize;
   args[4]      = taskList;
   args[5]      = codegenValue(taskListNode);
-  args[6]      = fn->linenum();
-  args[7]      = new_IntSymbol(gFilenameLookupCache[fn->fname()], INT_SIZE_32);
+  args[6]      = fn->hasFlag(FLAG_STACKLESS_TASK) ? gTrue : gFalse;
+  args[7]      = fn->linenum();
+  args[8]      = new_IntSymbol(gFilenameLookupCache[fn->fname()], INT_SIZE_32);
 
   genComment(fn->cname, true);
 
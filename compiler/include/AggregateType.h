@@ -43,6 +43,8 @@ enum AggregateResolved {
 };
 
 class AggregateType : public Type {
+  friend class ParseCache;
+
 public:
   static void                 setCreationStyle(TypeSymbol* t, FnSymbol* fn);
 
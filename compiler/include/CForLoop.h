@@ -27,6 +27,8 @@ class ForLoop;
 
 class CForLoop : public LoopStmt
 {
+  friend class ParseCache;
+
   //
   // Class interface
   //
@@ -25,6 +25,7 @@
 
 class DeferStmt : public Stmt
 {
+  friend class ParseCache;
 
 public:
 
@@ -25,6 +25,8 @@
 
 class DoWhileStmt : public WhileStmt
 {
+  friend class ParseCache;
+
   //
   // Class interface
   //
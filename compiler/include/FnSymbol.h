@@ -69,6 +69,8 @@ public:
 };
 
 class FnSymbol : public Symbol {
+  friend class ParseCache;
+
 public:
   // each formal is an ArgSymbol, but the elements are DefExprs
   AList                      formals;
@@ -31,6 +31,8 @@
 // iteration.
 class ForLoop : public LoopStmt
 {
+  friend class ParseCache;
+
   //
   // Class interface
   //
@@ -71,6 +71,8 @@ class ForallOptimizationInfo {
 
 class ForallStmt : public Stmt
 {
+  friend class ParseCache;
+
 public:
   bool       zippered()       const; // 'zip' keyword used and >1 index var
   AList&     inductionVariables();   // DefExprs, one per iterated expr
@@ -28,6 +28,8 @@
 
 
 class IfExpr : public Expr {
+  friend class ParseCache;
+
 public:
 
   IfExpr(Expr* condition, Expr* thenExpr, Expr* elseExpr);
@@ -25,6 +25,8 @@
 
 class LoopStmt : public BlockStmt
 {
+  friend class ParseCache;
+
 public:
   static LoopStmt*       findEnclosingLoop(Expr* expr);
 
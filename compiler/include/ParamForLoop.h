@@ -25,6 +25,8 @@
 
 class ParamForLoop : public LoopStmt
 {
+  friend class ParseCache;
+
   //
   // Class interface
   //
@@ -25,6 +25,7 @@
 
 class TryStmt : public Stmt
 {
+  friend class ParseCache;
 
 public:
 
@@ -26,6 +26,8 @@
 class ResolveScope;
 
 class UseStmt : public VisibilityStmt {
+  friend class ParseCache;
+
 public:
   UseStmt(BaseAST* source, const char* modRename, bool isPrivate);
 
@@ -25,6 +25,8 @@
 
 class WhileStmt : public LoopStmt
 {
+  friend class ParseCache;
+
 public:
   Expr*                  condExprGet()                                const;
   SymExpr*               condExprForTmpVariableGet()                  const;
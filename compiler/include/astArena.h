@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _AST_ARENA_H_
+#define _AST_ARENA_H_
+
+#include <cstddef>
+
+/************************************* | **************************************
+*                                                                             *
+* Storage for AST nodes.                                                      *
+*                                                                             *
+* BaseAST routes operator new/delete here.  Nodes are carved out of large     *
+* chunks with a bump pointer, so nodes created together (a parsed module, a   *
+* function being instantiated) are adjacent in memory.  Nodes deleted by      *
+* cleanAst() go onto a free list for their size class and are handed back     *
+* out to the next node of that size, which is how the many temporaries that   *
+* normalize and resolve create and remove get recycled.  Nodes too large for  *
+* a size class come from malloc.                                              *
+*                                                                             *
+************************************** | *************************************/
+
+struct AstArenaStats
+{
+  size_t  chunkBytes;       // reserved in chunks
+  size_t  liveBytes;        // held by nodes that have not been deleted
+  size_t  peakLiveBytes;    // high-water mark of liveBytes
+  size_t  freeBytes;        // on the free lists, waiting to be recycled
+  size_t  largeBytes;       // live nodes too large for a size class
+  size_t  numAllocs;        // total allocations
+  size_t  numRecycled;      // allocations served from a free list
+};
+
+void* astArenaAlloc(size_t size);
+void  astArenaFree(void* ptr, size_t size);
+
+// Release every chunk at once.  No node may be used afterwards.
+void  astArenaRelease();
+
+void  astArenaGetStats(AstArenaStats* stats);
+
+#endif
@@ -286,6 +286,10 @@ public:
 
   static  const       std::string tabText;
 
+  // Nodes live in the AST arena; see astArena.h
+  static void*        operator new(size_t size);
+  static void         operator delete(void* ptr, size_t size);
+
 protected:
                     BaseAST(AstTag type);
   virtual          ~BaseAST();
@@ -303,6 +307,9 @@ GenRet baseASTCodegenString(const char* str);
 // get the current AST node id
 int    lastNodeIDUsed();
 
+// make the next AST node id be id + 1
+void   setLastNodeIDUsed(int id);
+
 // trace various AST node removals
 void   trace_remove(BaseAST* ast, char flag);
 
@@ -217,4 +217,17 @@ void redefiningReservedWordError(const char* name);
 // when defining an explicit operator.
 void updateOpThisTagOrErr(FnSymbol* fn);
 
+// Counters that number the functions built for let and scan expressions,
+// lambdas, and forwarding expressions.
+enum BuildCounter {
+  BUILD_COUNTER_LET_EXPR,
+  BUILD_COUNTER_SCAN_EXPR,
+  BUILD_COUNTER_LAMBDA,
+  BUILD_COUNTER_FORWARDING,
+  NUM_BUILD_COUNTERS
+};
+
+int  buildCounterGet(BuildCounter counter);
+void buildCounterSet(BuildCounter counter, int value);
+
 #endif
@@ -136,6 +136,10 @@ extern const char* CHPL_LLVM_UNIQ_CFG_PATH;
 extern bool  printPasses;
 extern FILE* printPassesFile;
 
+extern bool fPrintStartupTimings;
+extern bool fChplEnvCache;
+extern bool fParseCache;
+
 extern char fExplainCall[256];
 extern int  explainCallID;
 extern int  breakOnResolveID;
@@ -144,6 +144,8 @@ public:
 
 
 class SymExpr : public Expr {
+  friend class ParseCache;
+
  private:
   Symbol* var;
 
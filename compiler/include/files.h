@@ -91,6 +91,14 @@ void genIncludeCommandLineHeaders(FILE* outfile);
 const char* createDebuggerFile(const char* debugger, int argc, char* argv[]);
 
 std::string runPrintChplEnv(std::map<std::string, const char*> varMap);
+const char* chplEnvCacheStatus();
+std::string compilerCacheFile(const char* dirVar, const char* prefix,
+                              const std::string& key);
+void compilerCacheAddStat(std::string& key, const std::string& path);
+bool compilerCacheRead(const std::string& file, const std::string& key,
+                       std::string& contents);
+void compilerCacheWrite(const std::string& file, const std::string& key,
+                        const std::string& contents);
 std::string getChplDepsApp();
 bool compilingWithPrgEnv();
 std::string runCommand(std::string& command);
@@ -88,6 +88,7 @@ symbolFlag( FLAG_COERCE_TEMP , npr, "coerce temp" , "a temporary that was stores
 symbolFlag( FLAG_COERCE_FN,  ypr, "coerce fn" , "coerce copy/move function" )
 symbolFlag( FLAG_CODEGENNED , npr, "codegenned" , "code has been generated for this type" )
 symbolFlag( FLAG_COFORALL_INDEX_VAR , npr, "coforall index var" , ncm )
+symbolFlag( FLAG_COFORALL_ON , npr, "coforall on" , ncm )
 symbolFlag( FLAG_COMMAND_LINE_SETTING , ypr, "command line setting" , ncm )
 // The compiler-generated flag has these meanings:
 // 1. In various parts of the compiler, when printing filename/lineno
@@ -324,6 +325,7 @@ symbolFlag( FLAG_OBJECT_CLASS , ypr, "object class" , ncm )
 //  on+begin       FLAG_ON  FLAG_NON_BLOCKING  FLAG_BEGIN
 //  cobegin+on     FLAG_ON  FLAG_NON_BLOCKING  FLAG_COBEGIN_OR_COFORALL
 //  coforall+on    FLAG_ON  FLAG_NON_BLOCKING  FLAG_COBEGIN_OR_COFORALL
+//                 FLAG_COFORALL_ON
 //  just 'on'      FLAG_ON  // no new Chapel tasks
 // For each of the above flags, the task function's wrapper has
 // the corresponding flag:
@@ -332,6 +334,7 @@ symbolFlag( FLAG_OBJECT_CLASS , ypr, "object class" , ncm )
 //     btw it does not apply to local (non-'on') task functions/wrappers)
 //   FLAG_BEGIN               --> FLAG_BEGIN_BLOCK
 //   FLAG_COBEGIN_OR_COFORALL --> FLAG_COBEGIN_OR_COFORALL_BLOCK
+//   FLAG_COFORALL_ON         --> FLAG_COFORALL_ON (the same flag)
 //
 symbolFlag( FLAG_ON , npr, "on" , ncm )
 symbolFlag( FLAG_ON_BLOCK , npr, "on block" , ncm )
@@ -427,6 +430,7 @@ symbolFlag( FLAG_SAFE, ypr, "safe", "safe (activate lifetime checking)")
 symbolFlag( FLAG_SCOPE, npr, "scope", "scoped (lifetime checking like a local variable)")
 symbolFlag( FLAG_SHOULD_NOT_PASS_BY_REF, npr, "should not pass by ref", "this symbol should be passed by value (not by reference) for performance, not for correctness")
 symbolFlag( FLAG_SINGLE , ypr, "single" , ncm )
+symbolFlag( FLAG_STACKLESS_TASK , npr, "stackless task" , "task function wrapper whose task runs to completion and need not have a stack of its own" )
 // Based on how this is used, I suggest renaming it to return_value_has_initializer
 // or something similar <hilde>.
 symbolFlag( FLAG_STAR_TUPLE , ypr, "star tuple" , "mark tuple types as star tuple types" )
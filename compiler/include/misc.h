@@ -111,6 +111,7 @@ void        printCallStack();
 void        printCallStackCalls();
 
 bool        fatalErrorsEncountered();
+int         diagnosticCount();
 void        clearFatalErrors();
 
 bool printsSameLocationAsLastError(const BaseAST* ast);
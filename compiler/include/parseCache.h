@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PARSE_CACHE_H_
+#define _PARSE_CACHE_H_
+
+/* The parse cache saves the AST that the parser builds for an internal
+   or standard module file on disk, and rebuilds it on a later compile
+   instead of lexing and parsing the file again.  See parseCache.cpp. */
+
+#include <cstdio>
+#include <cstdint>
+
+#include "symbol.h"
+
+class VisibilityStmt;
+
+// Returns the block the parser would build for the file, or NULL if it
+// has to be parsed.  Every call must be matched by parseCacheStore().
+BlockStmt* parseCacheLoad(const char* path,
+                          FILE*       fp,
+                          ModTag      modTag,
+                          bool        namedOnCommandLine,
+                          bool        include);
+
+// Called with the parser's result, or with the block parseCacheLoad()
+// returned.  Saves a parse that parseCacheLoad() could not provide.
+void       parseCacheStore(BlockStmt* block);
+
+// Notes parser actions that the cache must replay or depend on
+void       parseCacheNoteModuleUse(const char* name, VisibilityStmt* stmt);
+void       parseCacheNoteConfig(const char* name, bool found);
+
+// Keeps the file being parsed out of the cache
+void       parseCacheSkipFile();
+
+//
+// Records the creation of a literal while a file is parsed, so that it
+// can be redone when the parse is loaded from the cache.  A literal is
+// shared by all its uses, so it can't be part of the saved AST.
+//
+class ParseCacheLiteral {
+public:
+  ParseCacheLiteral(VarSymbol*& result,
+                    int         constKind,
+                    int         subKind,
+                    const char* text,
+                    uint64_t    num);
+  ~ParseCacheLiteral();
+
+private:
+  VarSymbol*& mResult;
+  bool        mRecording;
+  int         mEvent;
+};
+
+//
+// Saves and restores the fields of AST nodes.  The AST classes name it
+// a friend so that it can reach their private fields.
+//
+class ParseCache {
+public:
+  template <class Archive>
+  static void     transferFields(Archive& ar, BaseAST* ast);
+
+  static BaseAST* makeShell(AstTag     tag,
+                            int        subKind,
+                            BlockStmt* dummy,
+                            Type*      type);
+  static int      shellSubKind(BaseAST* ast);
+};
+
+#endif
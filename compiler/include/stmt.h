@@ -59,6 +59,8 @@ public:
 class ResolveScope;
 
 class VisibilityStmt: public Stmt {
+  friend class ParseCache;
+
  public:
   VisibilityStmt(AstTag astTag);
 
@@ -115,6 +117,8 @@ enum BlockTag {
 };
 
 class BlockStmt : public Stmt {
+  friend class ParseCache;
+
 public:
                       BlockStmt(Expr*    initBody     = NULL,
                                 BlockTag initBlockTag = BLOCK_NORMAL);
@@ -198,6 +202,8 @@ private:
 ************************************** | *************************************/
 
 class CondStmt : public Stmt {
+  friend class ParseCache;
+
 public:
                       CondStmt(Expr*    iCondExpr,
                                BaseAST* iThenStmt,
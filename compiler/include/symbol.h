@@ -299,6 +299,8 @@ private:
 ************************************** | *************************************/
 
 class VarSymbol : public LcnSymbol {
+  friend class ParseCache;
+
 public:
   // Note that string immediate values are stored
   // with C escapes - that is newline is 2 chars \ n
@@ -778,6 +780,7 @@ extern bool localTempNames;
 
 extern HashMap<Immediate*, ImmHashFns, VarSymbol*> uniqueConstantsHash;
 extern HashMap<Immediate*, ImmHashFns, VarSymbol*> stringLiteralsHash;
+extern HashMap<Immediate*, ImmHashFns, VarSymbol*> bytesLiteralsHash;
 
 extern StringChainHash uniqueStringHash;
 
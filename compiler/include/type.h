@@ -58,6 +58,8 @@ class VarSymbol;
 class IteratorInfo;
 
 class Type : public BaseAST {
+  friend class ParseCache;
+
 public:
   virtual Type*          copy(SymbolMap* map      = NULL,
                               bool       internal = false)                 = 0;
@@ -51,6 +51,8 @@
 #include <inttypes.h>
 #include <string>
 #include <sstream>
+#include <utility>
+#include <vector>
 #include <map>
 
 #ifdef HAVE_LLVM
@@ -170,6 +172,10 @@ bool fReportAutoAggregation= false;
 bool  printPasses     = false;
 FILE* printPassesFile = NULL;
 
+bool fPrintStartupTimings = false;
+bool fChplEnvCache = true;
+bool fParseCache = false;
+
 // flag for llvmWideOpt
 bool fLLVMWideOpt = false;
 
@@ -1004,6 +1010,7 @@ static ArgumentDescription arg_desc[] = {
  {"print-commands", ' ', NULL, "[Don't] print system commands", "N", &printSystemCommands, "CHPL_PRINT_COMMANDS", NULL},
  {"print-passes", ' ', NULL, "[Don't] print compiler passes", "N", &printPasses, "CHPL_PRINT_PASSES", NULL},
  {"print-passes-file", ' ', "<filename>", "Print compiler passes to <filename>", "S", NULL, "CHPL_PRINT_PASSES_FILE", setPrintPassesFile},
+ {"print-startup-timings", ' ', NULL, "[Don't] print the time spent in compiler startup", "N", &fPrintStartupTimings, "CHPL_PRINT_STARTUP_TIMINGS", NULL},
 
  {"", ' ', NULL, "Miscellaneous Options", NULL, NULL, NULL, NULL},
  DRIVER_ARG_DEVELOPER,
@@ -1020,6 +1027,8 @@ static ArgumentDescription arg_desc[] = {
 
  {"", ' ', NULL, "Compiler Configuration Options", NULL, NULL, NULL, NULL},
  {"home", ' ', "<path>", "Path to Chapel's home directory", "S", NULL, "_CHPL_HOME", setHome},
+ {"chplenv-cache", ' ', NULL, "[Don't] reuse cached printchplenv results", "N", &fChplEnvCache, "CHPL_CHPLENV_CACHE", NULL},
+ {"parse-cache", ' ', NULL, "[Don't] reuse cached parses of library modules", "N", &fParseCache, "CHPL_PARSE_CACHE", NULL},
  {"atomics", ' ', "<atomics-impl>", "Specify atomics implementation", "S", NULL, "_CHPL_ATOMICS", setEnv},
  {"network-atomics", ' ', "<network>", "Specify network atomics implementation", "S", NULL, "_CHPL_NETWORK_ATOMICS", setEnv},
  {"aux-filesys", ' ', "<aio-system>", "Specify auxiliary I/O system", "S", NULL, "_CHPL_AUX_FILESYS", setEnv},
@@ -1591,8 +1600,45 @@ static void postprocess_args() {
   checkUnsupportedConfigs();
 }
 
+//
+// Break the "init" phase of --print-passes down into its steps.  Most of it
+// is spent resolving the CHPL_* environment, so say whether that was served
+// from the chplenv cache.
+//
+static void noteStartupStep(Timer& timer, const char* name,
+                            std::vector<std::pair<const char*, double> >& steps) {
+  timer.stop();
+  steps.push_back(std::make_pair(name, timer.elapsedSecs()));
+  timer.clear();
+  timer.start();
+}
+
+static void printStartupTimings(std::vector<std::pair<const char*, double> >& steps) {
+  double total = 0.0;
+
+  fprintf(stderr, "Startup timings:\n");
+
+  for (size_t i = 0; i < steps.size(); i++) {
+    fprintf(stderr, "%32s :%8.3f seconds", steps[i].first, steps[i].second);
+
+    if (strcmp(steps[i].first, "chplenv") == 0)
+      fprintf(stderr, "  (cache %s)", chplEnvCacheStatus());
+
+    fprintf(stderr, "\n");
+
+    total += steps[i].second;
+  }
+
+  fprintf(stderr, "%32s :%8.3f seconds\n\n", "total startup", total);
+}
+
 int main(int argc, char* argv[]) {
   PhaseTracker tracker;
+  Timer        startupTimer;
+
+  std::vector<std::pair<const char*, double> > startupSteps;
+
+  startupTimer.start();
 
   startCatchingSignals();
 
@@ -1625,10 +1671,16 @@ int main(int argc, char* argv[]) {
 
     initStringLiteralModule();
 
+    noteStartupStep(startupTimer, "initialize AST", startupSteps);
+
     process_args(&sArgState, argc, argv);
 
+    noteStartupStep(startupTimer, "process arguments", startupSteps);
+
     setupChplGlobals(argv[0]);
 
+    noteStartupStep(startupTimer, "chplenv", startupSteps);
+
     postprocess_args();
 
     initCompilerGlobals(); // must follow argument parsing
@@ -1636,8 +1688,13 @@ int main(int argc, char* argv[]) {
     setupModulePaths();
 
     recordCodeGenStrings(argc, argv);
+
+    noteStartupStep(startupTimer, "postprocess arguments", startupSteps);
   } // astlocMarker scope
 
+  if (fPrintStartupTimings)
+    printStartupTimings(startupSteps);
+
   printStuff(argv[0]);
 
   if (fRungdb)
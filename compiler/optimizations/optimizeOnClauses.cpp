@@ -24,6 +24,10 @@
 // The comm layer can provide a "fast" option, for example, run within
 //  the handler (rather than creating a new task).
 //
+// Also mark begin, cobegin and coforall tasks that run to completion
+//  once started, which the tasking layer can run without giving them
+//  a stack of their own.
+//
 
 #include "passes.h"
 
@@ -34,6 +38,7 @@
 #include "stmt.h"
 #include "wellknown.h"
 
+#include <map>
 #include <vector>
 
 
@@ -493,6 +498,90 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   }
 }
 
+// Can fn, once called, run to completion without waiting for another
+// task?  It must not use sync variables, yield, create tasks or move to
+// another locale, which rules out extern functions other than those that
+// are fast-on safe.  Loops are ruled out too, both because they can have
+// arbitrary trip counts and because waiting on an atomic variable takes
+// one, and so is recursion.  Decrementing a task's end count is fine:
+// it only has to wait for a lock that another running task holds, and
+// so is halting, since the program does not continue after it.
+static bool
+runsToCompletion(FnSymbol* fn, int recurse, std::map<FnSymbol*, int>& visited) {
+  enum { IN_PROGRESS, YES, NO };
+
+  std::map<FnSymbol*, int>::iterator it = visited.find(fn);
+  if (it != visited.end())
+    return it->second == YES;
+
+  if (fn->hasFlag(FLAG_DOWN_END_COUNT_FN) ||
+      fn->hasFlag(FLAG_FUNCTION_TERMINATES_PROGRAM))
+    return true;
+
+  if (fn->hasFlag(FLAG_EXTERN))
+    return fn->hasFlag(FLAG_FAST_ON_SAFE_EXTERN);
+
+  visited[fn] = IN_PROGRESS;
+
+  bool retval = true;
+
+  std::vector<Expr*> stmts;
+  collect_stmts(fn->body, stmts);
+  for_vector(Expr, stmt, stmts) {
+    if (BlockStmt* block = toBlockStmt(stmt)) {
+      if (block->isLoopStmt()) {
+        retval = false;
+        break;
+      }
+    }
+  }
+
+  std::vector<CallExpr*> calls;
+  collectCallExprs(fn, calls);
+  for_vector(CallExpr, call, calls) {
+    if (retval == false)
+      break;
+
+    if (call->primitive) {
+      if (call->isPrimitive(PRIM_UNKNOWN) ||
+          call->isPrimitive(PRIM_FTABLE_CALL) ||
+          call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL))
+        retval = false;
+
+    } else if (recurse <= 0 || !call->isResolved()) {
+      retval = false;
+
+    } else {
+      FnSymbol* callee = call->resolvedFunction();
+
+      if (callee->hasFlag(FLAG_ON_BLOCK) ||
+          callee->hasFlag(FLAG_BEGIN_BLOCK) ||
+          callee->hasFlag(FLAG_COBEGIN_OR_COFORALL_BLOCK))
+        retval = false;
+      else
+        retval = runsToCompletion(callee, recurse - 1, visited);
+    }
+  }
+
+  visited[fn] = retval ? YES : NO;
+
+  return retval;
+}
+
+static void
+markStacklessTasks() {
+  std::map<FnSymbol*, int> visited;
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if ((fn->hasFlag(FLAG_BEGIN_BLOCK) ||
+         fn->hasFlag(FLAG_COBEGIN_OR_COFORALL_BLOCK)) &&
+        !fn->hasFlag(FLAG_ON_BLOCK) &&
+        runsToCompletion(fn, optimize_on_clause_limit, visited)) {
+      fn->addFlag(FLAG_STACKLESS_TASK);
+    }
+  }
+}
+
 // Removes PRIM_START_RMEM_FENCE and PRIM_FINISH_RMEM_FENCE
 // from the passed function.
 // For reporting purposes, returns true if the function actually
@@ -577,6 +666,8 @@ static void addRunningTaskModifiers(void) {
 
 void
 optimizeOnClauses(void) {
+  markStacklessTasks();
+
   if (fNoOptimizeOnClauses) {
     addRunningTaskModifiers();
     return;
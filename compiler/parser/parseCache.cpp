@@ -0,0 +1,2696 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/************************************* | **************************************
+*                                                                             *
+* The parse cache (--parse-cache) saves the block that the parser builds for  *
+* an internal or standard module file, and builds it again from the saved    *
+* copy on later compiles instead of lexing and parsing the file.             *
+*                                                                             *
+* The rebuilt AST has to be indistinguishable from what the parser would     *
+* have built, down to the node ids, because later passes order sets of       *
+* nodes by id.  So the nodes are recreated in their original order with      *
+* their original ids relative to the first id the parse used.                *
+*                                                                             *
+* Parsing a file also changes state outside of the block.  Literals are      *
+* shared by all files, so their creation is recorded (ParseCacheLiteral)     *
+* and redone at the same point; the ids it uses may differ when the literal  *
+* already exists, and the ids after it shift to match.  Uses of modules,     *
+* the counters used to name generated functions, and the SymExpr lists of    *
+* the symbols the block refers to are saved and restored as well.  A parse   *
+* that does anything else outside of the block, or that reports anything,    *
+* is not saved.                                                              *
+*                                                                             *
+* Each cache file is named by a hash of a key that covers the compiler, the  *
+* file's contents, and the settings that affect parsing, and starts with    *
+* that key, so a stale or colliding entry is never used.                     *
+*                                                                             *
+************************************** | *************************************/
+
+#include "parseCache.h"
+
+#include "AggregateType.h"
+#include "astutil.h"
+#include "build.h"
+#include "CatchStmt.h"
+#include "CForLoop.h"
+#include "config.h"
+#include "DecoratedClassType.h"
+#include "DeferStmt.h"
+#include "docsDriver.h"
+#include "DoWhileStmt.h"
+#include "driver.h"
+#include "expr.h"
+#include "files.h"
+#include "ForallStmt.h"
+#include "ForLoop.h"
+#include "IfExpr.h"
+#include "ImportStmt.h"
+#include "LoopExpr.h"
+#include "misc.h"
+#include "ParamForLoop.h"
+#include "parser.h"
+#include "primitive.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "TryStmt.h"
+#include "type.h"
+#include "UseStmt.h"
+#include "version.h"
+#include "WhileDoStmt.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+static const char* parseCacheHeader = "# parse cache v1\n";
+static const char* parseCacheSep    = "\n# parse cache data\n";
+
+/************************************* | **************************************
+*                                                                             *
+* State of the parse being recorded                                           *
+*                                                                             *
+************************************** | *************************************/
+
+struct LiteralEvent {
+  int         kind;
+  int         subKind;
+  const char* text;
+  uint64_t    num;
+  int         line;
+  int         start;      // ids used, relative to the first id of the parse
+  int         end;
+  VarSymbol*  result;
+};
+
+#define declare_gvec_size(type) int n##type
+struct GVecSizes {
+  foreach_ast(declare_gvec_size);
+};
+#undef declare_gvec_size
+
+typedef std::pair<const char*, VisibilityStmt*> ModuleUse;
+
+static int                       sNesting      = 0;
+static bool                      sArmed        = false;
+static bool                      sStorable     = false;
+static int                       sLiteralDepth = 0;
+
+static int                       sBase         = 0;
+static int                       sDiagnostics  = 0;
+static int                       sCounters[NUM_BUILD_COUNTERS];
+static GVecSizes                 sGVecSizes;
+static std::vector<LiteralEvent> sEvents;
+static std::vector<const char*>  sConfigs;
+static std::vector<ModuleUse>    sModuleUses;
+static const char*               sPath         = NULL;
+static std::string               sFile;
+static std::string               sKey;
+
+ParseCacheLiteral::ParseCacheLiteral(VarSymbol*& result,
+                                     int         constKind,
+                                     int         subKind,
+                                     const char* text,
+                                     uint64_t    num)
+  : mResult(result), mRecording(sArmed), mEvent(-1) {
+
+  // Only the outermost literal is redone; it creates the ones it uses
+  if (mRecording == true) {
+    if (sLiteralDepth == 0) {
+      LiteralEvent event;
+
+      event.kind    = constKind;
+      event.subKind = subKind;
+      event.text    = (text != NULL) ? astr(text) : NULL;
+      event.num     = num;
+      event.line    = yystartlineno;
+      event.start   = lastNodeIDUsed() + 1 - sBase;
+      event.end     = event.start;
+      event.result  = NULL;
+
+      mEvent = (int) sEvents.size();
+
+      sEvents.push_back(event);
+    }
+
+    sLiteralDepth++;
+  }
+}
+
+ParseCacheLiteral::~ParseCacheLiteral() {
+  if (mRecording == true) {
+    sLiteralDepth--;
+
+    if (mEvent >= 0) {
+      sEvents[mEvent].end    = lastNodeIDUsed() + 1 - sBase;
+      sEvents[mEvent].result = mResult;
+    }
+  }
+}
+
+void parseCacheNoteModuleUse(const char* name, VisibilityStmt* stmt) {
+  if (sArmed == true) {
+    sModuleUses.push_back(ModuleUse(astr(name), stmt));
+  }
+}
+
+void parseCacheNoteConfig(const char* name, bool found) {
+  if (sArmed == true) {
+    if (found == true) {
+      sStorable = false;
+    } else {
+      sConfigs.push_back(astr(name));
+    }
+  }
+}
+
+void parseCacheSkipFile() {
+  sStorable = false;
+}
+
+// The number of literal events that start at or before 'offset'
+static int eventsBefore(int offset) {
+  int lo = 0;
+  int hi = (int) sEvents.size();
+
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+
+    if (sEvents[mid].start <= offset) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+// The literal event that used the id at 'offset', or -1
+static int eventContaining(int offset) {
+  int index = eventsBefore(offset) - 1;
+
+  if (index >= 0 && offset < sEvents[index].end) {
+    return index;
+  }
+
+  return -1;
+}
+
+/************************************* | **************************************
+*                                                                             *
+* Symbols outside of the block that the block may refer to                    *
+*                                                                             *
+************************************** | *************************************/
+
+enum ExternalKind {
+  EXTERNAL_LITERAL,
+  EXTERNAL_WELL_KNOWN,
+  EXTERNAL_ROOT_SYMBOL,
+  EXTERNAL_ROOT_TYPE
+};
+
+struct External {
+  int         kind;
+  int         index;      // EXTERNAL_WELL_KNOWN
+  const char* name;       // EXTERNAL_ROOT_SYMBOL, EXTERNAL_ROOT_TYPE
+  Immediate   imm;        // EXTERNAL_LITERAL
+  int         producer;   // EXTERNAL_LITERAL: event that makes it, or -1
+  bool        result;     // EXTERNAL_LITERAL: the producer returns it
+  BaseAST*    ast;
+};
+
+static const int NUM_WELL_KNOWN = 15;
+
+static void wellKnownExternals(BaseAST* table[NUM_WELL_KNOWN]) {
+  AggregateType* types[] = {
+    dtObject, dtBytes, dtString, dtLocale, dtOwned, dtShared
+  };
+  int            n       = 0;
+
+  table[n++] = rootModule;
+  table[n++] = theProgram;
+  table[n++] = stringLiteralModule;
+
+  for (int i = 0; i < 6; i++) {
+    table[n++] = types[i];
+    table[n++] = (types[i] != NULL) ? types[i]->symbol : NULL;
+  }
+
+  INT_ASSERT(n == NUM_WELL_KNOWN);
+}
+
+static VarSymbol* findLiteral(Immediate* imm) {
+  if (imm->const_kind == CONST_KIND_STRING) {
+    if (imm->string_kind == STRING_KIND_STRING) {
+      return stringLiteralsHash.get(imm);
+
+    } else if (imm->string_kind == STRING_KIND_BYTES) {
+      return bytesLiteralsHash.get(imm);
+    }
+  }
+
+  return uniqueConstantsHash.get(imm);
+}
+
+static bool isLiteral(BaseAST* ast) {
+  VarSymbol* var = toVarSymbol(ast);
+
+  return var                          != NULL &&
+         var->immediate               != NULL &&
+         findLiteral(var->immediate)  == var;
+}
+
+//
+// The symbols defined in the root module, by name.  Names defined more than
+// once map to NULL.  The root module only grows while parsing, so the table
+// is extended rather than rebuilt.
+//
+static std::map<const char*, Symbol*> sRootSymbols;
+static Expr*                          sRootLast = NULL;
+
+static Symbol* rootSymbolNamed(const char* name) {
+  AList& body = rootModule->block->body;
+  Expr*  stmt = (sRootLast != NULL) ? sRootLast->next : body.head;
+
+  if (sRootLast != NULL && sRootLast->list != &body) {
+    sRootSymbols.clear();
+    stmt = body.head;
+  }
+
+  for (; stmt != NULL; stmt = stmt->next) {
+    sRootLast = stmt;
+
+    if (DefExpr* def = toDefExpr(stmt)) {
+      if (isLiteral(def->sym) == false) {
+        std::map<const char*, Symbol*>::iterator it;
+
+        it = sRootSymbols.find(def->sym->name);
+
+        if (it == sRootSymbols.end()) {
+          sRootSymbols[def->sym->name] = def->sym;
+
+        } else if (it->second != def->sym) {
+          it->second = NULL;
+        }
+      }
+    }
+  }
+
+  std::map<const char*, Symbol*>::iterator it = sRootSymbols.find(name);
+
+  return (it != sRootSymbols.end()) ? it->second : NULL;
+}
+
+/************************************* | **************************************
+*                                                                             *
+* The encoding                                                                *
+*                                                                             *
+* Integers are zigzag varints.  A string is 0 for NULL, or 1 + its index in  *
+* the string table.  A reference to a node is 0 for NULL, 1 + the node's     *
+* index, or -1 - the index of an external.                                   *
+*                                                                             *
+************************************** | *************************************/
+
+static void putInt(std::string& out, int64_t value) {
+  uint64_t bits = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+
+  while (bits >= 0x80) {
+    out += (char) ((bits & 0x7f) | 0x80);
+    bits >>= 7;
+  }
+
+  out += (char) bits;
+}
+
+static uint64_t hashBytes(const char* data, size_t size) {
+  uint64_t hash = 14695981039346656037ULL;   // FNV-1a
+
+  for (size_t i = 0; i < size; i++) {
+    hash ^= (unsigned char) data[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+static bool isSupportedTag(int tag) {
+  switch (tag) {
+    case E_ContextCallExpr:
+    case E_IfcConstraint:
+    case E_ImplementsStmt:
+    case E_InterfaceSymbol:
+    case E_ConstrainedType:
+    case E_DecoratedClassType:
+      return false;
+
+    default:
+      return tag >= E_SymExpr && tag <= E_DecoratedClassType;
+  }
+}
+
+static bool isSymbolTag(int tag) {
+  return tag >= E_ModuleSymbol && tag <= E_LabelSymbol;
+}
+
+static bool isTypeTag(int tag) {
+  return tag >= E_PrimitiveType && tag <= E_DecoratedClassType;
+}
+
+// The shells that are built with a placeholder for a required child
+static bool shellNeedsDummy(int tag) {
+  return tag == E_IfExpr    || tag == E_CondStmt   ||
+         tag == E_UseStmt   || tag == E_ImportStmt ||
+         tag == E_ForallStmt;
+}
+
+class ParseCacheWriter {
+public:
+  static const bool reading = false;
+
+                 ParseCacheWriter(const std::vector<BaseAST*>& nodes,
+                                  const std::vector<int>&      indexOf,
+                                  const char*                  path);
+
+  void           boolean(bool& flag)        { putInt(*mOut, flag ? 1 : 0); }
+  void           str(const char*& text)     { putInt(*mOut, stringCode(text)); }
+  void           require(bool condition)    { if (!condition) failed = true; }
+
+  template <class T>
+  void           value(T& val)              { putInt(*mOut, (int64_t) val); }
+
+  template <class T>
+  void           ref(T*& ast)               { putInt(*mOut, refCode(ast)); }
+
+  template <class T>
+  void           refVec(Vec<T*>& vec);
+
+  template <class T>
+  void           refVec(std::vector<T*>& vec);
+
+  void           prim(PrimitiveOp*& op);
+  void           list(AList& alist);
+  void           flagSet(FlagSet& flags);
+  void           loc(astlocT& astloc);
+  void           strVec(std::vector<const char*>& vec);
+  void           strSet(std::set<const char*>& set);
+  void           strMap(std::map<const char*, const char*>& map);
+
+  void           select(std::string& out)   { mOut = &out; }
+
+  int            nodeIndex(BaseAST* ast)                        const;
+  int64_t        refCode(BaseAST* ast);
+  int64_t        stringCode(const char* text);
+
+  bool                     failed;
+  std::vector<bool>        listed;
+  std::vector<External>    externals;
+  std::vector<std::string> strings;
+
+private:
+  int            externalIndex(BaseAST* ast);
+
+  const std::vector<BaseAST*>& mNodes;
+  const std::vector<int>&      mIndexOf;
+  const char*                  mPath;
+  std::string*                 mOut;
+  std::map<BaseAST*, int>      mExternalIndex;
+  std::map<std::string, int>   mStringIndex;
+};
+
+ParseCacheWriter::ParseCacheWriter(const std::vector<BaseAST*>& nodes,
+                                   const std::vector<int>&      indexOf,
+                                   const char*                  path)
+  : failed(false),
+    listed(nodes.size(), false),
+    mNodes(nodes),
+    mIndexOf(indexOf),
+    mPath(path),
+    mOut(NULL) {
+}
+
+int ParseCacheWriter::nodeIndex(BaseAST* ast) const {
+  int offset = ast->id - sBase;
+
+  if (offset >= 0 && offset < (int) mIndexOf.size()) {
+    int index = mIndexOf[offset];
+
+    if (index >= 0 && mNodes[index] == ast) {
+      return index;
+    }
+  }
+
+  return -1;
+}
+
+int64_t ParseCacheWriter::refCode(BaseAST* ast) {
+  if (ast == NULL) {
+    return 0;
+  }
+
+  int index = nodeIndex(ast);
+
+  if (index >= 0) {
+    return index + 1;
+  }
+
+  index = externalIndex(ast);
+
+  if (index < 0) {
+    failed = true;
+    return 0;
+  }
+
+  return -(int64_t) index - 1;
+}
+
+int ParseCacheWriter::externalIndex(BaseAST* ast) {
+  std::map<BaseAST*, int>::iterator it = mExternalIndex.find(ast);
+
+  if (it != mExternalIndex.end()) {
+    return it->second;
+  }
+
+  External ext;
+
+  ext.kind     = -1;
+  ext.index    = 0;
+  ext.name     = NULL;
+  ext.producer = -1;
+  ext.result   = false;
+  ext.ast      = ast;
+
+  if (isLiteral(ast) == true) {
+    ext.kind = EXTERNAL_LITERAL;
+    ext.imm  = *toVarSymbol(ast)->immediate;
+
+  } else if (ast->id < sBase) {
+    BaseAST* table[NUM_WELL_KNOWN];
+
+    wellKnownExternals(table);
+
+    for (int i = 0; i < NUM_WELL_KNOWN && ext.kind < 0; i++) {
+      if (table[i] == ast) {
+        ext.kind  = EXTERNAL_WELL_KNOWN;
+        ext.index = i;
+      }
+    }
+
+    if (ext.kind < 0) {
+      if (Symbol* sym = toSymbol(ast)) {
+        if (rootSymbolNamed(sym->name) == sym) {
+          ext.kind = EXTERNAL_ROOT_SYMBOL;
+          ext.name = sym->name;
+        }
+
+      } else if (Type* type = toType(ast)) {
+        if (type->symbol                          != NULL &&
+            rootSymbolNamed(type->symbol->name)   == type->symbol) {
+          ext.kind = EXTERNAL_ROOT_TYPE;
+          ext.name = type->symbol->name;
+        }
+      }
+    }
+  }
+
+  if (ext.kind < 0) {
+    return -1;
+  }
+
+  int index = (int) externals.size();
+
+  externals.push_back(ext);
+  mExternalIndex[ast] = index;
+
+  return index;
+}
+
+int64_t ParseCacheWriter::stringCode(const char* text) {
+  if (text == NULL) {
+    return 0;
+  }
+
+  std::string                          key = text;
+  std::map<std::string, int>::iterator it  = mStringIndex.find(key);
+
+  if (it != mStringIndex.end()) {
+    return it->second + 1;
+  }
+
+  int index = (int) strings.size();
+
+  strings.push_back(key);
+  mStringIndex[key] = index;
+
+  return index + 1;
+}
+
+template <class T>
+void ParseCacheWriter::refVec(Vec<T*>& vec) {
+  require(vec.i == 0);
+
+  putInt(*mOut, vec.n);
+
+  for (int i = 0; i < vec.n; i++) {
+    putInt(*mOut, refCode(vec.v[i]));
+  }
+}
+
+template <class T>
+void ParseCacheWriter::refVec(std::vector<T*>& vec) {
+  putInt(*mOut, vec.size());
+
+  for (size_t i = 0; i < vec.size(); i++) {
+    putInt(*mOut, refCode(vec[i]));
+  }
+}
+
+void ParseCacheWriter::prim(PrimitiveOp*& op) {
+  if (op == NULL) {
+    putInt(*mOut, 0);
+
+  } else if (op->tag == PRIM_UNKNOWN) {
+    // Primitives without a tag are known by their names
+    require(primitives_map.get(op->name) == op);
+
+    putInt(*mOut, PRIM_UNKNOWN + 1);
+    str(op->name);
+
+  } else {
+    require(op->tag < NUM_KNOWN_PRIMS && primitives[op->tag] == op);
+
+    putInt(*mOut, op->tag + 1);
+  }
+}
+
+void ParseCacheWriter::list(AList& alist) {
+  Expr* prev  = NULL;
+  int   count = 0;
+
+  putInt(*mOut, alist.length);
+
+  for_alist(expr, alist) {
+    int index = nodeIndex(expr);
+
+    if (index < 0 || expr->list != &alist || expr->prev != prev ||
+        count == alist.length) {
+      failed = true;
+      return;
+    }
+
+    listed[index] = true;
+
+    putInt(*mOut, index + 1);
+
+    prev  = expr;
+    count = count + 1;
+  }
+
+  require(count == alist.length && alist.tail == prev);
+
+  ref(alist.parent);
+}
+
+void ParseCacheWriter::flagSet(FlagSet& flags) {
+  putInt(*mOut, flags.count());
+
+  for (size_t i = 0; i < flags.size(); i++) {
+    if (flags[i]) {
+      putInt(*mOut, i);
+    }
+  }
+}
+
+void ParseCacheWriter::loc(astlocT& astloc) {
+  putInt(*mOut, astloc.lineno);
+
+  if (astloc.filename == NULL) {
+    putInt(*mOut, 0);
+
+  } else if (astloc.filename == mPath) {
+    putInt(*mOut, 1);
+
+  } else {
+    putInt(*mOut, stringCode(astloc.filename) + 1);
+  }
+}
+
+void ParseCacheWriter::strVec(std::vector<const char*>& vec) {
+  putInt(*mOut, vec.size());
+
+  for (size_t i = 0; i < vec.size(); i++) {
+    str(vec[i]);
+  }
+}
+
+void ParseCacheWriter::strSet(std::set<const char*>& set) {
+  putInt(*mOut, set.size());
+
+  for (std::set<const char*>::iterator it = set.begin();
+       it != set.end();
+       ++it) {
+    const char* text = *it;
+
+    str(text);
+  }
+}
+
+void ParseCacheWriter::strMap(std::map<const char*, const char*>& map) {
+  putInt(*mOut, map.size());
+
+  for (std::map<const char*, const char*>::iterator it = map.begin();
+       it != map.end();
+       ++it) {
+    const char* key = it->first;
+
+    str(key);
+    str(it->second);
+  }
+}
+
+class ParseCacheReader {
+public:
+  static const bool reading = true;
+
+                 ParseCacheReader(const char* begin,
+                                  const char* end,
+                                  const char* path);
+
+  void           boolean(bool& flag)        { flag = getInt() != 0; }
+  void           str(const char*& text)     { text = getString(); }
+  void           require(bool condition)    { }
+
+  template <class T>
+  void           value(T& val)              { val = (T) getInt(); }
+
+  template <class T>
+  void           ref(T*& ast);
+
+  template <class T>
+  void           refVec(Vec<T*>& vec);
+
+  template <class T>
+  void           refVec(std::vector<T*>& vec);
+
+  void           prim(PrimitiveOp*& op);
+  void           list(AList& alist);
+  void           flagSet(FlagSet& flags);
+  void           loc(astlocT& astloc);
+  void           strVec(std::vector<const char*>& vec);
+  void           strSet(std::set<const char*>& set);
+  void           strMap(std::map<const char*, const char*>& map);
+
+  int64_t        getInt();
+  int            getCount();
+  const char*    getString();
+  const char*    getLocFile();
+  bool           getBytes(void* data, size_t size);
+  BaseAST*       getRef();
+  bool           done()                                         const;
+
+  bool                     bad;
+  std::vector<const char*> strings;
+  std::vector<BaseAST*>    nodes;
+  std::vector<BaseAST*>    externals;
+
+private:
+  const char*    mPos;
+  const char*    mEnd;
+  const char*    mPath;
+};
+
+ParseCacheReader::ParseCacheReader(const char* begin,
+                                   const char* end,
+                                   const char* path)
+  : bad(false), mPos(begin), mEnd(end), mPath(path) {
+}
+
+int64_t ParseCacheReader::getInt() {
+  uint64_t bits  = 0;
+  int      shift = 0;
+
+  while (true) {
+    if (mPos == mEnd || shift > 63) {
+      bad = true;
+      return 0;
+    }
+
+    unsigned char byte = *mPos++;
+
+    bits |= (uint64_t) (byte & 0x7f) << shift;
+
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+
+    shift += 7;
+  }
+
+  return (int64_t) (bits >> 1) ^ -(int64_t) (bits & 1);
+}
+
+// A count of items that each take at least one byte
+int ParseCacheReader::getCount() {
+  int64_t count = getInt();
+
+  if (count < 0 || count > mEnd - mPos) {
+    bad = true;
+    return 0;
+  }
+
+  return (int) count;
+}
+
+const char* ParseCacheReader::getString() {
+  int64_t code = getInt();
+
+  if (code < 0 || code > (int64_t) strings.size()) {
+    bad = true;
+    return NULL;
+  }
+
+  return (code > 0) ? strings[code - 1] : NULL;
+}
+
+const char* ParseCacheReader::getLocFile() {
+  int64_t code = getInt();
+
+  if (code == 0) {
+    return NULL;
+
+  } else if (code == 1) {
+    return mPath;
+
+  } else if (code < 0 || code - 1 > (int64_t) strings.size()) {
+    bad = true;
+    return NULL;
+  }
+
+  return strings[code - 2];
+}
+
+bool ParseCacheReader::getBytes(void* data, size_t size) {
+  if ((size_t) (mEnd - mPos) < size) {
+    bad = true;
+    return false;
+  }
+
+  memcpy(data, mPos, size);
+  mPos += size;
+
+  return true;
+}
+
+BaseAST* ParseCacheReader::getRef() {
+  int64_t code = getInt();
+
+  if (code > 0) {
+    INT_ASSERT(code <= (int64_t) nodes.size());
+
+    return nodes[code - 1];
+
+  } else if (code < 0) {
+    INT_ASSERT(-code <= (int64_t) externals.size());
+    INT_ASSERT(externals[-code - 1] != NULL);
+
+    return externals[-code - 1];
+  }
+
+  return NULL;
+}
+
+bool ParseCacheReader::done() const {
+  return mPos == mEnd;
+}
+
+template <class T>
+void ParseCacheReader::ref(T*& ast) {
+  BaseAST* base = getRef();
+
+  ast = (base != NULL) ? dynamic_cast<T*>(base) : NULL;
+
+  INT_ASSERT(base == NULL || ast != NULL);
+}
+
+template <class T>
+void ParseCacheReader::refVec(Vec<T*>& vec) {
+  int count = getCount();
+
+  vec.clear();
+
+  for (int i = 0; i < count; i++) {
+    T* elem = NULL;
+
+    ref(elem);
+    vec.add(elem);
+  }
+}
+
+template <class T>
+void ParseCacheReader::refVec(std::vector<T*>& vec) {
+  int count = getCount();
+
+  vec.clear();
+
+  for (int i = 0; i < count; i++) {
+    T* elem = NULL;
+
+    ref(elem);
+    vec.push_back(elem);
+  }
+}
+
+void ParseCacheReader::prim(PrimitiveOp*& op) {
+  int64_t code = getInt();
+
+  INT_ASSERT(code >= 0 && code <= NUM_KNOWN_PRIMS);
+
+  if (code == PRIM_UNKNOWN + 1) {
+    op = primitives_map.get(getString());
+
+    INT_ASSERT(op != NULL);
+
+  } else {
+    op = (code > 0) ? primitives[code - 1] : NULL;
+  }
+}
+
+void ParseCacheReader::list(AList& alist) {
+  int   count = getCount();
+  Expr* prev  = NULL;
+
+  alist.head   = NULL;
+  alist.tail   = NULL;
+  alist.length = count;
+
+  for (int i = 0; i < count; i++) {
+    int64_t code = getInt();
+
+    INT_ASSERT(code > 0 && code <= (int64_t) nodes.size());
+
+    Expr* expr = toExpr(nodes[code - 1]);
+
+    INT_ASSERT(expr != NULL);
+
+    expr->list = &alist;
+    expr->prev = prev;
+    expr->next = NULL;
+
+    if (prev != NULL) {
+      prev->next = expr;
+    } else {
+      alist.head = expr;
+    }
+
+    alist.tail = expr;
+    prev       = expr;
+  }
+
+  ref(alist.parent);
+}
+
+void ParseCacheReader::flagSet(FlagSet& flags) {
+  int count = getCount();
+
+  flags.reset();
+
+  for (int i = 0; i < count; i++) {
+    int64_t flag = getInt();
+
+    INT_ASSERT(flag >= 0 && flag < NUM_FLAGS);
+
+    flags.set(flag);
+  }
+}
+
+void ParseCacheReader::loc(astlocT& astloc) {
+  astloc.lineno   = getInt();
+  astloc.filename = getLocFile();
+}
+
+void ParseCacheReader::strVec(std::vector<const char*>& vec) {
+  int count = getCount();
+
+  vec.clear();
+
+  for (int i = 0; i < count; i++) {
+    vec.push_back(getString());
+  }
+}
+
+void ParseCacheReader::strSet(std::set<const char*>& set) {
+  int count = getCount();
+
+  set.clear();
+
+  for (int i = 0; i < count; i++) {
+    set.insert(getString());
+  }
+}
+
+void ParseCacheReader::strMap(std::map<const char*, const char*>& map) {
+  int count = getCount();
+
+  map.clear();
+
+  for (int i = 0; i < count; i++) {
+    const char* key = getString();
+
+    map[key] = getString();
+  }
+}
+
+/************************************* | **************************************
+*                                                                             *
+* The nodes                                                                   *
+*                                                                             *
+* Each node is made as an empty shell first, in id order, and then gets its   *
+* fields.  Fields the parser never sets must still have their initial        *
+* values; 'require' keeps a parse that does set them out of the cache.        *
+*                                                                             *
+************************************** | *************************************/
+
+template <class T>
+static void discardShellPart(Vec<T*>& vec, T* part) {
+  T* last = vec.pop();
+
+  INT_ASSERT(last == part);
+
+  delete part;
+}
+
+BaseAST* ParseCache::makeShell(AstTag     tag,
+                               int        subKind,
+                               BlockStmt* dummy,
+                               Type*      type) {
+  BaseAST* retval = NULL;
+
+  switch (tag) {
+    case E_ModuleSymbol:
+      retval = new ModuleSymbol("", (ModTag) subKind, NULL);
+      break;
+
+    case E_VarSymbol:
+      retval = new VarSymbol("");
+      break;
+
+    case E_ArgSymbol:
+      retval = new ArgSymbol(INTENT_BLANK, "", dtUnknown);
+      break;
+
+    case E_ShadowVarSymbol: {
+      ShadowVarSymbol* svar = new ShadowVarSymbol(TFI_DEFAULT, "", NULL);
+
+      discardShellPart(gBlockStmts, svar->svDeinitBlock);
+      discardShellPart(gBlockStmts, svar->svInitBlock);
+
+      retval = svar;
+      break;
+    }
+
+    case E_TypeSymbol:
+      retval = new TypeSymbol("", type);
+      break;
+
+    case E_FnSymbol: {
+      FnSymbol* fn = new FnSymbol("");
+
+      discardShellPart(gBlockStmts, fn->body);
+      fn->body = NULL;
+
+      retval = fn;
+      break;
+    }
+
+    case E_EnumSymbol:
+      retval = new EnumSymbol("");
+      break;
+
+    case E_LabelSymbol:
+      retval = new LabelSymbol("");
+      break;
+
+    case E_PrimitiveType:
+      retval = new PrimitiveType(NULL, false);
+      break;
+
+    case E_EnumType:
+      retval = new EnumType();
+      break;
+
+    case E_AggregateType:
+      retval = new AggregateType((AggregateTag) subKind);
+      break;
+
+    case E_SymExpr:
+      retval = new SymExpr(gNil);
+      break;
+
+    case E_UnresolvedSymExpr:
+      retval = new UnresolvedSymExpr("");
+      break;
+
+    case E_DefExpr:
+      retval = new DefExpr(NULL);
+      break;
+
+    case E_CallExpr:
+      retval = new CallExpr((PrimitiveOp*) NULL);
+      break;
+
+    case E_NamedExpr:
+      retval = new NamedExpr("", NULL);
+      break;
+
+    case E_LoopExpr:
+      retval = new LoopExpr(false, false, false);
+      break;
+
+    case E_IfExpr:
+      retval = new IfExpr(NULL, dummy, dummy);
+      break;
+
+    case E_UseStmt:
+      retval = new UseStmt(dummy, "", false);
+      break;
+
+    case E_ImportStmt:
+      retval = new ImportStmt(dummy, false);
+      break;
+
+    case E_BlockStmt:
+      switch (subKind) {
+        case 0: retval = new BlockStmt(BLOCK_NORMAL);                  break;
+        case 1: retval = new WhileDoStmt((Expr*) NULL, (BlockStmt*) NULL);
+                break;
+        case 2: retval = new DoWhileStmt((Expr*) NULL, (BlockStmt*) NULL);
+                break;
+        case 3: retval = new ForLoop();                                break;
+        case 4: retval = new CForLoop();                               break;
+        case 5: retval = new ParamForLoop();                           break;
+      }
+      break;
+
+    case E_CondStmt:
+      retval = new CondStmt(NULL, dummy);
+      break;
+
+    case E_GotoStmt: {
+      GotoStmt* gotoStmt = new GotoStmt((GotoTag) subKind, (const char*) NULL);
+
+      discardShellPart(gSymExprs, toSymExpr(gotoStmt->label));
+      gotoStmt->label = NULL;
+
+      retval = gotoStmt;
+      break;
+    }
+
+    case E_DeferStmt:
+      retval = new DeferStmt((BlockStmt*) NULL);
+      break;
+
+    case E_ForallStmt:
+      retval = new ForallStmt(dummy);
+      break;
+
+    case E_TryStmt:
+      retval = new TryStmt(false, NULL, NULL, false);
+      break;
+
+    case E_ForwardingStmt:
+      retval = new ForwardingStmt((DefExpr*) NULL);
+      break;
+
+    case E_CatchStmt:
+      retval = new CatchStmt(NULL, NULL, NULL);
+      break;
+
+    case E_ExternBlockStmt:
+      retval = new ExternBlockStmt(NULL);
+      break;
+
+    default:
+      break;
+  }
+
+  INT_ASSERT(retval != NULL && retval->astTag == tag);
+
+  return retval;
+}
+
+// The part of a node's kind that its shell is built with
+int ParseCache::shellSubKind(BaseAST* ast) {
+  if (ModuleSymbol* mod = toModuleSymbol(ast)) {
+    return mod->modTag;
+
+  } else if (AggregateType* at = toAggregateType(ast)) {
+    return at->aggregateTag;
+
+  } else if (GotoStmt* gotoStmt = toGotoStmt(ast)) {
+    return gotoStmt->gotoTag;
+
+  } else if (BlockStmt* block = toBlockStmt(ast)) {
+    if (block->isWhileDoStmt()  == true) return 1;
+    if (block->isDoWhileStmt()  == true) return 2;
+    if (block->isForLoop()      == true) return 3;
+    if (block->isCForLoop()     == true) return 4;
+    if (block->isParamForLoop() == true) return 5;
+    if (block->isLoopStmt()     == true) return -1;
+  }
+
+  return 0;
+}
+
+template <class Archive>
+void ParseCache::transferFields(Archive& ar, BaseAST* ast) {
+  if (Expr* expr = toExpr(ast)) {
+    // list, prev and next are set by the AList the expression is in
+    ar.ref(expr->parentSymbol);
+    ar.ref(expr->parentExpr);
+  }
+
+  if (Symbol* sym = toSymbol(ast)) {
+    ar.value(sym->qual);
+    ar.ref(sym->type);
+    ar.flagSet(sym->flags);
+    ar.require(sym->fieldQualifiers == NULL);
+    ar.str(sym->name);
+    ar.str(sym->cname);
+    ar.ref(sym->defPoint);
+  }
+
+  if (LcnSymbol* lcn = toLcnSymbol(ast)) {
+    int depth  = lcn->depth();
+    int offset = lcn->offset();
+
+    ar.value(depth);
+    ar.value(offset);
+
+    if (Archive::reading) {
+      lcn->locationSet(depth, offset);
+    }
+  }
+
+  if (VarSymbol* var = toVarSymbol(ast)) {
+    ar.require(var->immediate == NULL);
+    ar.str(var->doc);
+    ar.boolean(var->isField);
+  }
+
+  if (Type* type = toType(ast)) {
+    ar.ref(type->symbol);
+    ar.ref(type->refType);
+    ar.refVec(type->methods);
+    ar.ref(type->defaultValue);
+    ar.boolean(type->isInternalType);
+    ar.ref(type->scalarPromotionType);
+    ar.ref(type->destructor);
+    ar.require(type->substitutions.n == 0);
+    ar.require(type->substitutionsPostResolve.empty());
+    ar.require(type->GEPMap.empty());
+  }
+
+  if (VisibilityStmt* vis = dynamic_cast<VisibilityStmt*>(ast)) {
+    ar.ref(vis->src);
+    ar.boolean(vis->isPrivate);
+    ar.strMap(vis->renamed);
+    ar.str(vis->modRename);
+  }
+
+  if (BlockStmt* block = toBlockStmt(ast)) {
+    ar.value(block->blockTag);
+    ar.list(block->body);
+    ar.ref(block->useList);
+    ar.ref(block->modRefs);
+    ar.str(block->userLabel);
+    ar.ref(block->byrefVars);
+    ar.ref(block->blockInfo);
+  }
+
+  if (LoopStmt* loop = toLoopStmt(ast)) {
+    ar.ref(loop->mBreakLabel);
+    ar.ref(loop->mContinueLabel);
+    ar.boolean(loop->mOrderIndependent);
+    ar.boolean(loop->mVectorizationHazard);
+    ar.boolean(loop->mParallelAccessVectorizationHazard);
+  }
+
+  if (WhileStmt* loop = toWhileStmt(ast)) {
+    ar.ref(loop->mCondExpr);
+  }
+
+  switch (ast->astTag) {
+    case E_ModuleSymbol: {
+      ModuleSymbol* mod = toModuleSymbol(ast);
+
+      ar.ref(mod->block);
+      ar.ref(mod->initFn);
+      ar.ref(mod->deinitFn);
+      ar.str(mod->filename);
+      ar.str(mod->doc);
+      ar.require(mod->modUseList.empty());
+      ar.require(mod->extern_info == NULL);
+      break;
+    }
+
+    case E_ArgSymbol: {
+      ArgSymbol* arg = toArgSymbol(ast);
+
+      ar.value(arg->intent);
+      ar.value(arg->originalIntent);
+      ar.ref(arg->typeExpr);
+      ar.ref(arg->defaultExpr);
+      ar.ref(arg->variableExpr);
+      ar.ref(arg->instantiatedFrom);
+      break;
+    }
+
+    case E_ShadowVarSymbol: {
+      ShadowVarSymbol* svar = toShadowVarSymbol(ast);
+
+      ar.value(svar->intent);
+      ar.ref(svar->outerVarSE);
+      ar.ref(svar->specBlock);
+      ar.ref(svar->svInitBlock);
+      ar.ref(svar->svDeinitBlock);
+      ar.boolean(svar->pruneit);
+      break;
+    }
+
+    case E_TypeSymbol: {
+      TypeSymbol* ts = toTypeSymbol(ast);
+
+      ar.str(ts->doc);
+      ar.ref(ts->instantiationPoint);
+      ar.loc(ts->userInstantiationPointLoc);
+      break;
+    }
+
+    case E_FnSymbol: {
+      FnSymbol* fn = toFnSymbol(ast);
+
+      ar.list(fn->formals);
+      ar.ref(fn->retType);
+      ar.ref(fn->where);
+      ar.ref(fn->lifetimeConstraints);
+      ar.ref(fn->retExprType);
+      ar.ref(fn->body);
+      ar.value(fn->thisTag);
+      ar.value(fn->retTag);
+      ar.ref(fn->_this);
+      ar.ref(fn->instantiatedFrom);
+      ar.loc(fn->userInstantiationPointLoc);
+      ar.ref(fn->_instantiationPoint);
+      ar.ref(fn->_backupInstantiationPoint);
+      ar.str(fn->userString);
+      ar.ref(fn->valueFunction);
+      ar.value(fn->codegenUniqueNum);
+      ar.str(fn->doc);
+      ar.ref(fn->retSymbol);
+      ar.boolean(fn->mIsNormalized);
+      ar.boolean(fn->_throwsError);
+      ar.boolean(fn->mIsGeneric);
+      ar.boolean(fn->mIsGenericIsValid);
+      ar.require(fn->iteratorInfo  == NULL);
+      ar.require(fn->iteratorGroup == NULL);
+      ar.require(fn->cacheInfo     == NULL);
+      ar.require(fn->interfaceInfo == NULL);
+      ar.require(fn->basicBlocks   == NULL);
+      ar.require(fn->calledBy      == NULL);
+      ar.require(fn->substitutions.n == 0);
+      ar.require(fn->substitutionsPostResolve.empty());
+      break;
+    }
+
+    case E_LabelSymbol:
+      ar.ref(toLabelSymbol(ast)->iterResumeGoto);
+      break;
+
+    case E_EnumType: {
+      EnumType* et = toEnumType(ast);
+
+      ar.list(et->constants);
+      ar.ref(et->integerType);
+      ar.str(et->doc);
+      break;
+    }
+
+    case E_AggregateType: {
+      AggregateType* at = toAggregateType(ast);
+
+      for (int i = 0; i < NUM_PACKED_DECORATED_TYPES; i++) {
+        ar.require(at->decoratedClasses[i] == NULL);
+      }
+
+      ar.boolean(at->builtDefaultInit);
+      ar.ref(at->instantiatedFrom);
+      ar.boolean(at->hasUserDefinedInit);
+      ar.boolean(at->initializerResolved);
+      ar.list(at->fields);
+      ar.list(at->inherits);
+      ar.list(at->forwardingTo);
+      ar.str(at->doc);
+      ar.value(at->classId);
+      ar.refVec(at->dispatchParents);
+      ar.refVec(at->dispatchChildren);
+      ar.value(at->resolveStatus);
+      ar.str(at->typeSignature);
+      ar.boolean(at->foundGenericFields);
+      ar.refVec(at->genericFields);
+      ar.value(at->genericField);
+      ar.boolean(at->mIsGeneric);
+      ar.boolean(at->mIsGenericWithDefaults);
+      ar.require(at->iteratorInfo == NULL);
+      ar.require(at->isCArrayFieldMap.empty());
+      ar.require(at->instantiations.empty());
+      break;
+    }
+
+    case E_SymExpr:
+      ar.ref(toSymExpr(ast)->var);
+      break;
+
+    case E_UnresolvedSymExpr:
+      ar.str(toUnresolvedSymExpr(ast)->unresolved);
+      break;
+
+    case E_DefExpr: {
+      DefExpr* def = toDefExpr(ast);
+
+      ar.ref(def->sym);
+      ar.ref(def->init);
+      ar.ref(def->exprType);
+      break;
+    }
+
+    case E_CallExpr: {
+      CallExpr* call = toCallExpr(ast);
+
+      ar.prim(call->primitive);
+      ar.ref(call->baseExpr);
+      ar.list(call->argList);
+      ar.boolean(call->partialTag);
+      ar.boolean(call->methodTag);
+      ar.boolean(call->square);
+      ar.value(call->tryTag);
+      break;
+    }
+
+    case E_NamedExpr: {
+      NamedExpr* named = toNamedExpr(ast);
+
+      ar.str(named->name);
+      ar.ref(named->actual);
+      break;
+    }
+
+    case E_LoopExpr: {
+      LoopExpr* loop = toLoopExpr(ast);
+
+      ar.list(loop->defIndices);
+      ar.ref(loop->indices);
+      ar.ref(loop->iteratorExpr);
+      ar.ref(loop->cond);
+      ar.ref(loop->loopBody);
+      ar.boolean(loop->forall);
+      ar.boolean(loop->zippered);
+      ar.boolean(loop->maybeArrayType);
+      break;
+    }
+
+    case E_IfExpr: {
+      IfExpr* ifExpr = toIfExpr(ast);
+
+      ar.ref(ifExpr->condition);
+      ar.ref(ifExpr->thenStmt);
+      ar.ref(ifExpr->elseStmt);
+      break;
+    }
+
+    case E_UseStmt: {
+      UseStmt* use = toUseStmt(ast);
+
+      ar.boolean(use->canReexport);
+      ar.strVec(use->named);
+      ar.boolean(use->except);
+      break;
+    }
+
+    case E_ImportStmt:
+      ar.strVec(toImportStmt(ast)->unqualified);
+      break;
+
+    case E_BlockStmt:
+      if (ForLoop* loop = toForLoop(ast)) {
+        ar.ref(loop->mIndex);
+        ar.ref(loop->mIterator);
+        ar.boolean(loop->mZippered);
+        ar.boolean(loop->mLoweredForall);
+        ar.boolean(loop->mIsForExpr);
+
+      } else if (CForLoop* loop = toCForLoop(ast)) {
+        ar.ref(loop->mInitClause);
+        ar.ref(loop->mTestClause);
+        ar.ref(loop->mIncrClause);
+
+      } else if (ParamForLoop* loop = toParamForLoop(ast)) {
+        ar.ref(loop->mResolveInfo);
+      }
+      break;
+
+    case E_CondStmt: {
+      CondStmt* cond = toCondStmt(ast);
+
+      ar.ref(cond->condExpr);
+      ar.ref(cond->thenStmt);
+      ar.ref(cond->elseStmt);
+      ar.boolean(cond->fIsIfExpr);
+      break;
+    }
+
+    case E_GotoStmt: {
+      GotoStmt* gotoStmt = toGotoStmt(ast);
+
+      ar.value(gotoStmt->gotoTag);
+      ar.ref(gotoStmt->label);
+      break;
+    }
+
+    case E_DeferStmt:
+      ar.ref(toDeferStmt(ast)->_body);
+      break;
+
+    case E_ForallStmt: {
+      ForallStmt* forall = toForallStmt(ast);
+
+      ar.list(forall->fIterVars);
+      ar.list(forall->fIterExprs);
+      ar.list(forall->fShadowVars);
+      ar.ref(forall->fLoopBody);
+      ar.boolean(forall->fZippered);
+      ar.boolean(forall->fFromForLoop);
+      ar.boolean(forall->fFromReduce);
+      ar.boolean(forall->fOverTupleExpand);
+      ar.boolean(forall->fAllowSerialIterator);
+      ar.boolean(forall->fRequireSerialIterator);
+      ar.boolean(forall->fVectorizationHazard);
+      ar.boolean(forall->fIsForallExpr);
+      ar.ref(forall->fContinueLabel);
+      ar.ref(forall->fErrorHandlerLabel);
+      ar.require(forall->fRecIterIRdef        == NULL);
+      ar.require(forall->fRecIterICdef        == NULL);
+      ar.require(forall->fRecIterGetIterator  == NULL);
+      ar.require(forall->fRecIterFreeIterator == NULL);
+      break;
+    }
+
+    case E_TryStmt: {
+      TryStmt* tryStmt = toTryStmt(ast);
+
+      ar.ref(tryStmt->_body);
+      ar.list(tryStmt->_catches);
+      ar.boolean(tryStmt->_tryBang);
+      ar.boolean(tryStmt->_isSyncTry);
+      break;
+    }
+
+    case E_CatchStmt: {
+      CatchStmt* catchStmt = toCatchStmt(ast);
+
+      ar.str(catchStmt->_name);
+      ar.ref(catchStmt->_type);
+      ar.ref(catchStmt->_body);
+      break;
+    }
+
+    case E_ExternBlockStmt:
+      ar.str(toExternBlockStmt(ast)->c_code);
+      break;
+
+    case E_ForwardingStmt: {
+      ForwardingStmt* fwd = toForwardingStmt(ast);
+
+      ar.ref(fwd->toFnDef);
+      ar.str(fwd->fnReturningForwarding);
+      ar.ref(fwd->type);
+      ar.ref(fwd->scratchFn);
+      ar.strSet(fwd->named);
+      ar.strMap(fwd->renamed);
+      ar.boolean(fwd->except);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+/************************************* | **************************************
+*                                                                             *
+* The key                                                                     *
+*                                                                             *
+************************************** | *************************************/
+
+static std::string compilerExecutable() {
+  char path[4096];
+
+#if defined(__linux__)
+  ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+
+  if (len > 0) {
+    path[len] = '\0';
+    return path;
+  }
+
+#elif defined(__APPLE__)
+  uint32_t size = sizeof(path);
+
+  if (_NSGetExecutablePath(path, &size) == 0) {
+    return path;
+  }
+#endif
+
+  return "";
+}
+
+// The part of the key that is the same for all files, or "" if the cache
+// can't be used
+static const std::string& parseCacheCommonKey() {
+  static bool        computed = false;
+  static std::string key      = "";
+
+  if (computed == false) {
+    std::string exe = compilerExecutable();
+
+    computed = true;
+
+    if (exe.empty() == false) {
+      char version[128];
+      char flags[128];
+
+      get_version(version);
+
+      key += parseCacheHeader;
+      key += std::string("version ") + version + "\n";
+
+      compilerCacheAddStat(key, exe);
+
+      for (std::map<std::string, const char*>::iterator it = envMap.begin();
+           it != envMap.end();
+           ++it) {
+        key += "env " + it->first + "=" + it->second + "\n";
+      }
+
+      snprintf(flags, sizeof(flags), "flags %d%d%d%d%d%d\n",
+               fWarnUnstable, fAllowExternC, fNoOptimizeRangeIteration,
+               fLocal, requireWideReferences(), requireOutlinedOn());
+
+      key += flags;
+    }
+  }
+
+  return key;
+}
+
+static std::string parseCacheKey(const char* path, FILE* fp, ModTag modTag) {
+  std::string key = parseCacheCommonKey();
+
+  if (key.empty() == false) {
+    std::string source;
+    char        buffer[65536];
+    size_t      n      = 0;
+    char        line[128];
+
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+      source.append(buffer, n);
+    }
+
+    rewind(fp);
+
+    snprintf(line, sizeof(line), "source %lu %016llx\nmodTag %d",
+             (unsigned long) source.size(),
+             (unsigned long long) hashBytes(source.data(), source.size()),
+             (int) modTag);
+
+    key += std::string("file ") + path + "\n";
+    key += line;
+    key += parseCacheSep;
+  }
+
+  return key;
+}
+
+/************************************* | **************************************
+*                                                                             *
+* Saving a parse                                                              *
+*                                                                             *
+************************************** | *************************************/
+
+struct Registration {
+  int      stamp;      // made just before this literal event is redone
+  Symbol*  sym;
+  SymExpr* se;
+};
+
+static bool lessById(BaseAST* a, BaseAST* b) {
+  return a->id < b->id;
+}
+
+static bool lessByStamp(const Registration& a, const Registration& b) {
+  return a.stamp < b.stamp;
+}
+
+// Nodes made while parsing that didn't end up in the block are fine as long
+// as nothing outside of the block can see them
+static bool isHarmlessGarbage(const ParseCacheWriter& writer, BaseAST* ast) {
+  if (writer.nodeIndex(ast) >= 0 || eventContaining(ast->id - sBase) >= 0) {
+    return true;
+
+  } else if (isModuleSymbol(ast) || isTypeSymbol(ast) || isType(ast)) {
+    return false;
+
+  } else if (Expr* expr = toExpr(ast)) {
+    return expr->parentSymbol == NULL;
+
+  } else if (Symbol* sym = toSymbol(ast)) {
+    return sym->defPoint == NULL || writer.nodeIndex(sym->defPoint) < 0;
+  }
+
+  return true;
+}
+
+#define check_gvec_garbage(type)                                         \
+  for (int i = sGVecSizes.n##type; i < g##type##s.n; i++) {              \
+    if (isHarmlessGarbage(writer, g##type##s.v[i]) == false) {           \
+      return false;                                                      \
+    }                                                                    \
+  }
+
+//
+// The literal event after which the literal exists, or -1 if it has to
+// exist already.  The block can only have gotten the literal from an event
+// that returned it, and that is how it is found again: looking it up by its
+// value fails for some, such as the fresh literal each "" gets.
+//
+static int literalProducer(VarSymbol* var, bool& result) {
+  int offset = var->id - sBase;
+
+  for (size_t i = 0; i < sEvents.size(); i++) {
+    if (sEvents[i].result == var) {
+      result = true;
+      return (int) i;
+    }
+  }
+
+  result = false;
+
+  return (offset >= 0) ? eventContaining(offset) : -1;
+}
+
+//
+// Finds when each SymExpr in the block has to be added to its symbol's list
+// so that the list ends up in the same order as after the parse.  The lists
+// can also hold SymExprs made by literal events and ones from before the
+// parse.
+//
+static bool computeRegistrations(ParseCacheWriter&           writer,
+                                 const std::vector<BaseAST*>& nodes,
+                                 std::vector<Registration>&  regs) {
+  std::vector<Symbol*> syms;
+  std::set<Symbol*>    seen;
+  int                  expected = 0;
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (SymExpr* se = toSymExpr(nodes[i])) {
+      if (se->parentSymbol != NULL) {
+        expected++;
+      }
+
+      if (se->symbol() != NULL && seen.insert(se->symbol()).second == true) {
+        syms.push_back(se->symbol());
+      }
+    }
+  }
+
+  // A symbol in the block with SymExprs must have some from the block
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (Symbol* sym = toSymbol(nodes[i])) {
+      if (sym->firstSymExpr() != NULL && seen.count(sym) == 0) {
+        return false;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < syms.size(); i++) {
+    Symbol*   sym      = syms[i];
+    int       symIndex = writer.nodeIndex(sym);
+    External* literal  = NULL;
+    size_t    first    = regs.size();
+    bool      feasible = false;
+
+    if (symIndex < 0) {
+      int ext = -writer.refCode(sym) - 1;
+
+      if (ext < 0) {
+        return false;
+      }
+
+      if (writer.externals[ext].kind == EXTERNAL_LITERAL) {
+        literal = &writer.externals[ext];
+      }
+    }
+
+    while (feasible == false) {
+      int  symStamp = 0;
+      int  prefix   = 0;
+      int  minimum  = 0;
+      bool later    = false;
+
+      if (symIndex >= 0) {
+        symStamp = eventsBefore(sym->id - sBase);
+
+      } else if (literal != NULL && literal->producer >= 0) {
+        symStamp = literal->producer + 1;
+      }
+
+      feasible = true;
+
+      for (SymExpr* se = sym->firstSymExpr();
+           se != NULL && feasible == true;
+           se = se->symbolSymExprsNext) {
+        int index = writer.nodeIndex(se);
+
+        if (index >= 0) {
+          int stamp = std::max(std::max(prefix, minimum),
+                               std::max(eventsBefore(se->id - sBase),
+                                        symStamp));
+          Registration reg;
+
+          reg.stamp = stamp;
+          reg.sym   = sym;
+          reg.se    = se;
+
+          regs.push_back(reg);
+
+          prefix = stamp;
+          later  = true;
+
+        } else if (se->id < sBase) {
+          if (later == true) {
+            return false;
+          }
+
+        } else {
+          int event = eventContaining(se->id - sBase);
+
+          if (event < 0) {
+            return false;
+
+          } else if (prefix > event) {
+            feasible = false;
+
+          } else {
+            minimum = std::max(minimum, event + 1);
+            later   = true;
+          }
+        }
+      }
+
+      if (feasible == false) {
+        // A literal that already existed can be required to exist at the
+        // start instead, which lets its SymExprs go anywhere
+        if (literal == NULL || literal->producer < 0 || sym->id >= sBase) {
+          return false;
+        }
+
+        literal->producer = -1;
+        literal->result   = false;
+
+        regs.resize(first);
+      }
+    }
+  }
+
+  std::stable_sort(regs.begin(), regs.end(), lessByStamp);
+
+  return (int) regs.size() == expected;
+}
+
+static bool parseCacheSave(BlockStmt* block, std::string& contents) {
+  std::vector<BaseAST*> nodes;
+  int                   range = lastNodeIDUsed() + 1 - sBase;
+
+  if (block->parentSymbol != NULL || block->parentExpr != NULL ||
+      block->list         != NULL) {
+    return false;
+  }
+
+  collect_asts(block, nodes);
+
+  std::sort(nodes.begin(), nodes.end(), lessById);
+
+  std::vector<int> indexOf(range, -1);
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    BaseAST* ast    = nodes[i];
+    int      offset = ast->id - sBase;
+
+    if (offset < 0 || offset >= range || indexOf[offset] >= 0 ||
+        eventContaining(offset) >= 0 || isSupportedTag(ast->astTag) == false ||
+        ParseCache::shellSubKind(ast) < 0) {
+      return false;
+    }
+
+    indexOf[offset] = (int) i;
+  }
+
+  ParseCacheWriter writer(nodes, indexOf, sPath);
+
+  foreach_ast(check_gvec_garbage);
+
+  for (size_t i = 0; i < sModuleUses.size(); i++) {
+    VisibilityStmt* stmt = sModuleUses[i].second;
+
+    if (stmt != NULL && writer.nodeIndex(stmt) < 0) {
+      return false;
+    }
+  }
+
+  // The fields, which also find the strings and externals
+  std::string fields;
+  std::string headers;
+
+  writer.select(fields);
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    ParseCache::transferFields(writer, nodes[i]);
+  }
+
+  writer.select(headers);
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    BaseAST* ast     = nodes[i];
+    int      subKind = ParseCache::shellSubKind(ast);
+
+    if (TypeSymbol* ts = toTypeSymbol(ast)) {
+      subKind = writer.nodeIndex(ts->type);
+
+      if (subKind < 0 || subKind >= (int) i) {
+        return false;
+      }
+    }
+
+    putInt(headers, ast->astTag);
+    putInt(headers, subKind);
+    putInt(headers, ast->id - sBase);
+    writer.loc(ast->astloc);
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (Expr* expr = toExpr(nodes[i])) {
+      if (expr->list != NULL && writer.listed[i] == false) {
+        return false;
+      }
+    }
+  }
+
+  if (writer.failed == true) {
+    return false;
+  }
+
+  for (size_t i = 0; i < writer.externals.size(); i++) {
+    External& ext = writer.externals[i];
+
+    if (ext.kind == EXTERNAL_LITERAL) {
+      ext.producer = literalProducer(toVarSymbol(ext.ast), ext.result);
+
+      if (ext.producer < 0 && ext.ast->id >= sBase) {
+        return false;
+      }
+
+      if (ext.result == false && findLiteral(&ext.imm) != ext.ast) {
+        return false;
+      }
+    }
+  }
+
+  std::vector<Registration> regs;
+
+  if (computeRegistrations(writer, nodes, regs) == false) {
+    return false;
+  }
+
+  // The other sections
+  std::string rest;
+
+  writer.select(rest);
+
+  for (int i = 0; i < NUM_BUILD_COUNTERS; i++) {
+    putInt(rest, sCounters[i]);
+    putInt(rest, buildCounterGet((BuildCounter) i));
+  }
+
+  writer.strVec(sConfigs);
+
+  putInt(rest, sEvents.size());
+
+  for (size_t i = 0; i < sEvents.size(); i++) {
+    LiteralEvent& event = sEvents[i];
+
+    putInt(rest, event.kind);
+    putInt(rest, event.subKind);
+    writer.str(event.text);
+    putInt(rest, (int64_t) event.num);
+    putInt(rest, event.line);
+    putInt(rest, event.start);
+    putInt(rest, event.end);
+  }
+
+  putInt(rest, writer.externals.size());
+
+  for (size_t i = 0; i < writer.externals.size(); i++) {
+    External& ext = writer.externals[i];
+
+    putInt(rest, ext.kind);
+
+    switch (ext.kind) {
+      case EXTERNAL_LITERAL:
+        putInt(rest, ext.imm.const_kind);
+        putInt(rest, ext.imm.string_kind);
+        putInt(rest, ext.imm.num_index);
+
+        if (ext.imm.const_kind == CONST_KIND_STRING) {
+          writer.str(ext.imm.v_string);
+        } else {
+          rest.append((const char*) &ext.imm, sizeof(ext.imm));
+        }
+
+        putInt(rest, ext.producer);
+        writer.boolean(ext.result);
+        break;
+
+      case EXTERNAL_WELL_KNOWN:
+        putInt(rest, ext.index);
+        break;
+
+      default:
+        writer.str(ext.name);
+        break;
+    }
+  }
+
+  putInt(rest, sModuleUses.size());
+
+  for (size_t i = 0; i < sModuleUses.size(); i++) {
+    writer.str(sModuleUses[i].first);
+    writer.ref(sModuleUses[i].second);
+  }
+
+  putInt(rest, regs.size());
+
+  for (size_t i = 0; i < regs.size(); i++) {
+    putInt(rest, regs[i].stamp);
+    writer.ref(regs[i].sym);
+    putInt(rest, writer.nodeIndex(regs[i].se));
+  }
+
+  putInt(rest, nodes.size());
+  putInt(rest, range);
+  putInt(rest, writer.nodeIndex(block));
+
+  if (writer.failed == true) {
+    return false;
+  }
+
+  // Put it all together, strings first
+  contents.clear();
+
+  putInt(contents, writer.strings.size());
+
+  for (size_t i = 0; i < writer.strings.size(); i++) {
+    putInt(contents, writer.strings[i].size());
+    contents += writer.strings[i];
+  }
+
+  contents += rest;
+  contents += headers;
+  contents += fields;
+
+  uint64_t checksum = hashBytes(contents.data(), contents.size());
+
+  for (int i = 0; i < 8; i++) {
+    contents += (char) ((checksum >> (8 * i)) & 0xff);
+  }
+
+  return true;
+}
+
+void parseCacheStore(BlockStmt* block) {
+  sNesting--;
+
+  if (sNesting == 0 && sArmed == true) {
+    std::string contents;
+
+    sArmed = false;
+
+    if (sStorable                == true          &&
+        block                    != NULL          &&
+        diagnosticCount()        == sDiagnostics  &&
+        fatalErrorsEncountered() == false         &&
+        parseCacheSave(block, contents)) {
+      compilerCacheWrite(sFile, sKey, contents);
+    }
+
+    sEvents.clear();
+    sConfigs.clear();
+    sModuleUses.clear();
+  }
+}
+
+/************************************* | **************************************
+*                                                                             *
+* Loading a parse                                                             *
+*                                                                             *
+************************************** | *************************************/
+
+struct NodeHeader {
+  AstTag  tag;
+  int     subKind;
+  int     offset;
+  astlocT astloc;
+
+  NodeHeader() : tag(E_SymExpr), subKind(0), offset(0), astloc(0, NULL) { }
+};
+
+struct SavedRegistration {
+  int     stamp;
+  int64_t sym;
+  int     se;
+};
+
+class ParseCacheLoader {
+public:
+                 ParseCacheLoader(const std::string& contents,
+                                  const char*        path);
+
+  bool           read();
+  bool           canInstantiate();
+  BlockStmt*     instantiate();
+
+private:
+  bool           readExternal(External& ext);
+  bool           isValidRef(int64_t code, bool symbol);
+  void           replayEvent(int index);
+  void           applyRegistrations(int stamp);
+  BaseAST*       resolve(int64_t code);
+
+  ParseCacheReader                 mReader;
+  int                              mCounters[NUM_BUILD_COUNTERS][2];
+  std::vector<const char*>         mConfigs;
+  std::vector<LiteralEvent>        mEvents;
+  std::vector<External>            mExternals;
+  std::vector<const char*>         mUseNames;
+  std::vector<int64_t>             mUseStmts;
+  std::vector<SavedRegistration>   mRegs;
+  std::vector<NodeHeader>          mHeaders;
+  int                              mRange;
+  int                              mBlock;
+
+  int                              mBase;
+  int                              mDelta;
+  size_t                           mNextReg;
+};
+
+ParseCacheLoader::ParseCacheLoader(const std::string& contents,
+                                   const char*        path)
+  : mReader(contents.data(), contents.data() + contents.size() - 8, path),
+    mRange(0),
+    mBlock(0),
+    mBase(0),
+    mDelta(0),
+    mNextReg(0) {
+}
+
+bool ParseCacheLoader::isValidRef(int64_t code, bool symbol) {
+  if (code > 0 && code <= (int64_t) mHeaders.size()) {
+    int tag = mHeaders[code - 1].tag;
+
+    return symbol == false || isSymbolTag(tag);
+
+  } else if (code < 0 && -code <= (int64_t) mExternals.size()) {
+    return symbol == false || mExternals[-code - 1].kind != EXTERNAL_ROOT_TYPE;
+  }
+
+  return false;
+}
+
+bool ParseCacheLoader::readExternal(External& ext) {
+  ext.kind     = (int) mReader.getInt();
+  ext.index    = 0;
+  ext.name     = NULL;
+  ext.producer = -1;
+  ext.result   = false;
+  ext.ast      = NULL;
+
+  switch (ext.kind) {
+    case EXTERNAL_LITERAL:
+      ext.imm.const_kind  = (uint32_t) mReader.getInt();
+      ext.imm.string_kind = (IF1_string_kind) mReader.getInt();
+      ext.imm.num_index   = (uint32_t) mReader.getInt();
+
+      if (ext.imm.const_kind == CONST_KIND_STRING) {
+        ext.imm.v_string = mReader.getString();
+
+        if (ext.imm.v_string == NULL) {
+          return false;
+        }
+
+      } else if (mReader.getBytes(&ext.imm, sizeof(ext.imm)) == false) {
+        return false;
+      }
+
+      ext.producer = (int) mReader.getInt();
+
+      mReader.boolean(ext.result);
+
+      return (ext.producer >= 0 || ext.result == false) &&
+             ext.producer >= -1 && ext.producer < (int) mEvents.size();
+
+    case EXTERNAL_WELL_KNOWN:
+      ext.index = (int) mReader.getInt();
+
+      return ext.index >= 0 && ext.index < NUM_WELL_KNOWN;
+
+    case EXTERNAL_ROOT_SYMBOL:
+    case EXTERNAL_ROOT_TYPE:
+      ext.name = mReader.getString();
+
+      return ext.name != NULL;
+
+    default:
+      return false;
+  }
+}
+
+// Reads and checks everything but the fields
+bool ParseCacheLoader::read() {
+  ParseCacheReader& in = mReader;
+  int               count;
+
+  count = in.getCount();
+
+  for (int i = 0; i < count && in.bad == false; i++) {
+    int64_t length = in.getInt();
+
+    if (length < 0 || length > INT_MAX) {
+      return false;
+    }
+
+    std::string text((size_t) length, '\0');
+
+    if (in.getBytes(&text[0], (size_t) length) == false ||
+        strlen(text.c_str()) != text.size()) {
+      return false;
+    }
+
+    in.strings.push_back(astr(text.c_str()));
+  }
+
+  for (int i = 0; i < NUM_BUILD_COUNTERS; i++) {
+    mCounters[i][0] = (int) in.getInt();
+    mCounters[i][1] = (int) in.getInt();
+  }
+
+  in.strVec(mConfigs);
+
+  count = in.getCount();
+
+  for (int i = 0; i < count && in.bad == false; i++) {
+    LiteralEvent event;
+
+    event.kind    = (int) in.getInt();
+    event.subKind = (int) in.getInt();
+    event.text    = in.getString();
+    event.num     = (uint64_t) in.getInt();
+    event.line    = (int) in.getInt();
+    event.start   = (int) in.getInt();
+    event.end     = (int) in.getInt();
+    event.result  = NULL;
+
+    switch (event.kind) {
+      case CONST_KIND_STRING:
+        if (event.subKind != STRING_KIND_STRING &&
+            event.subKind != STRING_KIND_BYTES  &&
+            event.subKind != STRING_KIND_C_STRING) {
+          return false;
+        }
+        if (event.text == NULL) {
+          return false;
+        }
+        break;
+
+      case NUM_KIND_INT:
+      case NUM_KIND_UINT:
+        if (event.subKind < INT_SIZE_8 || event.subKind > INT_SIZE_64) {
+          return false;
+        }
+        break;
+
+      case NUM_KIND_REAL:
+      case NUM_KIND_IMAG:
+        if (event.subKind != FLOAT_SIZE_32 && event.subKind != FLOAT_SIZE_64) {
+          return false;
+        }
+        if (event.text == NULL) {
+          return false;
+        }
+        break;
+
+      default:
+        return false;
+    }
+
+    if (event.start < (mEvents.empty() ? 0 : mEvents.back().end) ||
+        event.end   < event.start) {
+      return false;
+    }
+
+    mEvents.push_back(event);
+  }
+
+  count = in.getCount();
+
+  for (int i = 0; i < count && in.bad == false; i++) {
+    External ext;
+
+    if (readExternal(ext) == false) {
+      return false;
+    }
+
+    mExternals.push_back(ext);
+  }
+
+  count = in.getCount();
+
+  for (int i = 0; i < count && in.bad == false; i++) {
+    mUseNames.push_back(in.getString());
+    mUseStmts.push_back(in.getInt());
+  }
+
+  count = in.getCount();
+
+  for (int i = 0; i < count && in.bad == false; i++) {
+    SavedRegistration reg;
+
+    reg.stamp = (int) in.getInt();
+    reg.sym   = in.getInt();
+    reg.se    = (int) in.getInt();
+
+    if (reg.stamp < (mRegs.empty() ? 0 : mRegs.back().stamp) ||
+        reg.stamp > (int) mEvents.size()) {
+      return false;
+    }
+
+    mRegs.push_back(reg);
+  }
+
+  int nodeCount = in.getCount();
+
+  mRange = (int) in.getInt();
+  mBlock = (int) in.getInt();
+
+  for (int i = 0; i < nodeCount && in.bad == false; i++) {
+    NodeHeader header;
+
+    header.tag     = (AstTag) in.getInt();
+    header.subKind = (int) in.getInt();
+    header.offset  = (int) in.getInt();
+
+    in.loc(header.astloc);
+
+    if (isSupportedTag(header.tag) == false ||
+        header.offset < (i == 0 ? 0 : mHeaders.back().offset + 1) ||
+        header.offset >= mRange) {
+      return false;
+    }
+
+    if (header.tag == E_TypeSymbol &&
+        (header.subKind < 0 || header.subKind >= i ||
+         isTypeTag(mHeaders[header.subKind].tag) == false)) {
+      return false;
+    }
+
+    if (header.tag == E_BlockStmt &&
+        (header.subKind < 0 || header.subKind > 5)) {
+      return false;
+    }
+
+    mHeaders.push_back(header);
+  }
+
+  if (in.bad == true || mBlock < 0 || mBlock >= nodeCount ||
+      mHeaders[mBlock].tag != E_BlockStmt) {
+    return false;
+  }
+
+  if (mEvents.empty() == false && mEvents.back().end > mRange) {
+    return false;
+  }
+
+  for (size_t i = 0; i < mUseStmts.size(); i++) {
+    if (mUseNames[i] == NULL ||
+        (mUseStmts[i] != 0 && isValidRef(mUseStmts[i], false) == false) ||
+        mUseStmts[i] < 0) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < mRegs.size(); i++) {
+    if (isValidRef(mRegs[i].sym, true) == false ||
+        mRegs[i].se < 0 || mRegs[i].se >= nodeCount ||
+        mHeaders[mRegs[i].se].tag != E_SymExpr) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Checks that the parse would come out the same now
+bool ParseCacheLoader::canInstantiate() {
+  for (int i = 0; i < NUM_BUILD_COUNTERS; i++) {
+    if (mCounters[i][0] != mCounters[i][1] &&
+        mCounters[i][0] != buildCounterGet((BuildCounter) i)) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < mConfigs.size(); i++) {
+    if (mConfigs[i] == NULL || getCmdLineConfig(mConfigs[i]) != NULL) {
+      return false;
+    }
+  }
+
+  BaseAST* table[NUM_WELL_KNOWN];
+
+  wellKnownExternals(table);
+
+  for (size_t i = 0; i < mExternals.size(); i++) {
+    External& ext = mExternals[i];
+
+    switch (ext.kind) {
+      case EXTERNAL_LITERAL:
+        if (ext.producer < 0) {
+          ext.ast = findLiteral(&ext.imm);
+        }
+        break;
+
+      case EXTERNAL_WELL_KNOWN:
+        ext.ast = table[ext.index];
+        break;
+
+      case EXTERNAL_ROOT_SYMBOL:
+        ext.ast = rootSymbolNamed(ext.name);
+        break;
+
+      case EXTERNAL_ROOT_TYPE:
+        if (TypeSymbol* ts = toTypeSymbol(rootSymbolNamed(ext.name))) {
+          ext.ast = ts->type;
+        }
+        break;
+    }
+
+    if (ext.ast == NULL &&
+        (ext.kind != EXTERNAL_LITERAL || ext.producer < 0)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+BaseAST* ParseCacheLoader::resolve(int64_t code) {
+  if (code > 0) {
+    return mReader.nodes[code - 1];
+  }
+
+  INT_ASSERT(mExternals[-code - 1].ast != NULL);
+
+  return mExternals[-code - 1].ast;
+}
+
+void ParseCacheLoader::applyRegistrations(int stamp) {
+  while (mNextReg < mRegs.size() && mRegs[mNextReg].stamp <= stamp) {
+    SavedRegistration& reg = mRegs[mNextReg++];
+    Symbol*            sym = toSymbol(resolve(reg.sym));
+    SymExpr*           se  = toSymExpr(mReader.nodes[reg.se]);
+
+    INT_ASSERT(sym != NULL && se != NULL);
+
+    se->setSymbol(sym);
+    sym->addSymExpr(se);
+  }
+}
+
+void ParseCacheLoader::replayEvent(int index) {
+  LiteralEvent& event = mEvents[index];
+  int           first = mBase + event.start + mDelta;
+  int           line  = yystartlineno;
+  VarSymbol*    made  = NULL;
+
+  applyRegistrations(index);
+
+  setLastNodeIDUsed(first - 1);
+
+  yystartlineno = event.line;
+
+  switch (event.kind) {
+    case CONST_KIND_STRING:
+      if (event.subKind == STRING_KIND_STRING) {
+        made = new_StringSymbol(event.text);
+      } else if (event.subKind == STRING_KIND_BYTES) {
+        made = new_BytesSymbol(event.text);
+      } else {
+        made = new_CStringSymbol(event.text);
+      }
+      break;
+
+    case NUM_KIND_INT:
+      made = new_IntSymbol((int64_t) event.num,
+                           (IF1_int_type) event.subKind);
+      break;
+
+    case NUM_KIND_UINT:
+      made = new_UIntSymbol(event.num, (IF1_int_type) event.subKind);
+      break;
+
+    case NUM_KIND_REAL:
+      made = new_RealSymbol(event.text, (IF1_float_type) event.subKind);
+      break;
+
+    case NUM_KIND_IMAG:
+      made = new_ImagSymbol(event.text, (IF1_float_type) event.subKind);
+      break;
+  }
+
+  yystartlineno = line;
+
+  // The literals may have been made already, or may be made now
+  mDelta += (lastNodeIDUsed() + 1 - first) - (event.end - event.start);
+
+  for (size_t i = 0; i < mExternals.size(); i++) {
+    External& ext = mExternals[i];
+
+    if (ext.kind == EXTERNAL_LITERAL && ext.producer == index) {
+      ext.ast = (ext.result == true) ? made : findLiteral(&ext.imm);
+
+      INT_ASSERT(ext.ast != NULL);
+    }
+  }
+}
+
+BlockStmt* ParseCacheLoader::instantiate() {
+  ParseCacheReader& in    = mReader;
+  size_t            event = 0;
+
+  mBase = lastNodeIDUsed() + 1;
+
+  for (size_t i = 0; i < mExternals.size(); i++) {
+    in.externals.push_back(NULL);
+  }
+
+  for (size_t i = 0; i < mHeaders.size(); i++) {
+    NodeHeader& header = mHeaders[i];
+    BlockStmt*  dummy  = NULL;
+    Type*       type   = NULL;
+
+    while (event < mEvents.size() &&
+           mEvents[event].start <= header.offset) {
+      replayEvent((int) event++);
+    }
+
+    if (shellNeedsDummy(header.tag) == true) {
+      dummy = new BlockStmt();
+    }
+
+    if (header.tag == E_TypeSymbol) {
+      type = toType(in.nodes[header.subKind]);
+    }
+
+    setLastNodeIDUsed(mBase + header.offset + mDelta - 1);
+
+    BaseAST* ast = ParseCache::makeShell(header.tag, header.subKind,
+                                         dummy, type);
+
+    INT_ASSERT(ast->id == mBase + header.offset + mDelta);
+
+    if (dummy != NULL) {
+      discardShellPart(gBlockStmts, dummy);
+    }
+
+    ast->astloc = header.astloc;
+
+    in.nodes.push_back(ast);
+  }
+
+  while (event < mEvents.size()) {
+    replayEvent((int) event++);
+  }
+
+  applyRegistrations((int) mEvents.size());
+
+  setLastNodeIDUsed(mBase + mRange + mDelta - 1);
+
+  for (size_t i = 0; i < mExternals.size(); i++) {
+    in.externals[i] = mExternals[i].ast;
+  }
+
+  for (size_t i = 0; i < in.nodes.size(); i++) {
+    ParseCache::transferFields(in, in.nodes[i]);
+  }
+
+  INT_ASSERT(in.bad == false && in.done() == true);
+
+  for (size_t i = 0; i < mUseNames.size(); i++) {
+    BaseAST* stmt = (mUseStmts[i] != 0) ? resolve(mUseStmts[i]) : NULL;
+
+    addModuleToParseList(mUseNames[i], dynamic_cast<VisibilityStmt*>(stmt));
+  }
+
+  for (int i = 0; i < NUM_BUILD_COUNTERS; i++) {
+    if (mCounters[i][0] != mCounters[i][1]) {
+      buildCounterSet((BuildCounter) i, mCounters[i][1]);
+    }
+  }
+
+  return toBlockStmt(in.nodes[mBlock]);
+}
+
+BlockStmt* parseCacheLoad(const char* path,
+                          FILE*       fp,
+                          ModTag      modTag,
+                          bool        namedOnCommandLine,
+                          bool        include) {
+  BlockStmt* retval = NULL;
+
+  sNesting++;
+
+  // A file parsed while parsing another makes the other one unsafe to save
+  if (sNesting > 1) {
+    sStorable = false;
+    return NULL;
+  }
+
+  if (fParseCache                == false         ||
+      fDocs                      == true          ||
+      localTempNames             == true          ||
+      namedOnCommandLine         == true          ||
+      include                    == true          ||
+      (modTag != MOD_INTERNAL && modTag != MOD_STANDARD)) {
+    return NULL;
+  }
+
+  std::string key = parseCacheKey(path, fp, modTag);
+
+  if (key.empty() == true) {
+    return NULL;
+  }
+
+  std::string file = compilerCacheFile("CHPL_PARSE_CACHE_DIR", "parse", key);
+  std::string contents;
+
+  if (file.empty() == true) {
+    return NULL;
+  }
+
+  if (compilerCacheRead(file, key, contents) == true &&
+      contents.size() > 8) {
+    uint64_t checksum = hashBytes(contents.data(), contents.size() - 8);
+    bool     valid    = true;
+
+    for (int i = 0; i < 8; i++) {
+      unsigned char byte = contents[contents.size() - 8 + i];
+
+      if (byte != ((checksum >> (8 * i)) & 0xff)) {
+        valid = false;
+      }
+    }
+
+    if (valid == true) {
+      ParseCacheLoader loader(contents, path);
+
+      if (loader.read() == true && loader.canInstantiate() == true) {
+        retval = loader.instantiate();
+      }
+    }
+  }
+
+  // Record this parse so that it can be saved
+  if (retval == NULL) {
+    sArmed        = true;
+    sStorable     = true;
+    sLiteralDepth = 0;
+    sBase         = lastNodeIDUsed() + 1;
+    sDiagnostics  = diagnosticCount();
+    sPath         = path;
+    sFile         = file;
+    sKey          = key;
+
+    for (int i = 0; i < NUM_BUILD_COUNTERS; i++) {
+      sCounters[i] = buildCounterGet((BuildCounter) i);
+    }
+
+#define record_gvec_size(type) sGVecSizes.n##type = g##type##s.n
+    foreach_ast(record_gvec_size);
+#undef record_gvec_size
+  }
+
+  return retval;
+}
@@ -31,6 +31,7 @@
 #include "flex-chapel.h"
 #include "ImportStmt.h"
 #include "insertLineNumbers.h"
+#include "parseCache.h"
 #include "stringutil.h"
 #include "symbol.h"
 #include "wellknown.h"
@@ -240,6 +241,8 @@ void addFlagModulePath(const char* newPath) {
 void addModuleToParseList(const char* name, VisibilityStmt* expr) {
   const char* modName = astr(name);
 
+  parseCacheNoteModuleUse(modName, expr);
+
   if (sModDoneSet.set_in(modName) == NULL &&
       sModNameSet.set_in(modName) == NULL) {
     if (currentModuleType           == MOD_INTERNAL ||
@@ -606,6 +609,8 @@ static ModuleSymbol* parseFile(const char* path,
 
     chplLineno                    = 1;
 
+    yyblock = parseCacheLoad(path, fp, modTag, namedOnCommandLine, include);
+
     if (printModuleFiles && (modTag != MOD_INTERNAL || developer)) {
       if (sFirstFile) {
         fprintf(stderr, "Parsing module files:\n");
@@ -613,47 +618,52 @@ static ModuleSymbol* parseFile(const char* path,
         sFirstFile = false;
       }
 
-      fprintf(stderr, "  %s\n", cleanFilename(path));
+      fprintf(stderr, "  %s%s\n", cleanFilename(path),
+              (yyblock != NULL) ? " (cached)" : "");
     }
 
-    if (namedOnCommandLine == true) {
-      startCountingFileTokens(path);
-    }
+    if (yyblock == NULL) {
+      if (namedOnCommandLine == true) {
+        startCountingFileTokens(path);
+      }
 
-    yylex_init(&context.scanner);
+      yylex_init(&context.scanner);
 
-    stringBufferInit();
+      stringBufferInit();
 
-    yyset_in(fp, context.scanner);
+      yyset_in(fp, context.scanner);
 
-    while (lexerStatus != 0 && parserStatus == YYPUSH_MORE) {
-      YYSTYPE yylval;
+      while (lexerStatus != 0 && parserStatus == YYPUSH_MORE) {
+        YYSTYPE yylval;
 
-      lexerStatus = yylex(&yylval, &yylloc, context.scanner);
+        lexerStatus = yylex(&yylval, &yylloc, context.scanner);
 
-      if        (lexerStatus >= 0) {
-        parserStatus          = yypush_parse(parser,
-                                             lexerStatus,
-                                             &yylval,
-                                             &yylloc,
-                                             &context);
+        if        (lexerStatus >= 0) {
+          parserStatus          = yypush_parse(parser,
+                                               lexerStatus,
+                                               &yylval,
+                                               &yylloc,
+                                               &context);
 
-      } else if (lexerStatus == YYLEX_BLOCK_COMMENT) {
-        context.latestComment = yylval.pch;
-      } else if (lexerStatus == YYLEX_SINGLE_LINE_COMMENT) {
-        context.latestComment = NULL;
+        } else if (lexerStatus == YYLEX_BLOCK_COMMENT) {
+          context.latestComment = yylval.pch;
+        } else if (lexerStatus == YYLEX_SINGLE_LINE_COMMENT) {
+          context.latestComment = NULL;
+        }
+      }
+
+      if (namedOnCommandLine == true) {
+        stopCountingFileTokens(context.scanner);
       }
-    }
 
-    if (namedOnCommandLine == true) {
-      stopCountingFileTokens(context.scanner);
+      // Cleanup after the lexer
+      yylex_destroy(context.scanner);
     }
 
     // Cleanup after the parser
     yypstate_delete(parser);
 
-    // Cleanup after the lexer
-    yylex_destroy(context.scanner);
+    parseCacheStore(yyblock);
 
     closeInputFile(fp);
 
@@ -200,15 +200,24 @@ static void cleanupRedRefs(Expr*& redRef1, Expr*& redRef2) {
 // our stuff after the latter.
 //
 static Expr* findTailInsertionPoint(Expr* fromHere, bool isCoforall) {
-  Expr*     curr   = (isCoforall) ? fromHere->parentExpr : fromHere;
+  Expr*     level  = (isCoforall) ? fromHere->parentExpr : fromHere;
   CallExpr* result = NULL;
 
-  while ((curr = curr->next)) {
-    if (CallExpr* call = toCallExpr(curr))
-      if (call->isNamed("_waitEndCount")) {
-        result = call;
-        break;
-      }
+  // The loop of a coforall+on is in a block of its own, which
+  // _waitEndCount follows.
+  for (; level != NULL && result == NULL; level = level->parentExpr) {
+    Expr* curr = level;
+
+    while ((curr = curr->next)) {
+      if (CallExpr* call = toCallExpr(curr))
+        if (call->isNamed("_waitEndCount")) {
+          result = call;
+          break;
+        }
+    }
+
+    if (!isCoforall)
+      break;
   }
 
   INT_ASSERT(result);
@@ -790,6 +799,9 @@ void createTaskFunctions(void) {
           fn->addFlag(FLAG_NON_BLOCKING);
           fn->addFlag(FLAG_COBEGIN_OR_COFORALL);
         }
+        if (info->isPrimitive(PRIM_BLOCK_COFORALL_ON)) {
+          fn->addFlag(FLAG_COFORALL_ON);
+        }
 
         ArgSymbol* arg = new ArgSymbol(INTENT_CONST_IN, "dummy_locale_arg", dtLocaleID);
         fn->insertFormalAtTail(arg);
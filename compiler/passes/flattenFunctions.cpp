@@ -478,13 +478,33 @@ void flattenNestedFunctions(Vec<FnSymbol*>& nestedFunctions) {
 
 
               form_Map(SymbolMapElem, use, *uses) {
-                usesCopy->put(use->key, gNil);
+                if (use->key->defPoint->parentSymbol != parent &&
+                    !isOuterVar(use->key, parent)) {
+                  usesCopy->put(use->key, gNil);
+                }
               }
 
               args_map.put(parent, usesCopy);
 
               change = true;
             }
+          } else {
+            //
+            // A nested function calling fn from outside the scope of some
+            // of fn's outer vars, e.g. a task function in a generic function
+            // instantiated with a comparator that is itself nested, needs
+            // those vars passed in as well.
+            //
+            SymbolMap* parentUses = args_map.get(parent);
+
+            form_Map(SymbolMapElem, use, *uses) {
+              if (use->key->defPoint->parentSymbol != parent &&
+                  !isOuterVar(use->key, parent) &&
+                  !parentUses->get(use->key)) {
+                parentUses->put(use->key, gNil);
+                change = true;
+              }
+            }
           }
         }
       }
@@ -39,22 +39,29 @@
 #include "stlUtil.h"
 #include "stringutil.h"
 #include "tmpdirname.h"
+#include "version.h"
 
 #ifdef HAVE_LLVM
 #include "llvm/Support/FileSystem.h"
 #endif
 
+#include <dirent.h>
 #include <pwd.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 #include <cerrno>
 #include <string>
 #include <map>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/utsname.h>
+
+extern char** environ;
 
 char executableFilename[FILENAME_MAX + 1] = "";
 char libmodeHeadername[FILENAME_MAX + 1]  = "";
@@ -547,6 +554,280 @@ const char* createDebuggerFile(const char* debugger, int argc, char* argv[]) {
   return dbgfilename;
 }
 
+/************************************* | **************************************
+*                                                                             *
+* Resolving the CHPL_* environment means running printchplenv, which starts   *
+* a Python interpreter and probes compilers, CPUs, and the third-party        *
+* install directories.  That is a noticeable fraction of the startup time of  *
+* short compiles, and it produces the same answer almost every time.  Keep    *
+* its output in a per-user cache file named by a hash of everything that can  *
+* influence the answer:                                                       *
+*                                                                             *
+*   - the printchplenv command line (including the envMap variables) and     *
+*     the compiler version                                                    *
+*   - the environment variables the chplenv scripts consult                  *
+*   - the host's identity (uname)                                             *
+*   - the mtimes of the chplenv scripts, chplconfig files, third-party        *
+*     install directories, and the tools printchplenv finds on the PATH       *
+*                                                                             *
+* The full key is stored in the file and compared on every lookup, so a hash  *
+* collision is just a miss.  Any I/O problem also degrades to a miss.         *
+*                                                                             *
+************************************** | *************************************/
+
+static const char* chplEnvCacheState = "disabled";
+
+static const char* chplEnvCacheHeader = "# chplenv cache v1\n";
+static const char* chplEnvCacheSep    = "\n# printchplenv output\n";
+
+void compilerCacheAddStat(std::string& key, const std::string& path) {
+  struct stat st;
+
+  key += "stat " + path + "=";
+
+  if (stat(path.c_str(), &st) == 0) {
+    char buf[64];
+
+#ifdef __APPLE__
+    long nsec = (long) st.st_mtimespec.tv_nsec;
+#else
+    long nsec = (long) st.st_mtim.tv_nsec;
+#endif
+
+    snprintf(buf, sizeof(buf), "%lld.%09ld:%lld",
+             (long long) st.st_mtime, nsec, (long long) st.st_size);
+    key += buf;
+  }
+
+  key += "\n";
+}
+
+static void chplEnvCacheAddDir(std::string& key, const std::string& dir) {
+  std::vector<std::string> entries;
+
+  if (DIR* d = opendir(dir.c_str())) {
+    while (struct dirent* ent = readdir(d)) {
+      if (ent->d_name[0] != '.')
+        entries.push_back(ent->d_name);
+    }
+
+    closedir(d);
+  }
+
+  std::sort(entries.begin(), entries.end());
+
+  compilerCacheAddStat(key, dir);
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    compilerCacheAddStat(key, dir + "/" + entries[i]);
+  }
+}
+
+static void chplEnvCacheAddTool(std::string& key, const char* tool,
+                                const char* path) {
+  std::string dirs = path ? path : "";
+  size_t      pos  = 0;
+
+  // Only the first hit on the PATH matters, as it is the one the scripts run
+  while (pos <= dirs.size()) {
+    size_t      end  = dirs.find(':', pos);
+    std::string dir  = dirs.substr(pos, end == std::string::npos ?
+                                         std::string::npos : end - pos);
+    std::string file = (dir.empty() ? "." : dir) + "/" + tool;
+
+    if (access(file.c_str(), X_OK) == 0) {
+      compilerCacheAddStat(key, file);
+      return;
+    }
+
+    if (end == std::string::npos)
+      break;
+
+    pos = end + 1;
+  }
+
+  key += std::string("tool ") + tool + "=\n";
+}
+
+static bool chplEnvCacheKeyVar(const char* var) {
+  static const char* prefixes[] = {
+    "CHPL_", "CRAY", "PE_ENV=", "MPI_DIR=", "LIBFABRIC_DIR=", "PATH=",
+    "HOME=", "PYTHONPATH=", "CC=", "CXX=", NULL
+  };
+
+  // The cache controls themselves do not affect printchplenv's answer
+  if (strncmp(var, "CHPL_CHPLENV_CACHE", strlen("CHPL_CHPLENV_CACHE")) == 0)
+    return false;
+
+  for (int i = 0; prefixes[i] != NULL; i++) {
+    if (strncmp(var, prefixes[i], strlen(prefixes[i])) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+static std::string chplEnvCacheKey(const std::string& command) {
+  static const char* tools[] = {
+    "python3", "python", "gcc", "g++", "clang", "clang++", "cc", "CC", "c++",
+    "icc", "pgcc", "llvm-config", "gmake", "make", "aprun", "srun", NULL
+  };
+
+  std::string              key     = chplEnvCacheHeader;
+  std::string              home    = CHPL_HOME;
+  std::vector<std::string> envVars;
+  char                     version[128];
+  struct utsname           host;
+
+  get_version(version);
+
+  key += std::string("version ") + version + "\n";
+  key += "command " + command + "\n";
+
+  if (uname(&host) == 0) {
+    key += std::string("host ") + host.sysname + " " + host.nodename + " " +
+           host.release + " " + host.version + " " + host.machine + "\n";
+  }
+
+  for (char** env = environ; *env != NULL; env++) {
+    if (chplEnvCacheKeyVar(*env))
+      envVars.push_back(*env);
+  }
+
+  std::sort(envVars.begin(), envVars.end());
+
+  for (size_t i = 0; i < envVars.size(); i++) {
+    key += "env " + envVars[i] + "\n";
+  }
+
+  compilerCacheAddStat(key, home + "/util/printchplenv");
+  chplEnvCacheAddDir(key, home + "/util/chplenv");
+
+  // chplconfig is searched for in $CHPL_CONFIG, ~, and $CHPL_HOME
+  const char* configDirs[] = { getenv("CHPL_CONFIG"), getenv("HOME"),
+                               CHPL_HOME };
+
+  for (int i = 0; i < 3; i++) {
+    if (configDirs[i] != NULL) {
+      compilerCacheAddStat(key, std::string(configDirs[i]) + "/chplconfig");
+      compilerCacheAddStat(key, std::string(configDirs[i]) + "/.chplconfig");
+    }
+  }
+
+  // Defaults such as CHPL_GMP and CHPL_LLVM depend on what has been built
+  std::string thirdParty = home + "/third-party";
+  std::vector<std::string> packages;
+
+  if (DIR* d = opendir(thirdParty.c_str())) {
+    while (struct dirent* ent = readdir(d)) {
+      if (ent->d_name[0] != '.')
+        packages.push_back(ent->d_name);
+    }
+
+    closedir(d);
+  }
+
+  std::sort(packages.begin(), packages.end());
+
+  for (size_t i = 0; i < packages.size(); i++) {
+    chplEnvCacheAddDir(key, thirdParty + "/" + packages[i] + "/install");
+  }
+
+  for (int i = 0; tools[i] != NULL; i++) {
+    chplEnvCacheAddTool(key, tools[i], getenv("PATH"));
+  }
+
+  return key;
+}
+
+static std::string compilerCacheDir(const char* dirVar) {
+  if (const char* dir = getenv(dirVar))
+    return dir;
+
+  if (const char* xdg = getenv("XDG_CACHE_HOME"))
+    if (xdg[0] != '\0')
+      return std::string(xdg) + "/chapel";
+
+  if (const char* home = getenv("HOME"))
+    if (home[0] != '\0')
+      return std::string(home) + "/.cache/chapel";
+
+  return "";
+}
+
+std::string compilerCacheFile(const char*        dirVar,
+                              const char*        prefix,
+                              const std::string& key) {
+  std::string        dir  = compilerCacheDir(dirVar);
+  unsigned long long hash = 14695981039346656037ULL;   // FNV-1a
+  char               name[64];
+
+  if (dir.empty())
+    return "";
+
+  for (size_t i = 0; i < key.size(); i++) {
+    hash ^= (unsigned char) key[i];
+    hash *= 1099511628211ULL;
+  }
+
+  snprintf(name, sizeof(name), "/%s-%016llx", prefix, hash);
+
+  return dir + name;
+}
+
+bool compilerCacheRead(const std::string& file, const std::string& key,
+                       std::string& contents) {
+  std::string data   = "";
+  char        buffer[4096];
+  size_t      n      = 0;
+  FILE*       fp     = fopen(file.c_str(), "rb");
+
+  if (fp == NULL)
+    return false;
+
+  while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    data.append(buffer, n);
+
+  fclose(fp);
+
+  if (data.size() <= key.size() || data.compare(0, key.size(), key) != 0)
+    return false;
+
+  contents = data.substr(key.size());
+
+  return true;
+}
+
+void compilerCacheWrite(const std::string& file, const std::string& key,
+                        const std::string& contents) {
+  std::string dir = file.substr(0, file.rfind('/'));
+  char        tmp[32];
+
+  // Create the directory (and its parent) if needed; failures surface below
+  mkdir(dir.substr(0, dir.rfind('/')).c_str(), 0755);
+  mkdir(dir.c_str(), 0755);
+
+  // Write to a private name and rename, so concurrent compiles never see a
+  // partial file
+  snprintf(tmp, sizeof(tmp), ".tmp.%ld", (long) getpid());
+
+  std::string tmpFile = file + tmp;
+  FILE*       fp      = fopen(tmpFile.c_str(), "wb");
+
+  if (fp == NULL)
+    return;
+
+  bool ok = fwrite(key.data(), 1, key.size(), fp) == key.size() &&
+            fwrite(contents.data(), 1, contents.size(), fp) == contents.size();
+
+  if (fclose(fp) != 0 || ok == false || rename(tmpFile.c_str(), file.c_str()))
+    unlink(tmpFile.c_str());
+}
+
+const char* chplEnvCacheStatus() {
+  return chplEnvCacheState;
+}
+
 std::string runPrintChplEnv(std::map<std::string, const char*> varMap) {
   // Run printchplenv script, passing currently known CHPL_vars as well
   std::string command = "";
@@ -560,7 +841,30 @@ std::string runPrintChplEnv(std::map<std::string, const char*> varMap) {
   // Toss stderr away until printchplenv supports a '--suppresswarnings' flag
   command += std::string(CHPL_HOME) + "/util/printchplenv --all --internal --no-tidy --simple 2> /dev/null";
 
-  return runCommand(command);
+  if (fChplEnvCache == false) {
+    chplEnvCacheState = "disabled";
+
+    return runCommand(command);
+  }
+
+  std::string key    = chplEnvCacheKey(command) + chplEnvCacheSep;
+  std::string file   = compilerCacheFile("CHPL_CHPLENV_CACHE_DIR", "chplenv",
+                                         key);
+  std::string output = "";
+
+  if (file.empty() == false && compilerCacheRead(file, key, output)) {
+    chplEnvCacheState = "hit";
+
+  } else {
+    chplEnvCacheState = "miss";
+    output            = runCommand(command);
+
+    // Don't remember an answer that printchplenv couldn't fully produce
+    if (file.empty() == false && output.find("CHPL_HOME=") != std::string::npos)
+      compilerCacheWrite(file, key, output);
+  }
+
+  return output;
 }
 
 std::string getChplDepsApp() {
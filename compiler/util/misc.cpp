@@ -53,6 +53,7 @@ static int         err_fatal        =    0;
 static int         err_user         =    0;
 static int         err_print        =    0;
 static int         err_ignore       =    0;
+static int         err_count        =    0;
 
 static FnSymbol*   err_fn           = NULL;
 static int         err_fn_id        = 0;
@@ -78,6 +79,8 @@ void setupError(const char* subdir, const char* filename, int lineno, int tag) {
   err_print         = tag == 5;
   err_ignore        = ignore_warnings && tag == 4;
 
+  err_count++;
+
   exit_immediately  = tag == 1 || tag == 2;
   exit_eventually  |= tag == 3;
 }
@@ -853,6 +856,11 @@ bool fatalErrorsEncountered() {
   return exit_eventually || exit_end_of_pass;
 }
 
+// The number of errors, warnings and notes reported so far
+int diagnosticCount() {
+  return err_count;
+}
+
 void clearFatalErrors() {
   exit_eventually = false;
   exit_end_of_pass = false;
@@ -211,8 +211,52 @@ config param disableStencilLazyRAD = defaultDisableLazyRADOpt;
 
     // ghost caches are now up-to-date
 
-  After updating, any read from the array should be up-to-date. The
-  ``updateFluff`` function does not currently accept any arguments.
+  After updating, any read from the array should be up-to-date.
+
+  ``updateFluff`` accepts optional arguments that limit which cached elements
+  are refreshed:
+
+  .. code-block:: chapel
+
+    proc updateFluff(depth: rank*idxType = fluff,
+                     low: rank*bool = (true, ...),
+                     high: rank*bool = (true, ...))
+
+  ``depth`` gives the number of cached elements to update in each dimension,
+  counting outward from the locale's block, and may not exceed the ``fluff``
+  the distribution was created with. A zero in ``depth`` skips every cached
+  region lying beyond the block along that dimension. ``low`` and ``high``
+  select whether the regions on the low and high side of each dimension are
+  updated. For example, a sweep that only reads the neighbor above it in the
+  first dimension could use:
+
+  .. code-block:: chapel
+
+    A.updateFluff(depth=(1,0), low=(false,false));
+
+  Corner regions are updated only when every dimension they lie along is
+  selected.
+
+  **Overlapping Updates with Computation**
+
+  ``startFluffUpdate`` accepts the same arguments as ``updateFluff`` and begins
+  the update in the background, returning immediately. ``waitFluffUpdate``
+  blocks until it has completed. Between the two calls the program may compute
+  on elements that neither read the cached elements nor are sent to other
+  locales' caches, such as the interior of each locale's block. Writing to
+  elements near the edge of a block or reading cached elements before
+  ``waitFluffUpdate`` returns may observe partially updated data.
+
+  .. code-block:: chapel
+
+    A.startFluffUpdate();
+    forall (i,j) in Interior do B[i,j] = stencil(A, i, j);
+    A.waitFluffUpdate();
+    forall (i,j) in Edges do B[i,j] = stencil(A, i, j);
+
+  ``waitFluffUpdate`` must be called on the same locale as
+  ``startFluffUpdate``. Starting an update, or calling ``updateFluff``, while
+  another is in progress first waits for the earlier one to complete.
 
   **Reading and Writing to Array Elements**
 
@@ -336,6 +380,8 @@ class StencilArr: BaseRectangularArr {
   pragma "local field"
   var myLocArr: unmanaged LocStencilArr(eltType, rank, idxType, stridable)?;
   const SENTINEL = max(rank*idxType);
+  // number of updates started by 'startFluffUpdate' that have not finished
+  var pendingFluffUpdates: atomic int;
 }
 
 //
@@ -1147,6 +1193,7 @@ override proc StencilArr.dsiElementDeinitializationComplete() {
 }
 
 override proc StencilArr.dsiDestroyArr(deinitElts:bool) {
+  waitFluffUpdate();
   coforall localeIdx in dom.dist.targetLocDom {
     on locArr(localeIdx) {
       var arr = locArr(localeIdx);
@@ -1450,6 +1497,41 @@ private inline proc isZeroTuple(t) {
   return true;
 }
 
+private proc trueTuple(param rank) {
+  var ret : rank*bool;
+  for param i in 0..rank-1 do ret(i) = true;
+  return ret;
+}
+
+//
+// Returns true if the fluff region in direction 'L' (a tuple of values in
+// -1..1) is part of an update restricted to 'depth', 'low' and 'high'.
+//
+private proc fluffSelected(L, depth, low, high) {
+  for param i in 0..L.size-1 {
+    if L(i) != 0 && depth(i) == 0 then return false;
+    if L(i) < 0 && !low(i) then return false;
+    if L(i) > 0 && !high(i) then return false;
+  }
+  return true;
+}
+
+//
+// Narrows 'D', a fluff region in direction 'L' or the slice it is copied
+// from, to the 'depth(i)' indices nearest the owning block in each
+// dimension 'i' along which 'L' points.
+//
+private proc fluffSlice(D, L, depth) {
+  var dims = D.dims();
+  for param i in 0..D.rank-1 {
+    if L(i) < 0 then
+      dims(i) = dims(i) # -depth(i);
+    else if L(i) > 0 then
+      dims(i) = dims(i) # depth(i);
+  }
+  return {(...dims)};
+}
+
 iter _array.boundaries() {
   for d in _value.dsiBoundaries() do yield d;
 }
@@ -1577,7 +1659,8 @@ proc StencilArr.noFluffView() {
 //
 // Ideally the compiler could do something like this for us...
 //
-proc StencilArr.naiveUpdateFluff() {
+proc StencilArr.naiveUpdateFluff(depth: rank*idxType, low: rank*bool,
+                                  high: rank*bool) {
   coforall i in dom.dist.targetLocDom {
     on dom.dist.targetLocales(i) {
       ref myLocDom = locArr[i].locDom;
@@ -1588,8 +1671,11 @@ proc StencilArr.naiveUpdateFluff() {
         //
         // if "L" is zero, that indicates we are at the center of the stencil
         // and do not need to update
-        if !isZeroTuple(L) && S.size != 0 {
-          locArr[i].myElems[D] = locArr[N].myElems[S];
+        if !isZeroTuple(L) && S.size != 0 &&
+           fluffSelected(chpl__tuplify(L), depth, low, high) {
+          const dir = chpl__tuplify(L);
+          locArr[i].myElems[fluffSlice(D, dir, depth)] =
+            locArr[N].myElems[fluffSlice(S, dir, depth)];
         }
       }
     }
@@ -1625,7 +1711,8 @@ proc StencilArr.naiveUpdateFluff() {
 //    b) Bulk-copy the remote buffer into a local buffer
 //    c) Copy elements from the local buffer into the cache
 //
-proc StencilArr._packedUpdate() {
+proc StencilArr._packedUpdate(depth: rank*idxType, low: rank*bool,
+                              high: rank*bool) {
   coforall i in dom.dist.targetLocDom {
     on dom.dist.targetLocales(i) {
       var myLocDom = locArr[i].locDom;
@@ -1637,15 +1724,20 @@ proc StencilArr._packedUpdate() {
       // BHARSH TODO: can we fuse these two foralls? My current concern is that
       // by waiting we might prevent another iteration running and possibly
       // find ourselves in a deadlock.
-      forall (D, S, recvIdx, sendBufIdx) in zip(myLocDom.sendDest, myLocDom.sendSrc,
-                                                myLocDom.Neighs,
-                                                myLocDom.NeighDom) {
-        // If S.size == 0, no communication is required
-        if S.size != 0 {
+      forall (fullD, fullS, recvIdx, sendBufIdx) in zip(myLocDom.sendDest,
+                                                        myLocDom.sendSrc,
+                                                        myLocDom.Neighs,
+                                                        myLocDom.NeighDom) {
+        // If fullS.size == 0, no communication is required. The receiving
+        // locale sees this region as its fluff in the direction opposite
+        // ours, so that is the direction 'depth', 'low' and 'high' apply to.
+        const recvBufIdx = translateIdx(sendBufIdx);
+        if fullS.size != 0 && fluffSelected(recvBufIdx, depth, low, high) {
+          const S = fluffSlice(fullS, recvBufIdx, depth),
+                D = fluffSlice(fullD, recvBufIdx, depth);
           const chunkSize  = max(1, S.dim(rank-1).size); // avoid divide by zero
           const numChunks = S.size / chunkSize;
           if numChunks >= stencilDistPackedUpdateMinChunks {
-            const recvBufIdx = translateIdx(sendBufIdx);
 
             // Pack the buffer
             //
@@ -1664,15 +1756,21 @@ proc StencilArr._packedUpdate() {
           }
         }
       }
-      forall (D, S, srcIdx, recvBufIdx) in zip(myLocDom.recvDest, myLocDom.recvSrc,
-                                               myLocDom.Neighs,
-                                               myLocDom.NeighDom) {
+      forall (fullD, fullS, srcIdx, recvBufIdx) in zip(myLocDom.recvDest,
+                                                       myLocDom.recvSrc,
+                                                       myLocDom.Neighs,
+                                                       myLocDom.NeighDom) {
+        const dir = chpl__tuplify(recvBufIdx);
+        const selected = fullS.size != 0 &&
+                         fluffSelected(dir, depth, low, high);
+        const S = if selected then fluffSlice(fullS, dir, depth) else fullS,
+              D = if selected then fluffSlice(fullD, dir, depth) else fullD;
         const chunkSize  = max(1, S.dim(rank-1).size); // avoid divide by zero
         const numChunks = S.size / chunkSize;
 
         // If we did a naive update in the previous loop, this iteration does
         // not need to do anything.
-        if S.size != 0 && numChunks >= stencilDistPackedUpdateMinChunks {
+        if selected && numChunks >= stencilDistPackedUpdateMinChunks {
           const srcBufIdx = translateIdx(recvBufIdx);
           if debugStencilDist then
             writeln(here, "::", recvBufIdx, " WAITING");
@@ -1697,8 +1795,6 @@ proc StencilArr.shouldDoPackedUpdate() param : bool {
 
 // Update caches
 //
-// TODO: allow a bool argument here?
-//
 // TODO: allow for some kind of user-defined packing/unpacking for complicated
 // types?
 //
@@ -1709,13 +1805,53 @@ proc StencilArr.shouldDoPackedUpdate() param : bool {
 // approach. What we really want is to do a naive transfer if the periodic
 // neighbor is the current locale.
 //
-proc StencilArr.updateFluff() {
+proc StencilArr.updateFluff(depth: rank*idxType = dom.fluff,
+                            low: rank*bool = trueTuple(rank),
+                            high: rank*bool = trueTuple(rank)) {
+  // An update must not overlap one that is still in flight, since both
+  // would use the same buffers and flags.
+  waitFluffUpdate();
+  _updateFluff(depth, low, high);
+}
+
+//
+// Start updating the caches in the background; 'waitFluffUpdate' blocks
+// until the update has completed.
+//
+proc StencilArr.startFluffUpdate(depth: rank*idxType = dom.fluff,
+                                 low: rank*bool = trueTuple(rank),
+                                 high: rank*bool = trueTuple(rank)) {
+  waitFluffUpdate();
+  checkFluffDepth(depth);
+  pendingFluffUpdates.add(1);
+  begin {
+    _updateFluff(depth, low, high);
+    pendingFluffUpdates.sub(1);
+  }
+}
+
+proc StencilArr.waitFluffUpdate() {
+  pendingFluffUpdates.waitFor(0);
+}
+
+proc StencilArr.checkFluffDepth(depth: rank*idxType) {
+  for param i in 0..rank-1 {
+    if depth(i) < 0 || depth(i) > dom.fluff(i) then
+      halt("StencilDist: fluff update depth ", depth,
+           " is outside of the array's fluff ", dom.fluff);
+  }
+}
+
+proc StencilArr._updateFluff(depth: rank*idxType, low: rank*bool,
+                             high: rank*bool) {
   if isZeroTuple(dom.fluff) then return;
+  checkFluffDepth(depth);
+  if isZeroTuple(depth) then return;
 
   if shouldDoPackedUpdate() && dom.dist.targetLocales.size > 1 {
-    this._packedUpdate();
+    this._packedUpdate(depth, low, high);
   } else {
-    this.naiveUpdateFluff();
+    this.naiveUpdateFluff(depth, low, high);
   }
 }
 
@@ -112,6 +112,94 @@ module ByteBufferHelpers {
     chpl_here_free(buf);
   }
 
+  //
+  // Shared buffers are handed out by copy-initialization and assignment of
+  // strings and bytes.  The runtime keeps a reference count in front of
+  // them, so they must only be released, never passed to bufferFree.
+  //
+  pragma "fn synchronization free"
+  pragma "insert line file info"
+  private extern proc chpl_string_shared_alloc(size: size_t): bufferType;
+  pragma "fn synchronization free"
+  pragma "insert line file info"
+  private extern proc chpl_string_shared_realloc(buf: bufferType,
+                                                 size: size_t): bufferType;
+  pragma "fn synchronization free"
+  private extern proc chpl_string_shared_retain(buf: bufferType);
+  pragma "fn synchronization free"
+  pragma "insert line file info"
+  private extern proc chpl_string_shared_release(buf: bufferType);
+  pragma "fn synchronization free"
+  private extern proc chpl_string_shared_is_unique(buf: bufferType): bool;
+  pragma "fn synchronization free"
+  private extern proc chpl_string_shared_codepoint_offset(buf: bufferType,
+                                                          len: int,
+                                                          cp: int): int;
+  pragma "fn synchronization free"
+  private extern proc chpl_string_shared_invalidate(buf: bufferType);
+
+  inline proc bufferAllocShared(requestedSize): (bufferType, int) {
+    const allocSize = getGoodAllocSize(requestedSize);
+    var buf = chpl_string_shared_alloc(allocSize.safeCast(size_t));
+    return (buf, allocSize);
+  }
+
+  // Only valid when bufferIsUniqueShared(buf)
+  proc bufferReallocShared(buf: bufferType, requestedSize: int) {
+    const allocSize = getGoodAllocSize(requestedSize+1);
+    var newBuff = chpl_string_shared_realloc(buf, allocSize.safeCast(size_t));
+    return (newBuff, allocSize);
+  }
+
+  inline proc bufferRetainShared(buf: bufferType) {
+    chpl_string_shared_retain(buf);
+  }
+
+  inline proc bufferReleaseShared(buf: bufferType) {
+    chpl_string_shared_release(buf);
+  }
+
+  inline proc bufferIsUniqueShared(buf: bufferType): bool {
+    return chpl_string_shared_is_unique(buf);
+  }
+
+  // Must be called before the sole owner changes the contents in place
+  inline proc bufferInvalidateShared(buf: bufferType) {
+    chpl_string_shared_invalidate(buf);
+  }
+
+  // Like bufferCodepointOffset from the start of buf, but may use an index
+  // cached alongside the buffer
+  inline proc bufferCodepointOffsetShared(buf: bufferType, len: int,
+                                          cp: int): int {
+    return chpl_string_shared_codepoint_offset(buf, len, cp);
+  }
+
+  inline proc bufferCopyLocalShared(src_addr: bufferType, len: int) {
+      const (dst, allocSize) = bufferAllocShared(len+1);
+      bufferMemcpyLocal(dst=dst, src=src_addr, len=len);
+      dst[len] = 0;
+      return (dst, allocSize);
+  }
+
+  proc bufferCopyRemoteShared(src_loc_id: int(64), src_addr: bufferType,
+                              len: int) {
+      const (dst, allocSize) = bufferAllocShared(len+1);
+      chpl_string_comm_get(dst, src_loc_id, src_addr, len);
+      dst[len] = 0;
+      return (dst, allocSize);
+  }
+
+  inline proc bufferCopyShared(buf: bufferType, off: int, len: int,
+                               loc: locIdType) {
+    if !_local && loc != chpl_nodeID {
+      return bufferCopyRemoteShared(loc, buf+off, len);
+    }
+    else {
+      return bufferCopyLocalShared(buf+off, len);
+    }
+  }
+
   inline proc bufferCopy(buf: bufferType, off: int, len: int, loc: locIdType) {
     if !_local && loc != chpl_nodeID {
       var newBuf = bufferCopyRemote(loc, buf+off, len);
@@ -209,4 +297,37 @@ module ByteBufferHelpers {
       return ret;
     }
   }
+
+  //
+  // UTF-8 helpers.  buf must be local and hold valid UTF-8.
+  //
+  pragma "fn synchronization free"
+  private extern proc chpl_string_validate_utf8(buf: bufferType, len: int,
+                                                allowEsc: bool,
+                                                ref numCodepoints: int): c_int;
+  pragma "fn synchronization free"
+  private extern proc chpl_string_count_codepoints(buf: bufferType,
+                                                   len: int): int;
+  pragma "fn synchronization free"
+  private extern proc chpl_string_codepoint_offset(buf: bufferType, len: int,
+                                                   start: int, cp: int): int;
+
+  // Returns true if buf holds valid UTF-8, and stores the number of
+  // codepoints in numCodepoints.  With allowEsc, the codepoints used to
+  // escape undecodable bytes are accepted as well.
+  inline proc bufferValidateUTF8(buf: bufferType, len: int, allowEsc: bool,
+                                 ref numCodepoints: int): bool {
+    return chpl_string_validate_utf8(buf, len, allowEsc, numCodepoints) == 0;
+  }
+
+  inline proc bufferCountCodepoints(buf: bufferType, len: int): int {
+    return chpl_string_count_codepoints(buf, len);
+  }
+
+  // Returns the byte offset of the codepoint 'cp' codepoints past the one
+  // starting at byte 'start', or len if there are not that many
+  inline proc bufferCodepointOffset(buf: bufferType, len: int,
+                                    start: int, cp: int): int {
+    return chpl_string_codepoint_offset(buf, len, start, cp);
+  }
 }
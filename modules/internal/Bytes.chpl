@@ -276,6 +276,8 @@ module Bytes {
     var buffSize: int = 0; // size of the buffer we own
     var buff: bufferType = nil;
     var isOwned: bool = true;
+    // buff is a reference-counted buffer that copies may share
+    var isShared: bool = false;
     // We use chpl_nodeID as a shortcut to get at here.id without actually constructing
     // a locale object. Used when determining if we should make a remote transfer.
     var locale_id = chpl_nodeID; // : chpl_nodeID_t
@@ -288,7 +290,8 @@ module Bytes {
       if isOwned && this.buff != nil {
         on __primitive("chpl_on_locale_num",
                        chpl_buildLocaleID(this.locale_id, c_sublocid_any)) {
-          chpl_here_free(this.buff);
+          if isShared then bufferReleaseShared(this.buff);
+                      else chpl_here_free(this.buff);
         }
       }
     }
@@ -302,7 +305,7 @@ module Bytes {
 
     proc init=(b: bytes) {
       this.complete();
-      initWithNewBuffer(this, b);
+      initWithSharedBuffer(this, b);
     }
 
     proc init=(b: string) {
@@ -988,7 +991,8 @@ module Bytes {
                 characters remain untouched.
     */
     proc bytes.toLower() : bytes {
-      var result: bytes = this;
+      // result is written in place, so it can't share this's buffer
+      var result = createBytesWithNewBuffer(this);
       if result.isEmpty() then return result;
       for (i,b) in zip(0.., result.bytes()) {
         result.buff[i] = byte_toLower(b); //check is done by byte_toLower
@@ -1005,7 +1009,7 @@ module Bytes {
                 characters remain untouched.
     */
     proc bytes.toUpper() : bytes {
-      var result: bytes = this;
+      var result = createBytesWithNewBuffer(this);
       if result.isEmpty() then return result;
       for (i,b) in zip(0.., result.bytes()) {
         result.buff[i] = byte_toUpper(b); //check is done by byte_toUpper
@@ -1023,7 +1027,7 @@ module Bytes {
                 lowercase.
      */
     proc bytes.toTitle() : bytes {
-      var result: bytes = this;
+      var result = createBytesWithNewBuffer(this);
       if result.isEmpty() then return result;
 
       param UN = 0, LETTER = 1;
@@ -98,6 +98,20 @@ module BytesStringCommon {
 
     if length == 0 then return "";
 
+    // Most buffers are valid UTF-8, so check for that first and then copy
+    // them in one go.  Escape codepoints in the input aren't accepted here,
+    // under any policy.
+    {
+      var numCodepoints: int;
+      if bufferValidateUTF8(buff, length, allowEsc=false, numCodepoints) {
+        var (newBuff, allocSize) = bufferCopyLocalShared(buff, length);
+        var ret: string;
+        ret.cachedNumCodepoints = numCodepoints;
+        initWithSharedOwnedBuffer(ret, newBuff, length, allocSize);
+        return ret;
+      }
+    }
+
     // allocate buffer the same size as this buffer assuming that the string
     // is in fact perfectly decodable. In the worst case, the user wants the
     // replacement policy and we grow the buffer couple of times.
@@ -295,6 +309,14 @@ module BytesStringCommon {
     x.buffLen = length;
   }
 
+  // Like initWithOwnedBuffer, but 'other' came from bufferAllocShared, so
+  // copies of 'x' can share it.
+  inline proc initWithSharedOwnedBuffer(ref x: ?t, other: bufferType,
+                                        length:int, size:int) {
+    initWithOwnedBuffer(x, other, length, size);
+    x.isShared = true;
+  }
+
   inline proc initWithNewBuffer(ref x: ?t, other: t) {
     assertArgType(t, "initWithNewBuffer");
 
@@ -321,6 +343,49 @@ module BytesStringCommon {
     }
   }
 
+  // Copy-initialize 'x' from 'other'.  If 'other' is local and already
+  // shares its buffer, 'x' just takes another reference to it.  Otherwise
+  // the contents are copied once, into a buffer that later copies of 'x'
+  // can share.
+  proc initWithSharedBuffer(ref x: ?t, other: t) {
+    assertArgType(t, "initWithSharedBuffer");
+
+    const otherRemote = other.locale_id != chpl_nodeID;
+    const otherLen = other.numBytes;
+    x.isOwned = true;
+    if t == string then x.hasEscapes = other.hasEscapes;
+    if t == string then x.cachedNumCodepoints = other.cachedNumCodepoints;
+
+    if otherLen > 0 {
+      x.buffLen = otherLen;
+      x.isShared = true;
+      if !_local && otherRemote {
+        const (buff, allocSize) = bufferCopyRemoteShared(other.locale_id,
+                                                         other.buff, otherLen);
+        x.buff = buff;
+        x.buffSize = allocSize;
+      }
+      else if other.isShared {
+        bufferRetainShared(other.buff);
+        x.buff = other.buff;
+        x.buffSize = other.buffSize;
+      }
+      else {
+        const (buff, allocSize) = bufferCopyLocalShared(other.buff, otherLen);
+        x.buff = buff;
+        x.buffSize = allocSize;
+      }
+    }
+  }
+
+  // Let go of the buffer 'x' owns: free it, or drop 'x's reference to it if
+  // it is shared.  Must be called on the locale that owns the buffer.
+  inline proc releaseBuffer(ref x: ?t) {
+    if x.isShared then bufferReleaseShared(x.buff);
+                  else bufferFree(x.buff);
+    x.isShared = false;
+  }
+
   proc initWithNewBuffer(ref x: ?t, other: bufferType, length:int, size:int) {
     assertArgType(t, "initWithNewBuffer");
 
@@ -410,7 +475,15 @@ module BytesStringCommon {
       var byteLow = x.buffLen;  // empty range if bounds outside string
       var byteHigh = x.buffLen - 1;
 
-      if cpIdxHigh >= 0 {
+      if cpIdxHigh >= 0 && x.locale_id == chpl_nodeID {
+        byteLow = _findByteIndexOfCodepoint(x, cpIdxLow);
+        if r.hasHighBound() {
+          byteHigh = _findByteIndexOfCodepoint(x, cpIdxHigh+1,
+                                               fromCp=cpIdxLow,
+                                               fromByte=byteLow) - 1;
+        }
+      }
+      else if cpIdxHigh >= 0 {
         for (i, nBytes) in x._indexLen() {
           if cpCount == cpIdxLow {
             byteLow = i:int;
@@ -424,7 +497,10 @@ module BytesStringCommon {
           cpCount += 1;
         }
       }
-      return (byteLow..byteHigh, cpIdxHigh-cpIdxLow+1);
+      // without a high bound, cpIdxHigh isn't the last codepoint's index,
+      // so leave the count to the caller
+      const numChars = if r.hasHighBound() then cpIdxHigh-cpIdxLow+1 else -1;
+      return (byteLow..byteHigh, numChars);
     }
   }
 
@@ -451,15 +527,15 @@ module BytesStringCommon {
     // from low to high then do a strided operation to put the data in the
     // buffer in the correct order.
     const copyLen = r2.high-r2.low+1;
-    var (copyBuf, copySize) = bufferCopy(buf=x.buff, off=r2.low,
-                                        len=copyLen, loc=x.locale_id);
     if r2.stride == 1 {
-      buff = copyBuf;
-      buffSize = copySize;
+      (buff, buffSize) = bufferCopyShared(buf=x.buff, off=r2.low,
+                                          len=copyLen, loc=x.locale_id);
     }
     else {
       // the range is strided
-      var (newBuff, allocSize) = bufferAlloc(r2.size+1);
+      var (copyBuf, copySize) = bufferCopy(buf=x.buff, off=r2.low,
+                                          len=copyLen, loc=x.locale_id);
+      var (newBuff, allocSize) = bufferAllocShared(r2.size+1);
       for (r2_i, i) in zip(r2, 0..) {
         newBuff[i] = copyBuf[r2_i-r2.low];
       }
@@ -470,17 +546,16 @@ module BytesStringCommon {
     const buffLen = r2.size;
     buff[buffLen] = 0;
 
+    var ret: t;
     if t == string {
       var numCodepoints = numChars;
       if numCodepoints == -1 {
         numCodepoints = countNumCodepoints(buff, buffLen);
       }
-      return chpl_createStringWithOwnedBufferNV(x=buff, length=buffLen,
-          size=buffSize, numCodepoints=numCodepoints);
-    }
-    else {
-      return createBytesWithOwnedBuffer(x=buff, length=buffLen, size=buffSize);
+      ret.cachedNumCodepoints = numCodepoints;
     }
+    initWithSharedOwnedBuffer(ret, buff, buffLen, buffSize);
+    return ret;
   }
 
   proc getIndexType(type t) type {
@@ -827,7 +902,7 @@ module BytesStringCommon {
       if joinedSize == 0 then
         return "":t;
 
-      var (newBuff, allocSize) = bufferAlloc(joinedSize+1);
+      var (newBuff, allocSize) = bufferAllocShared(joinedSize+1);
 
       var first = true;
       var offset = 0;
@@ -853,17 +928,10 @@ module BytesStringCommon {
         }
       }
       newBuff[joinedSize] = 0;
-      if t == string {
-        return chpl_createStringWithOwnedBufferNV(x=newBuff,
-                                                  length=joinedSize,
-                                                  size=allocSize,
-                                                  numCodepoints=numCodepoints);
-      }
-      else {
-        return createBytesWithOwnedBuffer(x=newBuff,
-                                          length=joinedSize,
-                                          size=allocSize);
-      }
+      var ret: t;
+      if t == string then ret.cachedNumCodepoints = numCodepoints;
+      initWithSharedOwnedBuffer(ret, newBuff, joinedSize, allocSize);
+      return ret;
     }
   }
 
@@ -995,11 +1063,27 @@ module BytesStringCommon {
       if !safeAdd(lhs.buffLen,rhs.buffLen) then 
         halt("Buffer overflow allocating string copy data");
       const newLength = lhs.buffLen + rhs.buffLen;
+      const requestedSize = max(newLength+1,
+                                (lhs.buffLen*chpl_stringGrowthFactor):int);
+      if lhs.isOwned && lhs.isShared && !bufferIsUniqueShared(lhs.buff) {
+        // other copies can see our buffer, so write to a buffer of our own
+        var (newBuff, allocSize) = bufferAlloc(requestedSize);
+        bufferMemcpyLocal(dst=newBuff, src=lhs.buff, lhs.buffLen);
+        releaseBuffer(lhs);
+        lhs.buff = newBuff;
+        lhs.buffSize = allocSize;
+      }
+      else if lhs.isOwned && lhs.isShared && lhs.buffSize > newLength {
+        bufferInvalidateShared(lhs.buff);
+      }
       //resize the buffer if needed
-      if lhs.buffSize <= newLength {
-        const requestedSize = max(newLength+1,
-                                  (lhs.buffLen*chpl_stringGrowthFactor):int);
-        if lhs.isOwned {
+      else if lhs.buffSize <= newLength {
+        if lhs.isOwned && lhs.isShared {
+          var (newBuff, allocSize) = bufferReallocShared(lhs.buff,
+                                                         requestedSize);
+          lhs.buff = newBuff;
+          lhs.buffSize = allocSize;
+        } else if lhs.isOwned {
           var (newBuff, allocSize) = bufferRealloc(lhs.buff, requestedSize);
           lhs.buff = newBuff;
           lhs.buffSize = allocSize;
@@ -1009,6 +1093,7 @@ module BytesStringCommon {
           lhs.buff = newBuff;
           lhs.buffSize = allocSize;
           lhs.isOwned = true;
+          lhs.isShared = false;
         }
       }
       // copy the data from rhs
@@ -1027,24 +1112,30 @@ module BytesStringCommon {
       // If the lhs.buff is longer than buff, then reuse the buffer if we are
       // allowed to (lhs.isOwned == true)
       if buffLen != 0 {
-        if !lhs.isOwned || buffLen+1 > lhs.buffSize {
+        if !lhs.isOwned || buffLen+1 > lhs.buffSize ||
+           (lhs.isShared && !bufferIsUniqueShared(lhs.buff)) {
           // If the new string is too big for our current buffer or we dont
-          // own our current buffer then we need a new one.
+          // own our current buffer (alone) then we need a new one.
           if lhs.isOwned && !lhs.isEmpty() then
-            bufferFree(lhs.buff);
+            releaseBuffer(lhs);
           // TODO: should I just allocate 'size' bytes?
           const (buff, allocSize) = bufferAlloc(buffLen+1);
           lhs.buff = buff;
           lhs.buffSize = allocSize;
           // We just allocated a buffer, make sure to free it later
           lhs.isOwned = true;
+          lhs.isShared = false;
+        }
+        else if lhs.isShared {
+          bufferInvalidateShared(lhs.buff);
         }
         bufferMemmoveLocal(lhs.buff, buff, buffLen);
         lhs.buff[buffLen] = 0;
       } else {
         // If buffLen is 0, 'buf' may still have been allocated. Regardless, we
         // need to free the old buffer if 'lhs' is isOwned.
-        if lhs.isOwned && !lhs.isEmpty() then bufferFree(lhs.buff);
+        if lhs.isOwned && !lhs.isEmpty() then releaseBuffer(lhs);
+        lhs.isShared = false;
         lhs.buffSize = 0;
 
         // If we need to copy, we can just set 'buff' to nil. Otherwise the
@@ -1066,18 +1157,19 @@ module BytesStringCommon {
       // allowed to (lhs.isOwned == true)
       if buffLen != 0 {
         if lhs.isOwned && !lhs.isEmpty() then
-          bufferFree(lhs.buff);
+          releaseBuffer(lhs);
         lhs.buff = buff;
         lhs.buffSize = buffSize;
       } else {
         // If buffLen is 0, 'buf' may still have been allocated. Regardless, we
         // need to free the old buffer if 'lhs' is isOwned.
-        if lhs.isOwned && !lhs.isEmpty() then bufferFree(lhs.buff);
+        if lhs.isOwned && !lhs.isEmpty() then releaseBuffer(lhs);
         lhs.buff = buff;
         lhs.buffSize = 0;
       }
 
       lhs.isOwned = true;
+      lhs.isShared = false;
       lhs.buffLen = buffLen;
       if t==string then lhs.cachedNumCodepoints = numCodepoints;
   }
@@ -1086,7 +1178,21 @@ module BytesStringCommon {
     assertArgType(t, "doAssign");
 
     inline proc helpMe(ref lhs: t, rhs: t) {
-      if _local || rhs.locale_id == chpl_nodeID {
+      if (_local || rhs.locale_id == chpl_nodeID) &&
+         rhs.isShared && rhs.buffLen != 0 {
+        // share rhs's buffer rather than copying it
+        if lhs.buff != rhs.buff {
+          bufferRetainShared(rhs.buff);
+          if lhs.isOwned && !lhs.isEmpty() then releaseBuffer(lhs);
+          lhs.buff = rhs.buff;
+          lhs.buffSize = rhs.buffSize;
+          lhs.isOwned = true;
+          lhs.isShared = true;
+        }
+        lhs.buffLen = rhs.buffLen;
+        if t == string then lhs.cachedNumCodepoints = rhs.cachedNumCodepoints;
+      }
+      else if _local || rhs.locale_id == chpl_nodeID {
         if t == string {
           reinitWithNewBuffer(lhs, rhs.buff, rhs.buffLen, rhs.buffSize,
                               rhs.numCodepoints);
@@ -1140,7 +1246,7 @@ module BytesStringCommon {
       halt("Buffer overflow allocating string copy data");
 
     const buffLen = sLen * n;
-    var (buff, allocSize) = bufferAlloc(buffLen+1);
+    var (buff, allocSize) = bufferAllocShared(buffLen+1);
 
     bufferMemcpy(dst=buff, src_loc=x.locale_id, src=x.buff, len=x.buffLen);
     var offset = sLen;
@@ -1151,13 +1257,10 @@ module BytesStringCommon {
     }
     buff[buffLen] = 0;
 
-    if t==string {
-      return chpl_createStringWithOwnedBufferNV(buff, buffLen, allocSize,
-                                                x.cachedNumCodepoints*n);
-    }
-    else {
-      return createBytesWithOwnedBuffer(buff, buffLen, allocSize);
-    }
+    var ret: t;
+    if t == string then ret.cachedNumCodepoints = x.cachedNumCodepoints*n;
+    initWithSharedOwnedBuffer(ret, buff, buffLen, allocSize);
+    return ret;
   }
 
   proc doConcat(s0: ?t, s1: t): t {
@@ -1170,7 +1273,7 @@ module BytesStringCommon {
     if s1len == 0 then return s0;
 
     const buffLen = s0len + s1len;
-    var (buff, buffSize) = bufferAlloc(buffLen+1);
+    var (buff, buffSize) = bufferAllocShared(buffLen+1);
 
     bufferMemcpy(dst=buff, src_loc=s0.locale_id, src=s0.buff, len=s0len);
     bufferMemcpy(dst=buff, src_loc=s1.locale_id, src=s1.buff, len=s1len,
@@ -1181,7 +1284,7 @@ module BytesStringCommon {
     if t == string {
       ret.cachedNumCodepoints = s0.cachedNumCodepoints + s1.cachedNumCodepoints;
     }
-    initWithOwnedBuffer(ret, buff, buffLen, buffSize);
+    initWithSharedOwnedBuffer(ret, buff, buffLen, buffSize);
     return ret;
   }
 
@@ -1311,15 +1414,7 @@ module BytesStringCommon {
   }
 
   proc countNumCodepoints(buff: bufferType, buffLen: int) {
-    var n = 0;
-    var i = 0;
-    while i < buffLen {
-      i += 1;
-      while i < buffLen && !isInitialByte(buff[i]) do
-        i += 1;
-      n += 1;
-    }
-    return n;
+    return bufferCountCodepoints(buff, buffLen);
   }
 
   /*
@@ -1345,6 +1440,20 @@ module BytesStringCommon {
     return ret;
   }
 
+  /*
+   Returns the byte index of the codepoint with index cp, or x.buffLen if
+   there is no such codepoint.  x must be local.  When looking for a later
+   codepoint than one already found, passing that one's codepoint and byte
+   index as fromCp and fromByte saves rescanning the start of the string.
+   */
+  proc _findByteIndexOfCodepoint(const ref x: string, cp: int,
+                                 fromCp = 0, fromByte = 0) {
+    if x.isShared then
+      return bufferCodepointOffsetShared(x.buff, x.buffLen, cp);
+    else
+      return bufferCodepointOffset(x.buff, x.buffLen, fromByte, cp-fromCp);
+  }
+
   // cast helpers
   proc _cleanupForNumericCast(ref x: ?t) {
     assertArgType(t, "_cleanupForNumericCast");
@@ -962,6 +962,32 @@ module ChapelBase {
     return ret;
   }
 
+  // Like _ddata_allocate_noinit, but asks for memory that is already
+  // zeroed.  isZero says whether we got it; if not, the elements are
+  // left uninitialized as with _ddata_allocate_noinit.
+  pragma "llvm return noalias"
+  proc _ddata_allocate_zero(type eltType, size: integral,
+                            out callPostAlloc: bool,
+                            out isZero: bool,
+                            subloc = c_sublocid_none) {
+    pragma "fn synchronization free"
+    pragma "insert line file info"
+    extern proc chpl_mem_array_alloc_zero(nmemb: size_t, eltSize: size_t,
+                                          subloc: chpl_sublocID_t,
+                                          ref callPostAlloc: bool,
+                                          ref isZero: bool): c_void_ptr;
+    var ret: _ddata(eltType);
+    ret = chpl_mem_array_alloc_zero(size:size_t, _ddata_sizeof_element(ret),
+                                    subloc, callPostAlloc, isZero):ret.type;
+    return ret;
+  }
+
+  // True for element types whose default value is all zero bits, so
+  // that zeroed memory already holds default-initialized elements.
+  proc _ddata_defaultIsZero(type eltType) param {
+    return isNumericType(eltType) || isBoolType(eltType);
+  }
+
   inline proc _ddata_allocate_postalloc(data:_ddata, size: integral) {
     pragma "fn synchronization free"
     pragma "insert line file info"
@@ -1201,6 +1227,10 @@ module ChapelBase {
     e.i.add(numTasks:int, memoryOrder.release);
 
     if countRunningTasks {
+      // The tasks of a cobegin, or of a coforall over a range, domain, or
+      // array, are added without anything in between that could wait for
+      // one of them, so they can be started together in _waitEndCount().
+      chpl_taskListDefer(e.taskList);
       if numTasks > 1 {
         here.runningTaskCntAdd(numTasks:int-1);  // decrement is in _waitEndCount()
       }
@@ -1216,6 +1246,8 @@ module ChapelBase {
 
   extern proc chpl_comm_task_create();
 
+  extern proc chpl_comm_task_join(): void;
+
   pragma "task complete impl fn"
   extern proc chpl_comm_task_end(): void;
 
@@ -1244,6 +1276,10 @@ module ChapelBase {
   pragma "task join impl fn"
   pragma "unchecked throws"
   proc _waitEndCount(e: _EndCount, param countRunningTasks=true) throws {
+    // Let the comm layer send anything it is still holding for the tasks
+    // we are about to wait for
+    chpl_comm_task_join();
+
     // Remove the task that will just be waiting/yielding in the following
     // waitFor() from the running task count to let others do real work. It is
     // re-added after the waitFor().
@@ -1274,6 +1310,10 @@ module ChapelBase {
   pragma "task join impl fn"
   pragma "unchecked throws"
   proc _waitEndCount(e: _EndCount, param countRunningTasks=true, numTasks) throws {
+    // Let the comm layer send anything it is still holding for the tasks
+    // we are about to wait for
+    chpl_comm_task_join();
+
     // See if we can help with any of the started tasks
     chpl_taskListExecute(e.taskList);
 
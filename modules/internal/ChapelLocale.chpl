@@ -92,6 +92,10 @@ module ChapelLocale {
     return (subloc != c_sublocid_none
             && subloc != c_sublocid_any
             && subloc != c_sublocid_all);
+
+  // Must match CHPL_TOPO_MAX_CACHE_LEVELS in the runtime.
+  pragma "no doc"
+  param chpl_maxCacheLevels = 5;
   
   /*
     regular: Has a concrete BaseLocale instance
@@ -304,6 +308,71 @@ module ChapelLocale {
   */
   inline proc locale.callStackSize { return this._value.callStackSize; }
 
+  /*
+    ``numCacheLevels`` is the number of levels of data (or unified)
+    cache that could be found on a given locale.  It is 0 if the cache
+    hierarchy could not be determined.
+  */
+  inline proc locale.numCacheLevels { return this._value.nCacheLevels; }
+
+  /*
+    Returns the size in bytes of the data (or unified) cache at the
+    given level on this locale, where level 1 is the cache closest to
+    the cores.  This can be used to size blocks or tiles for
+    cache-aware algorithms.
+
+    :arg level: cache level, starting from 1
+    :type level: `int`
+    :returns: cache size in bytes, or 0 if the level doesn't exist
+              or its size could not be determined
+    :rtype: `int`
+  */
+  inline proc locale.cacheSize(level: int) {
+    return this._value.cacheVal(this._value.cacheSizes, level);
+  }
+
+  /*
+    Returns the line size in bytes of the data (or unified) cache at
+    the given level on this locale.
+
+    :arg level: cache level, starting from 1.  Defaults to 1.
+    :type level: `int`
+    :returns: cache line size in bytes, or 0 if unknown
+    :rtype: `int`
+  */
+  inline proc locale.cacheLineSize(level: int = 1) {
+    return this._value.cacheVal(this._value.cacheLineSizes, level);
+  }
+
+  /*
+    Returns the associativity of the data (or unified) cache at the
+    given level on this locale.
+
+    :arg level: cache level, starting from 1
+    :type level: `int`
+    :returns: number of ways, -1 if the cache is fully associative,
+              or 0 if unknown
+    :rtype: `int`
+  */
+  inline proc locale.cacheAssociativity(level: int) {
+    return this._value.cacheVal(this._value.cacheAssocs, level);
+  }
+
+  /*
+    Returns how many PUs (see :proc:`locale.numPUs`) share a single
+    instance of the data (or unified) cache at the given level on this
+    locale.  For example, a level 3 cache shared by a whole socket of
+    16 hyperthreaded cores would give 32.
+
+    :arg level: cache level, starting from 1
+    :type level: `int`
+    :returns: number of logical PUs sharing the cache, or 0 if unknown
+    :rtype: `int`
+  */
+  inline proc locale.numPUsSharingCache(level: int) {
+    return this._value.cacheVal(this._value.cacheSharers, level);
+  }
+
   pragma "no doc"
   proc =(ref l1: locale, const ref l2: locale) {
     l1._instance = l2._instance;
@@ -350,6 +419,19 @@ module ChapelLocale {
 
     var callStackSize: size_t;
 
+    // Data cache hierarchy, indexed by level-1.
+    pragma "no doc" var nCacheLevels: int;
+    pragma "no doc" var cacheSizes: chpl_maxCacheLevels*int;
+    pragma "no doc" var cacheLineSizes: chpl_maxCacheLevels*int;
+    pragma "no doc" var cacheAssocs: chpl_maxCacheLevels*int;
+    pragma "no doc" var cacheSharers: chpl_maxCacheLevels*int;
+
+    pragma "no doc"
+    inline proc cacheVal(const ref vals: chpl_maxCacheLevels*int,
+                         level: int): int {
+      return if level < 1 || level > nCacheLevels then 0 else vals(level-1);
+    }
+
     proc id : int return chpl_nodeFromLocaleID(__primitive("_wide_get_locale", this));
 
     pragma "no doc"
@@ -28,10 +28,12 @@ module ChapelTaskData {
   // up to 16 bytes of wide pointer for _remoteEndCountType
   // 1 byte for serial_state
   // 1 byte for nextCoStmtSerial
+  // 8 bytes of pointer for the coforall+on loop being collected
   private const chpl_offset_endCount = 0:size_t;
   private const chpl_offset_serial = sizeof_endcount_ptr();
   private const chpl_offset_nextCoStmtSerial = chpl_offset_serial+1;
-  private const chpl_offset_end = chpl_offset_nextCoStmtSerial+1;
+  private const chpl_offset_coforallOnList = chpl_offset_nextCoStmtSerial+1;
+  private const chpl_offset_end = chpl_offset_coforallOnList+c_sizeof(c_void_ptr);
 
   // What is the size of a wide _EndCount pointer?
   private
@@ -123,6 +125,21 @@ module ChapelTaskData {
     return v == 1;
   }
 
+  proc chpl_task_data_setCoforallOnList(tls:c_ptr(chpl_task_infoChapel_t), list: c_void_ptr) : void {
+    var prv = tls:c_ptr(c_uchar);
+    var i = chpl_offset_coforallOnList;
+    var v = list;
+    c_memcpy(c_ptrTo(prv[i]), c_ptrTo(v), c_sizeof(c_void_ptr));
+  }
+
+  proc chpl_task_data_getCoforallOnList(tls:c_ptr(chpl_task_infoChapel_t)) : c_void_ptr {
+    var prv = tls:c_ptr(c_uchar);
+    var i = chpl_offset_coforallOnList;
+    var v:c_void_ptr;
+    c_memcpy(c_ptrTo(v), c_ptrTo(prv[i]), c_sizeof(c_void_ptr));
+    return v;
+  }
+
 
   // These functions are like the above but first get the pointer
   // to the task local storage region for the currently executing task.
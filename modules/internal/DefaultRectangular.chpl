@@ -1234,18 +1234,47 @@ module DefaultRectangular {
           chpl_debug_writeln("*** DR alloc ", eltType:string, " ", size);
         }
 
+        //
+        // If default initialization would just zero the elements, ask
+        // for zeroed memory and skip it when we get that, rather than
+        // zeroing memory the OS has already zeroed.  Reused pooled
+        // memory isn't zeroed, so that still gets initialized.
+        //
+        param wantZero = initElts && _ddata_defaultIsZero(eltType);
+        var eltsZeroed = false;
+
         if !localeModelHasSublocales {
-          data = _ddata_allocate_noinit(eltType, size, callPostAlloc);
+          if wantZero then
+            data = _ddata_allocate_zero(eltType, size, callPostAlloc,
+                                        eltsZeroed);
+          else
+            data = _ddata_allocate_noinit(eltType, size, callPostAlloc);
+
+          //
+          // Parallel initialization already touches the memory the
+          // way a forall would, so only do it ourselves if that won't
+          // happen.
+          //
+          if wantsFirstTouch(size) &&
+             (!initElts || eltsZeroed ||
+              init_elts_method(size, eltType) != ArrayInit.parallelInit) {
+            firstTouchData(size);
+          }
         } else {
-          data = _ddata_allocate_noinit(eltType, size,
-                                        callPostAlloc,
-                                        subloc = (if here.getChildCount() > 1
-                                                  then c_sublocid_all
-                                                  else c_sublocid_none));
+          const subloc = if here.getChildCount() > 1
+                         then c_sublocid_all
+                         else c_sublocid_none;
+          if wantZero then
+            data = _ddata_allocate_zero(eltType, size, callPostAlloc,
+                                        eltsZeroed, subloc);
+          else
+            data = _ddata_allocate_noinit(eltType, size, callPostAlloc,
+                                          subloc);
         }
 
         if initElts {
-          init_elts(data, size, eltType);
+          if !eltsZeroed then
+            init_elts(data, size, eltType);
           dsiElementInitializationComplete();
         }
       }
@@ -1253,6 +1282,34 @@ module DefaultRectangular {
       initShiftedData();
     }
 
+    proc wantsFirstTouch(size) {
+      pragma "fn synchronization free"
+      extern proc chpl_mem_array_policy_wantsFirstTouch(size: size_t): bool;
+      // The parallel chunking uses 'here', so wait for the root locale.
+      return rootLocaleInitialized && size > 0 &&
+             chpl_mem_array_policy_wantsFirstTouch(
+               size:size_t * _ddata_sizeof_element(data));
+    }
+
+    //
+    // Touch the pages of the newly allocated data in parallel, using
+    // the same block decomposition that a forall over the elements
+    // would, so that under a first-touch NUMA policy each page lands
+    // in the NUMA domain of the task that will be using it.
+    //
+    proc firstTouchData(size) {
+      pragma "fn synchronization free"
+      extern proc chpl_mem_array_touch(data: c_void_ptr, eltSize: size_t,
+                                       lo: size_t, hi: size_t);
+      const eltSize = _ddata_sizeof_element(data);
+      const numChunks = _computeNumChunks(size);
+      coforall chunk in 0..#numChunks {
+        const (lo, hi) = _computeBlock(size, numChunks, chunk, size-1);
+        chpl_mem_array_touch(data:c_void_ptr, eltSize,
+                             lo:size_t, (hi+1):size_t);
+      }
+    }
+
     inline proc getDataIndex(ind: idxType ...1,
                              param getShifted = true)
       where rank == 1
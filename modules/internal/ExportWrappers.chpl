@@ -64,12 +64,21 @@ module ExportWrappers {
   // Generic, but both string and bytes have the same implementation.
   proc chpl__exportRetStringOrBytes(ref val): chpl_byte_buffer {
     var result: chpl_byte_buffer;
-    result.isOwned = val.isOwned:int(8);
-    result.data = val.buff:c_ptr(c_char);
     // Get the length of the string/bytes record in bytes!
     result.size = val.numBytes:uint(64);
-    // Assume ownership of the string/bytes record's internal buffer.
-    val.isOwned = false;
+    if val.isShared {
+      // Other copies may still use a shared buffer, and the receiver will
+      // free what we hand it, so give it a private copy.
+      use ByteBufferHelpers only bufferCopyLocal;
+      const (buff, _) = bufferCopyLocal(val.buff, val.numBytes);
+      result.isOwned = 1;
+      result.data = buff:c_ptr(c_char);
+    } else {
+      result.isOwned = val.isOwned:int(8);
+      result.data = val.buff:c_ptr(c_char);
+      // Assume ownership of the string/bytes record's internal buffer.
+      val.isOwned = false;
+    }
     return result;
   }
 
@@ -131,4 +131,20 @@ module LocaleModelHelpFlat {
       }
     }
   }
+
+  //
+  // nonblocking "on" for an iteration of a coforall+on loop, which may
+  // be collected and launched at the end of the loop
+  //
+  pragma "insert line file info"
+  export
+  proc chpl_executeOnCoforall(in loc: chpl_localeID_t, // target locale
+                              fn: int,              // on-body function idx
+                              args: chpl_comm_on_bundle_p,     // function args
+                              args_size: size_t     // args size
+                             ) {
+    const node = chpl_nodeFromLocaleID(loc);
+    if !chpl_coforallOnDefer(node, c_sublocid_any, fn, args, args_size) then
+      chpl_executeOnNB(loc, fn, args, args_size);
+  }
 }
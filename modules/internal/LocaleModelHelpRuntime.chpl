@@ -124,6 +124,13 @@ module LocaleModelHelpRuntime {
                                       subloc_id: int,
                                       ref tlist: c_void_ptr, tlist_node_id: int,
                                       is_begin: bool);
+  pragma "insert line file info"
+  extern proc chpl_task_addStacklessToTaskList(fn: int,
+                                      args: chpl_task_bundle_p, args_size: size_t,
+                                      subloc_id: int,
+                                      ref tlist: c_void_ptr, tlist_node_id: int,
+                                      is_begin: bool);
+  extern proc chpl_task_deferTasksInList(ref tlist: c_void_ptr);
   extern proc chpl_task_executeTasksInList(ref tlist: c_void_ptr);
   extern proc chpl_task_yield();
 
@@ -137,7 +144,8 @@ module LocaleModelHelpRuntime {
                              args: chpl_task_bundle_p,      // function args
                              args_size: size_t,     // args size
                              ref tlist: c_void_ptr, // task list
-                             tlist_node_id: int     // task list owner node
+                             tlist_node_id: int,    // task list owner node
+                             stackless: bool        // runs to completion?
                             ) {
     var tls = chpl_task_getInfoChapel();
     var isSerial = chpl_task_data_getSerial(tls);
@@ -145,8 +153,12 @@ module LocaleModelHelpRuntime {
       chpl_ftable_call(fn, args);
     } else {
       chpl_task_data_setup(args, tls);
-      chpl_task_addToTaskList(fn, args, args_size,
-                              subloc_id, tlist, tlist_node_id, true);
+      if stackless then
+        chpl_task_addStacklessToTaskList(fn, args, args_size,
+                                         subloc_id, tlist, tlist_node_id, true);
+      else
+        chpl_task_addToTaskList(fn, args, args_size,
+                                subloc_id, tlist, tlist_node_id, true);
     }
   }
 
@@ -161,7 +173,8 @@ module LocaleModelHelpRuntime {
                               args: chpl_task_bundle_p,      // function args
                               args_size: size_t,     // args size
                               ref tlist: c_void_ptr, // task list
-                              tlist_node_id: int     // task list owner node
+                              tlist_node_id: int,    // task list owner node
+                              stackless: bool        // runs to completion?
                              ) {
     var tls = chpl_task_getInfoChapel();
     var isSerial = chpl_task_data_getSerial(tls);
@@ -173,11 +186,22 @@ module LocaleModelHelpRuntime {
       chpl_ftable_call(fn, args);
     } else {
       chpl_task_data_setup(args, tls);
-      chpl_task_addToTaskList(fn, args, args_size,
-                              subloc_id, tlist, tlist_node_id, false);
+      if stackless then
+        chpl_task_addStacklessToTaskList(fn, args, args_size,
+                                         subloc_id, tlist, tlist_node_id, false);
+      else
+        chpl_task_addToTaskList(fn, args, args_size,
+                                subloc_id, tlist, tlist_node_id, false);
      }
   }
 
+  //
+  // allow the tasks added to a list to wait until chpl_taskListExecute()
+  //
+  proc chpl_taskListDefer(ref task_list: c_void_ptr) {
+    chpl_task_deferTasksInList(task_list);
+  }
+
   //
   // make sure all tasks in a list have an opportunity to run
   //
@@ -190,6 +214,173 @@ module LocaleModelHelpRuntime {
     chpl_task_executeTasksInList(task_list);
   }
 
+  //////////////////////////////////////////
+  //
+  // support for coforall+on loops
+  //
+  // Rather than launching the iterations of a large coforall+on loop one
+  // at a time from the parent task, chpl_executeOnCoforall() collects
+  // their argument bundles, and chpl_coforallOnEnd() launches them as a
+  // tree when the parent reaches the end of the loop: the upper half of
+  // the iterations is forwarded to the node the first of them runs on,
+  // which launches them the same way, while the parent continues with the
+  // lower half.  The loop's end count is still what the parent waits on.
+  //
+
+  // loops with fewer iterations launch them directly
+  private param coforallOnTreeMinTasks = 16;
+
+  // the number of iterations a launching task launches by itself
+  private param coforallOnTreeLeafSize = 4;
+
+  record chpl_coforallOnTask {
+    var node: chpl_nodeID_t;
+    var subloc: chpl_sublocID_t;
+    var fn: int;
+    var argsOffset: int;
+    var argsSize: int;
+  }
+
+  record chpl_coforallOnList {
+    var maxTasks: int;
+    var numTasks: int;
+    var tasks: c_ptr(chpl_coforallOnTask);
+    var args: c_ptr(uint(8));
+    var maxArgsSize: int;
+    var argsSize: int;
+  }
+
+  //
+  // Start collecting the iterations of a coforall+on loop with maxTasks
+  // iterations, or stop collecting if maxTasks is 0, and return the
+  // collection of any enclosing loop, for chpl_coforallOnEnd().
+  //
+  proc chpl_coforallOnBegin(maxTasks): c_void_ptr {
+    var tls = chpl_task_getInfoChapel();
+    const saved = chpl_task_data_getCoforallOnList(tls);
+    var list: c_ptr(chpl_coforallOnList) = c_nil;
+    if maxTasks >= coforallOnTreeMinTasks && numLocales > 1 &&
+       !chpl_task_data_getSerial(tls) {
+      list = c_malloc(chpl_coforallOnList, 1);
+      list.deref() = new chpl_coforallOnList(maxTasks=maxTasks:int,
+                         tasks=c_malloc(chpl_coforallOnTask, maxTasks));
+    }
+    chpl_task_data_setCoforallOnList(tls, list:c_void_ptr);
+    return saved;
+  }
+
+  //
+  // Add an iteration to the collection of the current coforall+on loop,
+  // if there is one with room for it.  Returns false if the caller should
+  // launch the iteration itself.
+  //
+  proc chpl_coforallOnDefer(node: chpl_nodeID_t,
+                            subloc: chpl_sublocID_t,
+                            fn: int,
+                            args: chpl_comm_on_bundle_p,
+                            args_size: size_t): bool {
+    var tls = chpl_task_getInfoChapel();
+    const list = chpl_task_data_getCoforallOnList(tls):c_ptr(chpl_coforallOnList);
+    if list == c_nil || chpl_task_data_getSerial(tls) then
+      return false;
+
+    ref l = list.deref();
+    // keep the bundles aligned as if each had been allocated separately
+    const size = args_size:int, stride = (size + 15) & ~15;
+    if l.args == c_nil {
+      // all the iterations are launched from the same call site
+      l.maxArgsSize = l.maxTasks * stride;
+      l.args = c_malloc(uint(8), l.maxArgsSize);
+    }
+    if l.numTasks == l.maxTasks || l.argsSize + size > l.maxArgsSize then
+      return false;
+
+    chpl_task_data_setup(chpl_comm_on_bundle_task_bundle(args), tls);
+    c_memcpy(l.args + l.argsSize, __primitive("cast", c_void_ptr, args), size);
+    l.tasks[l.numTasks] = new chpl_coforallOnTask(node, subloc, fn,
+                                                  l.argsSize, size);
+    l.numTasks += 1;
+    l.argsSize += stride;
+    return true;
+  }
+
+  //
+  // Launch the iterations collected for the current coforall+on loop and
+  // go back to the collection of the enclosing loop, if any.
+  //
+  proc chpl_coforallOnEnd(saved: c_void_ptr) {
+    var tls = chpl_task_getInfoChapel();
+    const list = chpl_task_data_getCoforallOnList(tls):c_ptr(chpl_coforallOnList);
+    chpl_task_data_setCoforallOnList(tls, saved);
+    if list != c_nil {
+      ref l = list.deref();
+      chpl_coforallOnLaunch(l.tasks, l.args, 0, 0, l.numTasks);
+      c_free(l.args);
+      c_free(l.tasks);
+      c_free(list);
+    }
+  }
+
+  //
+  // Launch iterations lo..hi-1, whose bundles are at args, which holds
+  // the collected bundles starting at offset argsBase.
+  //
+  private proc chpl_coforallOnLaunch(tasks: c_ptr(chpl_coforallOnTask),
+                                     args: c_ptr(uint(8)), argsBase: int,
+                                     lo: int, hi: int) {
+    if hi - lo <= coforallOnTreeLeafSize {
+      for i in lo..hi-1 {
+        const t = tasks[i];
+        const bundle = __primitive("cast", chpl_comm_on_bundle_p,
+                                   args + (t.argsOffset - argsBase));
+        if t.node == chpl_nodeID then
+          chpl_comm_taskCallFTable(t.fn, bundle, t.argsSize:size_t, t.subloc);
+        else
+          chpl_comm_execute_on_nb(t.node, t.subloc, t.fn, bundle,
+                                  t.argsSize:size_t);
+      }
+    } else {
+      const mid = lo + (hi - lo) / 2;
+      const node = tasks[mid].node;
+      cobegin {
+        if node == chpl_nodeID then
+          chpl_coforallOnLaunch(tasks, args, argsBase, mid, hi);
+        else
+          chpl_coforallOnForward(node, tasks, args, argsBase, mid, hi);
+        chpl_coforallOnLaunch(tasks, args, argsBase, lo, mid);
+      }
+    }
+  }
+
+  //
+  // Have node launch iterations lo..hi-1, after copying their entries
+  // and bundles from here.
+  //
+  private proc chpl_coforallOnForward(node: chpl_nodeID_t,
+                                      tasks: c_ptr(chpl_coforallOnTask),
+                                      args: c_ptr(uint(8)), argsBase: int,
+                                      lo: int, hi: int) {
+    const srcNode = chpl_nodeID;
+    on __primitive("chpl_on_locale_num",
+                   chpl_buildLocaleID(node, c_sublocid_any)) {
+      const n = hi - lo;
+      var myTasks = c_malloc(chpl_coforallOnTask, n);
+      __primitive("chpl_comm_get", myTasks, srcNode, tasks + lo,
+                  n:size_t * c_sizeof(chpl_coforallOnTask));
+
+      const myArgsBase = myTasks[0].argsOffset;
+      const myArgsSize = myTasks[n-1].argsOffset + myTasks[n-1].argsSize
+                         - myArgsBase;
+      var myArgs = c_malloc(uint(8), myArgsSize);
+      __primitive("chpl_comm_get", myArgs, srcNode,
+                  args + (myArgsBase - argsBase), myArgsSize:size_t);
+
+      chpl_coforallOnLaunch(myTasks, myArgs, myArgsBase, 0, n);
+      c_free(myArgs);
+      c_free(myTasks);
+    }
+  }
+
   // wrap around runtime's chpl__initCopy
   proc chpl__initCopy(initial: chpl_localeID_t,
                       definedConst: bool): chpl_localeID_t {
@@ -163,6 +163,29 @@ module LocaleModelHelpSetup {
 
     extern proc chpl_task_getMaxPar(): uint(32);
     dst.maxTaskPar = chpl_task_getMaxPar();
+
+    extern proc chpl_topo_getNumCacheLevels(): c_int;
+    extern proc chpl_topo_getCacheInfo(level: c_int,
+                                       ref info: chpl_topo_cacheInfo_t);
+    dst.nCacheLevels = min(chpl_topo_getNumCacheLevels(): int,
+                           chpl_maxCacheLevels);
+    for i in 0..<dst.nCacheLevels {
+      var info: chpl_topo_cacheInfo_t;
+      chpl_topo_getCacheInfo((i+1): c_int, info);
+      dst.cacheSizes(i) = info.size: int;
+      dst.cacheLineSizes(i) = info.lineSize: int;
+      dst.cacheAssocs(i) = info.associativity: int;
+      dst.cacheSharers(i) = info.numSharingPUs: int;
+    }
+  }
+
+  // Must match the runtime's chpl_topo_cacheInfo_t.
+  pragma "no doc"
+  extern record chpl_topo_cacheInfo_t {
+    var size: size_t;
+    var lineSize: size_t;
+    var associativity: c_int;
+    var numSharingPUs: c_int;
   }
 
   proc helpSetupLocaleNUMA(dst:borrowed LocaleModel, out local_name:string, numSublocales, type NumaDomain) {
@@ -189,6 +212,12 @@ module LocaleModelHelpSetup {
         dst.childLocales[i].nPUsLogAcc = nPUsLogAccPerSubloc;
         dst.childLocales[i].nPUsLogAll = nPUsLogAllPerSubloc;
         dst.childLocales[i].maxTaskPar = maxTaskParPerSubloc;
+        // Caches are assumed to look the same from every NUMA domain.
+        dst.childLocales[i].nCacheLevels = dst.nCacheLevels;
+        dst.childLocales[i].cacheSizes = dst.cacheSizes;
+        dst.childLocales[i].cacheLineSizes = dst.cacheLineSizes;
+        dst.childLocales[i].cacheAssocs = dst.cacheAssocs;
+        dst.childLocales[i].cacheSharers = dst.cacheSharers;
       }
       chpl_task_setSubloc(origSubloc);
     }
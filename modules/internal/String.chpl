@@ -431,11 +431,9 @@ module String {
   // End index arithmetic support
 
   private proc validateEncoding(buf, len): int throws {
-    extern proc chpl_enc_validate_buf(buf, len, ref numCodepoints) : c_int;
-    
     var numCodepoints: int;
     
-    if chpl_enc_validate_buf(buf, len, numCodepoints) != 0 {
+    if !bufferValidateUTF8(buf, len, allowEsc=true, numCodepoints) {
       throw new DecodeError();
     }
     
@@ -723,6 +721,8 @@ module String {
     var cachedNumCodepoints: int = 0;
     var buff: bufferType = nil;
     var isOwned: bool = true;
+    // buff is a reference-counted buffer that copies may share
+    var isShared: bool = false;
     var hasEscapes: bool = false;
     // We use chpl_nodeID as a shortcut to get at here.id without actually constructing
     // a locale object. Used when determining if we should make a remote transfer.
@@ -734,7 +734,7 @@ module String {
 
     proc init=(s: string) {
       this.complete();
-      initWithNewBuffer(this, s);
+      initWithSharedBuffer(this, s);
     }
 
     proc init=(cs: c_string) {
@@ -753,7 +753,8 @@ module String {
       if isOwned && this.buff != nil {
         on __primitive("chpl_on_locale_num",
                        chpl_buildLocaleID(this.locale_id, c_sublocid_any)) {
-          chpl_here_free(this.buff);
+          if isShared then bufferReleaseShared(this.buff);
+                      else chpl_here_free(this.buff);
         }
       }
     }
@@ -1460,6 +1461,20 @@ module String {
                                             len=1, loc=this.locale_id);
       return chpl_createStringWithOwnedBufferNV(newBuff, 1, allocSize, 1);
     }
+    else if this.locale_id == chpl_nodeID {
+      const byteIdx = _findByteIndexOfCodepoint(this, i:int);
+      if byteIdx >= this.buffLen {
+        if boundsChecking then
+          halt("index ", i:int, " out of bounds for string with length ", this.size);
+        return "";
+      }
+      var nBytes = 1;
+      while byteIdx+nBytes < this.buffLen &&
+            !isInitialByte(this.buff[byteIdx+nBytes]) do
+        nBytes += 1;
+      var (newBuff, allocSize) = bufferCopyLocal(this.buff+byteIdx, nBytes);
+      return chpl_createStringWithOwnedBufferNV(newBuff, nBytes, allocSize, 1);
+    }
     else {
       var charCount = 0;
       for (cp, byteIdx, nBytes) in _cpIndexLen() {
@@ -36,4 +36,8 @@ module stopInitCommDiags {
     writeln(getCommDiagnostics());
     resetCommDiagnostics();
   }
+
+  proc deinit() {
+    chpl_reportCommProfileAtExit();
+  }
 }
@@ -0,0 +1,528 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+The Benchmark module provides support for measuring the performance of Chapel
+code with repeatable, statistically summarized timings.
+
+Writing benchmarks
+------------------
+
+A benchmark is a function that takes a single argument of type
+``borrowed Bench`` and executes the code being measured
+:var:`Bench.iterations` times:
+
+.. code-block:: chapel
+
+   use Benchmark;
+
+   config const n = 1_000_000;
+
+   proc benchSum(b: borrowed Bench) {
+     var A: [1..n] real = 1.0;
+     b.resetTimer();   // don't count the set-up above
+     for 1..b.iterations do
+       b.keep(+ reduce A);
+   }
+
+   runBenchmarks(benchSum);
+
+:proc:`runBenchmarks` runs every benchmark passed to it and prints a table
+with one row per benchmark.  Each benchmark is run in four phases:
+
+1. *calibration*: unless :var:`benchIterations` is set, the benchmark is
+   called with a growing iteration count until one call takes at least
+   :var:`benchMinTime` seconds.  This determines the number of iterations
+   used for the rest of the run, and also serves to warm up caches, the
+   memory allocator and the tasking layer.
+2. *warm-up*: the benchmark is called :var:`benchWarmup` more times with
+   the calibrated iteration count, and these timings are discarded.
+3. *timed runs*: the benchmark is called :var:`benchRuns` times.  Each run
+   produces one sample, the time per iteration of that call.
+4. *reporting*: the minimum, maximum, mean, median, standard deviation and
+   90th/99th percentiles of the samples are computed and printed.
+
+Time spent between :proc:`Bench.stopTimer` and :proc:`Bench.startTimer` is
+not counted, so set-up and verification code inside the loop can be
+excluded from the measurements.  :proc:`Bench.keep` can be used to keep the
+compiler from eliminating a computation whose result is otherwise unused.
+
+Communication and memory
+------------------------
+
+When :var:`benchCommDiags` is ``true``, communication diagnostics (see
+:mod:`CommDiagnostics`) are collected across all locales during the timed
+portion of every run and reported as operations per iteration.  When the
+program is run with ``--memTrack``, the change in memory allocated across
+all locales over each run is reported as well, which helps to catch
+kernels that leak or retain memory.
+
+JSON output
+-----------
+
+When :var:`benchJSON` names a file, the results are also written to it as a
+JSON object with two members: ``context``, which describes the
+configuration the program was built and run with, and ``benchmarks``, an
+array with one object per benchmark.  Each benchmark object has the
+following members, using seconds per iteration for all times:
+
+* ``name``, ``iterations`` and ``runs``
+* ``min``, ``max``, ``mean``, ``median``, ``stddev``, ``p90`` and ``p99``
+* ``samples``: the time per iteration of every timed run
+* ``bytesPerIteration`` and ``bytesPerSecond``, if :proc:`Bench.setBytes`
+  was called
+* ``comm``: communication operations per iteration by kind, if
+  :var:`benchCommDiags` was set
+* ``memoryDelta``: bytes of memory retained per run, if memory tracking
+  was enabled
+
+The set of keys and their meaning is kept stable so that files produced by
+different runs, for example by successive nightly builds, can be compared
+directly by scripts that watch for performance regressions.
+
+Running benchmarks with mason
+-----------------------------
+
+``mason bench`` compiles every program in a mason package's ``bench/``
+directory with ``--fast``, runs it and writes its results to
+``target/bench/<name>.json``.  See the mason documentation for details.
+*/
+module Benchmark {
+  private use List;
+  private use Sort;
+  private use Time;
+  private use Reflection;
+  private use CommDiagnostics;
+  private use ChapelEnv;
+  private use IO;
+  private use Memory.Diagnostics;
+  private use MemTracking only memTrack;
+
+  /* Number of timed runs used to compute the statistics of each benchmark */
+  config const benchRuns = 10;
+
+  /* Number of untimed runs made after calibration and before the timed runs */
+  config const benchWarmup = 1;
+
+  /* Minimum time, in seconds, that a single run of a benchmark should take
+     when the number of iterations is calibrated */
+  config const benchMinTime = 0.5;
+
+  /* Number of iterations per run.  If this is 0 (the default), the number of
+     iterations is calibrated using :var:`benchMinTime`. */
+  config const benchIterations = 0;
+
+  /* Only run benchmarks whose name contains one of these space-separated
+     strings.  The empty string runs all benchmarks. */
+  config const benchFilter = "";
+
+  /* If not empty, the name of a file to write the results to in JSON form */
+  config const benchJSON = "";
+
+  /* Collect communication diagnostics during the timed runs */
+  config const benchCommDiags = false;
+
+  /* Upper bound on the number of iterations chosen by calibration */
+  private param maxIterations = 1_000_000_000;
+
+  /*
+    The handle through which a benchmark function learns how many
+    iterations to run and controls what is timed.
+  */
+  class Bench {
+    /* The number of times the benchmark should execute the code being
+       measured in this call */
+    var iterations: int;
+
+    pragma "no doc"
+    var timer: Timer;
+
+    pragma "no doc"
+    var bytesPerIter: int;
+
+    pragma "no doc"
+    var sink: atomic int;
+
+    /* Start, or resume, timing this run.  Runs are started automatically
+       before the benchmark function is called. */
+    proc startTimer() {
+      if !timer.running {
+        timer.start();
+        if benchCommDiags then startCommDiagnostics();
+      }
+    }
+
+    /* Pause timing this run, for example to exclude verification code */
+    proc stopTimer() {
+      if timer.running {
+        timer.stop();
+        if benchCommDiags then stopCommDiagnostics();
+      }
+    }
+
+    /* Discard the time and communication counted so far in this run,
+       for example after initializing the data the benchmark operates on */
+    proc resetTimer() {
+      timer.clear();
+      if benchCommDiags then resetCommDiagnostics();
+    }
+
+    /* Record the number of bytes processed by one iteration, so that a
+       throughput can be reported along with the timings */
+    proc setBytes(n: integral) {
+      bytesPerIter = n: int;
+    }
+
+    /* Consume a value so that the computation producing it can't be
+       optimized away */
+    proc keep(x) {
+      if isIntegralType(x.type) || isBoolType(x.type) then
+        sink.add(x: int, memoryOrder.relaxed);
+      else if isRealType(x.type) then
+        sink.add((x != 0.0): int, memoryOrder.relaxed);
+      else
+        sink.add(1, memoryOrder.relaxed);
+    }
+
+    pragma "no doc"
+    override proc writeThis(f) throws {
+      f <~> "Bench(iterations = " <~> iterations <~> ")";
+    }
+  }
+
+  /*
+    The results of running a single benchmark.  All times are in seconds
+    per iteration.
+  */
+  record BenchResult {
+    /* The name of the benchmark */
+    var name: string;
+    /* The number of iterations in each timed run */
+    var iterations: int;
+    /* The time per iteration of each timed run, in the order they ran */
+    var samples: list(real);
+    /* Statistics of :var:`samples` */
+    var min, max, mean, median, stddev, p90, p99: real;
+    /* Bytes processed per iteration, as set by :proc:`Bench.setBytes` */
+    var bytesPerIter: int;
+    /* Whether :var:`comm` holds counts */
+    var hasComm: bool;
+    /* Communication operations summed over all locales and all timed
+       runs */
+    var comm: commDiagnostics;
+    /* Whether :var:`memoryDelta` was measured */
+    var hasMemory: bool;
+    /* Mean change in memory allocated over a timed run, in bytes */
+    var memoryDelta: real;
+
+    /* The number of timed runs */
+    proc runs { return samples.size; }
+
+    /* The value of the communication counter ``field`` per iteration */
+    proc commPerIteration(param field: string): real {
+      return getField(comm, field): real / (iterations * runs);
+    }
+
+    /* Bytes processed per second, based on the median time */
+    proc bytesPerSecond(): real {
+      return if median > 0.0 then bytesPerIter / median else 0.0;
+    }
+  }
+
+  /* Return the given percentile, from 0 to 100, of the sorted samples ``s``,
+     interpolating linearly between neighboring samples */
+  proc percentile(const ref s: [] real, p: real): real {
+    if s.size == 0 then return 0.0;
+    const pos = (s.size - 1) * p / 100.0,
+          lo = s.domain.low + pos: int,
+          hi = min(lo + 1, s.domain.high),
+          frac = pos - pos: int;
+    return s[lo] + (s[hi] - s[lo]) * frac;
+  }
+
+  private proc summarize(ref r: BenchResult) {
+    var s = r.samples.toArray();
+    sort(s);
+    const n = s.size;
+    r.min = s[s.domain.low];
+    r.max = s[s.domain.high];
+    r.mean = (+ reduce s) / n;
+    r.median = percentile(s, 50);
+    r.p90 = percentile(s, 90);
+    r.p99 = percentile(s, 99);
+    const m = r.mean;
+    r.stddev = if n > 1 then sqrt((+ reduce [x in s] (x - m)**2) / (n - 1))
+               else 0.0;
+  }
+
+  private proc totalMemoryUsed(): int {
+    var total = 0;
+    for loc in Locales do on loc do
+      total += memoryUsed(): int;
+    return total;
+  }
+
+  // the fields of an extern record aren't zeroed by default initialization
+  private proc clearComm(ref total: commDiagnostics) {
+    for param i in 0..<numFields(commDiagnostics) do
+      getFieldRef(total, i) = 0;
+  }
+
+  private proc addComm(ref total: commDiagnostics) {
+    for d in getCommDiagnostics() do
+      for param i in 0..<numFields(commDiagnostics) do
+        getFieldRef(total, i) += getField(d, i);
+  }
+
+  /* Run one call of the benchmark with ``n`` iterations and return the
+     time it took */
+  private proc runOnce(fn, b: borrowed Bench, n: int) throws {
+    b.iterations = n;
+    b.resetTimer();
+    b.startTimer();
+    fn(b);
+    b.stopTimer();
+    return b.timer.elapsed();
+  }
+
+  /* Find the number of iterations for which one run takes at least
+     :var:`benchMinTime` seconds.  The count grows by at most 100x per step
+     and aims 20% past the goal so that it converges in a few calls.  The
+     first call is discarded, as it can pay one-time costs such as starting
+     up remote tasks that would otherwise make a single iteration look long
+     enough. */
+  private proc calibrate(fn, b: borrowed Bench) throws {
+    runOnce(fn, b, 1);
+    var n = 1;
+    while true {
+      const t = runOnce(fn, b, n);
+      if t >= benchMinTime || n >= maxIterations then break;
+      var next = if t > 0.0 then (1.2 * benchMinTime / t * n): int
+                 else 100 * n;
+      next = max(min(next, 100 * n, maxIterations), n + 1);
+      n = next;
+    }
+    return n;
+  }
+
+  /*
+    Run a single benchmark and return its results.
+
+    :arg name: The name to report the benchmark under
+    :arg fn: The benchmark function, which takes a ``borrowed Bench``
+  */
+  proc runBenchmark(name: string, fn): BenchResult throws {
+    if benchRuns < 1 then
+      halt("benchRuns must be at least 1");
+    var result = new BenchResult(name);
+    var b = new Bench();
+
+    result.iterations = if benchIterations > 0 then benchIterations
+                        else calibrate(fn, b);
+    for 1..benchWarmup do
+      runOnce(fn, b, result.iterations);
+
+    const trackMem = memTrack;
+    result.hasComm = benchCommDiags;
+    clearComm(result.comm);
+    result.hasMemory = trackMem;
+    var memTotal = 0;
+    for 1..benchRuns {
+      const before = if trackMem then totalMemoryUsed() else 0;
+      const t = runOnce(fn, b, result.iterations);
+      if trackMem then memTotal += totalMemoryUsed() - before;
+      if benchCommDiags then addComm(result.comm);
+      result.samples.append(t / result.iterations);
+    }
+    if benchCommDiags then resetCommDiagnostics();
+
+    result.bytesPerIter = b.bytesPerIter;
+    if trackMem then result.memoryDelta = memTotal: real / benchRuns;
+    summarize(result);
+    return result;
+  }
+
+  /* Whether :var:`benchFilter` selects the benchmark named ``name``.  Use
+     this to honor the filter when calling :proc:`runBenchmark` directly. */
+  proc isSelected(name: string): bool {
+    if benchFilter.isEmpty() then return true;
+    for f in benchFilter.split() do
+      if name.find(f) != -1 then return true;
+    return false;
+  }
+
+  /*
+    Run the given benchmark functions, print a table of their results and,
+    if :var:`benchJSON` is set, write them to that file.  Benchmarks are
+    named after their functions.  Call this as
+
+    .. code-block:: chapel
+
+      runBenchmarks(benchFoo, benchBar);
+
+    :returns: the results of the benchmarks that were run
+  */
+  proc runBenchmarks(benchmarks...): list(BenchResult) throws {
+    var results: list(BenchResult);
+    for param i in 0..<benchmarks.size {
+      // named after the function, without the "()" of its string form
+      const name = (benchmarks(i): string).strip("()", leading=false);
+      if isSelected(name) then
+        results.append(runBenchmark(name, benchmarks(i)));
+    }
+    printResults(results);
+    if !benchJSON.isEmpty() then
+      writeJSON(results, benchJSON);
+    return results;
+  }
+
+  /* Format a time in seconds using the most readable unit */
+  proc formatTime(t: real): string {
+    if t < 1e-6 then return try! "%.2dr ns".format(t * 1e9);
+    if t < 1e-3 then return try! "%.2dr us".format(t * 1e6);
+    if t < 1.0 then return try! "%.2dr ms".format(t * 1e3);
+    return try! "%.2dr s".format(t);
+  }
+
+  private proc formatBytes(x: real): string {
+    if abs(x) < 1024.0 then return try! "%.0dr B".format(x);
+    if abs(x) < 1024.0**2 then return try! "%.1dr KiB".format(x / 1024.0);
+    if abs(x) < 1024.0**3 then return try! "%.1dr MiB".format(x / 1024.0**2);
+    return try! "%.1dr GiB".format(x / 1024.0**3);
+  }
+
+  // Communication operations of all kinds per iteration
+  private proc commOps(r: BenchResult): real {
+    var total = 0: uint;
+    for param i in 0..<numFields(commDiagnostics) {
+      param name = getFieldName(commDiagnostics, i);
+      if !name.startsWith("cache_") then total += getField(r.comm, i);
+    }
+    return total: real / (r.iterations * r.runs);
+  }
+
+  /* Print a table of benchmark results to ``ch`` */
+  proc printResults(const ref results: list(BenchResult), ch = stdout) throws {
+    const showComm = || reduce [r in results] r.hasComm,
+          showMem = || reduce [r in results] r.hasMemory,
+          showBytes = || reduce [r in results] r.bytesPerIter > 0;
+    var w = 9;
+    for r in results do w = max(w, r.name.size);
+
+    ch.writef("%-*s %10s %10s %10s %10s %10s %10s", w, "benchmark",
+              "iterations", "median", "mean", "stddev", "min", "p90");
+    if showBytes then ch.writef(" %12s", "throughput");
+    if showComm then ch.writef(" %10s", "comm/iter");
+    if showMem then ch.writef(" %10s", "mem/run");
+    ch.writeln();
+    for r in results {
+      ch.writef("%-*s %10i %10s %10s %10s %10s %10s", w, r.name,
+                r.iterations, formatTime(r.median), formatTime(r.mean),
+                formatTime(r.stddev), formatTime(r.min), formatTime(r.p90));
+      if showBytes then
+        ch.writef(" %12s", if r.bytesPerIter > 0
+                           then formatBytes(r.bytesPerSecond()) + "/s"
+                           else "-");
+      if showComm then ch.writef(" %10.2dr", commOps(r));
+      if showMem then ch.writef(" %10s", formatBytes(r.memoryDelta));
+      ch.writeln();
+    }
+  }
+
+  private proc jsonString(s: string): string {
+    var ret = '"';
+    for c in s.items() {
+      select c {
+        when '"' do ret += '\\"';
+        when '\\' do ret += '\\\\';
+        when '\n' do ret += '\\n';
+        when '\t' do ret += '\\t';
+        otherwise do ret += c;
+      }
+    }
+    return ret + '"';
+  }
+
+  private proc jsonReal(x: real): string {
+    return try! "%.9er".format(x);
+  }
+
+  /* Write the results of benchmarks in JSON form to the file at ``path``,
+     replacing it if it exists */
+  proc writeJSON(const ref results: list(BenchResult), path: string) throws {
+    var f = open(path, iomode.cw);
+    var ch = f.writer();
+    writeJSON(results, ch);
+    ch.close();
+    f.close();
+  }
+
+  /* Write the results of benchmarks in JSON form to the channel ``ch`` */
+  proc writeJSON(const ref results: list(BenchResult), ch: channel) throws {
+    ch.writeln("{");
+    ch.writeln('  "context": {');
+    ch.writeln('    "numLocales": ', numLocales, ",");
+    ch.writeln('    "maxTaskPar": ', here.maxTaskPar, ",");
+    ch.writeln('    "dataParTasksPerLocale": ', dataParTasksPerLocale, ",");
+    ch.writeln('    "CHPL_COMM": ', jsonString(CHPL_COMM), ",");
+    ch.writeln('    "CHPL_TASKS": ', jsonString(CHPL_TASKS), ",");
+    ch.writeln('    "CHPL_MEM": ', jsonString(CHPL_MEM), ",");
+    ch.writeln('    "CHPL_TARGET_CPU": ', jsonString(CHPL_TARGET_CPU), ",");
+    ch.writeln('    "CHPL_LOCALE_MODEL": ', jsonString(CHPL_LOCALE_MODEL));
+    ch.writeln("  },");
+    ch.writeln('  "benchmarks": [');
+    for (r, i) in zip(results, 1..) {
+      ch.writeln("    {");
+      ch.writeln('      "name": ', jsonString(r.name), ",");
+      ch.writeln('      "iterations": ', r.iterations, ",");
+      ch.writeln('      "runs": ', r.runs, ",");
+      for (key, val) in zip(("min", "max", "mean", "median", "stddev",
+                             "p90", "p99"),
+                            (r.min, r.max, r.mean, r.median, r.stddev,
+                             r.p90, r.p99)) do
+        ch.writeln('      "', key, '": ', jsonReal(val), ",");
+      if r.bytesPerIter > 0 {
+        ch.writeln('      "bytesPerIteration": ', r.bytesPerIter, ",");
+        ch.writeln('      "bytesPerSecond": ', jsonReal(r.bytesPerSecond()),
+                   ",");
+      }
+      if r.hasComm {
+        ch.write('      "comm": {');
+        for param f in 0..<numFields(commDiagnostics) {
+          if f > 0 then ch.write(", ");
+          param name = getFieldName(commDiagnostics, f);
+          ch.write('"', name, '": ', jsonReal(r.commPerIteration(name)));
+        }
+        ch.writeln("},");
+      }
+      if r.hasMemory then
+        ch.writeln('      "memoryDelta": ', jsonReal(r.memoryDelta), ",");
+      ch.write('      "samples": [');
+      for (s, j) in zip(r.samples, 1..) {
+        if j > 1 then ch.write(", ");
+        ch.write(jsonReal(s));
+      }
+      ch.writeln("]");
+      ch.writeln(if i < results.size then "    }," else "    }");
+    }
+    ch.writeln("  ]");
+    ch.writeln("}");
+  }
+}
@@ -35,32 +35,32 @@
   with a best-effort round-robin algorithm such that each task begins searching
   at another segment (with the added benefit of reducing overall contention), in
   particular is useful for locally distributing insertion operations. Next it also
-  employs a work-stealing algorithm that horizontally steals a ratio of elements
-  across segments. A segment is considered 'horizontal' if it shares the same
-  segment index within [0, here.maxTaskPar); those other segments likely are also
-  benefited from local distribution from the round-robin algorithm discussed above.
-  We also steal a ratio of elements, say 25%, because it leaves all other segments
-  with 75% of their work; the more elements they have, the more we take, but the
-  less they have, the less we steal; this also has the added benefit of reducing
-  unnecessary work stealing between segments when the bag is nearly emptied. Furthermore,
-  stealing horizontally ensures that all segments remain filled and that we still
-  achieve parallelism across segments for removal operations. Lastly, we attempt
+  employs a continuous work-stealing algorithm: when a node runs out of elements,
+  a single task on that node becomes the thief, reads the size each other node
+  advertises (the sum of its segments' element counters, read without taking any
+  locks), and picks the node advertising the most elements as its victim. It then
+  steals half of the victim's largest segment in a single bulk transfer, and spreads
+  the stolen elements across its own segments. Stealing half leaves the victim with
+  as much work as the thief, which keeps nodes from stealing the same elements back
+  and forth, and stealing from the largest segment means the fewest steals are
+  needed to drain a skewed distribution. Other tasks on the thief's node that run
+  dry in the meantime wait on the thief rather than stealing themselves, which keeps
+  the number of concurrent steals to at most one per node. Lastly, we attempt
   to steal a maximum of `N / sizeof(eltType)`, where N is some size in megabytes
   (representing how much data can be sent in one network request), which keeps
   down excessive communication.
 
-  This data structure does not come without flaws; as work stealing is dynamic
-  and triggered on demand, work stealing can still be performed in excess, which
-  dramatically causes a performance drop. Furthermore, a severe imbalance across
-  nodes, such as an unfair distribution of work to a single or small subset of nodes,
-  may also causes an equally severe performance degradation. To circumvent this,
-  we allow the user to determine manually when to 'balance', which will evenly distribute all
-  elements across nodes. This data structure scales in terms of nodes, processors per node,
-  and even work load. The larger the work load, the more data that gets stolen when
-  stealing work, and better locality of elements among segments. As well, to
-  achieve true parallelism, usage of a privatized instance is a requirement, as
-  it avoids the overhead of remotely accessing class fields, bounding performance
-  on communication.
+  As work stealing is triggered on demand, the bag can serve as the work pool of
+  an irregular distributed computation, such as a tree search, without the need
+  for global rebalancing phases. A severe imbalance, such as all of the work being
+  placed on a single node up front, still takes a number of steals to even out,
+  so we also allow the user to determine manually when to 'balance', which will
+  evenly distribute all elements across nodes. This data structure scales in terms
+  of nodes, processors per node, and even work load. The larger the work load, the
+  more data that gets stolen when stealing work, and better locality of elements
+  among segments. As well, to achieve true parallelism, usage of a privatized
+  instance is a requirement, as it avoids the overhead of remotely accessing class
+  fields, bounding performance on communication.
 */
 
 
@@ -102,17 +102,26 @@
     bag.addBulk(1..N);
     bag.balance();
 
+  Adding and removing elements one at a time acquires a segment for every element.
+  When a task produces or consumes several elements at once, such as the children
+  of a node in a tree search, :proc:`DistributedBagImpl.addBulk` and
+  :proc:`DistributedBagImpl.removeBulk` amortize this by holding on to a segment
+  for a whole batch.
+
+  .. code-block:: chapel
+
+    coforall loc in Locales do on loc {
+      while true {
+        const work = bag.removeBulk(16);
+        if work.size == 0 then break;
+        for node in work do bag.addBulk(expand(node));
+      }
+    }
+
   Planned Improvements
   ____________________
 
-  1.  Dynamic work-stealing will require an overhaul to use a helper algorithm to keep down
-      the number of tasks spawned. Currently user tasks will wait on the current work-stealer
-      task, which will spawn is own helper tasks which act as shepherds, which then spawns more
-      in a fork-join fashion. This leads to an excessive amount of tasks being spawned at once.
-      To make matters worse, the waiting tasks don't even get any elements, nor does the work
-      stealing task, which opens up the possibility of live-lock where nodes steal work back
-      and forth before either can process it.
-  2.  Static work-stealing (A.K.A :proc:`DistributedBagImpl.balance`) requires a rework that performs a more distributed
+  1.  Static work-stealing (A.K.A :proc:`DistributedBagImpl.balance`) requires a rework that performs a more distributed
       and fast way of distributing memory, as currently 'excess' elements are shifted to a single
       node to be redistributed in the next pass. On the note, we need to collapse the pass for moving
       excess elements into a single pass, hopefully with a zero-copy overhead.
@@ -142,15 +151,6 @@ module DistributedBag {
   private param STATUS_LOOKUP : uint = 3;
   private param STATUS_BALANCE : uint = 4;
 
-  /*
-    Below are statuses specific to the work stealing algorithm. These allow the
-    shepherd tasks to know when its sub-helpers finish and the end status of their
-    work stealing attempt.
-  */
-  private param WS_INITIALIZED = -1;
-  private param WS_FINISHED_WITH_NO_WORK = 0;
-  private param WS_FINISHED_WITH_WORK = 1;
-
   /*
     The phases for operations. An operation is composed of multiple phases,
     where they make a full pass searching for ideal conditions, then less-than-ideal
@@ -171,16 +171,16 @@ module DistributedBag {
   */
   config const distributedBagInitialBlockSize = 1024;
   /*
-    To prevent stealing too many elements (horizontally) from another node's segment
-    (hence creating an artificial load imbalance), if the other node's segment has
-    less than a certain threshold (see :const:`distributedBagWorkStealingMemCap`) but above
-    another threshold (see :const:`distributedBagWorkStealingMinElems`), we steal a percentage of their
-    elements, leaving them with majority of their elements. This way, the amount the
-    other segment loses is proportional to how much it owns, ensuring a balance.
+    The fraction of the victim's largest segment that is stolen at once, bounded
+    above by :const:`distributedBagWorkStealingMemCap` and below by
+    :const:`distributedBagWorkStealingMinElems`. The default of one half leaves
+    the victim with as many elements as the thief receives, so that the amount
+    the victim loses is proportional to how much it owns and neither node
+    immediately needs to steal them back.
   */
-  config const distributedBagWorkStealingRatio = 0.25;
+  config const distributedBagWorkStealingRatio = 0.5;
   /*
-    The maximum amount of work to steal from a horizontal node's segment. This
+    The maximum amount of work to steal from another node's segment. This
     should be set to a value, in megabytes, that determines the maximum amount of
     data that should be sent in bulk at once. The maximum number of elements is
     determined by: (:const:`distributedBagWorkStealingMemCap` * 1024 * 1024) / sizeof(``eltType``).
@@ -189,8 +189,8 @@ module DistributedBag {
   */
   config const distributedBagWorkStealingMemCap : real = 1.0;
   /*
-    The minimum number of elements a horizontal segment must have to become eligible
-    to be stolen from. This may be useful if some segments produce less elements than
+    The minimum number of elements a node must advertise to become eligible to be
+    stolen from. This may be useful if some nodes produce less elements than
     others and should not be stolen from.
   */
   config const distributedBagWorkStealingMinElems = 1;
@@ -359,6 +359,27 @@ module DistributedBag {
       return bag!.remove();
     }
 
+    /*
+      Insert all elements of `elts` to this node's bag, returning the number of
+      elements added. Rather than acquiring a segment per element, elements are
+      added in batches of :const:`distributedBagInitialBlockSize` to one segment
+      at a time, and successive batches are spread across this node's segments.
+    */
+    override proc addBulk(elts) : int {
+      return bag!.addBulk(elts);
+    }
+
+    /*
+      Remove up to `nElts` elements from this node's bag, returning them as an
+      array. Each segment that is acquired is drained of as many elements as are
+      still needed in one bulk transfer. If this node's bag runs out before `nElts`
+      elements have been found, it will attempt to steal elements from bags of other
+      nodes, and the returned array is only smaller than `nElts` when that fails too.
+    */
+    override proc removeBulk(nElts : int) {
+      return bag!.removeBulk(nElts);
+    }
+
     /*
       Obtain the number of elements held in all bags across all nodes. This method
       is best-effort and can be non-deterministic for concurrent updates across nodes,
@@ -934,8 +955,8 @@ module DistributedBag {
 
     /*
       If a task makes 2 complete passes (1 best-case, 1 average-case) and has not
-      found enough items, then it may attempt to balance the load distribution.
-      Furthermore, if a task is waiting on a load balance, it may piggyback on the
+      found enough items, then it may attempt to steal work from another node.
+      Furthermore, if a task is waiting on a work stealer, it may piggyback on the
       result.
     */
     var loadBalanceInProgress : atomic bool;
@@ -1098,149 +1119,18 @@ module DistributedBag {
           /*
             Pass 3: Worst Case
 
-            After two full iterations, we're sure the queue is full at this point, so we
-            can attempt to steal work from other nodes. In this pass, we find *any* segment
-            and if it is empty, we attempt to become the work-stealer; if someone else is the
-            current work stealer we assist them instead and lift an element for ourselves.
-
-            Furthermore, in this phase we loop indefinitely until we are 100% certain it is
-            empty or we get an item, so introduce some backoff here.
+            After two full iterations, we're sure our bag is empty at this point, so we
+            attempt to steal work from other nodes. If someone else on this node is
+            currently the work stealer, we wait on them instead and, if they found
+            work, scan for it like everyone else.
           */
           when REMOVE_WORST_CASE {
-            while true {
-              ref segment = segments[idx];
-
-              select segment.currentStatus {
-                // Quick acquire
-                when STATUS_UNLOCKED {
-                  if segment.acquireWithStatus(STATUS_REMOVE) {
-                    // We're lucky; another element has been added to the current segment,
-                    // take it and leave like normal...
-                    if !segment.isEmpty {
-                      var (hasElem, elem) : (bool, eltType) = segment.takeElement();
-                      segment.releaseStatus();
-                      return (hasElem, elem);
-                    }
-
-                    if parentHandle.targetLocales.size == 1 {
-                      segment.releaseStatus();
-                      var default: eltType;
-                      return (false, default);
-                    }
-
-                    // Attempt to become the sole work stealer for this node. If we
-                    // do not, we spin until they finish. We need to release the lock
-                    // on our segment so our segment may be load balanced as well.
-                    if loadBalanceInProgress.testAndSet() {
-                      segment.releaseStatus();
-
-                      loadBalanceInProgress.waitFor(false);
-                      var notEmpty = loadBalanceResult.read();
-                      if !notEmpty {
-                        var default: eltType;
-                        return (false, default);
-                      }
-
-                      // Reset our phase and scan for more elements...
-                      phase = REMOVE_BEST_CASE;
-                      break;
-                    }
-
-                    // We are the sole work stealer, and so it is our responsibility
-                    // to balance the load for our node. We fork-join new worker
-                    // tasks that will check horizontally across each node (as in
-                    // across each segment with the same index), and vertically across
-                    // each segment (each segment in a node). Horizontally, we steal
-                    // at most a % of work from other nodes to give to ourselves.
-                    // As load balancer, we also are the only one who knows whether
-                    // or not all bags are empty.
-                    var isEmpty : atomic bool;
-                    isEmpty.write(true);
-                    segment.releaseStatus();
-                    coforall segmentIdx in 0..#here.maxTaskPar {
-                      var stolenWork : [{0..#numLocales}] (int, c_ptr(eltType));
-                      coforall loc in parentHandle.targetLocalesNotHere() {
-                        if loc != here then on loc {
-                          // As we jumped to the target node, 'localBag' returns
-                          // the target's bag that we are attempting to steal from.
-                          var targetBag = parentHandle.bag;
-
-                          // Only proceed if the target is not load balancing themselves...
-                          if !targetBag!.loadBalanceInProgress.read() {
-                            ref targetSegment = targetBag!.segments[segmentIdx];
-
-                            // As we only care that the segment contains data,
-                            // we test-and-test-and-set until we gain ownership.
-                            while targetSegment.nElems.read() >= distributedBagWorkStealingMinElems {
-                              var backoff = 0;
-                              if targetSegment.currentStatus == STATUS_UNLOCKED && targetSegment.acquireWithStatus(STATUS_REMOVE) {
-                                // Sanity check: ensure segment did not fall under minimum since last check
-                                if  targetSegment.nElems.read() < distributedBagWorkStealingMinElems {
-                                  targetSegment.releaseStatus();
-                                  break;
-                                }
-
-                                extern proc sizeof(type x): size_t;
-                                // We steal at most 1MB worth of data. If the user has less than that, we steal a %, at least 1.
-                                const mb = distributedBagWorkStealingMemCap * 1024 * 1024;
-                                var toSteal = max(distributedBagWorkStealingMinElems, min(mb / sizeof(eltType), targetSegment.nElems.read() * distributedBagWorkStealingRatio)) : int;
-
-                                // Allocate storage...
-                                on stolenWork do stolenWork[loc.id] = (toSteal, c_malloc(eltType, toSteal));
-                                var destPtr = stolenWork[here.id][1];
-                                targetSegment.transferElements(destPtr, toSteal, stolenWork.locale.id);
-                                targetSegment.releaseStatus();
-
-                                // We are done...
-                                break;
-                              }
-
-                              // Backoff...
-                              chpl_task_yield();
-                            }
-                          }
-                        }
-                      }
-
-                      // It is our job now to distribute all stolen data to the same
-                      // horizontal segment on our node. Acquire lock...
-                      ref recvSegment = segments[segmentIdx];
-                      while true {
-                        if recvSegment.currentStatus == STATUS_UNLOCKED && recvSegment.acquireWithStatus(STATUS_ADD) then break;
-                        chpl_task_yield();
-                      }
-
-                      // Add stolen elements to segment...
-                      for (nStolen, stolenPtr) in stolenWork {
-                        if nStolen == 0 then continue;
-                        recvSegment.addElementsPtr(stolenPtr, nStolen);
-                        c_free(stolenPtr);
-
-                        // Let parent know that the bag is not empty.
-                        isEmpty.write(false);
-                      }
-                      recvSegment.releaseStatus();
-                    }
-
-                    loadBalanceResult.write(!isEmpty.read());
-                    loadBalanceInProgress.write(false);
-
-                    // At this point, if no work has been found, we will return empty...
-                    if isEmpty.read() {
-                      var default: eltType;
-                      return (false, default);
-                    } else {
-                      // Otherwise, we try to get data like everyone else.
-                      phase = REMOVE_BEST_CASE;
-                      break;
-                    }
-                  }
-                }
-              }
-
-              // Backoff to maximum...
-              chpl_task_yield();
+            if !stealWork() {
+              var default: eltType;
+              return (false, default);
             }
+
+            phase = REMOVE_BEST_CASE;
           }
 
           otherwise do halt("DistributedBag Internal Error: Invalid phase #", phase);
@@ -1254,5 +1144,172 @@ module DistributedBag {
 
       halt("DistributedBag Internal Error: DEADCODE");
     }
+
+    proc addBulk(elts) : int {
+      var nAdded = 0;
+      var segmentIdx = -1;
+      var nBatched = 0;
+
+      for elt in elts {
+        // Hold on to a segment for a whole batch, and move on to the next one
+        // afterwards so that the elements are spread across this node.
+        if nBatched == 0 {
+          segmentIdx = nextStartIdxEnq;
+          segments[segmentIdx].acquire(STATUS_ADD);
+        }
+
+        segments[segmentIdx].addElements(elt);
+        nAdded += 1;
+        nBatched += 1;
+
+        if nBatched == distributedBagInitialBlockSize {
+          segments[segmentIdx].releaseStatus();
+          nBatched = 0;
+        }
+      }
+
+      if nBatched != 0 then segments[segmentIdx].releaseStatus();
+
+      return nAdded;
+    }
+
+    proc removeBulk(nElts : int) {
+      var dom = {0..#nElts};
+      var arr : [dom] eltType;
+      var nRemoved = 0;
+
+      while nRemoved < nElts {
+        var startIdx = nextStartIdxDeq;
+        for offset in 0 .. #here.maxTaskPar {
+          ref segment = segments[(startIdx + offset) % here.maxTaskPar];
+
+          if segment.acquireIfNonEmpty(STATUS_REMOVE) {
+            var n = min(nElts - nRemoved, segment.nElems.read() : int);
+            segment.transferElements(c_ptrTo(arr[nRemoved]), n);
+            segment.releaseStatus();
+
+            nRemoved += n;
+            if nRemoved == nElts then break;
+          }
+        }
+
+        if nRemoved < nElts && !stealWork() then break;
+      }
+
+      dom = {0..#nRemoved};
+      return arr;
+    }
+
+    /*
+      The number of elements this node advertises to work stealers, along with
+      the index of its largest segment. The counters are read without acquiring
+      any segment, so the result is only a hint.
+    */
+    proc advertisedSize() : (int, int) {
+      var total = 0;
+      var largestIdx = 0;
+      var largestSize = 0;
+      for segmentIdx in 0 .. #here.maxTaskPar {
+        var nElems = segments[segmentIdx].nElems.read() : int;
+        total += nElems;
+        if nElems > largestSize {
+          largestIdx = segmentIdx;
+          largestSize = nElems;
+        }
+      }
+
+      return (total, largestIdx);
+    }
+
+    /*
+      Steal elements from another node into this node's bag, returning whether
+      any were found. Only one task per node steals at a time; any other task that
+      calls this while a steal is in progress waits on it and shares its result.
+    */
+    proc stealWork() : bool {
+      if parentHandle.targetLocales.size == 1 then return false;
+
+      if loadBalanceInProgress.testAndSet() {
+        loadBalanceInProgress.waitFor(false);
+        return loadBalanceResult.read();
+      }
+
+      const pid = parentHandle.pid;
+      var sizes : [parentHandle.targetLocDom] (int, int);
+      coforall (loc, size) in zip(parentHandle.targetLocales, sizes) {
+        if loc != here then on loc {
+          var targetBag = chpl_getPrivatizedCopy(unmanaged DistributedBagImpl(eltType), pid).bag;
+          size = targetBag!.advertisedSize();
+        }
+      }
+
+      extern proc sizeof(type x): size_t;
+      const mb = distributedBagWorkStealingMemCap * 1024 * 1024;
+      const maxSteal = max(distributedBagWorkStealingMinElems, (mb / sizeof(eltType)) : int);
+
+      // Try victims in order of their advertised size, as the victim may have
+      // drained its segment by the time we get to it.
+      var nStolen = 0;
+      var buffer : c_ptr(eltType);
+      while nStolen == 0 {
+        var (victimSize, victimSegmentIdx) = (0, 0);
+        var victimIdx = -1;
+        for (size, locIdx) in zip(sizes, parentHandle.targetLocDom) {
+          if size[0] > victimSize {
+            (victimSize, victimSegmentIdx) = size;
+            victimIdx = locIdx;
+          }
+        }
+
+        if victimIdx == -1 || victimSize < distributedBagWorkStealingMinElems then break;
+        sizes[victimIdx] = (0, 0);
+
+        // The buffer lives on this node, so the victim can transfer half of its
+        // largest segment with a single bulk put. It is sized for the largest
+        // steal we would make from the segment, as it may grow meanwhile.
+        const bufferSz = min(maxSteal, victimSize);
+        buffer = c_malloc(eltType, bufferSz);
+        on parentHandle.targetLocales[victimIdx] {
+          var targetBag = chpl_getPrivatizedCopy(unmanaged DistributedBagImpl(eltType), pid).bag;
+          ref targetSegment = targetBag!.segments[victimSegmentIdx];
+
+          if targetSegment.acquireIfNonEmpty(STATUS_REMOVE) {
+            var nElems = targetSegment.nElems.read() : int;
+            if nElems >= distributedBagWorkStealingMinElems {
+              var toSteal = max(distributedBagWorkStealingMinElems, (nElems * distributedBagWorkStealingRatio) : int);
+              toSteal = min(toSteal, nElems, bufferSz);
+              targetSegment.transferElements(buffer, toSteal, buffer.locale.id);
+              nStolen = toSteal;
+            }
+            targetSegment.releaseStatus();
+          }
+        }
+
+        if nStolen == 0 then c_free(buffer);
+      }
+
+      // Spread what we stole across our segments, so every task on this node
+      // that is waiting on us can find some of it.
+      if nStolen > 0 {
+        const chunkSz = divceil(nStolen, here.maxTaskPar);
+        var startIdx = nextStartIdxEnq;
+        var offset = 0;
+        while offset < nStolen {
+          ref segment = segments[startIdx];
+          var n = min(chunkSz, nStolen - offset);
+          segment.acquire(STATUS_ADD);
+          segment.addElementsPtr(buffer + offset, n);
+          segment.releaseStatus();
+
+          offset += n;
+          startIdx = (startIdx + 1) % here.maxTaskPar;
+        }
+        c_free(buffer);
+      }
+
+      loadBalanceResult.write(nStolen > 0);
+      loadBalanceInProgress.write(false);
+      return nStolen > 0;
+    }
   }
 }
@@ -814,9 +814,7 @@ proc _matmatMultHelper(ref AMat: [?Adom] ?eltType,
                        ref BMat : [?Bdom] eltType,
                        ref CMat : [] eltType)
 {
-  // TODO - Add logic to calculate blockSize
-  // based on eltType and L1 cache size
-  const blockSize = 32;
+  const blockSize = _matmatMultBlockSize(eltType);
   const bVecRange = 0..#blockSize;
   const blockDom = {bVecRange, bVecRange};
   const (Adim0, Adim1) = Adom.dims();
@@ -862,6 +860,23 @@ proc _matmatMultHelper(ref AMat: [?Adom] ?eltType,
   }
 }
 
+pragma "no doc"
+/* Pick a tile size so that the three tiles used by _matmatMultHelper
+   fit in the L1 data cache together */
+proc _matmatMultBlockSize(type eltType): int {
+  param defaultBlockSize = 32;
+  if !isNumericType(eltType) then
+    return defaultBlockSize;
+
+  const l1Size = here.cacheSize(1);
+  if l1Size <= 0 then
+    return defaultBlockSize;
+
+  // round down to a multiple of 8, keeping it within sensible bounds
+  const fits = sqrt(l1Size / (3 * numBytes(eltType)): real): int;
+  return max(8, min(256, fits / 8 * 8));
+}
+
 pragma "no doc"
 private inline proc hasNonStridedIndices(Adom : domain(2)) {
   return (if Adom.stridable
@@ -428,8 +428,9 @@ Sort the elements in an array. It is up to the implementation to choose
 the sorting algorithm.
 
 .. note::
-  This function currently either uses a parallel radix sort or a serial
-  quickSort. The algorithms used will change over time.
+  This function currently either uses a parallel radix sort or a parallel
+  introsort (a quickSort that switches to heap sort if it is not making
+  progress). The algorithms used will change over time.
 
   It currently uses parallel radix sort if the following conditions are met:
 
@@ -451,20 +452,49 @@ the sorting algorithm.
     * ``string``
     * ``c_string``
 
+  If ``stable`` is ``true``, a parallel merge sort is used instead.
+
+  Arrays over non-strided ``int`` domains whose distribution gives each
+  locale one contiguous block of indices, such as :mod:`BlockDist`, are
+  sorted with a distributed algorithm: each locale sorts its own block
+  with one of the algorithms above, the blocks are then split at the
+  positions where the sorted result crosses locale boundaries, and each
+  locale fetches its pieces with bulk transfers and merges them.  This
+  is stable if ``stable`` is ``true``.
+
 :arg Data: The array to be sorted
 :type Data: [] `eltType`
 :arg comparator: :ref:`Comparator <comparators>` record that defines how the
   data is sorted.
+:arg stable: Whether elements that compare equal must keep their
+  relative order.
 
  */
-proc sort(Data: [?Dom] ?eltType, comparator:?rec=defaultComparator) {
-  // TODO: This should have a flag `stable` to request a stable sort
+proc sort(Data: [?Dom] ?eltType, comparator:?rec=defaultComparator,
+          param stable:bool = false) {
   chpl_check_comparator(comparator, eltType);
 
   if Dom.low >= Dom.high then
     return;
 
-  if radixSortOk(Data, comparator) {
+  if !Data._instance.isDefaultRectangular() && !chpl__isArrayView(Data) &&
+     Data.hasSingleLocalSubdomain() && !Dom.stridable && Dom.idxType == int &&
+     !isOwnedClass(eltType) {
+    if MultiwayMergeSort.distributedSort(Data, comparator, stable) then
+      return;
+  }
+
+  localSort(Data, comparator, stable);
+}
+
+private
+proc localSort(Data: [?Dom] ?eltType, comparator, param stable:bool) {
+  if stable {
+    if Dom.stridable then
+      MergeSort.mergeSort(Data, comparator=comparator);
+    else
+      MultiwayMergeSort.parallelStableSort(Data, comparator);
+  } else if radixSortOk(Data, comparator) {
     MSBRadixSort.msbRadixSort(Data, comparator=comparator);
   } else {
     QuickSort.quickSort(Data, comparator=comparator);
@@ -474,7 +504,8 @@ proc sort(Data: [?Dom] ?eltType, comparator:?rec=defaultComparator) {
 
 pragma "no doc"
 /* Error message for multi-dimension arrays */
-proc sort(Data: [?Dom] ?eltType, comparator:?rec=defaultComparator)
+proc sort(Data: [?Dom] ?eltType, comparator:?rec=defaultComparator,
+          param stable:bool = false)
   where Dom.rank != 1 || !isRectangularArr(Data) {
     compilerError("sort() is currently only supported for 1D rectangular arrays");
 }
@@ -512,6 +543,140 @@ proc isSorted(Data: [?Dom] ?eltType, comparator:?rec=defaultComparator)
 }
 
 
+/*
+   Partially sort `Data` so that its first `k` elements are the `k`
+   elements that come first in sorted order, in that order.  The order
+   of the remaining elements is unspecified.  This is faster than
+   sorting the whole array when `k` is much smaller than its size.
+
+   :arg Data: The array to be partially sorted
+   :type Data: [] `eltType`
+   :arg k: The number of elements to sort.  If it is at least the size
+      of `Data`, the whole array is sorted.
+   :arg comparator: :ref:`Comparator <comparators>` record that defines how the
+      data is sorted.
+ */
+proc partialSort(Data: [?Dom] ?eltType, k: int,
+                 comparator:?rec=defaultComparator) {
+  chpl_check_comparator(comparator, eltType);
+
+  if k >= Dom.size {
+    sort(Data, comparator=comparator);
+  } else if Dom.stridable {
+    ref reindexed = Data.reindex(0..#Dom.size);
+    QuickSort.partialSortImpl(reindexed, k, comparator);
+  } else {
+    QuickSort.partialSortImpl(Data, k, comparator);
+  }
+}
+
+pragma "no doc"
+/* Error message for multi-dimension arrays */
+proc partialSort(Data: [?Dom] ?eltType, k: int,
+                 comparator:?rec=defaultComparator)
+  where Dom.rank != 1 || !isRectangularArr(Data) {
+    compilerError("partialSort() is currently only supported for 1D rectangular arrays");
+}
+
+
+/*
+   Reorder `Data` so that its `k`-th element is the one that would be
+   there if it were sorted, no element before it comes after it in
+   sorted order, and no element after it comes before it.  For example,
+   ``selectKth(A, (A.size+1)/2)`` puts a median of ``A`` in the middle.
+
+   :arg Data: The array to be reordered
+   :type Data: [] `eltType`
+   :arg k: Which element to select, counting from 1.  It must be between
+      1 and the size of `Data`.
+   :arg comparator: :ref:`Comparator <comparators>` record that defines how the
+      data is sorted.
+ */
+proc selectKth(Data: [?Dom] ?eltType, k: int,
+               comparator:?rec=defaultComparator) {
+  chpl_check_comparator(comparator, eltType);
+
+  if k < 1 || k > Dom.size then
+    halt("selectKth() called with k=", k, " for an array of size ", Dom.size);
+
+  if Dom.stridable {
+    ref reindexed = Data.reindex(0..#Dom.size);
+    QuickSort.quickSelectImpl(reindexed, k-1, comparator);
+  } else {
+    QuickSort.quickSelectImpl(Data, Dom.low + k-1, comparator);
+  }
+}
+
+pragma "no doc"
+/* Error message for multi-dimension arrays */
+proc selectKth(Data: [?Dom] ?eltType, k: int,
+               comparator:?rec=defaultComparator)
+  where Dom.rank != 1 || !isRectangularArr(Data) {
+    compilerError("selectKth() is currently only supported for 1D rectangular arrays");
+}
+
+
+/*
+   Return a new array holding the `k` elements of `Data` that come first
+   in sorted order, in that order, without modifying `Data`.  Use
+   :record:`ReverseComparator` to get the `k` largest elements.
+
+   This makes one parallel pass over `Data`, in which each task keeps
+   the best `k` elements it has seen so far.  If `Data` is distributed,
+   each locale scans its own part.
+
+   :arg Data: The array to select from
+   :type Data: [] `eltType`
+   :arg k: The number of elements to return.  If it is larger than the
+      size of `Data`, all of its elements are returned.
+   :arg comparator: :ref:`Comparator <comparators>` record that defines how the
+      data is sorted.
+   :returns: An array over ``{0..#min(k, Data.size)}``
+ */
+proc topK(Data: [?Dom] ?eltType, k: int, comparator:?rec=defaultComparator) {
+  chpl_check_comparator(comparator, eltType);
+
+  const n = max(0, min(k, Dom.size));
+  var Result: [0..#n] eltType;
+  if n == 0 then
+    return Result;
+
+  if n > Dom.size / 8 {
+    // Keeping that many elements per task wouldn't save anything.
+    var Copy: [0..#Dom.size] eltType = Data;
+    QuickSort.partialSortImpl(Copy, n, comparator);
+    Result = Copy[0..#n];
+    return Result;
+  }
+
+  if Data.hasSingleLocalSubdomain() {
+    const ref tgtLocs = Data.targetLocales();
+    var Found: [0..#tgtLocs.size*n] eltType;
+    var nFound: [0..#tgtLocs.size] int;
+    coforall (loc, i) in zip(tgtLocs, 0..) with (ref Found, ref nFound) do
+    on loc {
+      var LocFound: [0..#n] eltType;
+      const cnt = TopKHelp.topKOfRange(Data, Data.localSubdomain().dim(0),
+                                       n, comparator, LocFound);
+      if cnt > 0 then
+        Found[i*n..#cnt] = LocFound[0..#cnt];
+      nFound[i] = cnt;
+    }
+    TopKHelp.keepFirst(Found, nFound, n, comparator, Result);
+  } else {
+    TopKHelp.topKOfRange(Data, Dom.dim(0), n, comparator, Result);
+  }
+  return Result;
+}
+
+pragma "no doc"
+/* Error message for multi-dimension arrays */
+proc topK(Data: [?Dom] ?eltType, k: int, comparator:?rec=defaultComparator)
+  where Dom.rank != 1 || !isRectangularArr(Data) {
+    compilerError("topK() is currently only supported for 1D rectangular arrays");
+}
+
+
 //
 // This is a first draft "sorterator" which is designed to take some
 // other iterator/iterable and yield its elements, in sorted order.
@@ -1230,28 +1395,110 @@ module QuickSort {
                      minlen=16,
                      comparator:?rec=defaultComparator,
                      start:int = Dom.low, end:int = Dom.high) {
-    import Sort.InsertionSort;
+    if end <= start then
+      return;
 
-    // grab obvious indices
-    const lo = start,
-          hi = end,
-          mid = lo + (hi-lo+1)/2;
-    var piv = mid;
+    introSortImpl(Data, minlen, comparator, start, end,
+                  depthLimit=2*log2(end-start+1));
+  }
+
+  //
+  // Quicksort Data[lo..hi], but heap sort any range that is still being
+  // partitioned after depthLimit levels, so that bad pivots can't make
+  // it quadratic.
+  //
+  private proc introSortImpl(Data: [?Dom] ?eltType, minlen, comparator,
+                             lo: int, hi: int, depthLimit: int) {
+    import Sort.InsertionSort;
 
-    if hi - lo < 0 { // minlen {
+    if hi - lo < minlen {
       // base case -- use insertion sort
       InsertionSort.insertionSortMoveElts(Data, comparator=comparator, lo, hi);
       return;
-    } else if hi <= lo {
-      // nothing to sort
+    }
+
+    if depthLimit == 0 {
+      heapSortRange(Data, lo, hi, comparator);
       return;
     }
 
-    // find pivot using median-of-3 method for small arrays
-    // and a "ninther" for bigger arrays. Places the pivot in
-    // Data[lo].
+    const piv = choosePivot(Data, lo, hi, comparator);
+    const nTasks = numPartitionTasks(hi - lo + 1);
+    const (eqStart, eqEnd) =
+      if nTasks > 1 then parallelPartition(Data, lo, piv, hi, comparator,
+                                           nTasks)
+                    else partition(Data, lo, piv, hi, comparator);
+
+    if hi-lo < 300 {
+      // stay sequential
+      introSortImpl(Data, minlen, comparator, lo, eqStart-1, depthLimit-1);
+      introSortImpl(Data, minlen, comparator, eqEnd+1, hi, depthLimit-1);
+    } else {
+      // do the subproblems in parallel
+      forall i in 1..2 {
+        if i == 1 then
+          introSortImpl(Data, minlen, comparator, lo, eqStart-1, depthLimit-1);
+        else
+          introSortImpl(Data, minlen, comparator, eqEnd+1, hi, depthLimit-1);
+      }
+    }
+  }
+
+  //
+  // Rearrange Data[start..end] so that Data[k] holds the element that
+  // would be there if the range were sorted, with nothing greater than
+  // it before it and nothing less than it after it.
+  //
+  proc quickSelectImpl(Data: [?Dom] ?eltType, k: int, comparator,
+                       start:int = Dom.low, end:int = Dom.high) {
+    import Sort.InsertionSort;
+
+    var lo = start, hi = end;
+    var depthLimit = 2*log2(max(1, end-start+1));
+
+    while hi - lo >= 16 {
+      if depthLimit == 0 {
+        heapSortRange(Data, lo, hi, comparator);
+        return;
+      }
+      depthLimit -= 1;
+
+      const piv = choosePivot(Data, lo, hi, comparator);
+      const nTasks = numPartitionTasks(hi - lo + 1);
+      const (eqStart, eqEnd) =
+        if nTasks > 1 then parallelPartition(Data, lo, piv, hi, comparator,
+                                             nTasks)
+                      else partition(Data, lo, piv, hi, comparator);
+      if k < eqStart then
+        hi = eqStart - 1;
+      else if k > eqEnd then
+        lo = eqEnd + 1;
+      else
+        return;
+    }
+
+    InsertionSort.insertionSortMoveElts(Data, comparator=comparator, lo, hi);
+  }
+
+  // Make Data[start..start+k-1] the first k elements in sorted order.
+  proc partialSortImpl(Data: [?Dom] ?eltType, k: int, comparator,
+                       start:int = Dom.low, end:int = Dom.high) {
+    if k <= 0 then
+      return;
+    if k < end - start + 1 then
+      quickSelectImpl(Data, start + k - 1, comparator, start, end);
+    quickSortImpl(Data, comparator=comparator, start=start,
+                  end=start + k - 1);
+  }
+
+  // find pivot using median-of-3 method for small arrays
+  // and a "ninther" for bigger arrays.
+  private proc choosePivot(Data: [?Dom] ?eltType, lo: int, hi: int,
+                           comparator): int {
+    const mid = lo + (hi-lo+1)/2;
+
     if hi - lo < 100 {
-      piv = order3(Data, lo, mid, hi, comparator);
+      return order3(Data, lo, mid, hi, comparator);
     } else {
       // assumes array size > 9 at the very least
 
@@ -1260,24 +1507,276 @@ module QuickSort {
       const medMid = order3(Data, mid-1, mid,  mid+1, comparator);
       const medHi  = order3(Data, hi-2,  hi-1, hi,    comparator);
       // median of the medians
-      piv = order3(Data, medLo, medMid, medHi, comparator);
+      return order3(Data, medLo, medMid, medHi, comparator);
     }
+  }
 
-    var (eqStart, eqEnd) = partition(Data, lo, piv, hi, comparator);
+  // Ranges smaller than this are always partitioned by one task.
+  private param parallelPartitionMinSize = 1 << 17;
+  // Don't give a partitioning task less than this many elements.
+  private param minPartitionSizePerTask = 1 << 15;
 
-    if hi-lo < 300 {
-      // stay sequential
-      quickSortImpl(Data, minlen, comparator, lo, eqStart-1);
-      quickSortImpl(Data, minlen, comparator, eqEnd+1, hi);
-    } else {
-      // do the subproblems in parallel
-      forall i in 1..2 {
-        if i == 1 then
-          quickSortImpl(Data, minlen, comparator, lo, eqStart-1);
-        else
-          quickSortImpl(Data, minlen, comparator, eqEnd+1, hi);
+  private proc numPartitionTasks(n: int): int {
+    if n < parallelPartitionMinSize then
+      return 1;
+    const maxTasks = if dataParTasksPerLocale > 0 then dataParTasksPerLocale
+                                                  else here.maxTaskPar;
+    const idleTasks = if dataParIgnoreRunningTasks then maxTasks
+                      else maxTasks - here.runningTasks() + 1;
+    return max(1, min(idleTasks, n / minPartitionSizePerTask));
+  }
+
+  // Heap sort Data[lo..hi].
+  private proc heapSortRange(Data: [?Dom] ?eltType, lo: int, hi: int,
+                             comparator) {
+    const n = hi - lo + 1;
+
+    // Sift Data[lo+root] down within the heap Data[lo..#size].
+    proc siftDown(in root: int, size: int) {
+      while true {
+        const child = 2*root + 1;
+        if child >= size then
+          return;
+        var big = child;
+        if child + 1 < size &&
+           chpl_compare(Data[lo+child], Data[lo+child+1], comparator) < 0 then
+          big = child + 1;
+        if chpl_compare(Data[lo+root], Data[lo+big], comparator) >= 0 then
+          return;
+        ShallowCopy.shallowSwap(Data[lo+root], Data[lo+big]);
+        root = big;
+      }
+    }
+
+    for i in 0..#n/2 by -1 do
+      siftDown(i, n);
+    for size in 1..<n by -1 {
+      ShallowCopy.shallowSwap(Data[lo], Data[lo+size]);
+      siftDown(0, size);
+    }
+  }
+
+  //
+  // Parallel version of partition(), with the same result.
+  //
+  // The pivot is kept in Data[lo] while two parallel two-way partitions
+  // split Data[lo+1..hi] into elements less than it, then the rest into
+  // elements equal to it and elements greater than it.  Then it is
+  // swapped with the last of the lesser elements.
+  //
+  proc parallelPartition(Data: [?Dom] ?eltType,
+                         lo: int, pivIdx: int, hi: int,
+                         comparator, nTasks: int) {
+    if lo != pivIdx then
+      ShallowCopy.shallowSwap(Data[lo], Data[pivIdx]);
+
+    const geStart = parallelPartition2(Data, lo+1, hi, lo, comparator,
+                                       equalGoesLeft=false, nTasks);
+    const eqEnd = parallelPartition2(Data, geStart, hi, lo, comparator,
+                                     equalGoesLeft=true, nTasks) - 1;
+    const eqStart = geStart - 1;
+    if eqStart != lo then
+      ShallowCopy.shallowSwap(Data[lo], Data[eqStart]);
+
+    return (eqStart, eqEnd);
+  }
+
+  //
+  // Partition Data[lo..hi] in place so that the elements less than
+  // Data[pivIdx] (or no greater than it, if equalGoesLeft) come first,
+  // using nTasks tasks.  Returns the index of the first element of the
+  // second part.  Data[pivIdx] must be outside of lo..hi.
+  //
+  // Each task partitions its own chunk.  Then the elements in the first
+  // part's chunk pieces that belong in the second part and vice versa
+  // are counted off in order and swapped pairwise, again split evenly
+  // among the tasks.
+  //
+  private proc parallelPartition2(Data: [?Dom] ?eltType,
+                                  lo: int, hi: int, pivIdx: int,
+                                  comparator, param equalGoesLeft: bool,
+                                  in nTasks: int): int {
+    const n = hi - lo + 1;
+    nTasks = min(nTasks, n / minPartitionSizePerTask);
+    if nTasks <= 1 then
+      return partitionChunk(Data, lo, hi, pivIdx, comparator, equalGoesLeft);
+
+    var nLeft: [0..#nTasks] int;
+    coforall t in 0..#nTasks with (ref nLeft) {
+      const s = lo + t*n/nTasks, e = lo + (t+1)*n/nTasks - 1;
+      nLeft[t] = partitionChunk(Data, s, e, pivIdx, comparator,
+                                equalGoesLeft) - s;
+    }
+
+    const split = lo + + reduce nLeft;
+
+    // For each chunk, the piece of its first part that lies at or after
+    // split, and the piece of its second part that lies before it.
+    var leftLo, leftCnt, rightLo, rightCnt: [0..#nTasks] int;
+    for t in 0..#nTasks {
+      const s = lo + t*n/nTasks, e = lo + (t+1)*n/nTasks - 1;
+      const mid = s + nLeft[t];
+      leftLo[t] = max(s, split);
+      leftCnt[t] = max(0, mid - leftLo[t]);
+      rightLo[t] = mid;
+      rightCnt[t] = max(0, min(e + 1, split) - mid);
+    }
+
+    const nMisplaced = + reduce leftCnt;
+    if nMisplaced == 0 then
+      return split;
+
+    const leftBefore = (+ scan leftCnt) - leftCnt;
+    const rightBefore = (+ scan rightCnt) - rightCnt;
+
+    coforall t in 0..#nTasks {
+      var first = t*nMisplaced/nTasks;
+      const last = (t+1)*nMisplaced/nTasks;
+      if first < last {
+        var l = 0, r = 0;
+        while leftBefore[l] + leftCnt[l] <= first do l += 1;
+        while rightBefore[r] + rightCnt[r] <= first do r += 1;
+        var li = leftLo[l] + first - leftBefore[l];
+        var ri = rightLo[r] + first - rightBefore[r];
+        while true {
+          ShallowCopy.shallowSwap(Data[li], Data[ri]);
+          first += 1;
+          if first == last then
+            break;
+          li += 1;
+          if li == leftLo[l] + leftCnt[l] {
+            do { l += 1; } while leftCnt[l] == 0;
+            li = leftLo[l];
+          }
+          ri += 1;
+          if ri == rightLo[r] + rightCnt[r] {
+            do { r += 1; } while rightCnt[r] == 0;
+            ri = rightLo[r];
+          }
+        }
+      }
+    }
+
+    return split;
+  }
+
+  // Sequentially partition Data[lo..hi] for parallelPartition2().
+  private proc partitionChunk(Data: [?Dom] ?eltType,
+                              lo: int, hi: int, pivIdx: int,
+                              comparator, param equalGoesLeft: bool): int {
+    const ref piv = Data[pivIdx];
+
+    inline proc goesLeft(const ref x) {
+      const cmp = chpl_compare(x, piv, comparator);
+      return if equalGoesLeft then cmp <= 0 else cmp < 0;
+    }
+
+    var i = lo, j = hi;
+    while true {
+      while i <= j && goesLeft(Data[i]) do i += 1;
+      while i <= j && !goesLeft(Data[j]) do j -= 1;
+      if i >= j then
+        break;
+      ShallowCopy.shallowSwap(Data[i], Data[j]);
+      i += 1;
+      j -= 1;
+    }
+    return i;
+  }
+}
+
+pragma "no doc"
+module TopKHelp {
+  import Sort.chpl_compare;
+  import Sort.QuickSort;
+  private use RangeChunk;
+
+  //
+  // Add x to the bounded heap Heap[0..#size] of the best k elements seen
+  // so far.  The heap is ordered so that the element that comes last in
+  // sorted order is at the top, ready to be replaced.  Returns the new
+  // size.
+  //
+  proc heapOffer(ref Heap: [] ?eltType, size: int, k: int, const ref x,
+                 comparator): int {
+    var i: int;
+    if size < k {
+      // sift up from the new slot
+      i = size;
+      while i > 0 {
+        const parent = (i - 1) / 2;
+        if chpl_compare(Heap[parent], x, comparator) >= 0 then
+          break;
+        Heap[i] = Heap[parent];
+        i = parent;
       }
+      Heap[i] = x;
+      return size + 1;
+    }
+
+    if chpl_compare(x, Heap[0], comparator) >= 0 then
+      return size;
+
+    // replace the top and sift down
+    i = 0;
+    while true {
+      const child = 2*i + 1;
+      if child >= size then
+        break;
+      var big = child;
+      if child + 1 < size &&
+         chpl_compare(Heap[child], Heap[child+1], comparator) < 0 then
+        big = child + 1;
+      if chpl_compare(x, Heap[big], comparator) >= 0 then
+        break;
+      Heap[i] = Heap[big];
+      i = big;
     }
+    Heap[i] = x;
+    return size;
+  }
+
+  //
+  // Store the first k elements in sorted order of Data[idxs], which
+  // should be local, into Result[0..#cnt] in sorted order, where cnt is
+  // returned.  Each task keeps a bounded heap over part of the range.
+  //
+  proc topKOfRange(const ref Data: [] ?eltType, idxs: range(?), k: int,
+                   comparator, ref Result: [] eltType): int {
+    const maxTasks = if dataParTasksPerLocale > 0 then dataParTasksPerLocale
+                                                  else here.maxTaskPar;
+    const nTasks = max(1, min(maxTasks, idxs.size / max(k, 1024)));
+
+    var Found: [0..#nTasks*k] eltType;
+    var nFound: [0..#nTasks] int;
+    coforall t in 0..#nTasks with (ref Found, ref nFound) {
+      var Heap: [0..#k] eltType;
+      var size = 0;
+      for i in chunk(idxs, nTasks, t) do
+        size = heapOffer(Heap, size, k, Data[i], comparator);
+      Found[t*k..#size] = Heap[0..#size];
+      nFound[t] = size;
+    }
+    return keepFirst(Found, nFound, k, comparator, Result);
+  }
+
+  //
+  // Found holds groups of up to k candidates, group g having nFound[g]
+  // of them starting at g*k.  Store the first k of them in sorted order
+  // into Result, and return how many that is.
+  //
+  proc keepFirst(ref Found: [] ?eltType, const ref nFound: [] int, k: int,
+                 comparator, ref Result: [] eltType): int {
+    var total = 0;
+    for g in nFound.domain {
+      for i in 0..#nFound[g] do
+        Found[total+i] = Found[g*k+i];
+      total += nFound[g];
+    }
+    const cnt = min(k, total);
+    QuickSort.partialSortImpl(Found, cnt, comparator, 0, total-1);
+    Result[0..#cnt] = Found[0..#cnt];
+    return cnt;
   }
 }
 
@@ -1376,8 +1875,21 @@ module SampleSortHelp {
     return log2(n);
   }
 
+  // The most buckets we want when the hardware is known: each bucket
+  // is an output stream, and their current cache lines should all fit
+  // in the L1 data cache at once.
+  proc cacheLogBuckets(): int {
+    const lineSize = here.cacheLineSize(1);
+    if lineSize <= 0 then
+      return maxLogBuckets;
+    const lines = here.cacheSize(1) / lineSize;
+    if lines <= 0 then
+      return maxLogBuckets;
+    return max(1, min(maxLogBuckets, log2int(lines)));
+  }
+
   proc computeLogBucketSize(n: int) {
-    const LogBuckets = 8;
+    const LogBuckets = cacheLogBuckets();
     const BaseCaseSize = 16;
     const BaseCaseMultiplier = 16;
     const SingleLevelThreshold = maxInline * LogBuckets;
@@ -1388,11 +1900,12 @@ module SampleSortHelp {
     } else if n <= TwoLevelThreshold {
       ret = (log2int(n / maxInline / 2)+1)/2;
     } else {
-      ret = maxLogBuckets;
+      ret = LogBuckets;
     }
 
     ret = max(1, ret); // make sure it's at least 1
-    ret = min(maxLogBuckets, ret); // make sure it's at most maxLogBuckets.
+    ret = min(LogBuckets, ret); // make sure it's at most LogBuckets,
+                                // which is at most maxLogBuckets.
 
     return ret;
   }
@@ -3219,6 +3732,396 @@ module TwoArraySampleSort {
   }
 }
 
+pragma "no doc"
+module MultiwayMergeSort {
+  import Sort.{chpl_compare, MergeSort, localSort};
+  private use BlockDist;
+
+  // Don't give a merging task less than this many elements.
+  private param minMergeSizePerTask = 16384;
+
+  //
+  // Orders elements first by value, then by which run they are in, and
+  // then by their position in that run.  Since the runs are numbered in
+  // index order this is a strict total order that agrees with the
+  // original order of equal elements, which is what makes the merges
+  // below stable and lets us split them at exact positions.
+  //
+  private inline proc precedes(a, aRun:int, aPos:int,
+                               b, bRun:int, bPos:int, comparator) {
+    const c = chpl_compare(a, b, comparator);
+    return c < 0 || (c == 0 && (aRun < bRun ||
+                                (aRun == bRun && aPos < bPos)));
+  }
+
+  // Count the elements of A[base+l..<base+h] that come before the pivot.
+  private proc countBefore(A:[], base:int, in l:int, in h:int, run:int,
+                           const ref pivVal, pivRun:int, pivPos:int,
+                           comparator) {
+    while l < h {
+      const m = l + (h - l) / 2;
+      if precedes(A[m], run, m - base, pivVal, pivRun, pivPos, comparator)
+        then l = m + 1;
+        else h = m;
+    }
+    return l - base;
+  }
+
+  //
+  // Given sorted runs A[runLo[r]..runHi[r]], find how many elements of
+  // each run are among the first 'rank' elements of their merge.  A may
+  // be distributed, in which case each run is expected to be local to
+  // one locale.
+  //
+  // This is a multi-sequence selection.  Each round picks the weighted
+  // median of the midpoints of the still-undecided part of every run
+  // as a pivot, counts the elements below it in each run with a binary
+  // search on that run's locale, and then discards everything on the
+  // wrong side of the pivot.  That removes at least a quarter of what
+  // is left every round, and only moves a few values per run.
+  //
+  proc multiwaySelect(A:[], const ref runLo:[] int, const ref runHi:[] int,
+                      rank:int, comparator) {
+    // For a distributed array, fetch each candidate once.  For a local
+    // one just look at it where it is, so we don't copy elements.
+    param fetchCands = !A._instance.isDefaultRectangular();
+
+    const nRuns = runLo.size;
+    var lo, hi: [0..#nRuns] int;
+    for r in 0..#nRuns do
+      hi[r] = runHi[r] - runLo[r] + 1;
+
+    var candVal: [0..#(if fetchCands then nRuns else 0)] A.eltType;
+    var candRun, candPos, order: [0..#nRuns] int;
+    var counts: [0..#nRuns] int;
+
+    inline proc candPrecedes(i:int, j:int) {
+      if fetchCands then
+        return precedes(candVal[i], candRun[i], candPos[i],
+                        candVal[j], candRun[j], candPos[j], comparator);
+      else
+        return precedes(A[runLo[candRun[i]] + candPos[i]],
+                        candRun[i], candPos[i],
+                        A[runLo[candRun[j]] + candPos[j]],
+                        candRun[j], candPos[j], comparator);
+    }
+
+    while true {
+      var nCands = 0, remaining = 0;
+      for r in 0..#nRuns {
+        if hi[r] > lo[r] {
+          const mid = lo[r] + (hi[r] - lo[r]) / 2;
+          if fetchCands then
+            candVal[nCands] = A[runLo[r] + mid];
+          candRun[nCands] = r;
+          candPos[nCands] = mid;
+          nCands += 1;
+          remaining += hi[r] - lo[r];
+        }
+      }
+      if remaining == 0 then
+        break;
+
+      // Sort the candidates.  There is one per run, so keep it simple.
+      for i in 0..#nCands {
+        var j = i;
+        while j > 0 && candPrecedes(i, order[j-1]) {
+          order[j] = order[j-1];
+          j -= 1;
+        }
+        order[j] = i;
+      }
+
+      // Pick the one at the weighted median.
+      var piv = 0, acc = 0;
+      while true {
+        const r = candRun[order[piv]];
+        acc += hi[r] - lo[r];
+        if 2*acc >= remaining then
+          break;
+        piv += 1;
+      }
+      const pivCand = order[piv];
+      const pivRun = candRun[pivCand], pivPos = candPos[pivCand];
+      const pivIdx = runLo[pivRun] + pivPos;
+
+      // Count the elements of each run that come before the pivot.
+      forall r in 0..#nRuns {
+        if r == pivRun {
+          counts[r] = pivPos;
+        } else if hi[r] == lo[r] {
+          counts[r] = lo[r];
+        } else {
+          const base = runLo[r], l = lo[r], h = hi[r];
+          var c: int;
+          on A[base + l] {
+            if fetchCands {
+              const pivVal = candVal[pivCand];
+              c = countBefore(A, base, base + l, base + h, r,
+                              pivVal, pivRun, pivPos, comparator);
+            } else {
+              c = countBefore(A, base, base + l, base + h, r,
+                              A[pivIdx], pivRun, pivPos, comparator);
+            }
+          }
+          counts[r] = c;
+        }
+      }
+
+      const below = + reduce counts;
+      if below == rank {
+        lo = counts;
+        break;
+      } else if below < rank {
+        lo = counts;
+        lo[pivRun] += 1;
+      } else {
+        hi = counts;
+      }
+    }
+
+    return lo;
+  }
+
+  //
+  // Merge the sorted runs Src[runStart[r]..<runEnd[r]] into Dst, starting
+  // at index dstStart.  Equal elements are taken from lower-numbered runs
+  // first.
+  //
+  proc multiwayMerge(Src:[], const ref runStart:[] int,
+                     const ref runEnd:[] int, Dst:[], dstStart:int,
+                     comparator) {
+    const nRuns = runStart.size;
+    var pos = runStart;
+    var heap: [0..#nRuns] int;
+    var heapSize = 0;
+    var d = dstStart;
+
+    inline proc before(a:int, b:int) {
+      return precedes(Src[pos[a]], a, pos[a], Src[pos[b]], b, pos[b],
+                      comparator);
+    }
+
+    proc siftDown(in i:int) {
+      while true {
+        const left = 2*i + 1, right = left + 1;
+        var least = i;
+        if left < heapSize && before(heap[left], heap[least]) then
+          least = left;
+        if right < heapSize && before(heap[right], heap[least]) then
+          least = right;
+        if least == i then
+          return;
+        heap[i] <=> heap[least];
+        i = least;
+      }
+    }
+
+    for r in 0..#nRuns {
+      if pos[r] < runEnd[r] {
+        heap[heapSize] = r;
+        heapSize += 1;
+      }
+    }
+    for i in 0..#heapSize/2 by -1 do
+      siftDown(i);
+
+    while heapSize > 1 {
+      const r = heap[0];
+      Dst[d] = Src[pos[r]];
+      d += 1;
+      pos[r] += 1;
+      if pos[r] == runEnd[r] {
+        heapSize -= 1;
+        heap[0] = heap[heapSize];
+      }
+      siftDown(0);
+    }
+
+    if heapSize == 1 {
+      const r = heap[0];
+      const n = runEnd[r] - pos[r];
+      Dst[d..#n] = Src[pos[r]..#n];
+    }
+  }
+
+  //
+  // Merge the sorted runs Src[segStarts[r]..<segStarts[r+1]] into
+  // Dst[dstStart..], using several tasks.  Each task gets an equal share
+  // of the output and finds where that share begins in each run with
+  // multiwaySelect(), so all of them can merge independently.
+  //
+  proc parallelMultiwayMerge(Src:[], const ref segStarts:[] int,
+                             Dst:[], dstStart:int, comparator) {
+    const nRuns = segStarts.size - 1;
+    const n = segStarts[nRuns] - segStarts[0];
+    const maxTasks = if dataParTasksPerLocale > 0 then dataParTasksPerLocale
+                                                  else here.maxTaskPar;
+    const nTasks = max(1, min(maxTasks, n / minMergeSizePerTask));
+
+    var runLo, runHi: [0..#nRuns] int;
+    for r in 0..#nRuns {
+      runLo[r] = segStarts[r];
+      runHi[r] = segStarts[r+1] - 1;
+    }
+    if nTasks == 1 {
+      const runEnd: [0..#nRuns] int = runHi + 1;
+      multiwayMerge(Src, runLo, runEnd, Dst, dstStart, comparator);
+      return;
+    }
+
+    // Find all the splits before anyone starts merging, because merging
+    // can move elements out of Src.
+    var splits: [0..nTasks, 0..#nRuns] int;
+    forall t in 0..nTasks {
+      if t == 0 {
+        splits[t, ..] = runLo;
+      } else if t == nTasks {
+        splits[t, ..] = runHi + 1;
+      } else {
+        const split = multiwaySelect(Src, runLo, runHi, t * n / nTasks,
+                                     comparator);
+        splits[t, ..] = runLo + split;
+      }
+    }
+
+    coforall t in 0..#nTasks {
+      const mergeStart: [0..#nRuns] int = splits[t, ..];
+      const mergeEnd: [0..#nRuns] int = splits[t+1, ..];
+      multiwayMerge(Src, mergeStart, mergeEnd, Dst, dstStart + t * n / nTasks,
+                    comparator);
+    }
+  }
+
+  //
+  // Stable sort for a local, non-strided array: sort equal chunks with
+  // the stable merge sort in parallel, then merge them in parallel.
+  //
+  proc parallelStableSort(Data:[?Dom] ?eltType, comparator) {
+    const n = Dom.size;
+    const maxTasks = if dataParTasksPerLocale > 0 then dataParTasksPerLocale
+                                                  else here.maxTaskPar;
+    const nChunks = max(1, min(maxTasks, n / minMergeSizePerTask));
+
+    if nChunks == 1 {
+      MergeSort.mergeSort(Data, comparator=comparator);
+      return;
+    }
+
+    var Scratch: [Dom] eltType = Data;
+    var segStarts: [0..nChunks] int;
+    for c in 0..nChunks do
+      segStarts[c] = Dom.low + c * n / nChunks;
+
+    forall c in 0..#nChunks do
+      MergeSort.mergeSort(Scratch[segStarts[c]..<segStarts[c+1]],
+                          comparator=comparator);
+
+    parallelMultiwayMerge(Scratch, segStarts, Data, Dom.low, comparator);
+  }
+
+  // What each locale keeps between the exchange and the merge.
+  record MultiwayMergeLocaleState {
+    type eltType;
+    var bufDom: domain(1);
+    var buf: [bufDom] eltType;
+    var segDom: domain(1);
+    var segStarts: [segDom] int;
+    var srcStarts: [segDom] int;
+  }
+
+  //
+  // Sort an array whose distribution gives each target locale one
+  // contiguous block of indices, in target locale order.  Returns false
+  // without touching the array if it is not laid out that way.
+  //
+  //  1. Each locale sorts its own block.
+  //  2. Each locale finds where the part of the result that it will
+  //     own starts and ends in every block, with multiwaySelect().
+  //  3. Each locale fetches those pieces with one bulk transfer per
+  //     block.
+  //  4. Once everyone has their pieces, each locale merges them back
+  //     into its own block.
+  //
+  // Ending each coforall below is the barrier between these steps.
+  //
+  proc distributedSort(Data:[?Dom] ?eltType, comparator,
+                       param stable:bool): bool {
+    const ref tgtLocs = Data.targetLocales();
+    const nRuns = tgtLocs.size;
+    var runLo, runHi: [0..#nRuns] int;
+
+    var next = Dom.low;
+    for (loc, r) in zip(tgtLocs, 0..) {
+      const lsd = Data.localSubdomain(loc);
+      if lsd.size == 0 {
+        runLo[r] = next;
+        runHi[r] = next - 1;
+      } else {
+        if lsd.stride != 1 || lsd.low != next then
+          return false;
+        runLo[r] = lsd.low;
+        runHi[r] = lsd.high;
+        next = lsd.high + 1;
+      }
+    }
+    if next != Dom.high + 1 then
+      return false;
+
+    const StateSpace = {0..#nRuns} dmapped Block(boundingBox={0..#nRuns},
+                                                 targetLocales=tgtLocs);
+    var perLocale: [StateSpace] MultiwayMergeLocaleState(eltType);
+
+    coforall (loc, r) in zip(tgtLocs, 0..) do on loc {
+      const lo = runLo[r], hi = runHi[r];
+      if hi > lo then
+        localSort(Data.localSlice(lo..hi), comparator, stable);
+    }
+
+    coforall (loc, r) in zip(tgtLocs, 0..) do on loc {
+      const myRunLo = runLo, myRunHi = runHi;
+      const lo = myRunLo[r], hi = myRunHi[r];
+      ref state = perLocale[r];
+      if hi >= lo {
+        const startSplit = multiwaySelect(Data, myRunLo, myRunHi,
+                                          lo - Dom.low, comparator);
+        const endSplit = multiwaySelect(Data, myRunLo, myRunHi,
+                                        hi + 1 - Dom.low, comparator);
+        state.bufDom = {0..#(hi - lo + 1)};
+        state.segDom = {0..nRuns};
+        for s in 0..#nRuns {
+          state.segStarts[s+1] = state.segStarts[s] +
+                                 endSplit[s] - startSplit[s];
+          state.srcStarts[s] = myRunLo[s] + startSplit[s];
+        }
+      }
+    }
+
+    coforall (loc, r) in zip(tgtLocs, 0..) do on loc {
+      const lo = runLo[r], hi = runHi[r];
+      ref state = perLocale[r];
+      if hi >= lo {
+        forall s in 0..#nRuns with (ref state) {
+          const size = state.segStarts[s+1] - state.segStarts[s];
+          if size > 0 then
+            state.buf[state.segStarts[s]..#size] =
+              Data[state.srcStarts[s]..#size];
+        }
+      }
+    }
+
+    coforall (loc, r) in zip(tgtLocs, 0..) do on loc {
+      const lo = runLo[r], hi = runHi[r];
+      ref state = perLocale[r];
+      if hi >= lo then
+        parallelMultiwayMerge(state.buf, state.segStarts,
+                              Data.localSlice(lo..hi), lo, comparator);
+    }
+
+    return true;
+  }
+}
+
 pragma "no doc"
 module InPlacePartitioning {
   // TODO -- based on ips4o
@@ -46,13 +46,24 @@ module VisualDebug
   */
   config const VisualDebugOn = DefaultVisualDebugOn;
 
+  /*
+    If this is `true`, events are recorded in a compact binary format
+    instead of the text format read by :ref:`chplvis`.  Each thread
+    buffers its events and writes them out in bulk, which perturbs the
+    program's timing much less.  The ``vdebug2trace.py`` script in
+    ``$CHPL_HOME/tools/chplvis`` converts the binary files into a Chrome
+    trace-event JSON file for a timeline viewer such as Perfetto.
+  */
+  config const VisualDebugBinary = false;
+
   private extern proc chpl_now_time():real;
 
   //
   // Data Generation for the Visual Debug tool  (offline)
   //
 
-  private extern proc chpl_vdebug_start (rootname: c_string, time:real);
+  private extern proc chpl_vdebug_start (rootname: c_string, time:real,
+                                         binary: bool);
 
   private extern proc chpl_vdebug_stop ();
 
@@ -103,7 +114,8 @@ private proc VDebugTree (what: vis_op, name: string, time: real, tagno: int,
 
      /* Do the op at the root  */
      select what {
-         when vis_op.v_start    do chpl_vdebug_start (name.localize().c_str(), time);
+         when vis_op.v_start    do chpl_vdebug_start (name.localize().c_str(), time,
+                                                  VisualDebugBinary);
          when vis_op.v_stop     do chpl_vdebug_stop ();
          when vis_op.v_tag      do chpl_vdebug_tag (tagno);
          when vis_op.v_pause    do chpl_vdebug_pause (tagno);
@@ -111,14 +123,14 @@ private proc VDebugTree (what: vis_op, name: string, time: real, tagno: int,
 }
 
 
- private var Vdebugstarted: atomic bool = false;
+ private var Vdebugstarted: atomic bool;
 /*
   Start logging events for VisualDebug.  Open a new set of data
   files, one for each locale, for :ref:`chplvis`.  This routine should be
   called only once for each program.  It creates a directory with the
   rootname and creates the files in that directory.  The files are
   named with the rootname and "-n" is added where n is the locale
-  number.
+  number.  With :var:`VisualDebugBinary` set, ".bin" is added as well.
 
   :arg rootname:  Directory name and rootname for files.
 */
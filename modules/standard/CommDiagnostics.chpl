@@ -154,6 +154,32 @@
   was executed on locale 0, and a remote get and a remote put were
   executed on locale 1.
 
+  **Communication Profiling**
+
+  Counts tell you how much communication a program does, but not
+  where it comes from.  A communication profile gathers, for each
+  combination of operation, source location, initiating locale, and
+  target locale, how many times the operation was done, how many
+  bytes it moved, and a histogram of the transfer sizes:
+
+  .. code-block:: chapel
+
+    startCommProfile();
+    // between start/stop calls, profile comm ops initiated on any locale
+    stopCommProfile();
+    printCommProfile();
+
+  The report lists the busiest call sites first.  Calling
+  ``startCommProfile(latency=true)`` also measures how long blocking
+  GETs and PUTs take, at some extra cost per operation.
+  :proc:`getCommProfile` returns the profile as an array of
+  :record:`commProfileEntry` values, and :proc:`writeCommProfile`
+  writes it as a CSV file for further processing.
+
+  A whole program run can be profiled without changing the program,
+  by setting the ``CHPL_RT_COMM_PROFILE`` environment variable when
+  running it.  See :ref:`readme-executing` for details.
+
   **Studying Communication During Module Initialization**
 
   It is hard for a programmer to determine exactly what happens during
@@ -184,6 +210,8 @@
  */
 module CommDiagnostics
 {
+  private use CPtr, SysCTypes;
+
   /*
     Print out stack traces for comm events printed after startVerboseComm
    */
@@ -475,6 +503,314 @@ module CommDiagnostics
     }
   }
 
+  /*
+    The number of transfer size bins in a :record:`commProfileEntry`.
+    Bin 0 counts transfers of up to 8 bytes, bin `i` those of up to
+    ``8 << i`` bytes, and the last bin all larger ones.
+   */
+  param commProfileNumSizeBins = 12;
+
+  /*
+    The communication done by one call site on one locale to one
+    target locale, while profiling was on.
+   */
+  record commProfileEntry {
+    /*
+      the kind of operation, such as "get", "strided put",
+      "amo fetch_add", or "fast executeOn"
+     */
+    var op: string;
+    /* the locale that initiated the operations */
+    var srcLocale: int;
+    /* the target locale */
+    var dstLocale: int;
+    /* the source file of the call site */
+    var file: string;
+    /* the source line of the call site */
+    var line: int;
+    /* number of operations */
+    var count: uint(64);
+    /* total bytes transferred by GETs and PUTs */
+    var numBytes: uint(64);
+    /* operation counts by transfer size */
+    var sizeBins: commProfileNumSizeBins*uint(64);
+    /* number of operations whose latency was measured */
+    var timedCount: uint(64);
+    /* total latency of the measured operations, in nanoseconds */
+    var latencyNs: uint(64);
+    /* largest latency of a measured operation, in nanoseconds */
+    var maxLatencyNs: uint(64);
+  }
+
+  pragma "no doc"
+  extern record chpl_commProfileEntry {
+    var op: c_string;
+    var fn: int(32);
+    var ln: int(32);
+    var node: int(32);
+    var count: uint(64);
+    var num_bytes: uint(64);
+    var timed_count: uint(64);
+    var latency_ns: uint(64);
+    var latency_max_ns: uint(64);
+  }
+
+  private extern proc chpl_comm_startProfile(latency: bool);
+
+  private extern proc chpl_comm_stopProfile();
+
+  private extern proc chpl_comm_startProfileHere(latency: bool);
+
+  private extern proc chpl_comm_stopProfileHere();
+
+  private extern proc chpl_comm_resetProfileHere();
+
+  private extern proc
+    chpl_comm_getProfileHere(ref entries: c_ptr(chpl_commProfileEntry)): int;
+
+  private extern proc
+    chpl_comm_freeProfileHere(entries: c_ptr(chpl_commProfileEntry));
+
+  private extern proc
+    chpl_comm_getProfileSizeBin(entries: c_ptr(chpl_commProfileEntry),
+                                i: int, bin: c_int): uint(64);
+
+  private extern proc chpl_comm_profileOpenFile(filename: c_string,
+                                                ref f: c_void_ptr): c_int;
+
+  private extern proc chpl_comm_profileWriteRow(f: c_void_ptr, from: int,
+                                                op: c_string, to: int,
+                                                file: c_string, line: int,
+                                                count: uint(64),
+                                                numBytes: uint(64),
+                                                sizeBins: c_ptr(uint(64)),
+                                                timedCount: uint(64),
+                                                latencyNs: uint(64),
+                                                maxLatencyNs: uint(64));
+
+  private extern proc chpl_comm_profileCloseFile(f: c_void_ptr): c_int;
+
+  private extern proc chpl_comm_profileAtExit(): bool;
+
+  private extern proc chpl_comm_profileFile(): c_string;
+
+  /*
+    Start profiling communication initiated on any locale.
+
+    :arg latency: Also measure the latency of blocking GETs and PUTs
+    :type latency: `bool`
+   */
+  proc startCommProfile(latency=false) {
+    chpl_comm_startProfile(latency);
+  }
+
+  /*
+    Stop profiling communication initiated on any locale.
+   */
+  proc stopCommProfile() {
+    chpl_comm_stopProfile();
+  }
+
+  /*
+    Start profiling communication initiated on this locale.
+
+    :arg latency: Also measure the latency of blocking GETs and PUTs
+    :type latency: `bool`
+   */
+  proc startCommProfileHere(latency=false) {
+    chpl_comm_startProfileHere(latency);
+  }
+
+  /*
+    Stop profiling communication initiated on this locale.
+   */
+  proc stopCommProfileHere() {
+    chpl_comm_stopProfileHere();
+  }
+
+  /*
+    Discard the communication profile on all locales.
+   */
+  proc resetCommProfile() {
+    for loc in Locales do on loc do
+      resetCommProfileHere();
+  }
+
+  /*
+    Discard the communication profile on the calling locale.
+   */
+  inline proc resetCommProfileHere() {
+    chpl_comm_resetProfileHere();
+  }
+
+  /*
+    Retrieve the communication profile for the whole program.  Profiling
+    should be stopped first, or the communication done to gather the
+    profile will show up in it.
+
+    :returns: the entries of all locales, busiest first
+    :rtype: `[] commProfileEntry`
+   */
+  proc getCommProfile() {
+    var D = {0..<0};
+    var A: [D] commProfileEntry;
+    for loc in Locales {
+      const lo = D.size;
+      on loc {
+        const P = getCommProfileHere();
+        D = {0..<lo+P.size};
+        A[lo..#P.size] = P;
+      }
+    }
+    sortCommProfile(A);
+    return A;
+  }
+
+  /*
+    Retrieve the communication profile for this locale.
+
+    :returns: the entries of this locale, busiest first
+    :rtype: `[] commProfileEntry`
+   */
+  proc getCommProfileHere() {
+    var p: c_ptr(chpl_commProfileEntry);
+    const n = chpl_comm_getProfileHere(p);
+    var A: [0..<n] commProfileEntry;
+    for i in 0..<n {
+      ref e = A[i];
+      const op = p[i].op;
+      e.op = op:string;
+      e.srcLocale = here.id;
+      e.dstLocale = p[i].node;
+      const file: c_string = __primitive("chpl_lookupFilename", p[i].fn);
+      e.file = file:string;
+      e.line = p[i].ln;
+      e.count = p[i].count;
+      e.numBytes = p[i].num_bytes;
+      for param b in 0..<commProfileNumSizeBins do
+        e.sizeBins[b] = chpl_comm_getProfileSizeBin(p, i, b:c_int);
+      e.timedCount = p[i].timed_count;
+      e.latencyNs = p[i].latency_ns;
+      e.maxLatencyNs = p[i].latency_max_ns;
+    }
+    chpl_comm_freeProfileHere(p);
+    sortCommProfile(A);
+    return A;
+  }
+
+  // Busiest first, then by operation and call site.
+  private proc commProfileBefore(a: commProfileEntry, b: commProfileEntry) {
+    if a.count != b.count then return a.count > b.count;
+    if a.op != b.op then return a.op < b.op;
+    if a.file != b.file then return a.file < b.file;
+    if a.line != b.line then return a.line < b.line;
+    if a.srcLocale != b.srcLocale then return a.srcLocale < b.srcLocale;
+    return a.dstLocale < b.dstLocale;
+  }
+
+  //
+  // A simple merge sort, because the Sort module can't be used here:
+  // this module is initialized before the modules it needs.
+  //
+  private proc sortCommProfile(ref A: [?D] commProfileEntry) {
+    var B: [D] commProfileEntry;
+    var width = 1;
+    while width < D.size {
+      for lo in D.low..D.high by 2*width {
+        const mid = min(lo + width, D.high + 1),
+              hi = min(lo + 2*width, D.high + 1);
+        var (i, j) = (lo, mid);
+        for k in lo..<hi {
+          if j >= hi || (i < mid && !commProfileBefore(A[j], A[i])) {
+            B[k] = A[i];
+            i += 1;
+          } else {
+            B[k] = A[j];
+            j += 1;
+          }
+        }
+      }
+      A <=> B;
+      width *= 2;
+    }
+  }
+
+  /*
+    Print a communication profile as a table, one row per entry.
+
+    :arg profile: the profile to print (defaults to that of the whole
+                  program)
+    :arg maxRows: print at most this many of the busiest entries
+    :type maxRows: `int`
+   */
+  proc printCommProfile(profile = getCommProfile(), maxRows = max(int)) {
+    writef("%-24s %6s %6s %12s %14s %10s %10s  %s\n",
+           "operation", "from", "to", "count", "bytes",
+           "avg us", "max us", "location");
+    for (e, row) in zip(profile, 0..) {
+      if row >= maxRows then break;
+      writef("%-24s %6i %6i %12u %14u ",
+             e.op, e.srcLocale, e.dstLocale, e.count, e.numBytes);
+      if e.timedCount == 0 then
+        writef("%10s %10s ", "-", "-");
+      else
+        writef("%10.3dr %10.3dr ", e.latencyNs / 1e3 / e.timedCount,
+               e.maxLatencyNs / 1e3);
+      writef(" %s:%i\n", e.file, e.line);
+    }
+  }
+
+  /*
+    Write a communication profile as a CSV file, one row per entry.
+    The size histogram columns are labeled with their upper bounds.
+
+    :arg filename: the file to write
+    :type filename: `string`
+    :arg profile: the profile to write (defaults to that of the whole
+                  program)
+   */
+  proc writeCommProfile(filename: string,
+                        profile = getCommProfile()) throws {
+    use SysBasic, SysError;
+
+    var f: c_void_ptr;
+    var err = chpl_comm_profileOpenFile(filename.c_str(), f);
+    if err != 0 then
+      throw SystemError.fromSyserr(err:syserr, "in writeCommProfile(" +
+                                               filename + ")");
+    for e in profile {
+      var bins = e.sizeBins;
+      chpl_comm_profileWriteRow(f, e.srcLocale, e.op.c_str(), e.dstLocale,
+                                e.file.c_str(), e.line, e.count, e.numBytes,
+                                c_ptrTo(bins[0]), e.timedCount, e.latencyNs,
+                                e.maxLatencyNs);
+    }
+    err = chpl_comm_profileCloseFile(f);
+    if err != 0 then
+      throw SystemError.fromSyserr(err:syserr, "in writeCommProfile(" +
+                                               filename + ")");
+  }
+
+  //
+  // Called during teardown to report a whole-run profile requested by
+  // setting CHPL_RT_COMM_PROFILE.
+  //
+  pragma "no doc"
+  proc chpl_reportCommProfileAtExit() {
+    if !chpl_comm_profileAtExit() then return;
+
+    stopCommProfile();
+    const profile = getCommProfile();
+    printCommProfile(profile);
+    const filename = chpl_comm_profileFile():string;
+    try {
+      writeCommProfile(filename, profile);
+    } catch e {
+      writeln("warning: could not write communication profile to ",
+              filename, ": ", e.message());
+    }
+  }
+
   /*
     If this is set, on-the-fly reporting of communication operations
     will be turned on before any module initialization begins and
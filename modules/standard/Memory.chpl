@@ -20,7 +20,7 @@
 
 /*
   The :mod:`Memory` module provides submodules that contain operations
-  related to memory usage and memory initialization.
+  related to memory usage, memory initialization, and memory placement.
 
   .. warning::
 
@@ -33,6 +33,7 @@
 module Memory {
 
 include module Diagnostics;
+include module Placement;
 
 pragma "insert line file info"
 private extern proc chpl_memoryUsed(): uint(64);
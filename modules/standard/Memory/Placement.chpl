@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+  The :mod:`Placement` module provides procedures that give the runtime
+  hints about where the element storage of large local arrays should
+  be placed in memory.
+
+  The same hints can be applied program-wide, to all sufficiently large
+  arrays, by setting the ``CHPL_RT_ARRAY_HUGE_PAGES`` and
+  ``CHPL_RT_ARRAY_NUMA_POLICY`` environment variables when the program
+  is run.  See :ref:`readme-executing` for details.  Hints only apply
+  when ``CHPL_COMM=none`` and ``CHPL_LOCALE_MODEL=flat``.
+
+  Hints have full effect only if they are given before the array
+  memory is first touched.  For example:
+
+  .. code-block:: chapel
+
+    use Memory.Placement;
+
+    var A: [1..n] real = noinit;
+    adviseArrayMemory(A, hugePages=true, interleave=true);
+    A = 0.0;
+
+  Applied to an array whose memory has already been touched,
+  interleaving migrates the existing pages and huge pages will only be
+  used when the operating system later collapses the existing pages.
+ */
+module Placement {
+
+private use CPtr, SysCTypes;
+
+private extern const CHPL_MEM_ARRAY_HINT_NONE: c_int;
+private extern const CHPL_MEM_ARRAY_HINT_HUGE_PAGES: c_int;
+private extern const CHPL_MEM_ARRAY_HINT_INTERLEAVE: c_int;
+
+/*
+  Give placement hints for the element storage of a default rectangular
+  array.
+
+  :arg A: The array.
+  :arg hugePages: Ask for the array memory to be backed by transparent
+                  huge pages, to reduce TLB misses.
+  :arg interleave: Ask for the array memory pages to be interleaved
+                   round-robin across the NUMA domains of the locale,
+                   to spread memory traffic evenly.
+ */
+proc adviseArrayMemory(const ref A: [], hugePages: bool = false,
+                       interleave: bool = false) {
+  if !A._value.isDefaultRectangular() then
+    compilerError("adviseArrayMemory() is only supported on default ",
+                  "rectangular arrays");
+
+  pragma "fn synchronization free"
+  extern proc chpl_mem_array_advise(data: c_void_ptr, nmemb: size_t,
+                                    eltSize: size_t, hint: c_int);
+
+  var hint = CHPL_MEM_ARRAY_HINT_NONE;
+  if hugePages then hint |= CHPL_MEM_ARRAY_HINT_HUGE_PAGES;
+  if interleave then hint |= CHPL_MEM_ARRAY_HINT_INTERLEAVE;
+  if hint == CHPL_MEM_ARRAY_HINT_NONE then
+    return;
+
+  const arr = A._value;
+  on arr {
+    chpl_mem_array_advise(arr.data:c_void_ptr, arr.dom.dsiNumIndices:size_t,
+                          _ddata_sizeof_element(arr.data), hint);
+  }
+}
+
+}
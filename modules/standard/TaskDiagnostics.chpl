@@ -0,0 +1,239 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+  This module provides support for counting what the tasking layer does
+  on each locale: how many tasks are spawned and run, how long they
+  run, how often idle workers steal work from one another, how long
+  workers sit idle, and how long tasks spend blocked on sync variables.
+  It is meant to help answer questions like "are my tasks too small?"
+  or "is my forall loop load balanced?".
+
+  Counting is done between a pair of calls that turn it on and off,
+  in the same way as for :mod:`CommDiagnostics`:
+
+  .. code-block:: chapel
+
+    // (optional) if we counted previously, reset the counters to zero
+    resetTaskDiagnostics();
+    startTaskDiagnostics();
+    // between start/stop calls, count tasking events on all locales
+    stopTaskDiagnostics();
+    // retrieve the counts and report the results
+    writeln(getTaskDiagnostics());
+
+  As with comm diagnostics, each procedure also has a ``Here`` variant
+  that affects only the calling locale.  The counts are kept separately
+  for each worker (the threads that run tasks), and can be retrieved
+  per worker with :proc:`getWorkerTaskDiagnosticsHere` or summed over
+  the locale's workers with :proc:`getTaskDiagnosticsHere`.
+  :proc:`printTaskDiagnostics` prints a table of both.
+
+  Counting can also be turned on for an entire run without changing
+  the program, by setting the ``CHPL_RT_TASK_DIAGNOSTICS`` environment
+  variable.  Then the table is printed when the program exits, and
+  also whenever a locale's process receives a ``SIGUSR1`` signal.
+
+  Not all of the counts apply to every tasking layer.  Steals are only
+  counted where there is stealing, which is with
+  ``CHPL_TASKS=qthreads`` and work stealing enabled (see
+  :ref:`readme-tasks`).  Where the tasking layer does not report when
+  its workers are idle, idle time is taken to be the time a worker was
+  not running a task.
+ */
+module TaskDiagnostics
+{
+  private use CPtr, SysCTypes;
+
+  /* Tasking counts for a worker, or summed over a locale's workers.
+     This record type is defined in the same way by both the runtime
+     and this module.  Times are in nanoseconds.
+   */
+  extern record chpl_taskDiagnostics {
+    /*
+      tasks created by this worker
+     */
+    var tasks_spawned: uint(64);
+    /*
+      tasks this worker ran to completion
+     */
+    var tasks_run: uint(64);
+    /*
+      time spent running tasks, not counting sync variable waits
+     */
+    var run_ns: uint(64);
+    /*
+      tasks this worker took from another worker's queue
+     */
+    var steals: uint(64);
+    /*
+      time spent idle, waiting for tasks to run
+     */
+    var idle_ns: uint(64);
+    /*
+      times a task blocked waiting on a sync variable
+     */
+    var sync_waits: uint(64);
+    /*
+      time tasks spent blocked waiting on sync variables
+     */
+    var sync_wait_ns: uint(64);
+    /*
+      sum of the task queue lengths seen when starting each task
+     */
+    var queue_depth_sum: uint(64);
+    /*
+      longest task queue seen when starting a task
+     */
+    var queue_depth_max: uint(64);
+
+    /*
+      The average time each task ran, in seconds.
+     */
+    proc avgTaskSeconds(): real {
+      return if tasks_run == 0 then 0.0
+             else run_ns:real / 1e9 / tasks_run;
+    }
+
+    /*
+      The average task queue length seen when starting a task.
+     */
+    proc avgQueueDepth(): real {
+      return if tasks_run == 0 then 0.0
+             else queue_depth_sum:real / tasks_run;
+    }
+  };
+
+  /*
+    The Chapel record type inherits the runtime definition of it.
+   */
+  type taskDiagnostics = chpl_taskDiagnostics;
+
+  private extern proc chpl_task_startDiagnosticsHere();
+
+  private extern proc chpl_task_stopDiagnosticsHere();
+
+  private extern proc chpl_task_resetDiagnosticsHere();
+
+  private extern proc chpl_task_getNumDiagnosticsWorkersHere(): c_int;
+
+  private extern proc chpl_task_getDiagnosticsHere(worker: c_int,
+                                                   ref td: taskDiagnostics);
+
+  private extern proc chpl_task_printDiagnosticsHere();
+
+  /*
+    Start counting tasking events across the whole program.
+   */
+  proc startTaskDiagnostics() {
+    for loc in Locales do on loc do
+      startTaskDiagnosticsHere();
+  }
+
+  /*
+    Stop counting tasking events across the whole program.
+   */
+  proc stopTaskDiagnostics() {
+    for loc in Locales do on loc do
+      stopTaskDiagnosticsHere();
+  }
+
+  /*
+    Start counting tasking events on this locale.
+   */
+  inline proc startTaskDiagnosticsHere() {
+    chpl_task_startDiagnosticsHere();
+  }
+
+  /*
+    Stop counting tasking events on this locale.
+   */
+  inline proc stopTaskDiagnosticsHere() {
+    chpl_task_stopDiagnosticsHere();
+  }
+
+  /*
+    Reset tasking counts across the whole program.
+   */
+  proc resetTaskDiagnostics() {
+    for loc in Locales do on loc do
+      resetTaskDiagnosticsHere();
+  }
+
+  /*
+    Reset tasking counts on the calling locale.
+   */
+  inline proc resetTaskDiagnosticsHere() {
+    chpl_task_resetDiagnosticsHere();
+  }
+
+  /*
+    Retrieve tasking counts for the whole program, summed over the
+    workers on each locale.
+
+    :returns: array of tasking counts for each locale
+    :rtype: `[LocaleSpace] taskDiagnostics`
+   */
+  proc getTaskDiagnostics() {
+    var D: [LocaleSpace] taskDiagnostics;
+    for loc in Locales do on loc {
+      D(loc.id) = getTaskDiagnosticsHere();
+    }
+    return D;
+  }
+
+  /*
+    Retrieve tasking counts for this locale, summed over its workers.
+    The ``queue_depth_max`` field is the maximum over the workers.
+
+    :returns: tasking counts for this locale
+    :rtype: `taskDiagnostics`
+   */
+  proc getTaskDiagnosticsHere() {
+    var td: taskDiagnostics;
+    chpl_task_getDiagnosticsHere(-1, td);
+    return td;
+  }
+
+  /*
+    Retrieve tasking counts for each worker on this locale.  Workers are
+    numbered in the order in which they were first counted.
+
+    :returns: array of tasking counts for each worker
+    :rtype: `[0..<n] taskDiagnostics`
+   */
+  proc getWorkerTaskDiagnosticsHere() {
+    const n = chpl_task_getNumDiagnosticsWorkersHere(): int;
+    var D: [0..<n] taskDiagnostics;
+    for i in 0..<n do
+      chpl_task_getDiagnosticsHere(i: c_int, D(i));
+    return D;
+  }
+
+  /*
+    Print the current tasking counts for each locale, with a row per
+    worker and a total row.  Times are shown in seconds.  Each line is
+    prefixed with the number of the locale it describes.
+   */
+  proc printTaskDiagnostics() {
+    for loc in Locales do on loc do
+      chpl_task_printDiagnosticsHere();
+  }
+}
@@ -24,6 +24,7 @@
 #ifndef LAUNCHER
 
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
 #include "chpl-mem.h"
 #include "error.h"
 #include "chpl-wide-ptr-fns.h"
@@ -57,6 +58,8 @@ void chpl_gen_comm_get(void *addr, c_nodeid_t node, void* raddr,
   } else if( chpl_cache_enabled() ) {
     chpl_cache_comm_get(addr, node, raddr, size, commID, ln, fn);
 #endif
+  } else if (chpl_comm_profile_latency) {
+    chpl_comm_profile_timed_get(addr, node, raddr, size, commID, ln, fn);
   } else {
     chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
   }
@@ -98,6 +101,8 @@ void chpl_gen_comm_put(void* addr, c_nodeid_t node, void* raddr,
   } else if( chpl_cache_enabled() ) {
     chpl_cache_comm_put(addr, node, raddr, size, commID, ln, fn);
 #endif
+  } else if (chpl_comm_profile_latency) {
+    chpl_comm_profile_timed_put(addr, node, raddr, size, commID, ln, fn);
   } else {
     chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
   }
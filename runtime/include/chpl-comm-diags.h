@@ -80,6 +80,60 @@ void chpl_comm_resetDiagnosticsHere(void);
 void chpl_comm_getDiagnosticsHere(chpl_commDiagnostics *cd);
 
 
+//
+// Communication profiling: totals per (operation, call site, target
+// locale).  Message sizes are binned by powers of two.  Bin 0 holds sizes
+// up to 8 bytes, bin i sizes up to 8<<i bytes, and the last bin anything
+// bigger.  Latency is only measured when asked for, and only for
+// blocking GETs and PUTs from generated code that bypass the remote
+// cache.
+//
+extern int chpl_comm_profiling;       // set via startCommProfile
+extern int chpl_comm_profile_latency;
+
+#define CHPL_COMM_PROFILE_NUM_SIZE_BINS 12
+
+typedef struct _chpl_commProfileEntry {
+  const char* op;
+  int32_t fn;
+  int32_t ln;
+  int32_t node;
+  uint64_t count;
+  uint64_t num_bytes;
+  uint64_t size_bins[CHPL_COMM_PROFILE_NUM_SIZE_BINS];
+  uint64_t timed_count;
+  uint64_t latency_ns;
+  uint64_t latency_max_ns;
+} chpl_commProfileEntry;
+
+void chpl_comm_startProfile(chpl_bool latency);
+void chpl_comm_stopProfile(void);
+void chpl_comm_startProfileHere(chpl_bool latency);
+void chpl_comm_stopProfileHere(void);
+void chpl_comm_resetProfileHere(void);
+
+// Returns the number of entries for this locale, merged across threads,
+// in an array the caller frees with chpl_comm_freeProfileHere().
+int64_t chpl_comm_getProfileHere(chpl_commProfileEntry** entries);
+void chpl_comm_freeProfileHere(chpl_commProfileEntry* entries);
+uint64_t chpl_comm_getProfileSizeBin(chpl_commProfileEntry* entries,
+                                     int64_t i, int bin);
+
+int chpl_comm_profileOpenFile(const char* filename, void** f);
+void chpl_comm_profileWriteRow(void* f, int64_t from, const char* op,
+                               int64_t to, const char* file, int64_t line,
+                               uint64_t count, uint64_t bytes,
+                               const uint64_t* size_bins,
+                               uint64_t timed_count, uint64_t latency_ns,
+                               uint64_t latency_max_ns);
+int chpl_comm_profileCloseFile(void* f);
+
+// CHPL_RT_COMM_PROFILE: profile the whole run and report at exit.
+void chpl_comm_profile_init(void);
+chpl_bool chpl_comm_profileAtExit(void);
+const char* chpl_comm_profileFile(void);
+
+
 ////////////////////
 //
 // Private
@@ -93,6 +147,15 @@ typedef struct _chpl_atomic_commDiagnostics {
 extern chpl_atomic_commDiagnostics chpl_comm_diags_counters;
 extern atomic_int_least16_t chpl_comm_diags_disable_flag;
 
+void chpl_comm_profile_record(const char* op, c_nodeid_t node, size_t size,
+                              int32_t ln, int32_t fn);
+void chpl_comm_profile_timed_get(void* addr, c_nodeid_t node, void* raddr,
+                                 size_t size, int32_t commID,
+                                 int ln, int32_t fn);
+void chpl_comm_profile_timed_put(void* addr, c_nodeid_t node, void* raddr,
+                                 size_t size, int32_t commID,
+                                 int ln, int32_t fn);
+
 static inline
 void chpl_comm_diags_init(void) {
 #define _COMM_DIAGS_INIT(cdv) \
@@ -151,33 +214,69 @@ int chpl_comm_diags_is_enabled(void) {
     }                                                              \
   } while(0)
 
+#define chpl_comm_diags_profile(op, node, size, ln, fn)                 \
+  do {                                                                  \
+    if (chpl_comm_profiling && chpl_comm_diags_is_enabled()) {          \
+      chpl_comm_profile_record(op, node, size, ln, fn);                 \
+    }                                                                   \
+  } while(0)
+
+//
+// The comm layers call these for each operation they initiate.  Besides
+// the on-the-fly reporting they feed the communication profile.  The op
+// and kind arguments must be string literals.
+//
 #define chpl_comm_diags_verbose_rdma(op, node, size, ln, fn, commid)     \
-  chpl_comm_diags_verbose_printf(false,                                  \
-                                 "%s:%d: remote %s, node %d, %zu bytes, " \
-                                 "commid %d",                            \
-                                 chpl_lookupFilename(fn), ln, op,        \
-                                 (int) node, size, (int) commid)
+  do {                                                                   \
+    chpl_comm_diags_profile(op, node, size, ln, fn);                     \
+    chpl_comm_diags_verbose_printf(false,                                \
+                                   "%s:%d: remote %s, node %d, %zu bytes, " \
+                                   "commid %d",                          \
+                                   chpl_lookupFilename(fn), ln, op,      \
+                                   (int) node, size, (int) commid);      \
+  } while(0)
 
 #define chpl_comm_diags_verbose_rdmaStrd(op, node, ln, fn, commid)      \
-  chpl_comm_diags_verbose_printf(false,                                 \
-                                 "%s:%d: remote strided %s, node %d, "  \
-                                 "commid %d",                           \
-                                 chpl_lookupFilename(fn), ln, op,       \
-                                 (int) node, (int) commid)
+  do {                                                                  \
+    chpl_comm_diags_profile("strided " op, node, 0, ln, fn);            \
+    chpl_comm_diags_verbose_printf(false,                               \
+                                   "%s:%d: remote strided %s, node %d, " \
+                                   "commid %d",                         \
+                                   chpl_lookupFilename(fn), ln, op,     \
+                                   (int) node, (int) commid);           \
+  } while(0)
+
+#define chpl_comm_diags_verbose_rdmaV(op, node, n, ln, fn, commid)      \
+  do {                                                                  \
+    chpl_comm_diags_profile("vectored " op, node, 0, ln, fn);           \
+    chpl_comm_diags_verbose_printf(false,                               \
+                                   "%s:%d: remote vectored %s, node %d, " \
+                                   "%zu pieces, commid %d",             \
+                                   chpl_lookupFilename(fn), ln, op,     \
+                                   (int) node, (size_t) (n), (int) commid); \
+  } while(0)
 
 #define chpl_comm_diags_verbose_amo(op, node, ln, fn)                   \
-  chpl_comm_diags_verbose_printf(true,                                  \
-                                 "%s:%d: remote %s, node %d",           \
-                                 chpl_lookupFilename(fn), ln, op,       \
-                                 (int) node)
+  do {                                                                  \
+    chpl_comm_diags_profile(op, node, 0, ln, fn);                       \
+    chpl_comm_diags_verbose_printf(true,                                \
+                                   "%s:%d: remote %s, node %d",         \
+                                   chpl_lookupFilename(fn), ln, op,     \
+                                   (int) node);                         \
+  } while(0)
 
 #define chpl_comm_diags_verbose_executeOn(kind, node, ln, fn)           \
-  chpl_comm_diags_verbose_printf(false,                                 \
-                                 "%s:%d: remote %-*sexecuteOn, node %d", \
-                                 chpl_lookupFilename(fn), ln,           \
-                                 ((int) strlen(kind)                    \
-                                  + ((strlen(kind) == 0) ? 0 : 1)),     \
-                                 kind, (int) node)
+  do {                                                                  \
+    chpl_comm_diags_profile((kind[0] == '\0') ? "executeOn"             \
+                                              : kind " executeOn",      \
+                            node, 0, ln, fn);                           \
+    chpl_comm_diags_verbose_printf(false,                               \
+                                   "%s:%d: remote %-*sexecuteOn, node %d", \
+                                   chpl_lookupFilename(fn), ln,         \
+                                   ((int) strlen(kind)                  \
+                                    + ((strlen(kind) == 0) ? 0 : 1)),   \
+                                   kind, (int) node);                   \
+  } while(0)
 
 #define chpl_comm_diags_incr(_ctr)                                           \
   do {                                                                       \
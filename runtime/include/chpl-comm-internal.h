@@ -54,6 +54,8 @@ extern size_t chpl_rt_priv_bcast_lens[];
   MACRO(chpl_comm_diagnostics)               \
   MACRO(chpl_comm_diags_print_unstable)      \
   MACRO(chpl_verbose_comm_stacktrace)        \
+  MACRO(chpl_comm_profiling)                 \
+  MACRO(chpl_comm_profile_latency)           \
   MACRO(chpl_verbose_mem)
 
 #define _RT_PRV_BCAST_M(sym)  chpl_rt_prv_tab_ ## sym ## _idx,
@@ -28,3 +28,5 @@
 #undef chpl_comm_get
 #undef chpl_comm_put_strd
 #undef chpl_comm_get_strd
+#undef chpl_comm_put_v
+#undef chpl_comm_get_v
@@ -527,6 +527,54 @@ void strd_common_call(void* dstaddr_arg, size_t* dststrides, int32_t srclocale,
 }
 
 
+//
+// Common versions of the vectored bulk transfer functions, for comm
+// layer implementations that do not have native vectored transfers.
+// Like the strided ones above, these use non-blocking transactions for
+// the pieces, up to the given number in flight at once.
+//
+static inline
+void put_v_common(size_t n, void** addrs, int32_t node, void** raddrs,
+                  size_t* sizes,
+                  size_t maxOutstandingXfers, void (yieldFn)(void),
+                  int32_t commID, int ln, int32_t fn) {
+  chpl_comm_nb_handle_t handles[maxOutstandingXfers];
+  size_t currHandles = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    strd_nb_helper(chpl_comm_put_nb,
+                   addrs[i], node, raddrs[i], sizes[i],
+                   handles, &currHandles, maxOutstandingXfers, yieldFn,
+                   commID, ln, fn);
+  }
+
+  if (currHandles > 0) {
+    (void) chpl_comm_wait_nb_some(handles, currHandles);
+  }
+}
+
+
+static inline
+void get_v_common(size_t n, void** addrs, int32_t node, void** raddrs,
+                  size_t* sizes,
+                  size_t maxOutstandingXfers, void (yieldFn)(void),
+                  int32_t commID, int ln, int32_t fn) {
+  chpl_comm_nb_handle_t handles[maxOutstandingXfers];
+  size_t currHandles = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    strd_nb_helper(chpl_comm_get_nb,
+                   addrs[i], node, raddrs[i], sizes[i],
+                   handles, &currHandles, maxOutstandingXfers, yieldFn,
+                   commID, ln, fn);
+  }
+
+  if (currHandles > 0) {
+    (void) chpl_comm_wait_nb_some(handles, currHandles);
+  }
+}
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,3 +22,5 @@
 #define chpl_comm_get use_chpl_gen_comm_get
 #define chpl_comm_put_strd use_chpl_gen_comm_put_strd
 #define chpl_comm_get_strd use_chpl_gen_comm_get_strd
+#define chpl_comm_put_v use_chpl_gen_comm_put_v
+#define chpl_comm_get_v use_chpl_gen_comm_get_v
@@ -462,6 +462,22 @@ void chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode,
                         int32_t stridelevels, size_t elemSize, int32_t commID,
                         int ln, int32_t fn);
 
+//
+// put 'n' contiguous pieces of local data to remote data on locale
+// 'node': piece i is 'sizes[i]' bytes from local 'addrs[i]' to remote
+// 'raddrs[i]'.  This is equivalent to calling chpl_comm_put() for each
+// piece, but lets the comm layer initiate the pieces together.  All of
+// them are complete when this returns.
+//
+void chpl_comm_put_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn);
+
+//
+// same as chpl_comm_put_v(), but do get instead
+//
+void chpl_comm_get_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn);
+
 
 //
 // Unordered ops
@@ -536,6 +552,18 @@ void chpl_comm_task_create(void) {
 }
 
 
+// This is a hook that's called when a task is about to wait for the
+// tasks it created to finish.
+#ifndef CHPL_COMM_IMPL_TASK_JOIN
+#define CHPL_COMM_IMPL_TASK_JOIN() \
+        return
+#endif
+static inline
+void chpl_comm_task_join(void) {
+  CHPL_COMM_IMPL_TASK_JOIN();
+}
+
+
 // This is a hook that's called when a task is ending. It allows for things
 // like say flushing task private buffers.
 #ifndef CHPL_COMM_IMPL_TASK_END
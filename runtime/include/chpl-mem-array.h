@@ -50,10 +50,49 @@ chpl_bool chpl_mem_size_justifies_comm_alloc(size_t size) {
 }
 
 
+//
+// Placement hints for array element storage.  These are bit flags and
+// can be combined.  CHPL_MEM_ARRAY_HINT_DEFAULT means "use whatever
+// the CHPL_RT_ARRAY_* environment variables ask for".
+//
+typedef enum {
+  CHPL_MEM_ARRAY_HINT_DEFAULT     = -1,
+  CHPL_MEM_ARRAY_HINT_NONE        = 0x0,
+  CHPL_MEM_ARRAY_HINT_HUGE_PAGES  = 0x1,  // madvise(MADV_HUGEPAGE)
+  CHPL_MEM_ARRAY_HINT_INTERLEAVE  = 0x2,  // interleave over NUMA domains
+  CHPL_MEM_ARRAY_HINT_FIRST_TOUCH = 0x4,  // parallel first touch
+} chpl_mem_array_hint_t;
+
+//
+// Alignment used for allocations that get the huge pages hint, so
+// that the whole allocation can be backed by transparent huge pages.
+//
+#define CHPL_MEM_ARRAY_HUGE_PAGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+//
+// Array memory placement policy (see chpl-mem-array.c).
+//
+void chpl_mem_array_policy_init(void);
+chpl_bool chpl_mem_array_policy_needsTopo(void);
+int chpl_mem_array_policy_resolve(size_t, int);
+void chpl_mem_array_policy_apply(void*, size_t, int);
+chpl_bool chpl_mem_array_policy_wantsFirstTouch(size_t);
+void chpl_mem_array_policy_report(void);
+void chpl_mem_array_pool_exit(void);
+size_t chpl_mem_array_pool_allocSize(size_t);
+void chpl_mem_array_pool_noteAlloc(void*, size_t, c_sublocid_t);
+void* chpl_mem_array_pool_get(size_t, c_sublocid_t);
+chpl_bool chpl_mem_array_pool_put(void*, size_t);
+void chpl_mem_array_pool_getCounts(uint64_t*, uint64_t*);
+void chpl_mem_array_advise(void*, size_t, size_t, int);
+void chpl_mem_array_touch(void*, size_t, size_t, size_t);
+
+
 static inline
-void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
-                           c_sublocid_t subloc, chpl_bool* callPostAlloc,
-                           int32_t lineno, int32_t filename) {
+void* chpl_mem_array_alloc_hint(size_t nmemb, size_t eltSize,
+                                c_sublocid_t subloc, int memHint,
+                                chpl_bool* callPostAlloc, chpl_bool* isZero,
+                                int32_t lineno, int32_t filename) {
   //
   // To support dynamic array registration by comm layers, in addition
   // to the address to the allocated memory this returns either true or
@@ -66,12 +105,21 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
   // actual registration.  This is how we get NUMA locality correct on
   // registered memory, when that is possible.
   //
+  // If isZero is non-NULL the caller would like zeroed memory, and we
+  // set *isZero to say whether we were able to provide it cheaply.  We
+  // only do so for fresh memory from the memory layer, where calloc()
+  // can often hand back pages the OS has already zeroed.  Pooled and
+  // comm layer memory is returned as is, with *isZero==false.
+  //
   chpl_memhook_malloc_pre(nmemb, eltSize, CHPL_RT_MD_ARRAY_ELEMENTS,
                           lineno, filename);
 
   const size_t size = nmemb * eltSize;
   void* p = NULL;
   *callPostAlloc = false;
+  if (isZero != NULL) {
+    *isZero = false;
+  }
   if (chpl_mem_size_justifies_comm_alloc(size)) {
     p = chpl_comm_regMemAlloc(size, CHPL_RT_MD_ARRAY_ELEMENTS,
                               lineno, filename);
@@ -81,7 +129,43 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
   }
 
   if (p == NULL) {
-    p = chpl_malloc(nmemb * eltSize);
+    //
+    // Placement hints only apply to memory we get from the memory
+    // layer, and only when the caller isn't asking for a particular
+    // sublocale (the locale models with sublocales do their own
+    // localization).
+    //
+    const int hint = (subloc == c_sublocid_none || subloc == c_sublocid_any)
+                     ? chpl_mem_array_policy_resolve(size, memHint)
+                     : CHPL_MEM_ARRAY_HINT_NONE;
+
+    //
+    // Recently freed array storage of the same size can be reused, as
+    // long as no explicit hint asks for different placement.  It will
+    // already have had the policy placement applied.
+    //
+    if (memHint == CHPL_MEM_ARRAY_HINT_DEFAULT) {
+      p = chpl_mem_array_pool_get(size, subloc);
+    }
+
+    if (p == NULL) {
+      const size_t allocSize = chpl_mem_array_pool_allocSize(size);
+      if ((hint & CHPL_MEM_ARRAY_HINT_HUGE_PAGES) != 0) {
+        p = chpl_memalign(CHPL_MEM_ARRAY_HUGE_PAGE_SIZE, allocSize);
+      } else if (isZero != NULL) {
+        p = chpl_calloc(1, allocSize);
+        *isZero = (p != NULL);
+      } else {
+        p = chpl_malloc(allocSize);
+      }
+
+      if (p != NULL) {
+        chpl_mem_array_pool_noteAlloc(p, size, subloc);
+        if (hint != CHPL_MEM_ARRAY_HINT_NONE) {
+          chpl_mem_array_policy_apply(p, size, hint);
+        }
+      }
+    }
   }
 
   chpl_memhook_malloc_post(p, nmemb, eltSize, CHPL_RT_MD_ARRAY_ELEMENTS,
@@ -91,6 +175,27 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
 }
 
 
+static inline
+void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
+                           c_sublocid_t subloc, chpl_bool* callPostAlloc,
+                           int32_t lineno, int32_t filename) {
+  return chpl_mem_array_alloc_hint(nmemb, eltSize, subloc,
+                                   CHPL_MEM_ARRAY_HINT_DEFAULT, callPostAlloc,
+                                   NULL, lineno, filename);
+}
+
+
+static inline
+void* chpl_mem_array_alloc_zero(size_t nmemb, size_t eltSize,
+                                c_sublocid_t subloc, chpl_bool* callPostAlloc,
+                                chpl_bool* isZero,
+                                int32_t lineno, int32_t filename) {
+  return chpl_mem_array_alloc_hint(nmemb, eltSize, subloc,
+                                   CHPL_MEM_ARRAY_HINT_DEFAULT, callPostAlloc,
+                                   isZero, lineno, filename);
+}
+
+
 static inline
 void chpl_mem_array_postAlloc(void* p, size_t nmemb, size_t eltSize,
                               int32_t lineno, int32_t filename) {
@@ -129,7 +234,10 @@ void* chpl_mem_array_realloc(void* p, size_t oldNmemb, size_t newNmemb,
   }
 
   if (newp == NULL) {
-    newp = chpl_realloc(p, newSize);
+    newp = chpl_realloc(p, chpl_mem_array_pool_allocSize(newSize));
+    if (newp != NULL) {
+      chpl_mem_array_pool_noteAlloc(newp, newSize, subloc);
+    }
   }
 
   chpl_memhook_realloc_post(newp, p, newSize, CHPL_RT_MD_ARRAY_ELEMENTS,
@@ -160,8 +268,9 @@ void chpl_mem_array_free(void* p,
   //
   // If the size indicates we might have gotten this memory from the
   // comm layer then try to free it there.  If not, or if so but the
-  // comm layer says it didn't come from there, free it in the memory
-  // layer.
+  // comm layer says it didn't come from there, try to keep it in the
+  // array storage pool for reuse, and if that's not possible free it
+  // in the memory layer.
   //
   chpl_memhook_free_pre(p, lineno, filename);
 
@@ -171,6 +280,10 @@ void chpl_mem_array_free(void* p,
     return;
   }
 
+  if (chpl_mem_array_pool_put(p, size)) {
+    return;
+  }
+
   chpl_free(p);
 }
 
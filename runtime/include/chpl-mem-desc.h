@@ -70,6 +70,7 @@ extern "C" {
   m(STR_CONCAT_DATA,      "string concat data",                       true ), \
   m(STR_MOVE_DATA,        "string move data",                         true ), \
   m(STR_SELECT_DATA,      "string select data",                       true ), \
+  m(STR_CP_INDEX,         "string codepoint index",                   true ), \
   m(CFG_ARG_COPY_DATA,    "config arg copy data",                     true ), \
   m(CF_TABLE_DATA,        "config table data",                        true ), \
   m(LOCALE_NAME_BUF,      "locale name buffer",                       true ), \
@@ -91,6 +92,10 @@ extern "C" {
   m(GMP,                  "gmp data",                                 true ), \
   m(GETS_PUTS_STRIDES,    "put_strd/get_strd array of strides",       true ), \
   m(MLI_DATA,             "multilocale interop data",                 true ), \
+  m(ARRAY_POOL_DESC,      "array storage pool descriptor",            false), \
+  m(TASK_DIAGS_DATA,      "task diagnostics data",                    false), \
+  m(COMM_PROFILE_DATA,    "comm profile data",                        false), \
+  m(VDEBUG_TRACE_DATA,    "visual debug trace buffer",                false), \
   m(NUM,                  "*** this must be the last entry ***",      true )
 
 
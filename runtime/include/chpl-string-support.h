@@ -85,6 +85,24 @@ int string_index_of(c_string x, c_string y);
 c_string string_index(c_string x, int i, int32_t lineno, int32_t filename);
 c_string string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename);
 
+//
+// UTF-8 support for Chapel strings
+//
+
+// Checks that buf[0..len) is valid UTF-8, also accepting the codepoints
+// strings use to escape undecodable bytes if allow_escape is set.  Returns
+// 0 if it is and -1 if not, and stores the number of codepoints in *num_cp.
+int chpl_string_validate_utf8(const uint8_t* buf, int64_t len,
+                              chpl_bool allow_escape, int64_t* num_cp);
+
+// Returns the number of codepoints in buf[0..len), which must be valid.
+int64_t chpl_string_count_codepoints(const uint8_t* buf, int64_t len);
+
+// Returns the byte offset of the codepoint 'cp' codepoints past the one
+// starting at byte 'start', or len if there are not that many.
+int64_t chpl_string_codepoint_offset(const uint8_t* buf, int64_t len,
+                                     int64_t start, int64_t cp);
+
 #ifdef __cplusplus
 }
 #endif
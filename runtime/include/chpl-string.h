@@ -47,6 +47,29 @@ typedef struct chpl__inPlaceBuffer_t {
 uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf);
 uint8_t* chpl__getInPlaceBufferDataForWrite(chpl__inPlaceBuffer* buf);
 
+//
+// Buffers shared by copies of a string or bytes.  A reference count lives
+// just in front of the returned pointer; the buffer is freed by the release
+// that drops the count to zero.
+//
+uint8_t* chpl_string_shared_alloc(size_t size, int32_t lineno,
+                                  int32_t filename);
+uint8_t* chpl_string_shared_realloc(uint8_t* buf, size_t size,
+                                    int32_t lineno, int32_t filename);
+void chpl_string_shared_retain(uint8_t* buf);
+void chpl_string_shared_release(uint8_t* buf, int32_t lineno,
+                                int32_t filename);
+chpl_bool chpl_string_shared_is_unique(uint8_t* buf);
+
+//
+// Large shared buffers also cache a sparse index from codepoint number to
+// byte offset, built on first use.  The sole owner of a buffer must
+// invalidate it before changing the contents in place.
+//
+int64_t chpl_string_shared_codepoint_offset(uint8_t* buf, int64_t len,
+                                            int64_t cp);
+void chpl_string_shared_invalidate(uint8_t* buf);
+
 #ifdef __cplusplus
 }
 #endif
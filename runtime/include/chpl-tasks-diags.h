@@ -0,0 +1,132 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_tasks_diags_h_
+#define _chpl_tasks_diags_h_
+
+#include "chpltypes.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+////////////////////
+//
+// Public
+//
+
+extern int chpl_task_diagnostics; // set via startTaskDiagnostics
+
+//
+// Per-worker task counters.  Times are in nanoseconds.  The average
+// task granularity is run_ns / tasks_run, and the average queue depth
+// seen when starting a task is queue_depth_sum / tasks_run.
+//
+#define CHPL_TASK_DIAGS_VARS_ALL(MACRO) \
+  MACRO(tasks_spawned) \
+  MACRO(tasks_run) \
+  MACRO(run_ns) \
+  MACRO(steals) \
+  MACRO(idle_ns) \
+  MACRO(sync_waits) \
+  MACRO(sync_wait_ns) \
+  MACRO(queue_depth_sum) \
+  MACRO(queue_depth_max)
+
+
+typedef struct _chpl_taskDiagnostics {
+#define _TASK_DIAGS_DECL(tdv) uint64_t tdv;
+  CHPL_TASK_DIAGS_VARS_ALL(_TASK_DIAGS_DECL)
+#undef _TASK_DIAGS_DECL
+} chpl_taskDiagnostics;
+
+void chpl_task_diags_init(void);
+void chpl_task_diags_exit(void);
+
+void chpl_task_startDiagnosticsHere(void);
+void chpl_task_stopDiagnosticsHere(void);
+void chpl_task_resetDiagnosticsHere(void);
+
+//
+// Workers are numbered 0..n-1 in the order in which they first did
+// something countable.  Asking for worker -1 gets the sum over all of
+// them (with the maximum, for queue_depth_max).
+//
+int chpl_task_getNumDiagnosticsWorkersHere(void);
+void chpl_task_getDiagnosticsHere(int, chpl_taskDiagnostics*);
+void chpl_task_printDiagnosticsHere(void);
+
+
+////////////////////
+//
+// Private: hooks for the tasking layers.
+//
+// A task blocked in a sync variable wait isn't counted as running
+// until the wait is over.  Tasking layers that don't report
+// idle time themselves get it computed as the time not spent running
+// tasks.
+//
+void chpl_task_diags_spawn_(void);
+void chpl_task_diags_taskBegin_(uint64_t);
+void chpl_task_diags_taskEnd_(void);
+void chpl_task_diags_idleBegin_(void);
+void chpl_task_diags_idleEnd_(void);
+uint64_t chpl_task_diags_waitBegin_(void);
+void chpl_task_diags_waitEnd_(uint64_t);
+void chpl_task_diags_steal_(void);
+
+#define chpl_task_diags_spawn()                                         \
+  do { if (chpl_task_diagnostics) chpl_task_diags_spawn_(); } while (0)
+
+#define chpl_task_diags_taskBegin(queueDepth)                           \
+  do {                                                                  \
+    if (chpl_task_diagnostics) chpl_task_diags_taskBegin_(queueDepth);  \
+  } while (0)
+
+#define chpl_task_diags_taskEnd()                                       \
+  do { if (chpl_task_diagnostics) chpl_task_diags_taskEnd_(); } while (0)
+
+#define chpl_task_diags_idleBegin()                                     \
+  do { if (chpl_task_diagnostics) chpl_task_diags_idleBegin_(); } while (0)
+
+#define chpl_task_diags_idleEnd()                                       \
+  do { if (chpl_task_diagnostics) chpl_task_diags_idleEnd_(); } while (0)
+
+#define chpl_task_diags_steal()                                         \
+  do { if (chpl_task_diagnostics) chpl_task_diags_steal_(); } while (0)
+
+static inline
+uint64_t chpl_task_diags_waitBegin(void) {
+  return chpl_task_diagnostics ? chpl_task_diags_waitBegin_() : 0;
+}
+
+static inline
+void chpl_task_diags_waitEnd(uint64_t startTime) {
+  if (startTime != 0)
+    chpl_task_diags_waitEnd_(startTime);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
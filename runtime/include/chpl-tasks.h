@@ -210,6 +210,34 @@ void chpl_task_addToTaskList(
          int32_t);           // name of file containing function
 void chpl_task_executeTasksInList(void**);
 
+//
+// Called by the parent of a cobegin or bounded coforall before it adds
+// the tasks, when it will not block until it calls executeTasksInList().
+// The tasking layer may then hold the tasks back until that call, to
+// start them all at once.  Otherwise it must start each task when it is
+// added, because the parent may wait for one of them before adding the
+// next.
+//
+void chpl_task_deferTasksInList(void**);
+
+//
+// Like addToTaskList(), but for a task the compiler has proven to run
+// to completion once started: it cannot wait for another task, create
+// one, or move to another locale.  Such a task need not get a call
+// stack of its own.  The tasking layer may instead run it on the stack
+// of another task, one after the other with other such tasks.
+//
+void chpl_task_addStacklessToTaskList(
+         chpl_fn_int_t,      // function to call for task
+         chpl_task_bundle_t*,// argument to the function
+         size_t,             // length of the argument
+         c_sublocid_t,       // desired sublocale
+         void**,             // task list
+         c_nodeid_t,         // locale (node) where task list resides
+         chpl_bool,          // is begin{} stmt?  (vs. cobegin or coforall)
+         int,                // line at which function begins
+         int32_t);           // name of file containing function
+
 //
 // Call a chpl_ftable[] function in a task.
 //
@@ -306,6 +334,18 @@ char* chpl_task_idToString(
 //
 void chpl_task_yield(void);
 
+//
+// Back off while waiting for another task, for example to fill a sync
+// variable or set an atomic one.  The waiter calls this each time it
+// finds it still has to wait, with *iter set to 0 before the first
+// call.  The first calls just spin briefly, in case the wait is short,
+// and the next ones yield.  Once those are used up it returns false
+// without waiting, and a waiter that can block until it is woken
+// should do so.  The numbers of spins and yields are taken from
+// CHPL_RT_WAIT_SPINS and CHPL_RT_WAIT_YIELDS.
+//
+chpl_bool chpl_task_waitBackoff(uint32_t* iter);
+
 //
 // Suspend.
 //
@@ -55,6 +55,41 @@ int chpl_topo_getNumCPUsLogical(chpl_bool /*accessible_only*/);
 //
 int chpl_topo_getNumNumaDomains(void);
 
+//
+// What does the data cache hierarchy look like?
+//
+// Levels are numbered from 1 (closest to the cores).  For each level
+// chpl_topo_getCacheInfo() fills in the size and line size in bytes,
+// the associativity (0 if unknown, -1 if fully associative), and the
+// number of PUs that share one instance of the cache (0 if unknown).
+// Levels that don't exist or can't be determined are all zeroes.
+//
+#define CHPL_TOPO_MAX_CACHE_LEVELS 5
+
+typedef struct {
+  size_t size;
+  size_t lineSize;
+  int associativity;
+  int numSharingPUs;
+} chpl_topo_cacheInfo_t;
+
+int chpl_topo_getNumCacheLevels(void);
+void chpl_topo_getCacheInfo(int, chpl_topo_cacheInfo_t*);
+
+//
+// How closely are two PUs (given by OS index) related in the hardware
+// hierarchy?  Smaller is closer.  The tasking layer uses this to make
+// work-stealing victims nearby PUs before faraway ones.
+//
+typedef enum {
+  chpl_topo_pu_same = 0,        // the same PU
+  chpl_topo_pu_sharesL2,        // share an L2 (or closer) cache
+  chpl_topo_pu_sharesL3,        // share a deeper cache or a NUMA domain
+  chpl_topo_pu_remote           // share nothing but the node
+} chpl_topo_puDistance_t;
+
+chpl_topo_puDistance_t chpl_topo_getPUDistance(int, int);
+
 //
 // set the sublocale where the current thread is running
 //
@@ -90,6 +125,18 @@ void chpl_topo_setMemLocality(void*, size_t, chpl_bool, c_sublocid_t);
 //
 void chpl_topo_setMemSubchunkLocality(void*, size_t, chpl_bool, size_t*);
 
+//
+// interleave the pages of a block of memory across all the NUMA
+// domains, returning whether or not that could be done
+//
+// args:
+//   base address
+//   size (bytes)
+//   onlyInside?  true: only localize pages strictly within the memory
+//                false: also localize partial pages at edges
+//
+chpl_bool chpl_topo_interleaveMemLocality(void*, size_t, chpl_bool);
+
 //
 // touch a block of memory, while running on a given NUMA domain
 //
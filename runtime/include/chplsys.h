@@ -35,6 +35,13 @@ uint64_t chpl_sys_physicalMemoryBytes(void);
 int chpl_sys_getNumCPUsPhysical(chpl_bool accessible_only);
 int chpl_sys_getNumCPUsLogical(chpl_bool accessible_only);
 
+//
+// returns info about the data (or unified) cache at the given level
+// (1-based), or false if the system can't tell us about it
+//
+chpl_bool chpl_sys_getCacheInfo(int level, size_t* size, size_t* lineSize,
+                                int* assoc, int* numSharingPUs);
+
 //
 // returns the name of a locale via uname -n or the like
 //
@@ -61,6 +61,10 @@ void chpl_comm_impl_unordered_task_fence(void);
         chpl_comm_impl_task_create()
 void chpl_comm_impl_task_create(void);
 
+#define CHPL_COMM_IMPL_TASK_JOIN() \
+        chpl_comm_impl_task_join()
+void chpl_comm_impl_task_join(void);
+
 #define CHPL_COMM_IMPL_TASK_END() \
         chpl_comm_impl_task_end()
 void chpl_comm_impl_task_end(void);
@@ -46,6 +46,7 @@ typedef struct {
   void* amo_nf_buff;
   void* get_buff;
   void* put_buff;
+  void* am_agg_buff;            // aggregated nonblocking executeOns
 } chpl_comm_taskPrvData_t;
 
 //
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_comm_impl_h_
+#define _chpl_comm_impl_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// This is the comm layer sub-interface for dynamic allocation and
+// registration of memory.  With a memory layer that can manage a fixed
+// heap, each locale's heap is its own slice of a segment mapped at the
+// same address in every locale process.
+//
+#define CHPL_COMM_IMPL_REG_MEM_HEAP_INFO(start_p, size_p) \
+    chpl_comm_impl_regMemHeapInfo(start_p, size_p)
+void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
+
+#ifdef __cplusplus
+}
+#endif
+
+//
+// Network atomic operations.  These are processor atomics when the
+// target is reachable directly, and active messages otherwise.
+//
+#include "chpl-comm-native-atomics.h"
+
+#endif // _chpl_comm_impl_h_
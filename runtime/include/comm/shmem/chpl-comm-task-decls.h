@@ -0,0 +1,53 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _COMM_TASK_DECLS_H_
+#define _COMM_TASK_DECLS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The type of task private data.
+typedef struct {
+  int8_t dummy;    // structs must be nonempty
+} chpl_comm_taskPrvData_t;
+
+//
+// Comm layer private area within executeOn argument bundles
+// (bundle.comm)
+typedef struct {
+  int caller;
+
+  void* ack; // address on caller to post acknowledgement
+} chpl_comm_bundleData_t;
+
+// The type of the communication handle.
+typedef void* chpl_comm_nb_handle_t;
+
+#undef HAS_CHPL_CACHE_FNS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
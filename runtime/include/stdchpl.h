@@ -63,6 +63,7 @@
 #include "chpl-string.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
+#include "chpl-tasks-diags.h"
 #include "chpltimers.h"
 #include "chpl-topo.h"
 #include "chpltypes.h"
@@ -61,7 +61,7 @@ typedef unsigned int chpl_taskID_t;
 //
 typedef struct {
     aligned_t lock;
-    int       is_full;
+    volatile int is_full;
     aligned_t signal_full;
     aligned_t signal_empty;
 } chpl_sync_aux_t;
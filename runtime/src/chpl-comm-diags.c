@@ -25,20 +25,31 @@
 #include "chplrt.h"
 #include "chpl-env-gen.h"
 
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
 #include "chpl-comm-diags.h"
 #include "chpl-comm-internal.h"
+#include "chpl-comm-no-warning-macros.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
 #include "chpl-mem-consistency.h"
+#include "chpl-thread-local-storage.h"
 #include "error.h"
 
+#include <errno.h>
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 int chpl_verbose_comm = 0;
 int chpl_verbose_comm_stacktrace = 0;
 int chpl_comm_diagnostics = 0;
 int chpl_comm_diags_print_unstable = 0;
+int chpl_comm_profiling = 0;
+int chpl_comm_profile_latency = 0;
 
 atomic_int_least16_t chpl_comm_diags_disable_flag;
 chpl_atomic_commDiagnostics chpl_comm_diags_counters;
@@ -143,3 +154,389 @@ void chpl_comm_resetDiagnosticsHere() {
 void chpl_comm_getDiagnosticsHere(chpl_commDiagnostics *cd) {
   chpl_comm_diags_copy(cd);
 }
+
+
+//
+// Communication profiling.
+//
+// Each thread that initiates communication gets its own open-addressed
+// hash table of profile entries, keyed by operation, call site, and
+// target node.  The tables are on a list so that they can be merged
+// when someone asks for the profile.  The per-table lock is only
+// contended when a merge or reset is going on.
+//
+
+typedef struct profile_table {
+  struct profile_table* next;
+  atomic_spinlock_t lock;
+  int64_t size;                     // power of 2
+  int64_t used;
+  chpl_commProfileEntry* entries;   // op == NULL means empty
+} profile_table_t;
+
+static profile_table_t* tables_head = NULL;
+static atomic_spinlock_t tables_lock;
+
+static CHPL_TLS_DECL(profile_table_t*, my_table);
+
+static const char* profile_file = NULL;
+static chpl_bool profile_at_exit = false;
+
+
+static inline
+uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+
+static inline
+uint64_t profile_hash(const char* op, int32_t node, int32_t ln, int32_t fn) {
+  uint64_t h = 14695981039346656037ULL;
+  for (const char* p = op; *p != '\0'; p++)
+    h = (h ^ (uint8_t) *p) * 1099511628211ULL;
+  h = (h ^ (uint32_t) node) * 1099511628211ULL;
+  h = (h ^ (uint32_t) ln) * 1099511628211ULL;
+  h = (h ^ (uint32_t) fn) * 1099511628211ULL;
+  return h ^ (h >> 29);
+}
+
+
+static inline
+chpl_bool profile_key_eq(chpl_commProfileEntry* e, const char* op,
+                         int32_t node, int32_t ln, int32_t fn) {
+  return (e->node == node && e->ln == ln && e->fn == fn
+          && (e->op == op || strcmp(e->op, op) == 0));
+}
+
+
+//
+// Find the entry for a key, adding it if need be.  Table entries are
+// never removed except by a reset, which empties the whole table.
+//
+static
+chpl_commProfileEntry* profile_find(chpl_commProfileEntry* entries,
+                                    int64_t size, const char* op,
+                                    int32_t node, int32_t ln, int32_t fn,
+                                    chpl_bool* added) {
+  int64_t i = (int64_t) (profile_hash(op, node, ln, fn) & (size - 1));
+  *added = false;
+  while (entries[i].op != NULL) {
+    if (profile_key_eq(&entries[i], op, node, ln, fn))
+      return &entries[i];
+    i = (i + 1) & (size - 1);
+  }
+  entries[i].op = op;
+  entries[i].node = node;
+  entries[i].ln = ln;
+  entries[i].fn = fn;
+  *added = true;
+  return &entries[i];
+}
+
+
+static
+void profile_table_grow(profile_table_t* t) {
+  int64_t newSize = (t->size == 0) ? 64 : 2 * t->size;
+  chpl_commProfileEntry* newEntries
+    = chpl_mem_allocManyZero(newSize, sizeof(*newEntries),
+                             CHPL_RT_MD_COMM_PROFILE_DATA, 0, 0);
+  for (int64_t i = 0; i < t->size; i++) {
+    chpl_commProfileEntry* e = &t->entries[i];
+    if (e->op != NULL) {
+      chpl_bool added;
+      *profile_find(newEntries, newSize, e->op, e->node, e->ln, e->fn, &added)
+        = *e;
+    }
+  }
+  if (t->entries != NULL)
+    chpl_mem_free(t->entries, 0, 0);
+  t->entries = newEntries;
+  t->size = newSize;
+}
+
+
+static
+profile_table_t* get_table(void) {
+  profile_table_t* t = (profile_table_t*) CHPL_TLS_GET(my_table);
+  if (t == NULL) {
+    t = (profile_table_t*) chpl_mem_allocManyZero(1, sizeof(*t),
+                                                  CHPL_RT_MD_COMM_PROFILE_DATA,
+                                                  0, 0);
+    atomic_init_spinlock_t(&t->lock);
+
+    atomic_lock_spinlock_t(&tables_lock);
+    t->next = tables_head;
+    tables_head = t;
+    atomic_unlock_spinlock_t(&tables_lock);
+
+    CHPL_TLS_SET(my_table, t);
+  }
+  return t;
+}
+
+
+//
+// Callers hold the table lock.
+//
+static
+chpl_commProfileEntry* get_entry(profile_table_t* t, const char* op,
+                                 int32_t node, int32_t ln, int32_t fn) {
+  chpl_bool added;
+  chpl_commProfileEntry* e;
+
+  // Keep the load factor at or below 1/2.
+  if (2 * (t->used + 1) > t->size)
+    profile_table_grow(t);
+  e = profile_find(t->entries, t->size, op, node, ln, fn, &added);
+  if (added)
+    t->used++;
+  return e;
+}
+
+
+static inline
+int size_bin(size_t size) {
+  int bin = 0;
+  while (bin < CHPL_COMM_PROFILE_NUM_SIZE_BINS - 1
+         && size > ((size_t) 8 << bin))
+    bin++;
+  return bin;
+}
+
+
+void chpl_comm_profile_record(const char* op, c_nodeid_t node, size_t size,
+                              int32_t ln, int32_t fn) {
+  profile_table_t* t = get_table();
+  chpl_commProfileEntry* e;
+
+  atomic_lock_spinlock_t(&t->lock);
+  e = get_entry(t, op, (int32_t) node, ln, fn);
+  e->count++;
+  e->num_bytes += size;
+  e->size_bins[size_bin(size)]++;
+  atomic_unlock_spinlock_t(&t->lock);
+}
+
+
+static
+void profile_record_latency(const char* op, c_nodeid_t node,
+                            int32_t ln, int32_t fn, uint64_t ns) {
+  profile_table_t* t = get_table();
+  chpl_commProfileEntry* e;
+
+  atomic_lock_spinlock_t(&t->lock);
+  e = get_entry(t, op, (int32_t) node, ln, fn);
+  e->timed_count++;
+  e->latency_ns += ns;
+  if (ns > e->latency_max_ns)
+    e->latency_max_ns = ns;
+  atomic_unlock_spinlock_t(&t->lock);
+}
+
+
+//
+// Generated code calls these instead of chpl_comm_get() and
+// chpl_comm_put() when latency is being measured.  The comm layer
+// counts the operation itself; all we add is how long it took.
+//
+void chpl_comm_profile_timed_get(void* addr, c_nodeid_t node, void* raddr,
+                                 size_t size, int32_t commID,
+                                 int ln, int32_t fn) {
+  uint64_t start = now_ns();
+  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+  if (chpl_comm_profiling && chpl_comm_diags_is_enabled())
+    profile_record_latency("get", node, ln, fn, now_ns() - start);
+}
+
+
+void chpl_comm_profile_timed_put(void* addr, c_nodeid_t node, void* raddr,
+                                 size_t size, int32_t commID,
+                                 int ln, int32_t fn) {
+  uint64_t start = now_ns();
+  chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+  if (chpl_comm_profiling && chpl_comm_diags_is_enabled())
+    profile_record_latency("put", node, ln, fn, now_ns() - start);
+}
+
+
+void chpl_comm_startProfile(chpl_bool latency) {
+  // Make sure that there are no pending communication operations.
+  chpl_rmem_consist_release(0, 0);
+
+  chpl_comm_profiling = 1;
+  chpl_comm_profile_latency = (latency == true);
+  chpl_comm_diags_disable();
+  chpl_comm_bcast_rt_private(chpl_comm_profile_latency);
+  chpl_comm_bcast_rt_private(chpl_comm_profiling);
+  chpl_comm_diags_enable();
+}
+
+
+void chpl_comm_stopProfile(void) {
+  // Make sure that there are no pending communication operations.
+  chpl_rmem_consist_release(0, 0);
+
+  chpl_comm_profiling = 0;
+  chpl_comm_profile_latency = 0;
+  chpl_comm_diags_disable();
+  chpl_comm_bcast_rt_private(chpl_comm_profiling);
+  chpl_comm_bcast_rt_private(chpl_comm_profile_latency);
+  chpl_comm_diags_enable();
+}
+
+
+void chpl_comm_startProfileHere(chpl_bool latency) {
+  chpl_rmem_consist_release(0, 0);
+  chpl_comm_profile_latency = (latency == true);
+  chpl_comm_profiling = 1;
+}
+
+
+void chpl_comm_stopProfileHere(void) {
+  chpl_rmem_consist_release(0, 0);
+  chpl_comm_profiling = 0;
+  chpl_comm_profile_latency = 0;
+}
+
+
+void chpl_comm_resetProfileHere(void) {
+  profile_table_t* t;
+
+  atomic_lock_spinlock_t(&tables_lock);
+  for (t = tables_head; t != NULL; t = t->next) {
+    atomic_lock_spinlock_t(&t->lock);
+    if (t->entries != NULL)
+      memset(t->entries, 0, t->size * sizeof(t->entries[0]));
+    t->used = 0;
+    atomic_unlock_spinlock_t(&t->lock);
+  }
+  atomic_unlock_spinlock_t(&tables_lock);
+}
+
+
+int64_t chpl_comm_getProfileHere(chpl_commProfileEntry** entries) {
+  profile_table_t* t;
+  profile_table_t merged = { 0 };
+
+  atomic_lock_spinlock_t(&tables_lock);
+  for (t = tables_head; t != NULL; t = t->next) {
+    atomic_lock_spinlock_t(&t->lock);
+    for (int64_t i = 0; i < t->size; i++) {
+      chpl_commProfileEntry* src = &t->entries[i];
+      chpl_commProfileEntry* dst;
+      if (src->op == NULL)
+        continue;
+      dst = get_entry(&merged, src->op, src->node, src->ln, src->fn);
+      dst->count += src->count;
+      dst->num_bytes += src->num_bytes;
+      for (int b = 0; b < CHPL_COMM_PROFILE_NUM_SIZE_BINS; b++)
+        dst->size_bins[b] += src->size_bins[b];
+      dst->timed_count += src->timed_count;
+      dst->latency_ns += src->latency_ns;
+      if (src->latency_max_ns > dst->latency_max_ns)
+        dst->latency_max_ns = src->latency_max_ns;
+    }
+    atomic_unlock_spinlock_t(&t->lock);
+  }
+  atomic_unlock_spinlock_t(&tables_lock);
+
+  // Squeeze out the empty slots.
+  int64_t n = 0;
+  for (int64_t i = 0; i < merged.size; i++) {
+    if (merged.entries[i].op != NULL)
+      merged.entries[n++] = merged.entries[i];
+  }
+  *entries = merged.entries;
+  return n;
+}
+
+
+void chpl_comm_freeProfileHere(chpl_commProfileEntry* entries) {
+  if (entries != NULL)
+    chpl_mem_free(entries, 0, 0);
+}
+
+
+uint64_t chpl_comm_getProfileSizeBin(chpl_commProfileEntry* entries,
+                                     int64_t i, int bin) {
+  return entries[i].size_bins[bin];
+}
+
+
+//
+// CSV output of a profile, for the CommDiagnostics module.  These
+// return 0 on success or an errno value.
+//
+int chpl_comm_profileOpenFile(const char* filename, void** fp) {
+  FILE* f;
+
+  if ((f = fopen(filename, "w")) == NULL)
+    return errno;
+
+  fprintf(f, "from,operation,to,file,line,count,bytes");
+  for (int b = 0; b < CHPL_COMM_PROFILE_NUM_SIZE_BINS - 1; b++)
+    fprintf(f, ",le_%zu", (size_t) 8 << b);
+  fprintf(f, ",gt_%zu,timed,latency_ns,max_latency_ns\n",
+          (size_t) 8 << (CHPL_COMM_PROFILE_NUM_SIZE_BINS - 2));
+
+  *fp = f;
+  return 0;
+}
+
+
+void chpl_comm_profileWriteRow(void* fp, int64_t from, const char* op,
+                               int64_t to, const char* file, int64_t line,
+                               uint64_t count, uint64_t bytes,
+                               const uint64_t* size_bins,
+                               uint64_t timed_count, uint64_t latency_ns,
+                               uint64_t latency_max_ns) {
+  FILE* f = (FILE*) fp;
+
+  fprintf(f, "%" PRId64 ",%s,%" PRId64 ",%s,%" PRId64 ",%" PRIu64 ",%" PRIu64,
+          from, op, to, file, line, count, bytes);
+  for (int b = 0; b < CHPL_COMM_PROFILE_NUM_SIZE_BINS; b++)
+    fprintf(f, ",%" PRIu64, size_bins[b]);
+  fprintf(f, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+          timed_count, latency_ns, latency_max_ns);
+}
+
+
+int chpl_comm_profileCloseFile(void* fp) {
+  FILE* f = (FILE*) fp;
+  int err = ferror(f) ? EIO : 0;
+
+  if (fclose(f) != 0 && err == 0)
+    err = errno;
+  return err;
+}
+
+
+void chpl_comm_profile_init(void) {
+  CHPL_TLS_INIT(my_table);
+  atomic_init_spinlock_t(&tables_lock);
+
+  //
+  // With CHPL_RT_COMM_PROFILE set we profile the whole run.  The
+  // CommDiagnostics module merges the profiles of all the locales at
+  // exit, prints a report and writes CHPL_RT_COMM_PROFILE_FILE.
+  //
+  if (chpl_env_rt_get_bool("COMM_PROFILE", false)) {
+    profile_at_exit = true;
+    profile_file = chpl_env_rt_get("COMM_PROFILE_FILE",
+                                   "chpl-comm-profile.csv");
+    chpl_comm_startProfileHere(chpl_env_rt_get_bool("COMM_PROFILE_LATENCY",
+                                                    false));
+  }
+}
+
+
+chpl_bool chpl_comm_profileAtExit(void) {
+  return profile_at_exit;
+}
+
+
+const char* chpl_comm_profileFile(void) {
+  return profile_file;
+}
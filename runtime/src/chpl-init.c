@@ -26,6 +26,7 @@
 #include "chplcgfns.h"
 #include "chpl-cache.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
 #include "chplexit.h"
 #include "chplio.h"
 #include "chpl-init.h"
@@ -33,6 +34,7 @@
 #include "chplmemtrack.h"
 #include "chpl-privatization.h"
 #include "chpl-tasks.h"
+#include "chpl-tasks-diags.h"
 #include "chpl-topo.h"
 #include "chpl-linefile-support.h"
 #include "chplsys.h"
@@ -218,6 +220,8 @@ void chpl_rt_init(int argc, char* argv[]) {
   // Initialize the task management layer.
   //
   chpl_task_init();
+  chpl_task_diags_init();
+  chpl_comm_profile_init();
 
   // Initialize privatization, needs to happen before hitting module init
   chpl_privatization_init();
@@ -0,0 +1,614 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Placement policy and storage pool for large array element
+// allocations.
+//
+// In configurations where array memory comes from the memory layer
+// rather than being registered with the comm layer (comm=none) and
+// the locale model doesn't do its own localization (flat), large
+// arrays can be given transparent huge pages and/or be interleaved
+// across the NUMA domains, under control of these env vars:
+//
+//   CHPL_RT_ARRAY_HUGE_PAGES       bool: madvise(MADV_HUGEPAGE)
+//   CHPL_RT_ARRAY_NUMA_POLICY      none, interleave, or firsttouch
+//   CHPL_RT_ARRAY_MEM_THRESHOLD    only arrays at least this large
+//   CHPL_RT_ARRAY_MEM_REPORT       bool: report what was applied
+//
+// Separately, in any configuration, recently freed large array storage
+// can be kept in a per-(sub)locale pool and handed back out for later
+// arrays of the same size, which saves the allocation and page fault
+// cost for short-lived temporaries created over and over:
+//
+//   CHPL_RT_ARRAY_POOL_SIZE        byte budget for the pool (0: off)
+//
+#include "chplrt.h"
+#include "chpl-env-gen.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chpl-mem-array.h"
+#include "chpl-tasks.h"
+#include "chpl-topo.h"
+#include "chplsys.h"
+#include "error.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+
+static chpl_bool policySupported = false;
+static int policyHint = CHPL_MEM_ARRAY_HINT_NONE;
+static size_t policyThreshold = 2 * CHPL_MEM_ARRAY_HUGE_PAGE_SIZE;
+static chpl_bool policyReport = false;
+
+static atomic_uint_least64_t cntArrays;
+static atomic_uint_least64_t cntArrayBytes;
+static atomic_uint_least64_t cntHuge;
+static atomic_uint_least64_t cntHugeBytes;
+static atomic_uint_least64_t cntHugeFailed;
+static atomic_uint_least64_t cntInterleave;
+static atomic_uint_least64_t cntInterleaveBytes;
+static atomic_uint_least64_t cntInterleaveFailed;
+static atomic_uint_least64_t cntFirstTouch;
+
+
+//
+// Array storage pool.  Freed buffers are threaded onto lists by way
+// of a header written into the buffer itself: one list per power-of-2
+// size bucket for lookup, and one LRU list for eviction when the byte
+// budget would be exceeded.  Reuse requires an exact size match, since
+// the size a buffer is later freed with is all we know about it.
+//
+// Every buffer big enough to be pooled also gets a small trailer past
+// the end of the caller's elements, written when it is allocated, that
+// records the sublocale it was allocated for.  A freed buffer goes back
+// to that sublocale's pool rather than to the pool of whichever
+// sublocale the freeing task happens to be running on, so that reuse
+// keeps it where it was placed.  Using a trailer rather than a header
+// leaves the address and alignment the caller sees unchanged.
+//
+typedef struct {
+  c_sublocid_t subloc;
+} poolTrailer_t;
+
+typedef struct poolBuf_s {
+  struct poolBuf_s* bktNext;            // next in size bucket
+  struct poolBuf_s* lruPrev;            // LRU list, newest at head
+  struct poolBuf_s* lruNext;
+  size_t size;
+} poolBuf_t;
+
+#define POOL_NUM_BUCKETS (8 * sizeof(size_t))
+#define POOL_MIN_BUF_SIZE ((size_t) 64 * 1024)
+
+typedef struct {
+  atomic_spinlock_t lock;
+  poolBuf_t* bkts[POOL_NUM_BUCKETS];
+  poolBuf_t* lruHead;
+  poolBuf_t* lruTail;
+  size_t bytes;
+} pool_t;
+
+static size_t poolBudget = 0;           // per pool; 0 means disabled
+static pool_t* pools = NULL;            // [0]: no subloc, [i+1]: subloc i
+static int numPools = 0;
+
+static atomic_uint_least64_t cntPoolHits;
+static atomic_uint_least64_t cntPoolHitBytes;
+static atomic_uint_least64_t cntPoolMisses;
+static atomic_uint_least64_t cntPoolEvictions;
+
+
+static
+chpl_bool configSupportsPolicy(void) {
+  return (strcmp(CHPL_COMM, "none") == 0
+          && strcmp(CHPL_LOCALE_MODEL, "flat") == 0);
+}
+
+
+static
+int numaPolicyFromEnv(void) {
+  const char* ev = chpl_env_rt_get("ARRAY_NUMA_POLICY", NULL);
+
+  if (ev == NULL || strcmp(ev, "none") == 0) {
+    return CHPL_MEM_ARRAY_HINT_NONE;
+  } else if (strcmp(ev, "interleave") == 0) {
+    return CHPL_MEM_ARRAY_HINT_INTERLEAVE;
+  } else if (strcmp(ev, "firsttouch") == 0) {
+    return CHPL_MEM_ARRAY_HINT_FIRST_TOUCH;
+  }
+
+  if (chpl_nodeID == 0) {
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "CHPL_RT_ARRAY_NUMA_POLICY: unknown policy \"%s\", ignored", ev);
+    chpl_warning(msg, 0, 0);
+  }
+  return CHPL_MEM_ARRAY_HINT_NONE;
+}
+
+
+chpl_bool chpl_mem_array_policy_needsTopo(void) {
+  //
+  // This is called from chpl_topo_init(), before our own init, so it
+  // has to work directly from the environment.
+  //
+  const char* ev = chpl_env_rt_get("ARRAY_NUMA_POLICY", NULL);
+  return (configSupportsPolicy()
+          && ev != NULL
+          && strcmp(ev, "interleave") == 0);
+}
+
+
+static
+void poolInit(void) {
+  int i;
+
+  atomic_init_uint_least64_t(&cntPoolHits, 0);
+  atomic_init_uint_least64_t(&cntPoolHitBytes, 0);
+  atomic_init_uint_least64_t(&cntPoolMisses, 0);
+  atomic_init_uint_least64_t(&cntPoolEvictions, 0);
+
+  poolBudget = chpl_env_rt_get_size("ARRAY_POOL_SIZE", 0);
+  if (poolBudget == 0) {
+    return;
+  }
+
+  numPools = 1;
+  if (strcmp(CHPL_LOCALE_MODEL, "flat") != 0) {
+    numPools += chpl_topo_getNumNumaDomains();
+  }
+
+  pools = (pool_t*) chpl_mem_allocManyZero(numPools, sizeof(pools[0]),
+                                           CHPL_RT_MD_ARRAY_POOL_DESC,
+                                           0, 0);
+  for (i = 0; i < numPools; i++) {
+    atomic_init_spinlock_t(&pools[i].lock);
+  }
+}
+
+
+void chpl_mem_array_policy_init(void) {
+  int hint;
+
+  hint = numaPolicyFromEnv();
+  if (chpl_env_rt_get_bool("ARRAY_HUGE_PAGES", false)) {
+#ifdef MADV_HUGEPAGE
+    hint |= CHPL_MEM_ARRAY_HINT_HUGE_PAGES;
+#else
+    if (chpl_nodeID == 0) {
+      chpl_warning("CHPL_RT_ARRAY_HUGE_PAGES: transparent huge pages are "
+                   "not supported on this platform, ignored", 0, 0);
+    }
+#endif
+  }
+
+  policyThreshold = chpl_env_rt_get_size("ARRAY_MEM_THRESHOLD",
+                                         policyThreshold);
+  policyReport = chpl_env_rt_get_bool("ARRAY_MEM_REPORT", false);
+
+  policySupported = configSupportsPolicy();
+  if (hint != CHPL_MEM_ARRAY_HINT_NONE && !policySupported) {
+    if (chpl_nodeID == 0) {
+      chpl_warning("CHPL_RT_ARRAY_HUGE_PAGES and CHPL_RT_ARRAY_NUMA_POLICY "
+                   "only apply with CHPL_COMM=none and "
+                   "CHPL_LOCALE_MODEL=flat, ignored", 0, 0);
+    }
+    hint = CHPL_MEM_ARRAY_HINT_NONE;
+  }
+  policyHint = hint;
+
+  atomic_init_uint_least64_t(&cntArrays, 0);
+  atomic_init_uint_least64_t(&cntArrayBytes, 0);
+  atomic_init_uint_least64_t(&cntHuge, 0);
+  atomic_init_uint_least64_t(&cntHugeBytes, 0);
+  atomic_init_uint_least64_t(&cntHugeFailed, 0);
+  atomic_init_uint_least64_t(&cntInterleave, 0);
+  atomic_init_uint_least64_t(&cntInterleaveBytes, 0);
+  atomic_init_uint_least64_t(&cntInterleaveFailed, 0);
+  atomic_init_uint_least64_t(&cntFirstTouch, 0);
+
+  poolInit();
+}
+
+
+int chpl_mem_array_policy_resolve(size_t size, int memHint) {
+  //
+  // An explicit hint always wins.  Otherwise use the policy, but only
+  // for arrays large enough to make it worthwhile.
+  //
+  if (memHint != CHPL_MEM_ARRAY_HINT_DEFAULT) {
+    return memHint;
+  }
+
+  if (policyHint == CHPL_MEM_ARRAY_HINT_NONE || size < policyThreshold) {
+    return CHPL_MEM_ARRAY_HINT_NONE;
+  }
+
+  return policyHint;
+}
+
+
+chpl_bool chpl_mem_array_policy_wantsFirstTouch(size_t size) {
+  return ((chpl_mem_array_policy_resolve(size, CHPL_MEM_ARRAY_HINT_DEFAULT)
+           & CHPL_MEM_ARRAY_HINT_FIRST_TOUCH)
+          != 0);
+}
+
+
+static
+void adviseHugePages(void* p, size_t size) {
+#ifdef MADV_HUGEPAGE
+  const size_t pgSize = chpl_getSysPageSize();
+  const uintptr_t lo = ((uintptr_t) p + pgSize - 1) & ~(pgSize - 1);
+  const uintptr_t hi = ((uintptr_t) p + size) & ~(pgSize - 1);
+
+  if (hi > lo && madvise((void*) lo, hi - lo, MADV_HUGEPAGE) == 0) {
+    (void) atomic_fetch_add_uint_least64_t(&cntHuge, 1);
+    (void) atomic_fetch_add_uint_least64_t(&cntHugeBytes, hi - lo);
+    return;
+  }
+#endif
+
+  (void) atomic_fetch_add_uint_least64_t(&cntHugeFailed, 1);
+}
+
+
+static
+void adviseInterleave(void* p, size_t size) {
+  if (chpl_topo_interleaveMemLocality(p, size, true)) {
+    (void) atomic_fetch_add_uint_least64_t(&cntInterleave, 1);
+    (void) atomic_fetch_add_uint_least64_t(&cntInterleaveBytes, size);
+  } else {
+    (void) atomic_fetch_add_uint_least64_t(&cntInterleaveFailed, 1);
+  }
+}
+
+
+void chpl_mem_array_policy_apply(void* p, size_t size, int hint) {
+  (void) atomic_fetch_add_uint_least64_t(&cntArrays, 1);
+  (void) atomic_fetch_add_uint_least64_t(&cntArrayBytes, size);
+
+  //
+  // Both of these have to be done before the memory is first touched
+  // to have full effect.  The first touch itself is up to the module
+  // code, which knows how the array will be iterated over.
+  //
+  if ((hint & CHPL_MEM_ARRAY_HINT_HUGE_PAGES) != 0) {
+    adviseHugePages(p, size);
+  }
+
+  if ((hint & CHPL_MEM_ARRAY_HINT_INTERLEAVE) != 0) {
+    adviseInterleave(p, size);
+  }
+}
+
+
+void chpl_mem_array_advise(void* p, size_t nmemb, size_t eltSize, int hint) {
+  //
+  // Apply a per-array hint to already-allocated array memory.  Pages
+  // that have already been touched are migrated (for interleaving) or
+  // left for the kernel to collapse later (for huge pages).
+  //
+  const size_t size = nmemb * eltSize;
+
+  if (p == NULL || size == 0 || hint == CHPL_MEM_ARRAY_HINT_DEFAULT) {
+    return;
+  }
+
+  chpl_mem_array_policy_apply(p, size, hint);
+}
+
+
+void chpl_mem_array_touch(void* p, size_t eltSize, size_t lo, size_t hi) {
+  //
+  // Touch the pages of elements [lo, hi) that start within that range
+  // (plus the first page, if lo is the start of the array).  Callers
+  // run this in parallel over a block decomposition of the array that
+  // matches the one forall loops over it will use, so that each page
+  // ends up in the NUMA domain of the task that will later use it.
+  //
+  const size_t pgSize = chpl_getHeapPageSize();
+  unsigned char* pCh = (unsigned char*) p;
+  uintptr_t addr = (uintptr_t) (pCh + lo * eltSize);
+  const uintptr_t addrHi = (uintptr_t) (pCh + hi * eltSize);
+
+  if (lo >= hi) {
+    return;
+  }
+
+  if (lo == 0) {
+    *(volatile unsigned char*) addr = 0;
+  }
+
+  for (addr = (addr + pgSize - 1) & ~(uintptr_t) (pgSize - 1);
+       addr < addrHi;
+       addr += pgSize) {
+    *(volatile unsigned char*) addr = 0;
+  }
+
+  if (lo == 0) {
+    (void) atomic_fetch_add_uint_least64_t(&cntFirstTouch, 1);
+  }
+}
+
+
+static inline
+chpl_bool poolTakes(size_t size) {
+  return (poolBudget != 0 && size >= POOL_MIN_BUF_SIZE && size <= poolBudget);
+}
+
+
+static inline
+size_t poolTrailerOffset(size_t size) {
+  const size_t align = sizeof(poolTrailer_t);
+  return (size + align - 1) & ~(align - 1);
+}
+
+
+static inline
+poolTrailer_t* poolTrailer(void* p, size_t size) {
+  return (poolTrailer_t*) ((unsigned char*) p + poolTrailerOffset(size));
+}
+
+
+static inline
+c_sublocid_t poolSubloc(c_sublocid_t subloc) {
+  //
+  // Memory not allocated for a particular sublocale comes from the
+  // heap of the sublocale the allocating task is running on.
+  //
+  return isActualSublocID(subloc) ? subloc : chpl_task_getRequestedSubloc();
+}
+
+
+static inline
+pool_t* poolFor(c_sublocid_t subloc) {
+  //
+  // Each sublocale has its own pool, so that reused storage is already
+  // local to the sublocale that reuses it.
+  //
+  return &pools[(isActualSublocID(subloc) && subloc + 1 < numPools)
+                ? subloc + 1
+                : 0];
+}
+
+
+size_t chpl_mem_array_pool_allocSize(size_t size) {
+  return poolTakes(size)
+         ? poolTrailerOffset(size) + sizeof(poolTrailer_t)
+         : size;
+}
+
+
+void chpl_mem_array_pool_noteAlloc(void* p, size_t size,
+                                   c_sublocid_t subloc) {
+  if (poolTakes(size)) {
+    poolTrailer(p, size)->subloc = poolSubloc(subloc);
+  }
+}
+
+
+static inline
+int poolBucket(size_t size) {
+  int b = 0;
+  while ((size >>= 1) != 0) {
+    b++;
+  }
+  return b;
+}
+
+
+static
+void poolUnlinkLRU(pool_t* pool, poolBuf_t* pb) {
+  if (pb->lruPrev == NULL) {
+    pool->lruHead = pb->lruNext;
+  } else {
+    pb->lruPrev->lruNext = pb->lruNext;
+  }
+
+  if (pb->lruNext == NULL) {
+    pool->lruTail = pb->lruPrev;
+  } else {
+    pb->lruNext->lruPrev = pb->lruPrev;
+  }
+}
+
+
+static
+void poolUnlinkBucket(pool_t* pool, poolBuf_t* pb) {
+  poolBuf_t** pp;
+
+  for (pp = &pool->bkts[poolBucket(pb->size)]; *pp != pb; pp = &(*pp)->bktNext)
+    ;
+  *pp = pb->bktNext;
+}
+
+
+void* chpl_mem_array_pool_get(size_t size, c_sublocid_t subloc) {
+  pool_t* pool;
+  poolBuf_t** pp;
+  poolBuf_t* pb;
+
+  if (!poolTakes(size)) {
+    return NULL;
+  }
+
+  //
+  // Anything in this pool already has a trailer naming this sublocale.
+  //
+  pool = poolFor(poolSubloc(subloc));
+  atomic_lock_spinlock_t(&pool->lock);
+
+  for (pp = &pool->bkts[poolBucket(size)];
+       *pp != NULL && (*pp)->size != size;
+       pp = &(*pp)->bktNext)
+    ;
+
+  if ((pb = *pp) != NULL) {
+    *pp = pb->bktNext;
+    poolUnlinkLRU(pool, pb);
+    pool->bytes -= size;
+  }
+
+  atomic_unlock_spinlock_t(&pool->lock);
+
+  if (pb == NULL) {
+    (void) atomic_fetch_add_uint_least64_t(&cntPoolMisses, 1);
+    return NULL;
+  }
+
+  (void) atomic_fetch_add_uint_least64_t(&cntPoolHits, 1);
+  (void) atomic_fetch_add_uint_least64_t(&cntPoolHitBytes, size);
+  return pb;
+}
+
+
+chpl_bool chpl_mem_array_pool_put(void* p, size_t size) {
+  pool_t* pool;
+  poolBuf_t* pb = (poolBuf_t*) p;
+  poolBuf_t* evicted = NULL;
+  int bkt;
+
+  if (p == NULL || !poolTakes(size)) {
+    return false;
+  }
+
+  pool = poolFor(poolTrailer(p, size)->subloc);
+  atomic_lock_spinlock_t(&pool->lock);
+
+  //
+  // Make room by evicting the least recently freed buffers.  Do the
+  // actual frees after we've dropped the lock.
+  //
+  while (pool->bytes + size > poolBudget) {
+    poolBuf_t* old = pool->lruTail;
+    poolUnlinkLRU(pool, old);
+    poolUnlinkBucket(pool, old);
+    pool->bytes -= old->size;
+    old->bktNext = evicted;
+    evicted = old;
+  }
+
+  bkt = poolBucket(size);
+  pb->size = size;
+  pb->bktNext = pool->bkts[bkt];
+  pool->bkts[bkt] = pb;
+  pb->lruPrev = NULL;
+  pb->lruNext = pool->lruHead;
+  if (pool->lruHead == NULL) {
+    pool->lruTail = pb;
+  } else {
+    pool->lruHead->lruPrev = pb;
+  }
+  pool->lruHead = pb;
+  pool->bytes += size;
+
+  atomic_unlock_spinlock_t(&pool->lock);
+
+  while (evicted != NULL) {
+    poolBuf_t* next = evicted->bktNext;
+    chpl_free(evicted);
+    (void) atomic_fetch_add_uint_least64_t(&cntPoolEvictions, 1);
+    evicted = next;
+  }
+
+  return true;
+}
+
+
+void chpl_mem_array_pool_getCounts(uint64_t* hits, uint64_t* misses) {
+  *hits = (uint64_t) atomic_load_uint_least64_t(&cntPoolHits);
+  *misses = (uint64_t) atomic_load_uint_least64_t(&cntPoolMisses);
+}
+
+
+void chpl_mem_array_pool_exit(void) {
+  int i;
+
+  if (pools == NULL) {
+    return;
+  }
+
+  for (i = 0; i < numPools; i++) {
+    poolBuf_t* pb = pools[i].lruHead;
+    while (pb != NULL) {
+      poolBuf_t* next = pb->lruNext;
+      chpl_free(pb);
+      pb = next;
+    }
+    atomic_destroy_spinlock_t(&pools[i].lock);
+  }
+
+  chpl_mem_free(pools, 0, 0);
+  pools = NULL;
+  poolBudget = 0;
+}
+
+
+void chpl_mem_array_policy_report(void) {
+  if (!policyReport) {
+    return;
+  }
+
+  printf("%d: array memory policy: huge pages %s, NUMA %s, threshold %zd\n",
+         (int) chpl_nodeID,
+         ((policyHint & CHPL_MEM_ARRAY_HINT_HUGE_PAGES) != 0) ? "on" : "off",
+         ((policyHint & CHPL_MEM_ARRAY_HINT_INTERLEAVE) != 0)
+         ? "interleave"
+         : ((policyHint & CHPL_MEM_ARRAY_HINT_FIRST_TOUCH) != 0)
+         ? "firsttouch"
+         : "none",
+         policyThreshold);
+  printf("%d: arrays placed: %" PRIu64 " (%" PRIu64 " bytes)\n",
+         (int) chpl_nodeID,
+         (uint64_t) atomic_load_uint_least64_t(&cntArrays),
+         (uint64_t) atomic_load_uint_least64_t(&cntArrayBytes));
+  printf("%d:   huge pages: %" PRIu64 " (%" PRIu64 " bytes), %" PRIu64
+         " refused\n",
+         (int) chpl_nodeID,
+         (uint64_t) atomic_load_uint_least64_t(&cntHuge),
+         (uint64_t) atomic_load_uint_least64_t(&cntHugeBytes),
+         (uint64_t) atomic_load_uint_least64_t(&cntHugeFailed));
+  printf("%d:   interleaved over %d NUMA domains: %" PRIu64
+         " (%" PRIu64 " bytes), %" PRIu64 " refused\n",
+         (int) chpl_nodeID, chpl_topo_getNumNumaDomains(),
+         (uint64_t) atomic_load_uint_least64_t(&cntInterleave),
+         (uint64_t) atomic_load_uint_least64_t(&cntInterleaveBytes),
+         (uint64_t) atomic_load_uint_least64_t(&cntInterleaveFailed));
+  printf("%d:   parallel first touch: %" PRIu64 "\n",
+         (int) chpl_nodeID,
+         (uint64_t) atomic_load_uint_least64_t(&cntFirstTouch));
+  printf("%d: array storage pool: budget %zd, %" PRIu64 " hits (%" PRIu64
+         " bytes), %" PRIu64 " misses, %" PRIu64 " evictions\n",
+         (int) chpl_nodeID, poolBudget,
+         (uint64_t) atomic_load_uint_least64_t(&cntPoolHits),
+         (uint64_t) atomic_load_uint_least64_t(&cntPoolHitBytes),
+         (uint64_t) atomic_load_uint_least64_t(&cntPoolMisses),
+         (uint64_t) atomic_load_uint_least64_t(&cntPoolEvictions));
+  fflush(stdout);
+}
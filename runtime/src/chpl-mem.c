@@ -24,6 +24,7 @@
 #include "chplrt.h"
 
 #include "chpl-mem.h"
+#include "chpl-mem-array.h"
 #include "chpltypes.h"
 #include "error.h"
 #include "chplsys.h"
@@ -34,10 +35,12 @@ static int heapInitialized = 0;
 void chpl_mem_init(void) {
   chpl_mem_layerInit();
   heapInitialized = 1;
+  chpl_mem_array_policy_init();
 }
 
 
 void chpl_mem_exit(void) {
+  chpl_mem_array_pool_exit();
   chpl_mem_layerExit();
 }
 
@@ -40,6 +40,12 @@
 #include "chpltypes.h"
 #include "error.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // Uses the system allocator.  Should not be used to create user-visible data
 // (error messages are OK).
 char* chpl_glom_strings(int numstrings, ...) {
@@ -192,3 +198,186 @@ string_contains(c_string x, c_string y) {
 }
 
 
+//
+// UTF-8 support for Chapel strings.
+//
+// These scan the buffer a vector at a time where the target supports it
+// (AVX2 or SSE2, chosen at compile time) and 8 bytes at a time otherwise.
+// Only bytes that are not ASCII are looked at individually.
+//
+
+// Returns the number of leading bytes of buf[0..len) that are ASCII.
+static inline
+int64_t ascii_prefix_len(const uint8_t* buf, int64_t len) {
+  int64_t i = 0;
+
+#if defined(__AVX2__)
+  for ( ; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) (buf + i));
+    if (_mm256_movemask_epi8(v) != 0)
+      break;
+  }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+  for ( ; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (buf + i));
+    if (_mm_movemask_epi8(v) != 0)
+      break;
+  }
+#endif
+  for ( ; i + 8 <= len; i += 8) {
+    uint64_t w;
+    memcpy(&w, buf + i, sizeof(w));
+    if ((w & UINT64_C(0x8080808080808080)) != 0)
+      break;
+  }
+  while (i < len && buf[i] < 0x80)
+    i++;
+
+  return i;
+}
+
+// Returns the number of bytes in buf[0..len) that start a codepoint, that
+// is, the bytes that are not of the form 10xxxxxx.  Signed, those are the
+// bytes greater than (int8_t) 0xbf.
+static
+int64_t count_initial_bytes(const uint8_t* buf, int64_t len) {
+  int64_t n = 0;
+  int64_t i = 0;
+
+#if defined(__AVX2__)
+  {
+    const __m256i lastCont = _mm256_set1_epi8((char) 0xbf);
+    while (i + 32 <= len) {
+      // each lane counts up to 255 matches before it is summed
+      __m256i acc = _mm256_setzero_si256();
+      uint64_t sums[4];
+      int64_t iters = (len - i) / 32;
+      int64_t k;
+      if (iters > 255) iters = 255;
+      for (k = 0; k < iters; k++, i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (buf + i));
+        acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(v, lastCont));
+      }
+      _mm256_storeu_si256((__m256i*) sums,
+                          _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+      n += sums[0] + sums[1] + sums[2] + sums[3];
+    }
+  }
+#elif defined(__SSE2__)
+  {
+    const __m128i lastCont = _mm_set1_epi8((char) 0xbf);
+    while (i + 16 <= len) {
+      __m128i acc = _mm_setzero_si128();
+      uint64_t sums[2];
+      int64_t iters = (len - i) / 16;
+      int64_t k;
+      if (iters > 255) iters = 255;
+      for (k = 0; k < iters; k++, i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (buf + i));
+        acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, lastCont));
+      }
+      _mm_storeu_si128((__m128i*) sums,
+                       _mm_sad_epu8(acc, _mm_setzero_si128()));
+      n += sums[0] + sums[1];
+    }
+  }
+#endif
+  for ( ; i < len; i++)
+    n += (buf[i] & 0xc0) != 0x80;
+
+  return n;
+}
+
+// Returns the length of the multibyte sequence at the start of buf, or 0
+// if it is not valid UTF-8.  This accepts exactly what the utf8-decoder
+// DFA does, plus, if allow_escape is set, the encodings of U+DC80..U+DCFF
+// that strings use to escape undecodable bytes (see
+// chpl_enc_check_escape()).
+static inline
+int utf8_multibyte_len(const uint8_t* buf, int64_t avail,
+                       chpl_bool allow_escape) {
+  const uint8_t b0 = buf[0];
+
+  if (b0 < 0xc2) {
+    // stray continuation byte, or overlong 2-byte sequence
+    return 0;
+  } else if (b0 < 0xe0) {
+    if (avail < 2 || (buf[1] & 0xc0) != 0x80)
+      return 0;
+    return 2;
+  } else if (b0 < 0xf0) {
+    if (avail < 3 || (buf[1] & 0xc0) != 0x80 || (buf[2] & 0xc0) != 0x80)
+      return 0;
+    if (b0 == 0xe0 && buf[1] < 0xa0)
+      return 0;  // overlong
+    if (b0 == 0xed && buf[1] > 0x9f &&
+        !(allow_escape && (buf[1] == 0xb2 || buf[1] == 0xb3)))
+      return 0;  // surrogate that isn't an escaped byte
+    return 3;
+  } else if (b0 < 0xf5) {
+    if (avail < 4 || (buf[1] & 0xc0) != 0x80 || (buf[2] & 0xc0) != 0x80 ||
+        (buf[3] & 0xc0) != 0x80)
+      return 0;
+    if (b0 == 0xf0 && buf[1] < 0x90)
+      return 0;  // overlong
+    if (b0 == 0xf4 && buf[1] > 0x8f)
+      return 0;  // past U+10FFFF
+    return 4;
+  }
+  return 0;
+}
+
+int chpl_string_validate_utf8(const uint8_t* buf, int64_t len,
+                              chpl_bool allow_escape, int64_t* num_cp) {
+  int64_t i = 0;
+  int64_t n = 0;
+
+  while (i < len) {
+    if (buf[i] < 0x80) {
+      const int64_t ascii = ascii_prefix_len(buf + i, len - i);
+      i += ascii;
+      n += ascii;
+    } else {
+      const int nbytes = utf8_multibyte_len(buf + i, len - i,
+                                              allow_escape);
+      if (nbytes == 0) {
+        *num_cp = n;
+        return -1;
+      }
+      i += nbytes;
+      n++;
+    }
+  }
+
+  *num_cp = n;
+  return 0;
+}
+
+int64_t chpl_string_count_codepoints(const uint8_t* buf, int64_t len) {
+  return count_initial_bytes(buf, len);
+}
+
+int64_t chpl_string_codepoint_offset(const uint8_t* buf, int64_t len,
+                                     int64_t start, int64_t cp) {
+  const int64_t blockSize = 64;
+  int64_t i = start;
+
+  // skip whole blocks that end before the codepoint we want
+  while (i + blockSize <= len) {
+    const int64_t n = count_initial_bytes(buf + i, blockSize);
+    if (n > cp)
+      break;
+    cp -= n;
+    i += blockSize;
+  }
+
+  for ( ; i < len; i++) {
+    if ((buf[i] & 0xc0) != 0x80) {
+      if (cp == 0)
+        return i;
+      cp--;
+    }
+  }
+  return len;
+}
@@ -20,7 +20,10 @@
 
 #include "chplrt.h"
 #include "chpl-string.h"
+#include "chpl-atomics.h"
 #include "chpl-gen-includes.h"
+#include "chpl-mem.h"
+#include "chpl-string-support.h"
 
 struct chpl_chpl____wide_chpl_string_s {
   chpl_localeID_t locale;
@@ -47,3 +50,151 @@ uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf) {
 uint8_t* chpl__getInPlaceBufferDataForWrite(chpl__inPlaceBuffer* buf) {
   return chpl__getInPlaceBufferData(buf);
 }
+
+//
+// The header is padded to a multiple of 16 bytes so that the data following
+// it keeps the alignment the allocator gave the whole block.
+//
+typedef struct {
+  atomic_int_least64_t refCount;
+  atomic_uintptr_t cpIndex;       // chpl_string_cp_index_t*, or 0
+} chpl_string_shared_hdr_t;
+
+//
+// offsets[k] is the byte offset of codepoint k*CP_INDEX_STRIDE.  Buffers
+// shorter than CP_INDEX_MIN_BYTES are cheap enough to scan that they
+// don't get an index.
+//
+#define CP_INDEX_STRIDE 256
+#define CP_INDEX_MIN_BYTES 4096
+
+typedef struct {
+  int64_t len;
+  int64_t numOffsets;
+  int64_t offsets[];
+} chpl_string_cp_index_t;
+
+#define SHARED_HDR_SIZE \
+  ((sizeof(chpl_string_shared_hdr_t) + 15) & ~(size_t) 15)
+
+static inline
+chpl_string_shared_hdr_t* shared_hdr(uint8_t* buf) {
+  return (chpl_string_shared_hdr_t*) (buf - SHARED_HDR_SIZE);
+}
+
+uint8_t* chpl_string_shared_alloc(size_t size, int32_t lineno,
+                                  int32_t filename) {
+  uint8_t* mem = (uint8_t*) chpl_mem_alloc(SHARED_HDR_SIZE + size,
+                                           CHPL_RT_MD_STR_COPY_DATA,
+                                           lineno, filename);
+  chpl_string_shared_hdr_t* hdr = (chpl_string_shared_hdr_t*) mem;
+
+  atomic_init_int_least64_t(&hdr->refCount, 1);
+  atomic_init_uintptr_t(&hdr->cpIndex, 0);
+
+  return mem + SHARED_HDR_SIZE;
+}
+
+static
+void free_cp_index(chpl_string_shared_hdr_t* hdr) {
+  chpl_string_cp_index_t* index =
+    (chpl_string_cp_index_t*) atomic_load_explicit_uintptr_t(
+                                &hdr->cpIndex, memory_order_acquire);
+  if (index != NULL) {
+    atomic_store_explicit_uintptr_t(&hdr->cpIndex, 0, memory_order_relaxed);
+    chpl_mem_free(index, 0, 0);
+  }
+}
+
+uint8_t* chpl_string_shared_realloc(uint8_t* buf, size_t size,
+                                    int32_t lineno, int32_t filename) {
+  // Only the sole owner may do this, so nobody else can see the header move
+  uint8_t* mem;
+  free_cp_index(shared_hdr(buf));
+  mem = (uint8_t*) chpl_mem_realloc(shared_hdr(buf),
+                                             SHARED_HDR_SIZE + size,
+                                             CHPL_RT_MD_STR_COPY_DATA,
+                                             lineno, filename);
+  return mem + SHARED_HDR_SIZE;
+}
+
+void chpl_string_shared_retain(uint8_t* buf) {
+  atomic_fetch_add_explicit_int_least64_t(&shared_hdr(buf)->refCount, 1,
+                                          memory_order_relaxed);
+}
+
+void chpl_string_shared_release(uint8_t* buf, int32_t lineno,
+                                int32_t filename) {
+  chpl_string_shared_hdr_t* hdr = shared_hdr(buf);
+
+  if (atomic_fetch_sub_explicit_int_least64_t(&hdr->refCount, 1,
+                                              memory_order_acq_rel) == 1) {
+    free_cp_index(hdr);
+    atomic_destroy_uintptr_t(&hdr->cpIndex);
+    atomic_destroy_int_least64_t(&hdr->refCount);
+    chpl_mem_free(hdr, lineno, filename);
+  }
+}
+
+chpl_bool chpl_string_shared_is_unique(uint8_t* buf) {
+  return atomic_load_explicit_int_least64_t(&shared_hdr(buf)->refCount,
+                                            memory_order_acquire) == 1;
+}
+
+static
+chpl_string_cp_index_t* build_cp_index(const uint8_t* buf, int64_t len) {
+  const int64_t numOffsets =
+    chpl_string_count_codepoints(buf, len) / CP_INDEX_STRIDE + 1;
+  chpl_string_cp_index_t* index =
+    (chpl_string_cp_index_t*) chpl_mem_alloc(sizeof(*index) +
+                                             numOffsets * sizeof(int64_t),
+                                             CHPL_RT_MD_STR_CP_INDEX, 0, 0);
+  int64_t k;
+
+  index->len = len;
+  index->numOffsets = numOffsets;
+  index->offsets[0] = 0;
+  for (k = 1; k < numOffsets; k++) {
+    index->offsets[k] = chpl_string_codepoint_offset(buf, len,
+                                                     index->offsets[k-1],
+                                                     CP_INDEX_STRIDE);
+  }
+  return index;
+}
+
+int64_t chpl_string_shared_codepoint_offset(uint8_t* buf, int64_t len,
+                                            int64_t cp) {
+  chpl_string_shared_hdr_t* hdr = shared_hdr(buf);
+  chpl_string_cp_index_t* index;
+  int64_t k;
+
+  if (len < CP_INDEX_MIN_BYTES || cp < CP_INDEX_STRIDE)
+    return chpl_string_codepoint_offset(buf, len, 0, cp);
+
+  index = (chpl_string_cp_index_t*) atomic_load_explicit_uintptr_t(
+                                      &hdr->cpIndex, memory_order_acquire);
+  if (index == NULL) {
+    // Copies on other tasks may race to build it; the first one wins.
+    uintptr_t expected = 0;
+    index = build_cp_index(buf, len);
+    if (!atomic_compare_exchange_strong_explicit_uintptr_t(
+           &hdr->cpIndex, &expected, (uintptr_t) index,
+           memory_order_acq_rel, memory_order_acquire)) {
+      chpl_mem_free(index, 0, 0);
+      index = (chpl_string_cp_index_t*) expected;
+    }
+  }
+
+  if (index->len != len)
+    return chpl_string_codepoint_offset(buf, len, 0, cp);
+
+  k = cp / CP_INDEX_STRIDE;
+  if (k >= index->numOffsets)
+    return len;
+  return chpl_string_codepoint_offset(buf, len, index->offsets[k],
+                                      cp - k * CP_INDEX_STRIDE);
+}
+
+void chpl_string_shared_invalidate(uint8_t* buf) {
+  free_cp_index(shared_hdr(buf));
+}
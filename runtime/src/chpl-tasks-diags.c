@@ -0,0 +1,440 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Tasking diagnostics support.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chpl-tasks.h"
+#include "chpl-tasks-diags.h"
+#include "chpl-thread-local-storage.h"
+#include "error.h"
+
+#include <inttypes.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+int chpl_task_diagnostics = 0;
+
+
+typedef struct _chpl_atomic_taskDiagnostics {
+#define _TASK_DIAGS_DECL_ATOMIC(tdv) atomic_uint_least64_t tdv;
+  CHPL_TASK_DIAGS_VARS_ALL(_TASK_DIAGS_DECL_ATOMIC)
+#undef _TASK_DIAGS_DECL_ATOMIC
+} chpl_atomic_taskDiagnostics;
+
+//
+// Each worker (thread that runs tasks) gets one of these the first
+// time it does something we count.  Only the owning worker updates the
+// counters, so the atomics are just there to make reading and
+// resetting from other threads well defined.
+//
+typedef struct worker_diags {
+  struct worker_diags* next;
+  chpl_atomic_taskDiagnostics ctrs;
+  atomic_uint_least64_t since_ns;   // start of this counting period
+  atomic_uint_least64_t idle_start_ns;  // when we began waiting for work
+
+  // These are only touched by the owning worker.
+  int depth;                        // tasks begun but not yet ended
+  int waits;                        // ... of which, blocked in sync waits
+  uint64_t seg_start_ns;            // when the current run segment began
+} worker_diags_t;
+
+static worker_diags_t* workers_head = NULL;
+static worker_diags_t** workers_tail = &workers_head;
+static atomic_int_least32_t num_workers;
+static atomic_spinlock_t workers_lock;
+
+static CHPL_TLS_DECL(worker_diags_t*, my_worker);
+
+static chpl_bool idle_measured = false;
+static uint64_t stop_ns = 0;        // 0 while diagnostics are running
+static chpl_bool print_at_exit = false;
+
+//
+// Printing isn't async-signal-safe, so the SIGUSR1 handler just sets
+// print_requested and the next worker to begin or end a task or go idle
+// prints the counts.  print_claimed keeps two workers from doing so.
+//
+static volatile sig_atomic_t print_requested = 0;
+static atomic_bool print_claimed;
+
+static void poll_print_request(void);
+
+
+static inline
+uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+
+static
+worker_diags_t* get_worker(void) {
+  worker_diags_t* w = (worker_diags_t*) CHPL_TLS_GET(my_worker);
+  if (w == NULL) {
+    w = (worker_diags_t*) chpl_mem_allocManyZero(1, sizeof(*w),
+                                                 CHPL_RT_MD_TASK_DIAGS_DATA,
+                                                 0, 0);
+#define _TASK_DIAGS_INIT(tdv) atomic_init_uint_least64_t(&w->ctrs.tdv, 0);
+    CHPL_TASK_DIAGS_VARS_ALL(_TASK_DIAGS_INIT)
+#undef _TASK_DIAGS_INIT
+    atomic_init_uint_least64_t(&w->since_ns, now_ns());
+    atomic_init_uint_least64_t(&w->idle_start_ns, 0);
+
+    atomic_lock_spinlock_t(&workers_lock);
+    *workers_tail = w;
+    workers_tail = &w->next;
+    atomic_unlock_spinlock_t(&workers_lock);
+    (void) atomic_fetch_add_int_least32_t(&num_workers, 1);
+
+    CHPL_TLS_SET(my_worker, w);
+  }
+  return w;
+}
+
+
+static inline
+void ctr_add(atomic_uint_least64_t* ctr, uint64_t val) {
+  (void) atomic_fetch_add_explicit_uint_least64_t(ctr, val,
+                                                  memory_order_relaxed);
+}
+
+
+//
+// A worker is running a task when it has begun more tasks than it has
+// ended, not counting ones that are blocked waiting on sync variables.
+// Time is charged to run_ns across each stretch where that holds.
+//
+static inline
+void update_running(worker_diags_t* w, uint64_t t, int dTasks, int dWaits) {
+  if (w->seg_start_ns != 0) {
+    ctr_add(&w->ctrs.run_ns, t - w->seg_start_ns);
+    w->seg_start_ns = 0;
+  }
+
+  // Counts can go negative if diagnostics were turned on mid-task.
+  w->depth += dTasks;
+  if (w->depth < 0)
+    w->depth = 0;
+  w->waits += dWaits;
+  if (w->waits < 0)
+    w->waits = 0;
+
+  if (w->depth > w->waits)
+    w->seg_start_ns = t;
+}
+
+
+void chpl_task_diags_spawn_(void) {
+  ctr_add(&get_worker()->ctrs.tasks_spawned, 1);
+}
+
+
+void chpl_task_diags_taskBegin_(uint64_t queueDepth) {
+  worker_diags_t* w = get_worker();
+
+  poll_print_request();
+
+  update_running(w, now_ns(), 1, 0);
+
+  ctr_add(&w->ctrs.queue_depth_sum, queueDepth);
+  if (queueDepth > atomic_load_explicit_uint_least64_t(&w->ctrs.queue_depth_max,
+                                                       memory_order_relaxed)) {
+    atomic_store_explicit_uint_least64_t(&w->ctrs.queue_depth_max, queueDepth,
+                                         memory_order_relaxed);
+  }
+}
+
+
+void chpl_task_diags_taskEnd_(void) {
+  worker_diags_t* w = get_worker();
+
+  poll_print_request();
+
+  update_running(w, now_ns(), -1, 0);
+  ctr_add(&w->ctrs.tasks_run, 1);
+}
+
+
+void chpl_task_diags_idleBegin_(void) {
+  worker_diags_t* w = get_worker();
+
+  poll_print_request();
+
+  idle_measured = true;
+  if (atomic_load_uint_least64_t(&w->idle_start_ns) == 0) {
+    atomic_store_uint_least64_t(&w->idle_start_ns, now_ns());
+  }
+}
+
+
+void chpl_task_diags_idleEnd_(void) {
+  worker_diags_t* w = get_worker();
+  uint64_t start = atomic_exchange_uint_least64_t(&w->idle_start_ns, 0);
+  if (start != 0) {
+    uint64_t since = atomic_load_uint_least64_t(&w->since_ns);
+    uint64_t t = now_ns();
+    if (start < since)
+      start = since;
+    if (t > start)
+      ctr_add(&w->ctrs.idle_ns, t - start);
+  }
+}
+
+
+uint64_t chpl_task_diags_waitBegin_(void) {
+  uint64_t t = now_ns();
+  update_running(get_worker(), t, 0, 1);
+  return t;
+}
+
+
+void chpl_task_diags_waitEnd_(uint64_t startTime) {
+  worker_diags_t* w = get_worker();
+  uint64_t t = now_ns();
+
+  update_running(w, t, 0, -1);
+  ctr_add(&w->ctrs.sync_waits, 1);
+  ctr_add(&w->ctrs.sync_wait_ns, t - startTime);
+}
+
+
+void chpl_task_diags_steal_(void) {
+  ctr_add(&get_worker()->ctrs.steals, 1);
+}
+
+
+static
+void get_worker_diags(worker_diags_t* w, chpl_taskDiagnostics* td) {
+#define _TASK_DIAGS_COPY(tdv) \
+  td->tdv = atomic_load_uint_least64_t(&w->ctrs.tdv);
+  CHPL_TASK_DIAGS_VARS_ALL(_TASK_DIAGS_COPY)
+#undef _TASK_DIAGS_COPY
+
+  //
+  // Include the idle period the worker is in now, if any.  If the
+  // tasking layer doesn't tell us when workers are idle, count the
+  // time they weren't running tasks.
+  //
+  uint64_t end = (stop_ns != 0) ? stop_ns : now_ns();
+  uint64_t since = atomic_load_uint_least64_t(&w->since_ns);
+  if (idle_measured) {
+    uint64_t start = atomic_load_uint_least64_t(&w->idle_start_ns);
+    if (start != 0) {
+      if (start < since)
+        start = since;
+      if (end > start)
+        td->idle_ns += end - start;
+    }
+  } else {
+    uint64_t elapsed = (end > since) ? end - since : 0;
+    td->idle_ns = (elapsed > td->run_ns) ? elapsed - td->run_ns : 0;
+  }
+}
+
+
+int chpl_task_getNumDiagnosticsWorkersHere(void) {
+  return (int) atomic_load_int_least32_t(&num_workers);
+}
+
+
+void chpl_task_getDiagnosticsHere(int worker, chpl_taskDiagnostics* td) {
+  worker_diags_t* w;
+  int i;
+
+  atomic_lock_spinlock_t(&workers_lock);
+
+  if (worker >= 0) {
+    for (w = workers_head, i = 0; w != NULL && i < worker; w = w->next, i++)
+      ;
+    if (w != NULL) {
+      get_worker_diags(w, td);
+    } else {
+      memset(td, 0, sizeof(*td));
+    }
+  } else {
+    memset(td, 0, sizeof(*td));
+    for (w = workers_head; w != NULL; w = w->next) {
+      chpl_taskDiagnostics wtd;
+      get_worker_diags(w, &wtd);
+      uint64_t qmax = td->queue_depth_max;
+#define _TASK_DIAGS_SUM(tdv) td->tdv += wtd.tdv;
+      CHPL_TASK_DIAGS_VARS_ALL(_TASK_DIAGS_SUM)
+#undef _TASK_DIAGS_SUM
+      td->queue_depth_max = (wtd.queue_depth_max > qmax)
+                            ? wtd.queue_depth_max
+                            : qmax;
+    }
+  }
+
+  atomic_unlock_spinlock_t(&workers_lock);
+}
+
+
+void chpl_task_startDiagnosticsHere(void) {
+  worker_diags_t* w;
+  uint64_t t = now_ns();
+
+  //
+  // Counting periods don't include time spent stopped.
+  //
+  atomic_lock_spinlock_t(&workers_lock);
+  if (stop_ns != 0) {
+    for (w = workers_head; w != NULL; w = w->next) {
+      uint64_t since = atomic_load_uint_least64_t(&w->since_ns);
+      atomic_store_uint_least64_t(&w->since_ns, since + (t - stop_ns));
+    }
+  }
+  stop_ns = 0;
+  atomic_unlock_spinlock_t(&workers_lock);
+
+  chpl_task_diagnostics = 1;
+}
+
+
+void chpl_task_stopDiagnosticsHere(void) {
+  chpl_task_diagnostics = 0;
+  atomic_lock_spinlock_t(&workers_lock);
+  stop_ns = now_ns();
+  atomic_unlock_spinlock_t(&workers_lock);
+}
+
+
+void chpl_task_resetDiagnosticsHere(void) {
+  worker_diags_t* w;
+  uint64_t t;
+
+  atomic_lock_spinlock_t(&workers_lock);
+  t = (stop_ns != 0) ? stop_ns : now_ns();
+  for (w = workers_head; w != NULL; w = w->next) {
+#define _TASK_DIAGS_RESET(tdv) atomic_store_uint_least64_t(&w->ctrs.tdv, 0);
+    CHPL_TASK_DIAGS_VARS_ALL(_TASK_DIAGS_RESET)
+#undef _TASK_DIAGS_RESET
+    atomic_store_uint_least64_t(&w->since_ns, t);
+  }
+  atomic_unlock_spinlock_t(&workers_lock);
+}
+
+
+static
+void print_row(const char* name, chpl_taskDiagnostics* td) {
+  const double nsPerSec = 1e9;
+  const double gran = (td->tasks_run == 0)
+                      ? 0.0
+                      : td->run_ns / nsPerSec / td->tasks_run;
+  const double qdepth = (td->tasks_run == 0)
+                        ? 0.0
+                        : (double) td->queue_depth_sum / td->tasks_run;
+  printf("%d: %6s %10" PRIu64 " %10" PRIu64 " %10.4f %10.3e %8" PRIu64
+         " %10.4f %8" PRIu64 " %10.4f %7.2f %7" PRIu64 "\n",
+         (int) chpl_nodeID, name,
+         td->tasks_spawned, td->tasks_run, td->run_ns / nsPerSec, gran,
+         td->steals, td->idle_ns / nsPerSec,
+         td->sync_waits, td->sync_wait_ns / nsPerSec,
+         qdepth, td->queue_depth_max);
+}
+
+
+void chpl_task_printDiagnosticsHere(void) {
+  chpl_taskDiagnostics td;
+  int n = chpl_task_getNumDiagnosticsWorkersHere();
+
+  printf("%d: %6s %10s %10s %10s %10s %8s %10s %8s %10s %7s %7s\n",
+         (int) chpl_nodeID, "worker", "spawned", "run", "run sec",
+         "sec/task", "steals", "idle sec", "waits", "wait sec",
+         "avg q", "max q");
+  for (int i = 0; i < n; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "%d", i);
+    chpl_task_getDiagnosticsHere(i, &td);
+    print_row(name, &td);
+  }
+  chpl_task_getDiagnosticsHere(-1, &td);
+  print_row("total", &td);
+  fflush(stdout);
+}
+
+
+static
+void SIGUSR1_handler(int sig) {
+  print_requested = 1;
+}
+
+
+static
+void poll_print_request(void) {
+  if (print_requested && !atomic_exchange_bool(&print_claimed, true)) {
+    print_requested = 0;
+    chpl_task_printDiagnosticsHere();
+    atomic_store_bool(&print_claimed, false);
+  }
+}
+
+
+void chpl_task_diags_init(void) {
+  CHPL_TLS_INIT(my_worker);
+  atomic_init_spinlock_t(&workers_lock);
+  atomic_init_int_least32_t(&num_workers, 0);
+  atomic_init_bool(&print_claimed, false);
+
+  //
+  // With CHPL_RT_TASK_DIAGNOSTICS set we count for the whole run and
+  // print the counts at exit, and after a SIGUSR1 while running.
+  //
+  if (chpl_env_rt_get_bool("TASK_DIAGNOSTICS", false)) {
+    struct sigaction act;
+
+    print_at_exit = true;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = SIGUSR1_handler;
+    sigemptyset(&act.sa_mask);
+    act.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR1, &act, NULL) != 0) {
+      chpl_warning("could not install SIGUSR1 handler for task diagnostics",
+                   0, 0);
+    }
+    chpl_task_startDiagnosticsHere();
+  }
+}
+
+
+void chpl_task_diags_exit(void) {
+  if (print_at_exit) {
+    chpl_task_stopDiagnosticsHere();
+    chpl_task_printDiagnosticsHere();
+  }
+
+  //
+  // Workers may still be alive and holding pointers to their counters,
+  // so we leave those in place.  They aren't tracked memory.
+  //
+}
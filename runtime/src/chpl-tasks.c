@@ -24,6 +24,7 @@
 //
 #include "chplrt.h"
 #include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chpl-tasks.h"
 #include "chpl-topo.h"
 #include "error.h"
@@ -208,3 +209,53 @@ size_t chpl_task_getDefaultCallStackSize(void)
 
   return deflt;
 }
+
+
+//
+// Adaptive waiting.  Spinning only pays when whatever we're waiting for
+// can happen meanwhile, that is, when another task can run in parallel
+// with the waiter, so by default we only spin if that is possible.
+// Each spin is a single CPU pause, so the default spin count amounts to
+// a few microseconds, on the order of what it costs to block and be
+// woken again.
+//
+static int      have_wait_policy = 0;
+static uint32_t wait_spins;
+static uint32_t wait_yields;
+
+static void get_wait_policy(void)
+{
+  wait_spins = (uint32_t) chpl_env_rt_get_uint("WAIT_SPINS",
+                                              (chpl_task_getMaxPar() > 1)
+                                              ? 200 : 0);
+  wait_yields = (uint32_t) chpl_env_rt_get_uint("WAIT_YIELDS", 16);
+  have_wait_policy = 1;
+}
+
+
+static inline void cpu_pause(void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __asm__ __volatile__ ("pause" ::: "memory");
+#elif defined(__GNUC__) && defined(__aarch64__)
+  __asm__ __volatile__ ("yield" ::: "memory");
+#endif
+}
+
+
+chpl_bool chpl_task_waitBackoff(uint32_t* iter)
+{
+  if (!have_wait_policy)
+    get_wait_policy();
+
+  if (*iter < wait_spins) {
+    cpu_pause();
+  } else if (*iter - wait_spins < wait_yields) {
+    chpl_task_yield();
+  } else {
+    return false;
+  }
+
+  (*iter)++;
+  return true;
+}
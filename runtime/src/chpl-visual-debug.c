@@ -29,6 +29,9 @@
 #include "chpl-tasks-callbacks.h"
 #include "chpl-comm-callbacks.h"
 #include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chpl-thread-local-storage.h"
+#include "chpl-atomics.h"
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h>
@@ -38,6 +41,7 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <sys/resource.h>
 #include <sys/param.h>
@@ -87,7 +91,7 @@ int chpl_dprintf (int fd, const char * format, ...) {
   return -1;
 }
 
-static int chpl_make_vdebug_file (const char *rootname) {
+static int chpl_make_vdebug_file (const char *rootname, const char *suffix) {
     char fname[MAXPATHLEN]; 
     struct stat sb;
 
@@ -106,7 +110,8 @@ static int chpl_make_vdebug_file (const char *rootname) {
       }
     }
     
-    snprintf (fname, sizeof (fname), "%s/%s-%d", rootname, rootname, chpl_nodeID);
+    snprintf (fname, sizeof (fname), "%s/%s-%d%s", rootname, rootname,
+              chpl_nodeID, suffix);
     chpl_vdebug_fd = open (fname, O_WRONLY|O_CREAT|O_TRUNC|O_APPEND, 0666);
     if (chpl_vdebug_fd < 0) {
       fprintf (stderr, "Visual Debug failed to open %s: %s\n",
@@ -118,6 +123,257 @@ static int chpl_make_vdebug_file (const char *rootname) {
     return 0;
 }
 
+//
+// Binary trace support
+//
+// With the binary format, events are not formatted as they happen.
+// Instead each thread appends fixed-size records to a buffer of its
+// own, and a full buffer goes to the file in a single write.  The
+// per-buffer lock is only contended while chpl_vdebug_stop() is
+// flushing all the buffers.  tools/chplvis/vdebug2trace.py converts
+// the files to Chrome trace-event JSON.
+//
+// A file is the 8-byte magic "chplvdb1" followed by records in the
+// writing node's byte order.  The first record is a VDB_START whose
+// size field holds sizeof(vdb_rec_t), which readers can use to detect
+// the byte order.  Name records are followed by 'size' bytes of name,
+// without a terminating NUL.
+//
+
+#define VDB_MAGIC "chplvdb1"
+#define VDB_TBUF_RECS 1024
+
+typedef enum {
+  VDB_START = 1,     // id: number of nodes, node: this node
+  VDB_STOP,
+  VDB_FNAME,         // name record; id: file index
+  VDB_FIDNAME,       // name record; fid, lineno, fileno
+  VDB_TAGNAME,       // name record; id: tag number
+  VDB_TAG,           // id: tag number
+  VDB_PAUSE,         // id: tag number
+  VDB_MARK,          // task is running a VisualDebug routine
+  VDB_TASK_CREATE,   // id: new task, sub: is_executeOn, fid, lineno, fileno
+  VDB_TASK_BEGIN,    // task: the beginning task, fid, lineno, fileno
+  VDB_TASK_END,      // task: the ending task
+  VDB_PUT,           // comm: node: remote node, size: bytes, sub: commID
+  VDB_GET,
+  VDB_PUT_NB,
+  VDB_GET_NB,
+  VDB_PUT_STRD,
+  VDB_GET_STRD,
+  VDB_FORK,          // on-stmt: node: remote node, sub: sublocale, fid,
+  VDB_FORK_NB,       //   size: argument size
+  VDB_FORK_FAST
+} vdb_kind_t;
+
+typedef struct {
+  uint32_t kind;
+  int32_t  thread;   // index of the recording thread within its node
+  int64_t  time;     // nanoseconds since the epoch
+  uint64_t task;     // current task, or the task the event is about
+  uint64_t id;
+  uint64_t size;
+  int32_t  node;
+  int32_t  sub;
+  int32_t  lineno;
+  int32_t  fileno;
+  int32_t  fid;
+  int32_t  pad;
+} vdb_rec_t;
+
+typedef struct vdb_tbuf {
+  struct vdb_tbuf* next;
+  atomic_spinlock_t lock;
+  int32_t thread;
+  int32_t n;
+  vdb_rec_t recs[VDB_TBUF_RECS];
+} vdb_tbuf_t;
+
+static int vdb_binary = 0;
+static int vdb_initialized = 0;
+static int32_t vdb_num_threads = 0;
+static vdb_tbuf_t* vdb_tbufs_head = NULL;
+static atomic_spinlock_t vdb_tbufs_lock;
+static atomic_spinlock_t vdb_file_lock;
+static CHPL_TLS_DECL(vdb_tbuf_t*, vdb_my_tbuf);
+
+
+static inline
+int64_t vdb_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+//
+// Write all of buf to the file.  Callers hold vdb_file_lock.
+//
+static void vdb_write (const void *buf, size_t len) {
+  const char *p = (const char *) buf;
+  while (len > 0 && chpl_vdebug_fd >= 0) {
+    ssize_t wrv = write (chpl_vdebug_fd, p, len);
+    if (wrv < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    p += wrv;
+    len -= wrv;
+  }
+}
+
+
+//
+// Write out a thread's buffered records.  Callers hold its lock.
+//
+static void vdb_flush_tbuf (vdb_tbuf_t *tb) {
+  if (tb->n > 0) {
+    atomic_lock_spinlock_t(&vdb_file_lock);
+    vdb_write (tb->recs, tb->n * sizeof(tb->recs[0]));
+    atomic_unlock_spinlock_t(&vdb_file_lock);
+    tb->n = 0;
+  }
+}
+
+
+static vdb_tbuf_t* vdb_get_tbuf (void) {
+  vdb_tbuf_t* tb = (vdb_tbuf_t*) CHPL_TLS_GET(vdb_my_tbuf);
+  if (tb == NULL) {
+    tb = (vdb_tbuf_t*) chpl_mem_allocManyZero(1, sizeof(*tb),
+                                              CHPL_RT_MD_VDEBUG_TRACE_DATA,
+                                              0, 0);
+    atomic_init_spinlock_t(&tb->lock);
+
+    atomic_lock_spinlock_t(&vdb_tbufs_lock);
+    tb->thread = vdb_num_threads++;
+    tb->next = vdb_tbufs_head;
+    vdb_tbufs_head = tb;
+    atomic_unlock_spinlock_t(&vdb_tbufs_lock);
+
+    CHPL_TLS_SET(vdb_my_tbuf, tb);
+  }
+  return tb;
+}
+
+
+//
+// Append an event record to this thread's buffer, filling in the
+// thread and the time.
+//
+static void vdb_record (vdb_rec_t *r) {
+  vdb_tbuf_t *tb;
+  if (chpl_vdebug_fd < 0) return;
+  tb = vdb_get_tbuf ();
+  r->thread = tb->thread;
+  r->time = vdb_now ();
+  atomic_lock_spinlock_t(&tb->lock);
+  tb->recs[tb->n++] = *r;
+  if (tb->n == VDB_TBUF_RECS)
+    vdb_flush_tbuf (tb);
+  atomic_unlock_spinlock_t(&tb->lock);
+}
+
+
+//
+// Write a name record directly to the file.
+//
+static void vdb_record_name (vdb_rec_t *r, const char *name) {
+  if (chpl_vdebug_fd < 0) return;
+  r->time = vdb_now ();
+  r->size = strlen (name);
+  atomic_lock_spinlock_t(&vdb_file_lock);
+  vdb_write (r, sizeof(*r));
+  vdb_write (name, r->size);
+  atomic_unlock_spinlock_t(&vdb_file_lock);
+}
+
+
+static void vdb_start (void) {
+  vdb_rec_t r = { .kind = VDB_START, .task = chpl_task_getId(),
+                  .id = chpl_numNodes, .size = sizeof(vdb_rec_t),
+                  .node = chpl_nodeID };
+
+  if (!vdb_initialized) {
+    CHPL_TLS_INIT(vdb_my_tbuf);
+    atomic_init_spinlock_t(&vdb_tbufs_lock);
+    atomic_init_spinlock_t(&vdb_file_lock);
+    vdb_initialized = 1;
+  }
+
+  r.time = vdb_now ();
+  atomic_lock_spinlock_t(&vdb_file_lock);
+  vdb_write (VDB_MAGIC, strlen (VDB_MAGIC));
+  vdb_write (&r, sizeof(r));
+  atomic_unlock_spinlock_t(&vdb_file_lock);
+
+  // Dump file names and function names
+  if (chpl_nodeID == 0) {
+    int ix;
+    for (ix = 0; ix < chpl_filenameTableSize ; ix++) {
+      vdb_rec_t fr = { .kind = VDB_FNAME, .id = ix };
+      vdb_record_name (&fr, chpl_filenameTable[ix]);
+    }
+    for (ix = 0; chpl_finfo[ix].name != NULL; ix++) {
+      vdb_rec_t fr = { .kind = VDB_FIDNAME, .fid = ix,
+                       .lineno = chpl_finfo[ix].lineno,
+                       .fileno = chpl_finfo[ix].fileno };
+      vdb_record_name (&fr, chpl_finfo[ix].name);
+    }
+  }
+}
+
+
+static void vdb_stop (void) {
+  vdb_rec_t r = { .kind = VDB_STOP, .task = chpl_task_getId(),
+                  .node = chpl_nodeID };
+  vdb_record (&r);
+
+  atomic_lock_spinlock_t(&vdb_tbufs_lock);
+  for (vdb_tbuf_t *tb = vdb_tbufs_head; tb != NULL; tb = tb->next) {
+    atomic_lock_spinlock_t(&tb->lock);
+    vdb_flush_tbuf (tb);
+    atomic_unlock_spinlock_t(&tb->lock);
+  }
+  atomic_unlock_spinlock_t(&vdb_tbufs_lock);
+}
+
+
+static inline
+void vdb_comm (vdb_kind_t kind, const chpl_comm_cb_info_t *info) {
+  const struct chpl_comm_info_comm *cm = &info->iu.comm;
+  vdb_rec_t r = { .kind = kind, .task = chpl_task_getId(),
+                  .size = cm->size, .node = info->remoteNodeID,
+                  .sub = cm->commID,
+                  .lineno = cm->lineno, .fileno = cm->filename };
+  vdb_record (&r);
+}
+
+
+static inline
+void vdb_comm_strd (vdb_kind_t kind, const chpl_comm_cb_info_t *info) {
+  const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
+  size_t length = cm->elemSize;
+  for (int32_t i = 0; i < cm->stridelevels; i++) {
+    length *= cm->count[i];
+  }
+  vdb_rec_t r = { .kind = kind, .task = chpl_task_getId(),
+                  .size = length, .node = info->remoteNodeID,
+                  .sub = cm->commID, .lineno = cm->lineno,
+                  .fileno = cm->filename };
+  vdb_record (&r);
+}
+
+
+static inline
+void vdb_fork (vdb_kind_t kind, const chpl_comm_cb_info_t *info) {
+  const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
+  vdb_rec_t r = { .kind = kind, .task = chpl_task_getId(),
+                  .size = cm->arg_size, .node = info->remoteNodeID,
+                  .sub = cm->subloc, .lineno = cm->lineno,
+                  .fileno = cm->filename, .fid = cm->fid };
+  vdb_record (&r);
+}
+
 // Record>  ChplVdebug: ver # nid # tid # seq time.sec user.time system.time 
 //
 //  Ver # -- version number, currently 1.1
@@ -125,7 +381,7 @@ static int chpl_make_vdebug_file (const char *rootname) {
 //  tid # -- taskID
 //  seq time.sec -- unique number for this run
 
-void chpl_vdebug_start (const char *fileroot, double now) {
+void chpl_vdebug_start (const char *fileroot, double now, chpl_bool binary) {
   const char * rootname;
   struct rusage ru;
   struct timeval tv;
@@ -147,9 +403,16 @@ void chpl_vdebug_start (const char *fileroot, double now) {
   rootname = (fileroot == NULL || fileroot[0] == 0) ? ".Vdebug" : fileroot; 
   
   // In case of an error, just return
-  if (chpl_make_vdebug_file (rootname) < 0)
+  vdb_binary = binary;
+  if (chpl_make_vdebug_file (rootname, binary ? ".bin" : "") < 0)
     return;
-  
+
+  if (vdb_binary) {
+    vdb_start ();
+    chpl_vdebug = 1;
+    return;
+  }
+
   // Write initial information to the file, including resource time
   if ( getrusage (RUSAGE_SELF, &ru) < 0) {
     ru.ru_utime.tv_sec = 0;
@@ -211,7 +474,11 @@ void chpl_vdebug_stop (void) {
   uninstall_callbacks();
 
   // Now log the stop
-  if (chpl_vdebug_fd >= 0) {
+  if (chpl_vdebug_fd >= 0 && vdb_binary) {
+    vdb_stop ();
+    close (chpl_vdebug_fd);
+    chpl_vdebug_fd = -1;
+  } else if (chpl_vdebug_fd >= 0) {
     (void) gettimeofday (&tv, NULL);
     if ( getrusage (RUSAGE_SELF, &ru) < 0) {
       ru.ru_utime.tv_sec = 0;
@@ -239,6 +506,11 @@ void chpl_vdebug_mark (void) {
   struct timeval tv;
   chpl_taskID_t tagTask = chpl_task_getId();
   char buff[CHPL_TASK_ID_STRING_MAX_LEN];
+  if (vdb_binary) {
+    vdb_rec_t r = { .kind = VDB_MARK, .task = tagTask };
+    vdb_record (&r);
+    return;
+  }
   (void) gettimeofday (&tv, NULL);
   chpl_dprintf (chpl_vdebug_fd, "VdbMark: %lld.%06ld %d %s\n",
                 (long long) tv.tv_sec, (long) tv.tv_usec, chpl_nodeID, TID_STRING(buff, tagTask) );
@@ -247,6 +519,11 @@ void chpl_vdebug_mark (void) {
 // Record>  tname: tag# tagname
 
 void chpl_vdebug_tagname (const char* tagname, int tagno) {
+  if (vdb_binary) {
+    vdb_rec_t r = { .kind = VDB_TAGNAME, .id = tagno };
+    vdb_record_name (&r, tagname);
+    return;
+  }
   chpl_dprintf (chpl_vdebug_fd, "tname: %d %s\n", tagno, tagname);
 }
 
@@ -259,6 +536,13 @@ void chpl_vdebug_tag (int tagno) {
   chpl_taskID_t tagTask = chpl_task_getId();
   char buff[CHPL_TASK_ID_STRING_MAX_LEN];
 
+  if (vdb_binary) {
+    vdb_rec_t r = { .kind = VDB_TAG, .task = tagTask, .id = tagno };
+    chpl_vdebug = 1;
+    vdb_record (&r);
+    return;
+  }
+
   (void) gettimeofday (&tv, NULL);
   if ( getrusage (RUSAGE_SELF, &ru) < 0) {
     ru.ru_utime.tv_sec = 0;
@@ -282,7 +566,11 @@ void chpl_vdebug_pause (int tagno) {
   chpl_taskID_t pauseTask = chpl_task_getId();
   char buff[CHPL_TASK_ID_STRING_MAX_LEN];
 
-  if (chpl_vdebug_fd >=0 && chpl_vdebug == 1) {
+  if (chpl_vdebug_fd >=0 && chpl_vdebug == 1 && vdb_binary) {
+    vdb_rec_t r = { .kind = VDB_PAUSE, .task = pauseTask, .id = tagno };
+    vdb_record (&r);
+    chpl_vdebug = 0;
+  } else if (chpl_vdebug_fd >=0 && chpl_vdebug == 1) {
     (void) gettimeofday (&tv, NULL);
     if ( getrusage (RUSAGE_SELF, &ru) < 0) {
       ru.ru_utime.tv_sec = 0;
@@ -311,6 +599,10 @@ void chpl_vdebug_pause (int tagno) {
 
 void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_comm (VDB_PUT_NB, info);
+      return;
+    }
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
     chpl_taskID_t commTask = chpl_task_getId();
@@ -332,6 +624,10 @@ void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
 
 void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_comm (VDB_GET_NB, info);
+      return;
+    }
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
     chpl_taskID_t commTask = chpl_task_getId();
@@ -352,6 +648,10 @@ void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
 
 void cb_comm_put (const chpl_comm_cb_info_t *info) {
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_comm (VDB_PUT, info);
+      return;
+    }
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
     chpl_taskID_t commTask = chpl_task_getId();
@@ -373,6 +673,10 @@ void cb_comm_put (const chpl_comm_cb_info_t *info) {
 
 void cb_comm_get (const chpl_comm_cb_info_t *info) {
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_comm (VDB_GET, info);
+      return;
+    }
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
     chpl_taskID_t commTask = chpl_task_getId();
@@ -392,6 +696,10 @@ void cb_comm_get (const chpl_comm_cb_info_t *info) {
 
 void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
     if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_comm_strd (VDB_PUT_STRD, info);
+      return;
+    }
     struct timeval tv;
     size_t length;
     const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
@@ -422,6 +730,10 @@ void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
 
 void cb_comm_get_strd (const chpl_comm_cb_info_t *info) {
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_comm_strd (VDB_GET_STRD, info);
+      return;
+    }
     struct timeval tv;
     size_t length;
     const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
@@ -450,6 +762,10 @@ void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
 
   // Visual Debug Support
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_fork (VDB_FORK, info);
+      return;
+    }
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
@@ -469,6 +785,10 @@ void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
 
 void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_fork (VDB_FORK_NB, info);
+      return;
+    }
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
@@ -486,6 +806,10 @@ void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
 
 void cb_comm_executeOn_fast (const chpl_comm_cb_info_t *info) {
   if (chpl_vdebug) {
+    if (vdb_binary) {
+      vdb_fork (VDB_FORK_FAST, info);
+      return;
+    }
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
@@ -601,6 +925,15 @@ int uninstall_callbacks (void) {
 void cb_task_create (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
+  if (vdb_binary) {
+    vdb_rec_t r = { .kind = VDB_TASK_CREATE, .task = chpl_task_getId(),
+                    .id = info->iu.full.id, .sub = info->iu.full.is_executeOn,
+                    .lineno = info->iu.full.lineno,
+                    .fileno = info->iu.full.filename,
+                    .fid = info->iu.full.fid };
+    vdb_record (&r);
+    return;
+  }
   if (chpl_vdebug_fd >= 0) {
     chpl_taskID_t taskId = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
@@ -624,6 +957,15 @@ void cb_task_create (const chpl_task_cb_info_t *info) {
 void cb_task_begin (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
+  if (vdb_binary) {
+    vdb_rec_t r = { .kind = VDB_TASK_BEGIN, .task = info->iu.full.id,
+                    .sub = info->iu.full.is_executeOn,
+                    .lineno = info->iu.full.lineno,
+                    .fileno = info->iu.full.filename,
+                    .fid = info->iu.full.fid };
+    vdb_record (&r);
+    return;
+  }
   if (chpl_vdebug_fd >= 0) {
     (void)gettimeofday(&tv, NULL);
     chpl_dprintf (chpl_vdebug_fd, "Btask: %lld.%06ld %lld %lu\n",
@@ -638,6 +980,11 @@ void cb_task_begin (const chpl_task_cb_info_t *info) {
 void cb_task_end (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
+  if (vdb_binary) {
+    vdb_rec_t r = { .kind = VDB_TASK_END, .task = info->iu.id_only.id };
+    vdb_record (&r);
+    return;
+  }
   if (chpl_vdebug_fd >= 0) {
     (void)gettimeofday(&tv, NULL);
     chpl_dprintf (chpl_vdebug_fd, "Etask: %lld.%06ld %lld %lu\n",
@@ -24,6 +24,8 @@
 #include "chpl-comm.h"
 #include "chplexit.h"
 #include "chpl-mem.h"
+#include "chpl-mem-array.h"
+#include "chpl-tasks-diags.h"
 #include "chplmemtrack.h"
 #include "chpl-topo.h"
 #include "gdb.h"
@@ -40,7 +42,9 @@ static void chpl_exit_common(int status, int all) {
   chpl_comm_pre_task_exit(all);
   if (all) {
     chpl_task_exit();
+    chpl_task_diags_exit();
     chpl_reportMemInfo();
+    chpl_mem_array_policy_report();
   }
   chpl_comm_exit(all, status);
   if (all) {
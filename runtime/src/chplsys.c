@@ -57,6 +57,8 @@
 #include <ctype.h>
 #include <signal.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/utsname.h>
@@ -764,6 +766,144 @@ int chpl_sys_getNumCPUsLogical(chpl_bool accessible_only) {
 }
 
 
+#ifdef __linux__
+//
+// Read a single-line sysfs attribute for the cache at the given index
+// into buf, returning whether or not that worked.
+//
+static chpl_bool readCacheAttr(int idx, const char* attr,
+                               char* buf, size_t bufSize) {
+  char fname[100];
+  FILE* f;
+  chpl_bool ok;
+
+  snprintf(fname, sizeof(fname),
+           "/sys/devices/system/cpu/cpu0/cache/index%d/%s", idx, attr);
+  if ((f = fopen(fname, "r")) == NULL)
+    return false;
+  ok = (fgets(buf, bufSize, f) != NULL);
+  fclose(f);
+  return ok;
+}
+
+
+//
+// Count the CPUs in a sysfs cpu list such as "0-3,8-11".
+//
+static int countCpuList(const char* s) {
+  int n = 0;
+  while (*s != '\0' && *s != '\n') {
+    char* end;
+    long lo = strtol(s, &end, 10);
+    long hi = lo;
+    if (end == s)
+      break;
+    if (*end == '-')
+      hi = strtol(end + 1, &end, 10);
+    n += (int) (hi - lo + 1);
+    s = (*end == ',') ? end + 1 : end;
+  }
+  return n;
+}
+#endif
+
+
+chpl_bool chpl_sys_getCacheInfo(int level, size_t* size, size_t* lineSize,
+                                int* assoc, int* numSharingPUs) {
+  *size = 0;
+  *lineSize = 0;
+  *assoc = 0;
+  *numSharingPUs = 0;
+
+#if defined __APPLE__
+  //
+  // Apple
+  //
+  static const char* sizeNames[] = { "hw.l1dcachesize", "hw.l2cachesize",
+                                     "hw.l3cachesize" };
+  uint64_t val;
+  size_t len = sizeof(val);
+  if (level < 1 || level > (int) (sizeof(sizeNames) / sizeof(sizeNames[0]))
+      || sysctlbyname(sizeNames[level - 1], &val, &len, NULL, 0) != 0
+      || val == 0)
+    return false;
+  *size = (size_t) val;
+  len = sizeof(val);
+  if (sysctlbyname("hw.cachelinesize", &val, &len, NULL, 0) == 0)
+    *lineSize = (size_t) val;
+  return true;
+#elif defined __linux__
+  //
+  // Linux: prefer sysfs, which also tells us about sharing, and fall
+  // back to sysconf() if that isn't available.
+  //
+  char buf[100];
+  for (int idx = 0; readCacheAttr(idx, "level", buf, sizeof(buf)); idx++) {
+    if (atoi(buf) != level
+        || !readCacheAttr(idx, "type", buf, sizeof(buf))
+        || strncmp(buf, "Instruction", 11) == 0)
+      continue;
+
+    if (readCacheAttr(idx, "size", buf, sizeof(buf))) {
+      char* end;
+      size_t sz = (size_t) strtoul(buf, &end, 10);
+      if (*end == 'K')
+        sz <<= 10;
+      else if (*end == 'M')
+        sz <<= 20;
+      else if (*end == 'G')
+        sz <<= 30;
+      *size = sz;
+    }
+    if (readCacheAttr(idx, "coherency_line_size", buf, sizeof(buf)))
+      *lineSize = (size_t) strtoul(buf, NULL, 10);
+    if (readCacheAttr(idx, "ways_of_associativity", buf, sizeof(buf)))
+      *assoc = atoi(buf);
+    if (readCacheAttr(idx, "shared_cpu_list", buf, sizeof(buf)))
+      *numSharingPUs = countCpuList(buf);
+    return *size > 0;
+  }
+
+#if defined _SC_LEVEL1_DCACHE_SIZE
+  {
+    long sz = -1, ls = -1, as = -1;
+    switch (level) {
+    case 1:
+      sz = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+      ls = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+      as = sysconf(_SC_LEVEL1_DCACHE_ASSOC);
+      break;
+    case 2:
+      sz = sysconf(_SC_LEVEL2_CACHE_SIZE);
+      ls = sysconf(_SC_LEVEL2_CACHE_LINESIZE);
+      as = sysconf(_SC_LEVEL2_CACHE_ASSOC);
+      break;
+    case 3:
+      sz = sysconf(_SC_LEVEL3_CACHE_SIZE);
+      ls = sysconf(_SC_LEVEL3_CACHE_LINESIZE);
+      as = sysconf(_SC_LEVEL3_CACHE_ASSOC);
+      break;
+    case 4:
+      sz = sysconf(_SC_LEVEL4_CACHE_SIZE);
+      ls = sysconf(_SC_LEVEL4_CACHE_LINESIZE);
+      as = sysconf(_SC_LEVEL4_CACHE_ASSOC);
+      break;
+    }
+    if (sz > 0) {
+      *size = (size_t) sz;
+      *lineSize = (ls > 0) ? (size_t) ls : 0;
+      *assoc = (as > 0) ? (int) as : 0;
+      return true;
+    }
+  }
+#endif
+  return false;
+#else
+  return false;
+#endif
+}
+
+
 // Using a static buffer is a bad idea from the standpoint of thread-safety.
 // However, since the node name is not expected to change it is OK to
 // initialize it once and share the singleton string.
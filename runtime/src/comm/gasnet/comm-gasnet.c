@@ -1365,6 +1365,87 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   gasnet_puts_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls);
 }
 
+//
+// Vectored transfers map onto GASNet's gasnet_putv_bulk() and
+// gasnet_getv_bulk() when every remote piece is in the segment.
+// Otherwise we move the pieces one at a time, and chpl_comm_put() or
+// chpl_comm_get() deals with the ones that aren't.
+//
+static int remote_v_in_segment(c_nodeid_t node, size_t n, void** raddrs,
+                               size_t* sizes) {
+#ifdef GASNET_SEGMENT_EVERYTHING
+  return 1;
+#else
+  size_t i;
+  for (i = 0; i < n; i++) {
+    if (!chpl_comm_addr_gettable(node, raddrs[i], sizes[i]))
+      return 0;
+  }
+  return 1;
+#endif
+}
+
+static void fill_memvecs(gasnet_memvec_t** lvec_p, gasnet_memvec_t** rvec_p,
+                         size_t n, void** addrs, void** raddrs,
+                         size_t* sizes) {
+  gasnet_memvec_t* lvec;
+  gasnet_memvec_t* rvec;
+  size_t i;
+
+  lvec = chpl_mem_allocMany(2 * n, sizeof(*lvec),
+                            CHPL_RT_MD_GETS_PUTS_STRIDES, 0, 0);
+  rvec = lvec + n;
+  for (i = 0; i < n; i++) {
+    lvec[i].addr = addrs[i];
+    lvec[i].len = sizes[i];
+    rvec[i].addr = raddrs[i];
+    rvec[i].len = sizes[i];
+  }
+
+  *lvec_p = lvec;
+  *rvec_p = rvec;
+}
+
+void chpl_comm_put_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn) {
+  gasnet_memvec_t* lvec;
+  gasnet_memvec_t* rvec;
+  size_t i;
+
+  if (chpl_nodeID == node || !remote_v_in_segment(node, n, raddrs, sizes)) {
+    for (i = 0; i < n; i++)
+      chpl_comm_put(addrs[i], node, raddrs[i], sizes[i], commID, ln, fn);
+    return;
+  }
+
+  chpl_comm_diags_verbose_rdmaV("put", node, n, ln, fn, commID);
+  chpl_comm_diags_incr(put);
+
+  fill_memvecs(&lvec, &rvec, n, addrs, raddrs, sizes);
+  gasnet_putv_bulk((gasnet_node_t) node, n, rvec, n, lvec);
+  chpl_mem_free(lvec, 0, 0);
+}
+
+void chpl_comm_get_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn) {
+  gasnet_memvec_t* lvec;
+  gasnet_memvec_t* rvec;
+  size_t i;
+
+  if (chpl_nodeID == node || !remote_v_in_segment(node, n, raddrs, sizes)) {
+    for (i = 0; i < n; i++)
+      chpl_comm_get(addrs[i], node, raddrs[i], sizes[i], commID, ln, fn);
+    return;
+  }
+
+  chpl_comm_diags_verbose_rdmaV("get", node, n, ln, fn, commID);
+  chpl_comm_diags_incr(get);
+
+  fill_memvecs(&lvec, &rvec, n, addrs, raddrs, sizes);
+  gasnet_getv_bulk(n, lvec, (gasnet_node_t) node, n, rvec);
+  chpl_mem_free(lvec, 0, 0);
+}
+
 #define MAX_UNORDERED_TRANS_SZ 1024
 void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                 c_nodeid_t srcnode, void* srcaddr,
@@ -198,6 +198,22 @@ void  chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides, c_nodeid_t srcno
                   commID, ln, fn);
 }
 
+void chpl_comm_put_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn)
+{
+  assert(node==0);
+  for (size_t i = 0; i < n; i++)
+    memmove(raddrs[i], addrs[i], sizes[i]);
+}
+
+void chpl_comm_get_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn)
+{
+  assert(node==0);
+  for (size_t i = 0; i < n; i++)
+    memmove(addrs[i], raddrs[i], sizes[i]);
+}
+
 void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                 c_nodeid_t srcnode, void* srcaddr,
                                 size_t size, int32_t commID,
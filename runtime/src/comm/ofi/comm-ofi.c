@@ -205,6 +205,16 @@ struct amRequest_execOnLrg_t {
 
 static int numAmHandlers = 1;
 
+//
+// Aggregation of small nonblocking executeOns; see "Active Message
+// aggregation", below.
+//
+#define AM_AGG_NUM_DESTS 4         // dest buffers per task
+#define AM_AGG_MAX_BUNDLE_SIZE 256 // largest arg bundle we'll aggregate
+
+static chpl_bool amAggEnabled = false;
+static double amAggMaxWait;     // max secs a bundle may wait in a buffer
+
 //
 // AM request landing zones.
 //
@@ -2557,6 +2567,7 @@ int mrGetLocalKey(void* addr, size_t size) {
 static inline void amRequestNop(c_nodeid_t, chpl_bool);
 static inline chpl_bool setUpDelayedAmDone(chpl_comm_taskPrvData_t**, void**);
 static inline void retireDelayedAmDone(chpl_bool);
+static void amAggFlush(chpl_bool);
 
 static inline
 void mcmReleaseOneNode(c_nodeid_t node, struct perTxCtxInfo_t* tcip,
@@ -2616,6 +2627,7 @@ void chpl_comm_impl_unordered_task_fence(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
   task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  amAggFlush(false /*taskIsEnding*/);
 }
 
 
@@ -2628,10 +2640,18 @@ void chpl_comm_impl_task_create(void) {
 }
 
 
+void chpl_comm_impl_task_join(void) {
+  DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
+
+  amAggFlush(false /*taskIsEnding*/);
+}
+
+
 void chpl_comm_impl_task_end(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
   task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  amAggFlush(true /*taskIsEnding*/);
   retireDelayedAmDone(true /*taskIsEnding*/);
   waitForPutsVisAllNodes(NULL, NULL, true /*taskIsEnding*/);
 }
@@ -2645,6 +2665,7 @@ void chpl_comm_impl_task_end(void) {
 typedef enum {
   am_opExecOn = CHPL_ARG_BUNDLE_KIND_COMM, // impl-nonspecific on-stmt
   am_opExecOnLrg,                          // on-stmt, large arg
+  am_opExecOnAgg,                          // several nonblocking on-stmts
   am_opGet,                                // do an RMA GET
   am_opPut,                                // do an RMA PUT
   am_opAMO,                                // do an AMO
@@ -2712,6 +2733,13 @@ struct amRequest_free_t {
   void* p;                      // address to free, on AM target node
 };
 
+struct amRequest_execOnAgg_t {
+  struct amRequest_base_t b;
+  uint32_t numBundles;          // number of on-stmt arg bundles
+  uint32_t size;                // bytes of 'space' in use
+  char space[AM_MAX_EXEC_ON_PAYLOAD_SIZE]; // bundles, each 8-byte aligned
+};
+
 typedef union {
   struct amRequest_base_t b;
   struct amRequest_execOn_t xo;      // present only to set the max req size
@@ -2719,6 +2747,7 @@ typedef union {
   struct amRequest_RMA_t rma;
   struct amRequest_AMO_t amo;
   struct amRequest_free_t free;
+  struct amRequest_execOnAgg_t xoa;
 } amRequest_t;
 
 struct taskArg_RMA_t {
@@ -2747,6 +2776,7 @@ static void amRequestNop(c_nodeid_t, chpl_bool);
 static void amRequestCommon(c_nodeid_t, amRequest_t*, size_t,
                             amDone_t**, chpl_bool, struct perTxCtxInfo_t*);
 static inline void amWaitForDone(amDone_t*);
+static chpl_bool amAggAdd(c_nodeid_t, chpl_comm_on_bundle_t*, size_t);
 
 
 void chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
@@ -2830,6 +2860,9 @@ void amRequestExecOn(c_nodeid_t node, c_sublocid_t subloc,
   CHK_TRUE(!(fast && !blocking)); // handler doesn't expect fast nonblocking
 
   retireDelayedAmDone(false /*taskIsEnding*/);
+  if (blocking) {
+    amAggFlush(false /*taskIsEnding*/);
+  }
 
   arg->comm = (chpl_comm_bundleData_t) { .fast = fast,
                                          .fid = fid,
@@ -2837,6 +2870,16 @@ void amRequestExecOn(c_nodeid_t node, c_sublocid_t subloc,
                                          .subloc = subloc,
                                          .argSize = argSize, };
 
+  if (!blocking && amAggEnabled && argSize <= AM_AGG_MAX_BUNDLE_SIZE) {
+    //
+    // Small nonblocking on-stmt; try to add it to an aggregation buffer.
+    //
+    arg->kind = am_opExecOn;
+    if (amAggAdd(node, arg, argSize)) {
+      return;
+    }
+  }
+
   if (argSize <= sizeof(amRequest_t)) {
     //
     // The arg bundle will fit in max-sized AM request; just send it.
@@ -3208,6 +3251,216 @@ void retireDelayedAmDone(chpl_bool taskIsEnding) {
 }
 
 
+////////////////////////////////////////
+//
+// Active Message aggregation
+//
+// Programs that fire off many tiny 'begin on' statements can be
+// limited by the AM rate rather than by the network bandwidth.  When
+// CHPL_RT_COMM_OFI_AM_AGG is set, each task gathers its small
+// nonblocking executeOn bundles into per-destination buffers and sends
+// each buffer as a single AM request, which the target unpacks into
+// one task per bundle.  A buffer is sent when it is full, when it has
+// been waiting for longer than CHPL_RT_COMM_OFI_AM_AGG_MAX_USEC, or
+// when the task needs its slot for a different destination.  All of a
+// task's buffers are sent when it does a blocking executeOn, waits for
+// the tasks it created, hits an unordered-ops fence, or ends.  Finally,
+// so that a task spinning locally on something one of its buffered
+// on-stmts will do cannot wait forever, the AM handler also sends any
+// buffer that has been waiting too long.
+//
+// Before a bundle is buffered we make the task's prior PUTs visible,
+// just as we would before sending it directly.  That way the buffer
+// can be sent later, by either the task or the AM handler, with no MCM
+// obligations remaining.
+//
+
+struct amAggDest_t {
+  c_nodeid_t node;              // destination, if req.numBundles > 0
+  double tFirst;                // when the first bundle was added
+  struct amRequest_execOnAgg_t req;
+};
+
+struct amAggInfo_t {
+  atomic_bool busy;             // owning task or AM handler using it
+  struct amAggInfo_t* prev;     // all task buffers, for the AM handler
+  struct amAggInfo_t* next;
+  struct amAggDest_t dests[AM_AGG_NUM_DESTS];
+};
+
+static struct amAggInfo_t* amAggList;
+static pthread_mutex_t amAggListLock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint_least32_t amAggNumPending; // #non-empty dest buffers
+
+
+static inline
+size_t amAggBundleSpace(size_t argSize) {
+  return (argSize + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+
+static inline
+void amAggLock(struct amAggInfo_t* info) {
+  while (atomic_exchange_bool(&info->busy, true)) {
+    local_yield();
+  }
+}
+
+
+static inline
+void amAggUnlock(struct amAggInfo_t* info) {
+  atomic_store_bool(&info->busy, false);
+}
+
+
+static
+void amAggSendDest(struct amAggDest_t* d, struct perTxCtxInfo_t* tcip) {
+  struct amRequest_execOnAgg_t* xoa = &d->req;
+  xoa->b = (struct amRequest_base_t) { .op = am_opExecOnAgg,
+                                       .node = chpl_nodeID, };
+  amRequestCommon(d->node, (amRequest_t*) xoa,
+                  offsetof(struct amRequest_execOnAgg_t, space) + xoa->size,
+                  NULL, false /*yieldDuringTxnWait*/, tcip);
+  xoa->numBundles = 0;
+  xoa->size = 0;
+  (void) atomic_fetch_sub_uint_least32_t(&amAggNumPending, 1);
+}
+
+
+static
+chpl_bool amAggAdd(c_nodeid_t node,
+                   chpl_comm_on_bundle_t* arg, size_t argSize) {
+  chpl_comm_taskPrvData_t* prvData = get_comm_taskPrvdata();
+  if (prvData == NULL) {
+    return false;
+  }
+
+  struct amAggInfo_t* info = prvData->am_agg_buff;
+  if (info == NULL) {
+    info = chpl_mem_alloc(sizeof(*info), CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    atomic_init_bool(&info->busy, false);
+    for (int i = 0; i < AM_AGG_NUM_DESTS; i++) {
+      info->dests[i].req.numBundles = 0;
+      info->dests[i].req.size = 0;
+    }
+    PTHREAD_CHK(pthread_mutex_lock(&amAggListLock));
+    info->prev = NULL;
+    info->next = amAggList;
+    if (amAggList != NULL) {
+      amAggList->prev = info;
+    }
+    amAggList = info;
+    PTHREAD_CHK(pthread_mutex_unlock(&amAggListLock));
+    prvData->am_agg_buff = info;
+  }
+
+  waitForPutsVisAllNodes(NULL, NULL, false /*taskIsEnding*/);
+
+  amAggLock(info);
+
+  struct amAggDest_t* d = &info->dests[node % AM_AGG_NUM_DESTS];
+  const size_t space = amAggBundleSpace(argSize);
+  if (d->req.numBundles > 0
+      && (d->node != node || d->req.size + space > sizeof(d->req.space))) {
+    amAggSendDest(d, NULL);
+  }
+
+  if (d->req.numBundles == 0) {
+    d->node = node;
+    d->tFirst = chpl_comm_ofi_time_get();
+    (void) atomic_fetch_add_uint_least32_t(&amAggNumPending, 1);
+  }
+
+  memcpy(&d->req.space[d->req.size], arg, argSize);
+  d->req.size += space;
+  d->req.numBundles++;
+
+  DBG_PRINTF(DBG_AM | DBG_AM_SEND,
+             "AM agg to %d: fid %d, sz %zd, now %" PRIu32 " bundles",
+             (int) node, (int) arg->comm.fid, argSize, d->req.numBundles);
+
+  if (sizeof(d->req.space) - d->req.size < sizeof(chpl_comm_on_bundle_t)
+      || chpl_comm_ofi_time_get() - d->tFirst > amAggMaxWait) {
+    amAggSendDest(d, NULL);
+  }
+
+  amAggUnlock(info);
+  return true;
+}
+
+
+static
+void amAggFlush(chpl_bool taskIsEnding) {
+  //
+  // Send all of this task's aggregated executeOns.  If the task is
+  // ending, get rid of its buffers as well.
+  //
+  chpl_comm_taskPrvData_t* prvData = get_comm_taskPrvdata();
+  struct amAggInfo_t* info;
+  if (prvData == NULL || (info = prvData->am_agg_buff) == NULL) {
+    return;
+  }
+
+  amAggLock(info);
+  for (int i = 0; i < AM_AGG_NUM_DESTS; i++) {
+    if (info->dests[i].req.numBundles > 0) {
+      amAggSendDest(&info->dests[i], NULL);
+    }
+  }
+  amAggUnlock(info);
+
+  if (taskIsEnding) {
+    PTHREAD_CHK(pthread_mutex_lock(&amAggListLock));
+    if (info->prev == NULL) {
+      amAggList = info->next;
+    } else {
+      info->prev->next = info->next;
+    }
+    if (info->next != NULL) {
+      info->next->prev = info->prev;
+    }
+    PTHREAD_CHK(pthread_mutex_unlock(&amAggListLock));
+
+    atomic_destroy_bool(&info->busy);
+    chpl_mem_free(info, 0, 0);
+    prvData->am_agg_buff = NULL;
+  }
+}
+
+
+static
+void amAggSendStale(struct perTxCtxInfo_t* tcip) {
+  //
+  // The AM handler runs this, to send buffers whose owning tasks are
+  // not getting around to it.  Buffers in use by their owners at the
+  // moment are skipped; the owners will take care of them.
+  //
+  if (atomic_load_uint_least32_t(&amAggNumPending) == 0) {
+    return;
+  }
+
+  const double now = chpl_comm_ofi_time_get();
+  PTHREAD_CHK(pthread_mutex_lock(&amAggListLock));
+  for (struct amAggInfo_t* info = amAggList;
+       info != NULL;
+       info = info->next) {
+    if (atomic_exchange_bool(&info->busy, true)) {
+      continue;
+    }
+    for (int i = 0; i < AM_AGG_NUM_DESTS; i++) {
+      struct amAggDest_t* d = &info->dests[i];
+      if (d->req.numBundles > 0 && now - d->tFirst > amAggMaxWait) {
+        DBG_PRINTF(DBG_AM | DBG_AM_SEND,
+                   "AM agg to %d: sending stale buffer", (int) d->node);
+        amAggSendDest(d, tcip);
+      }
+    }
+    amAggUnlock(info);
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&amAggListLock));
+}
+
+
 ////////////////////////////////////////
 //
 // Handler-side active message support
@@ -3222,6 +3475,7 @@ static void processRxAmReq(struct perTxCtxInfo_t*);
 static void amHandleExecOn(chpl_comm_on_bundle_t*);
 static inline void amWrapExecOnBody(void*);
 static void amHandleExecOnLrg(chpl_comm_on_bundle_t*);
+static void amHandleExecOnAgg(struct amRequest_execOnAgg_t*);
 static void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t*);
 static void amWrapGet(struct taskArg_RMA_t*);
 static void amWrapPut(struct taskArg_RMA_t*);
@@ -3241,8 +3495,14 @@ void init_amHandling(void) {
   {
     chpl_comm_taskPrvData_t pd;
     CHK_TRUE(sizeof(pd.amDone) >= sizeof(amDone_t));
+    CHK_TRUE(sizeof(struct amRequest_execOnAgg_t)
+             <= sizeof(struct amRequest_execOn_t));
   }
 
+  amAggEnabled = chpl_env_rt_get_bool("COMM_OFI_AM_AGG", false);
+  amAggMaxWait = chpl_env_rt_get_int("COMM_OFI_AM_AGG_MAX_USEC", 100) * 1e-6;
+  atomic_init_uint_least32_t(&amAggNumPending, 0);
+
   //
   // Start AM handler thread(s).  Don't proceed from here until at
   // least one is running.
@@ -3311,7 +3571,13 @@ void amHandler(void* argNil) {
       OFI_CHK_COUNT(fi_poll(ofi_amhPollSet, contexts, pollSetSize), ret);
 
       if (ret == 0) {
-        ret = fi_wait(ofi_amhWaitSet, 100 /*ms*/);
+        //
+        // Don't sleep long if some task's aggregated executeOns may
+        // need to be sent on its behalf.
+        //
+        const int timeout =
+          (atomic_load_uint_least32_t(&amAggNumPending) == 0) ? 100 : 1;
+        ret = fi_wait(ofi_amhWaitSet, timeout /*ms*/);
         if (ret != FI_SUCCESS
             && ret != -FI_EINTR
             && ret != -FI_ETIMEDOUT) {
@@ -3349,6 +3615,10 @@ void amHandler(void* argNil) {
       sched_yield();
     }
 
+    if (amAggEnabled) {
+      amAggSendStale(tcip);
+    }
+
     if (amDoLivenessChecks) {
       amCheckLiveness();
     }
@@ -3413,8 +3683,9 @@ void processRxAmReq(struct perTxCtxInfo_t* tcip) {
                     ? sizeof(struct amRequest_AMO_t)
                     : (req->b.op == am_opFree)
                     ? sizeof(struct amRequest_free_t)
-                    : (req->b.op == am_opFree)
-                    ? sizeof(struct amRequest_free_t)
+                    : (req->b.op == am_opExecOnAgg)
+                    ? offsetof(struct amRequest_execOnAgg_t, space)
+                      + req->xoa.size
                     : sizeof(struct amRequest_base_t);
         }
         uint32_t rcvd_crc = xcrc32((void*) req, reqSize, ~(uint32_t) 0);
@@ -3438,6 +3709,10 @@ void processRxAmReq(struct perTxCtxInfo_t* tcip) {
         amHandleExecOnLrg(&req->xol.hdr);
         break;
 
+      case am_opExecOnAgg:
+        amHandleExecOnAgg(&req->xoa);
+        break;
+
       case am_opGet:
         {
           struct taskArg_RMA_t arg = { .hdr.kind = CHPL_ARG_BUNDLE_KIND_TASK,
@@ -3538,6 +3813,21 @@ void amHandleExecOnLrg(chpl_comm_on_bundle_t* req) {
 }
 
 
+static
+void amHandleExecOnAgg(struct amRequest_execOnAgg_t* xoa) {
+  //
+  // Start a task for each of the bundled nonblocking on-stmts.  Each
+  // bundle is a complete, ordinary executeOn request.
+  //
+  char* p = xoa->space;
+  for (uint32_t i = 0; i < xoa->numBundles; i++) {
+    chpl_comm_on_bundle_t* bundle = (chpl_comm_on_bundle_t*) p;
+    amHandleExecOn(bundle);
+    p += amAggBundleSpace(bundle->comm.argSize);
+  }
+}
+
+
 static
 void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t* xol) {
   //
@@ -3715,6 +4005,238 @@ void amCheckLiveness(void) {
 }
 
 
+////////////////////////////////////////
+//
+// Vectored RMA
+//
+// Strided and vectored transfers both come down to a list of
+// contiguous pieces moving between local memory and one remote node.
+// Rather than doing a blocking PUT or GET for each piece, we gather
+// them into fi_writemsg() or fi_readmsg() calls, each carrying as many
+// pieces as the provider's iov limits allow, initiate those back to
+// back, and wait for the whole batch at the end.  Pieces that are
+// adjacent on both sides are merged first, so a strided transfer whose
+// inner dimension is contiguous on one side costs no more than needed.
+// A piece whose remote side isn't RMA-accessible or whose local side
+// has no memory descriptor goes through the regular ofi_put()/ofi_get()
+// path, which knows how to deal with that.
+//
+
+#define RMA_V_MAX_IOV 16
+
+struct rmaVBatch_t {
+  chpl_bool isPut;
+  c_nodeid_t node;
+  struct perTxCtxInfo_t* tcip;
+  size_t iovLimit;              // max pieces per message
+  size_t numIov;                // pieces in the message being built
+  size_t msgLen;                // bytes in the message being built
+  chpl_bool anyRma;             // have we initiated any messages?
+  struct iovec iov[RMA_V_MAX_IOV];
+  void* desc[RMA_V_MAX_IOV];
+  struct fi_rma_iov rmaIov[RMA_V_MAX_IOV];
+};
+
+
+static
+void rmaVBegin(struct rmaVBatch_t* b, chpl_bool isPut, c_nodeid_t node) {
+  b->isPut = isPut;
+  b->node = node;
+  b->tcip = NULL;
+  b->iovLimit = RMA_V_MAX_IOV;
+  if (b->iovLimit > ofi_info->tx_attr->iov_limit) {
+    b->iovLimit = ofi_info->tx_attr->iov_limit;
+  }
+  if (b->iovLimit > ofi_info->tx_attr->rma_iov_limit) {
+    b->iovLimit = ofi_info->tx_attr->rma_iov_limit;
+  }
+  if (b->iovLimit == 0) {
+    b->iovLimit = 1;
+  }
+  b->numIov = 0;
+  b->msgLen = 0;
+  b->anyRma = false;
+}
+
+
+//
+// Initiate the message we've been building.  Say whether we expect to
+// initiate more right after this, so the provider can wait for them.
+//
+static
+void rmaVFlush(struct rmaVBatch_t* b, chpl_bool more) {
+  if (b->numIov == 0) {
+    return;
+  }
+
+  struct perTxCtxInfo_t* tcip = b->tcip;
+
+  //
+  // Make sure we have a free CQ entry for this message.
+  //
+  if (tcip->txCQ != NULL && tcip->numTxnsOut >= txCQLen) {
+    (*tcip->checkTxCmplsFn)(tcip);
+    while (tcip->numTxnsOut >= txCQLen) {
+      sched_yield();
+      (*tcip->checkTxCmplsFn)(tcip);
+    }
+  }
+
+  struct fi_msg_rma msg = (struct fi_msg_rma)
+                          { .msg_iov = b->iov,
+                            .desc = b->desc,
+                            .iov_count = b->numIov,
+                            .addr = rxRmaAddr(tcip, b->node),
+                            .rma_iov = b->rmaIov,
+                            .rma_iov_count = b->numIov,
+                            .context = txnTrkEncodeId(__LINE__),
+                            .data = 0 };
+  if (b->isPut) {
+    DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE,
+               "tx writemsg V: %d:%p <= %p, %zd pieces, size %zd",
+               (int) b->node, (void*) b->rmaIov[0].addr, b->iov[0].iov_base,
+               b->numIov, b->msgLen);
+    OFI_RIDE_OUT_EAGAIN(tcip, fi_writemsg(tcip->txCtx, &msg,
+                                          more ? FI_MORE : 0));
+  } else {
+    DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
+               "tx readmsg V: %p <= %d:%p, %zd pieces, size %zd",
+               b->iov[0].iov_base, (int) b->node, (void*) b->rmaIov[0].addr,
+               b->numIov, b->msgLen);
+    OFI_RIDE_OUT_EAGAIN(tcip, fi_readmsg(tcip->txCtx, &msg,
+                                         more ? FI_MORE : 0));
+  }
+  tcip->numTxnsOut++;
+  tcip->numTxnsSent++;
+
+  b->anyRma = true;
+  b->numIov = 0;
+  b->msgLen = 0;
+}
+
+
+static
+void rmaVAdd(struct rmaVBatch_t* b, void* addr, void* raddr, size_t size) {
+  if (size == 0) {
+    return;
+  }
+
+  if (b->node == chpl_nodeID) {
+    if (b->isPut) {
+      memmove(raddr, addr, size);
+    } else {
+      memmove(addr, raddr, size);
+    }
+    return;
+  }
+
+  uint64_t mrKey;
+  uint64_t mrRaddr;
+  void* mrDesc = NULL;
+  if (size > ofi_info->ep_attr->max_msg_size
+      || mrGetKey(&mrKey, &mrRaddr, b->node, raddr, size) != 0
+      || mrGetDesc(&mrDesc, addr, size) != 0) {
+    //
+    // Can't do this one directly.  Initiate what we have so far, to
+    // keep to the pieces' order, then do this one the long way.
+    //
+    rmaVFlush(b, false /*more*/);
+    if (b->isPut) {
+      (void) ofi_put(addr, b->node, raddr, size);
+    } else {
+      (void) ofi_get(addr, b->node, raddr, size);
+    }
+    return;
+  }
+
+  if (b->tcip == NULL) {
+    CHK_TRUE((b->tcip = tciAlloc()) != NULL);
+  }
+
+  //
+  // Merge with the previous piece if it's adjacent on both sides.
+  //
+  if (b->numIov > 0) {
+    struct iovec* lastIov = &b->iov[b->numIov - 1];
+    struct fi_rma_iov* lastRmaIov = &b->rmaIov[b->numIov - 1];
+    if ((char*) lastIov->iov_base + lastIov->iov_len == (char*) addr
+        && lastRmaIov->addr + lastRmaIov->len == mrRaddr
+        && lastRmaIov->key == mrKey
+        && b->desc[b->numIov - 1] == mrDesc
+        && b->msgLen + size <= ofi_info->ep_attr->max_msg_size) {
+      lastIov->iov_len += size;
+      lastRmaIov->len += size;
+      b->msgLen += size;
+      return;
+    }
+  }
+
+  if (b->numIov == b->iovLimit
+      || b->msgLen + size > ofi_info->ep_attr->max_msg_size) {
+    rmaVFlush(b, true /*more*/);
+  }
+
+  b->iov[b->numIov] = (struct iovec) { .iov_base = addr,
+                                       .iov_len = size };
+  b->desc[b->numIov] = mrDesc;
+  b->rmaIov[b->numIov] = (struct fi_rma_iov) { .addr = mrRaddr,
+                                               .len = size,
+                                               .key = mrKey };
+  b->numIov++;
+  b->msgLen += size;
+}
+
+
+static
+void rmaVEnd(struct rmaVBatch_t* b) {
+  rmaVFlush(b, false /*more*/);
+
+  struct perTxCtxInfo_t* tcip = b->tcip;
+  if (tcip == NULL) {
+    return;
+  }
+
+  if (b->anyRma) {
+    //
+    // Wait for the whole batch.  For PUTs, if we're using message
+    // ordering rather than delivery-complete, follow up with a dummy
+    // GET to force the data into visibility.  Our GETs do the same
+    // thing for any earlier PUTs to the node.
+    //
+    while (tcip->numTxnsOut > 0) {
+      (*tcip->ensureProgressFn)(tcip);
+    }
+
+    if (!haveDeliveryComplete) {
+      if (b->isPut) {
+        mcmReleaseOneNode(b->node, tcip, "vectored PUT");
+      } else if (tcip->bound) {
+        chpl_comm_taskPrvData_t* prvData = get_comm_taskPrvdata();
+        if (prvData != NULL && prvData->putBitmap != NULL) {
+          bitmapClear(prvData->putBitmap, b->node);
+        }
+      }
+    }
+  }
+
+  tciFree(tcip);
+}
+
+
+static
+void rmaVPutStrdPiece(void* raddr, int32_t node, void* addr, size_t size,
+                      void* ctx, int32_t commID, int ln, int32_t fn) {
+  rmaVAdd((struct rmaVBatch_t*) ctx, addr, raddr, size);
+}
+
+
+static
+void rmaVGetStrdPiece(void* addr, int32_t node, void* raddr, size_t size,
+                      void* ctx, int32_t commID, int ln, int32_t fn) {
+  rmaVAdd((struct rmaVBatch_t*) ctx, addr, raddr, size);
+}
+
+
 ////////////////////////////////////////
 //
 // Interface: RMA
@@ -3853,12 +4375,30 @@ void chpl_comm_put_strd(void* dstaddr_arg, size_t* dststrides,
              dstaddr_arg, dststrides, (int) dstnode, srcaddr_arg, srcstrides,
              count, (int) stridelevels, elemSize, (int) commID);
 
-  put_strd_common(dstaddr_arg, dststrides,
-                  dstnode,
-                  srcaddr_arg, srcstrides,
-                  count, stridelevels, elemSize,
-                  1, NULL,
-                  commID, ln, fn);
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put_strd, chpl_nodeID, dstnode,
+         .iu.comm_strd={srcaddr_arg, srcstrides, dstaddr_arg, dststrides,
+                        count, stridelevels, elemSize, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+  }
+
+  if (dstnode != chpl_nodeID) {
+    chpl_comm_diags_verbose_rdmaStrd("put", dstnode, ln, fn, commID);
+    chpl_comm_diags_incr(put);
+  }
+
+  struct rmaVBatch_t b;
+  rmaVBegin(&b, true /*isPut*/, dstnode);
+  strd_common_call(dstaddr_arg, dststrides, dstnode,
+                   srcaddr_arg, srcstrides,
+                   count, stridelevels, elemSize,
+                   &b, rmaVPutStrdPiece,
+                   commID, ln, fn);
+  rmaVEnd(&b);
 }
 
 
@@ -3872,12 +4412,74 @@ void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
              dstaddr_arg, dststrides, (int) srcnode, srcaddr_arg, srcstrides,
              count, (int) stridelevels, elemSize, (int) commID);
 
-  get_strd_common(dstaddr_arg, dststrides,
-                  srcnode,
-                  srcaddr_arg, srcstrides,
-                  count, stridelevels, elemSize,
-                  1, NULL,
-                  commID, ln, fn);
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_get_strd, chpl_nodeID, srcnode,
+       .iu.comm_strd={srcaddr_arg, srcstrides, dstaddr_arg, dststrides,
+                      count, stridelevels, elemSize, commID, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  if (srcnode != chpl_nodeID) {
+    chpl_comm_diags_verbose_rdmaStrd("get", srcnode, ln, fn, commID);
+    chpl_comm_diags_incr(get);
+  }
+
+  struct rmaVBatch_t b;
+  rmaVBegin(&b, false /*isPut*/, srcnode);
+  strd_common_call(dstaddr_arg, dststrides, srcnode,
+                   srcaddr_arg, srcstrides,
+                   count, stridelevels, elemSize,
+                   &b, rmaVGetStrdPiece,
+                   commID, ln, fn);
+  rmaVEnd(&b);
+}
+
+
+void chpl_comm_put_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn) {
+  DBG_PRINTF(DBG_IFACE,
+             "%s(%zd, %p, %d, %p, %p, %d)", __func__,
+             n, addrs, (int) node, raddrs, sizes, (int) commID);
+
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  if (node != chpl_nodeID) {
+    chpl_comm_diags_verbose_rdmaV("put", node, n, ln, fn, commID);
+    chpl_comm_diags_incr(put);
+  }
+
+  struct rmaVBatch_t b;
+  rmaVBegin(&b, true /*isPut*/, node);
+  for (size_t i = 0; i < n; i++) {
+    rmaVAdd(&b, addrs[i], raddrs[i], sizes[i]);
+  }
+  rmaVEnd(&b);
+}
+
+
+void chpl_comm_get_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn) {
+  DBG_PRINTF(DBG_IFACE,
+             "%s(%zd, %p, %d, %p, %p, %d)", __func__,
+             n, addrs, (int) node, raddrs, sizes, (int) commID);
+
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  if (node != chpl_nodeID) {
+    chpl_comm_diags_verbose_rdmaV("get", node, n, ln, fn, commID);
+    chpl_comm_diags_incr(get);
+  }
+
+  struct rmaVBatch_t b;
+  rmaVBegin(&b, false /*isPut*/, node);
+  for (size_t i = 0; i < n; i++) {
+    rmaVAdd(&b, addrs[i], raddrs[i], sizes[i]);
+  }
+  rmaVEnd(&b);
 }
 
 
@@ -6215,6 +6817,7 @@ const char* am_opName(amOp_t op) {
   switch (op) {
   case am_opExecOn: return "opExecOn";
   case am_opExecOnLrg: return "opExecOnLrg";
+  case am_opExecOnAgg: return "opExecOnAgg";
   case am_opGet: return "opGet";
   case am_opPut: return "opPut";
   case am_opAMO: return "opAMO";
@@ -6346,6 +6949,11 @@ const char* am_reqStr(c_nodeid_t tgtNode, amRequest_t* req, size_t reqSize) {
                     req->free.p);
     break;
 
+  case am_opExecOnAgg:
+    len += snprintf(buf + len, sizeof(buf) - len, ", %" PRIu32 " bundles",
+                    req->xoa.numBundles);
+    break;
+
   default:
     break;
   }
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chplrt.h"
+#include "arg.h"
+#include "chpl-comm.h"
+#include "chpl-comm-locales.h"
+#include "error.h"
+
+//
+// The launcher starts every locale on the local node, so there is no
+// natural default; the user has to say how many they want.
+//
+int64_t chpl_comm_default_num_locales(void) {
+  return chpl_specify_locales_error();
+}
+
+//
+// Any positive number of locales is acceptable to the launcher.  The
+// program itself checks that it was started with the number the user
+// asked for, which can only fail if the launcher was bypassed.
+//
+void chpl_comm_verify_num_locales(int64_t proposedNumLocales) {
+#ifndef LAUNCHER
+  if (proposedNumLocales != chpl_numNodes) {
+    chpl_error("number of locales does not match the number started; "
+               "run the program through its launcher", 0, 0);
+  }
+#endif
+}
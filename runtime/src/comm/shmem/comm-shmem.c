@@ -0,0 +1,1697 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Shared-memory communication layer.
+//
+// This runs every locale as a separate process on the local node.  At
+// startup the process the launcher started becomes a monitor: it maps
+// a control region shared by all the locales (plus, when the memory
+// layer can manage a fixed heap, a segment holding every locale's
+// heap), forks one child per locale, and then waits for the children,
+// reporting the first failure as the exit status of the program.
+//
+// Active messages travel through a bounded multi-producer queue per
+// locale in the control region.  Each locale's polling task drains its
+// own queue, and sleeps on a futex after it has been idle for a while.
+// PUTs and GETs that target the shared heap segment are plain memory
+// copies, and network atomics on it are processor atomics.  Any other
+// remote memory is reached with cross-memory attach (process_vm_readv()
+// and process_vm_writev()) when the kernel permits that, and otherwise
+// by active messages that carry the data through the queues.
+//
+
+#ifdef __linux__
+// for process_vm_readv() and process_vm_writev()
+#define _GNU_SOURCE
+#endif
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-comm-callbacks.h"
+#include "chpl-comm-callbacks-internal.h"
+#include "chpl-comm-internal.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chplsys.h"
+#include "chpl-tasks.h"
+#include "chpltypes.h"
+#include "chplcgfns.h"
+#include "chpl-gen-includes.h"
+#include "chpl-linefile-support.h"
+#include "error.h"
+#include "chpl-mem-desc.h"
+
+// Don't get warning macros for chpl_comm_get etc
+#include "chpl-comm-no-warning-macros.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+//
+// The queues and the control region are shared between processes, so
+// everything in them is accessed with the compiler's __atomic builtins
+// rather than through chpl-atomics.h, whose lock-based implementation
+// would not be coherent across processes.
+//
+#define AM_SLOT_SIZE      512
+#define AM_QUEUE_LEN      1024    // must be a power of 2
+#define AM_IDLE_SPINS     1000    // empty polls before the poller sleeps
+#define AM_SLEEP_NS       (100 * 1000 * 1000)
+
+#define CACHE_LINE_SIZE   64
+
+typedef struct {
+  uint64_t   seq;         // ticket: slot is free for producer at seq==pos
+  uint32_t   type;        // am_type_t
+  uint32_t   size;        // bytes of payload
+  c_nodeid_t src;         // sending locale
+  uint32_t   pad;
+  uint64_t   payload[(AM_SLOT_SIZE - 24) / sizeof(uint64_t)];
+} am_slot_t;
+
+#define AM_MAX_PAYLOAD sizeof(((am_slot_t*) NULL)->payload)
+
+typedef struct {
+  uint64_t  enq_pos;
+  char      pad0[CACHE_LINE_SIZE - sizeof(uint64_t)];
+  uint64_t  deq_pos;      // only the owning locale's poller touches this
+  char      pad1[CACHE_LINE_SIZE - sizeof(uint64_t)];
+  uint32_t  sleeping;     // poller is (about to be) waiting on doorbell
+  uint32_t  doorbell;     // futex word, bumped to wake the poller
+  char      pad2[CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+  am_slot_t slots[AM_QUEUE_LEN];
+} am_queue_t;
+
+typedef struct {
+  uint64_t  barrier_count;
+  uint64_t  barrier_gen;
+  uint32_t  cma_ok;       // cross-memory attach works between locales
+  uint32_t  exiting;      // an orderly whole-program exit has begun
+  void*     globals_buf;  // node 0's gathered global wide pointers
+  char*     heap_base;    // shared heap segment, or NULL
+  size_t    heap_size;    // each locale's share of that segment
+} shmem_ctl_t;
+
+static shmem_ctl_t* ctl;
+static pid_t* pids;
+static am_queue_t* am_queues;
+
+static char* shared_heap_lo;
+static char* shared_heap_hi;
+
+static chpl_bool taskingReady;
+static __thread chpl_bool isAmHandler = false;
+
+
+//
+// This is the type of object we use to manage acknowledgements.
+// Initialize the count to 0, the target to the number of return signal
+// events you expect, and the flag to 0.  Send the request(s), then wait
+// until the flag becomes 1.
+//
+typedef struct {
+  uint32_t      count;
+  uint32_t      target;
+  volatile int  flag;
+} done_t;
+
+static inline
+void init_done_obj(done_t* done, int target) {
+  done->count = 0;
+  done->target = target;
+  done->flag = 0;
+}
+
+static void shmem_yield(void);
+
+static inline
+void wait_done_obj(done_t* done) {
+  while (!__atomic_load_n(&done->flag, __ATOMIC_ACQUIRE)) {
+    shmem_yield();
+  }
+}
+
+
+//
+// AM functions
+//
+typedef enum {
+  FORK,            // run the bundle in a new task, ack if requested
+  FORK_LARGE,      // as FORK, but the task GETs the bundle from the caller
+  FORK_FAST,       // run the bundle in the handler (use with care)
+  SIGNAL,          // count an acknowledgement on a done_t
+  FREE,            // free data at addr
+  DO_PUT,          // copy the payload to an address here
+  DO_GET,          // send memory here back to the caller as DO_PUTs
+  DO_AMO,          // do an atomic operation on memory here
+  SHUTDOWN         // tell nodes to get ready for shutdown
+} am_type_t;
+
+typedef struct {
+  c_nodeid_t    caller;
+  c_sublocid_t  subloc;
+  void*         ack;
+  chpl_fn_int_t fid;
+  chpl_task_infoChapel_t infoChapel;
+  void*         arg;
+  size_t        arg_size;
+  chpl_bool     blocking;
+} large_fork_t;
+
+typedef struct {
+  chpl_comm_on_bundle_t bundle;
+  large_fork_t          large;
+} large_fork_task_t;
+
+typedef struct {
+  void*       ack;
+  c_nodeid_t  ack_node;   // where *ack lives: the caller, or us for replies
+  void*       dst;
+} put_hdr_t;
+
+typedef struct {
+  void*   ack;
+  void*   src;
+  void*   dst;
+  size_t  size;
+} get_hdr_t;
+
+typedef enum {
+  AMO_READ,
+  AMO_WRITE,
+  AMO_XCHG,
+  AMO_CMPXCHG,
+  AMO_AND,
+  AMO_OR,
+  AMO_XOR,
+  AMO_ADD
+} amo_op_t;
+
+typedef struct {
+  void*     ack;
+  void*     obj;
+  void*     result;     // on the caller; NULL for non-fetching ops
+  uint64_t  opnd1;
+  uint64_t  opnd2;
+  uint8_t   op;         // amo_op_t
+  uint8_t   size;       // 4 or 8
+  uint8_t   isReal;
+} amo_hdr_t;
+
+
+//
+// Active message queues
+//
+
+static void am_poll(void);
+
+#ifdef __linux__
+static inline
+void futex_wait(uint32_t* addr, uint32_t val, long ns) {
+  struct timespec ts = { ns / 1000000000, ns % 1000000000 };
+  (void) syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static inline
+void futex_wake(uint32_t* addr) {
+  (void) syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+#else
+static inline
+void futex_wait(uint32_t* addr, uint32_t val, long ns) {
+  struct timespec ts = { 0, 100 * 1000 };
+  if (__atomic_load_n(addr, __ATOMIC_ACQUIRE) == val)
+    nanosleep(&ts, NULL);
+}
+
+static inline
+void futex_wake(uint32_t* addr) { }
+#endif
+
+//
+// Claim the next free slot in a locale's queue, waiting for room if the
+// queue is full.  The slot is handed to the consumer by am_publish().
+//
+static
+am_slot_t* am_claim(c_nodeid_t node, uint64_t* pos_p) {
+  am_queue_t* q = &am_queues[node];
+  uint64_t pos = __atomic_load_n(&q->enq_pos, __ATOMIC_RELAXED);
+
+  while (true) {
+    am_slot_t* s = &q->slots[pos & (AM_QUEUE_LEN - 1)];
+    uint64_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    int64_t dif = (int64_t) seq - (int64_t) pos;
+
+    if (dif == 0) {
+      if (__atomic_compare_exchange_n(&q->enq_pos, &pos, pos + 1,
+                                      true, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {
+        *pos_p = pos;
+        return s;
+      }
+    } else if (dif < 0) {
+      //
+      // The queue is full.  If we are a handler we must keep draining
+      // our own queue while we wait, or two locales sending to each
+      // other could deadlock.
+      //
+      if (isAmHandler) {
+        am_poll();
+      } else {
+        shmem_yield();
+      }
+      pos = __atomic_load_n(&q->enq_pos, __ATOMIC_RELAXED);
+    } else {
+      pos = __atomic_load_n(&q->enq_pos, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+static
+void am_publish(c_nodeid_t node, am_slot_t* s, uint64_t pos) {
+  am_queue_t* q = &am_queues[node];
+
+  __atomic_store_n(&s->seq, pos + 1, __ATOMIC_RELEASE);
+
+  // Order the publication before the check of the sleeping flag.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&q->sleeping, __ATOMIC_RELAXED)) {
+    __atomic_fetch_add(&q->doorbell, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&q->doorbell);
+  }
+}
+
+//
+// Send an active message whose payload is a header followed by some
+// data.  The total must fit in one slot.
+//
+static
+void am_send(c_nodeid_t node, am_type_t type,
+             const void* hdr, size_t hdr_size,
+             const void* data, size_t data_size) {
+  uint64_t pos;
+  am_slot_t* s;
+
+  assert(hdr_size + data_size <= AM_MAX_PAYLOAD);
+
+  s = am_claim(node, &pos);
+  s->type = type;
+  s->size = hdr_size + data_size;
+  s->src = chpl_nodeID;
+  if (hdr_size > 0)
+    memcpy(s->payload, hdr, hdr_size);
+  if (data_size > 0)
+    memcpy((char*) s->payload + hdr_size, data, data_size);
+  am_publish(node, s, pos);
+}
+
+static inline
+void signal_done(done_t* done) {
+  if (__atomic_add_fetch(&done->count, 1, __ATOMIC_ACQ_REL) == done->target)
+    __atomic_store_n(&done->flag, 1, __ATOMIC_RELEASE);
+}
+
+static inline
+void am_signal(c_nodeid_t node, void* ack) {
+  if (node == chpl_nodeID)
+    signal_done((done_t*) ack);
+  else
+    am_send(node, SIGNAL, &ack, sizeof(ack), NULL, 0);
+}
+
+
+//
+// Memory transfers
+//
+
+static inline
+chpl_bool in_shared_heap(const void* addr, size_t size) {
+  return (shared_heap_lo != NULL
+          && (const char*) addr >= shared_heap_lo
+          && (const char*) addr + size <= shared_heap_hi);
+}
+
+#ifdef __linux__
+static
+chpl_bool cma_xfer(c_nodeid_t node, chpl_bool isPut,
+                   void* laddr, void* raddr, size_t size) {
+  struct iovec liov = { laddr, size };
+  struct iovec riov = { raddr, size };
+
+  while (liov.iov_len > 0) {
+    ssize_t n = isPut
+                ? process_vm_writev(pids[node], &liov, 1, &riov, 1, 0)
+                : process_vm_readv(pids[node], &liov, 1, &riov, 1, 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    liov.iov_base = (char*) liov.iov_base + n;
+    liov.iov_len -= n;
+    riov.iov_base = (char*) riov.iov_base + n;
+    riov.iov_len -= n;
+  }
+
+  return true;
+}
+#else
+static
+chpl_bool cma_xfer(c_nodeid_t node, chpl_bool isPut,
+                   void* laddr, void* raddr, size_t size) {
+  return false;
+}
+#endif
+
+#define AM_XFER_CHUNK (AM_MAX_PAYLOAD - sizeof(put_hdr_t))
+
+static inline
+int am_xfer_chunks(size_t size) {
+  return (size + AM_XFER_CHUNK - 1) / AM_XFER_CHUNK;
+}
+
+//
+// Move data to/from another locale's private memory through the AM
+// queues, for when cross-memory attach is not available.
+//
+static
+void am_put(c_nodeid_t node, void* raddr, void* addr, size_t size) {
+  done_t done;
+  size_t off;
+
+  init_done_obj(&done, am_xfer_chunks(size));
+  for (off = 0; off < size; off += AM_XFER_CHUNK) {
+    size_t this_size = size - off;
+    put_hdr_t hdr = { &done, chpl_nodeID, (char*) raddr + off };
+    if (this_size > AM_XFER_CHUNK)
+      this_size = AM_XFER_CHUNK;
+    am_send(node, DO_PUT, &hdr, sizeof(hdr), (char*) addr + off, this_size);
+  }
+  wait_done_obj(&done);
+}
+
+static
+void am_get(void* addr, c_nodeid_t node, void* raddr, size_t size) {
+  done_t done;
+  get_hdr_t hdr = { &done, raddr, addr, size };
+
+  init_done_obj(&done, am_xfer_chunks(size));
+  am_send(node, DO_GET, &hdr, sizeof(hdr), NULL, 0);
+  wait_done_obj(&done);
+}
+
+static
+void do_put(void* addr, c_nodeid_t node, void* raddr, size_t size) {
+  if (node == chpl_nodeID || in_shared_heap(raddr, size)) {
+    memmove(raddr, addr, size);
+  } else if (ctl->cma_ok) {
+    if (!cma_xfer(node, true, addr, raddr, size)) {
+      chpl_internal_error_v("shmem PUT to node %d failed: %s",
+                            (int) node, strerror(errno));
+    }
+  } else {
+    am_put(node, raddr, addr, size);
+  }
+}
+
+static
+void do_get(void* addr, c_nodeid_t node, void* raddr, size_t size) {
+  if (node == chpl_nodeID || in_shared_heap(raddr, size)) {
+    memmove(addr, raddr, size);
+  } else if (ctl->cma_ok) {
+    if (!cma_xfer(node, false, addr, raddr, size)) {
+      chpl_internal_error_v("shmem GET from node %d failed: %s",
+                            (int) node, strerror(errno));
+    }
+  } else {
+    am_get(addr, node, raddr, size);
+  }
+}
+
+
+//
+// Atomic operations on memory in this process (or the shared segment).
+// Integer ops work on the bit pattern, so signedness doesn't matter;
+// real additions use a compare-and-swap loop.
+//
+#define DEFN_AMO_LOCAL(bits, uType, rType)                              \
+  static                                                                \
+  void amo_local_ ## bits(amo_op_t op, chpl_bool isReal, uType* obj,    \
+                          uType v1, uType v2, uType* result) {          \
+    uType old = 0;                                                      \
+    switch (op) {                                                       \
+    case AMO_READ:                                                      \
+      old = __atomic_load_n(obj, __ATOMIC_SEQ_CST);                     \
+      break;                                                            \
+    case AMO_WRITE:                                                     \
+      __atomic_store_n(obj, v1, __ATOMIC_SEQ_CST);                      \
+      break;                                                            \
+    case AMO_XCHG:                                                      \
+      old = __atomic_exchange_n(obj, v1, __ATOMIC_SEQ_CST);             \
+      break;                                                            \
+    case AMO_CMPXCHG:                                                   \
+      old = v1;                                                         \
+      (void) __atomic_compare_exchange_n(obj, &old, v2, false,          \
+                                         __ATOMIC_SEQ_CST,              \
+                                         __ATOMIC_SEQ_CST);             \
+      break;                                                            \
+    case AMO_AND:                                                       \
+      old = __atomic_fetch_and(obj, v1, __ATOMIC_SEQ_CST);              \
+      break;                                                            \
+    case AMO_OR:                                                        \
+      old = __atomic_fetch_or(obj, v1, __ATOMIC_SEQ_CST);               \
+      break;                                                            \
+    case AMO_XOR:                                                       \
+      old = __atomic_fetch_xor(obj, v1, __ATOMIC_SEQ_CST);              \
+      break;                                                            \
+    case AMO_ADD:                                                       \
+      if (isReal) {                                                     \
+        uType nxt;                                                      \
+        rType r, d;                                                     \
+        memcpy(&d, &v1, sizeof(d));                                     \
+        old = __atomic_load_n(obj, __ATOMIC_RELAXED);                   \
+        do {                                                            \
+          memcpy(&r, &old, sizeof(r));                                  \
+          r += d;                                                       \
+          memcpy(&nxt, &r, sizeof(nxt));                                \
+        } while (!__atomic_compare_exchange_n(obj, &old, nxt, true,     \
+                                              __ATOMIC_SEQ_CST,         \
+                                              __ATOMIC_RELAXED));       \
+      } else {                                                          \
+        old = __atomic_fetch_add(obj, v1, __ATOMIC_SEQ_CST);            \
+      }                                                                 \
+      break;                                                            \
+    }                                                                   \
+    if (result != NULL)                                                 \
+      *result = old;                                                    \
+  }
+
+DEFN_AMO_LOCAL(32, uint32_t, _real32)
+DEFN_AMO_LOCAL(64, uint64_t, _real64)
+
+static
+void amo_local(amo_op_t op, chpl_bool isReal, size_t size, void* obj,
+               const void* opnd1, const void* opnd2, void* result) {
+  if (size == 4) {
+    uint32_t v1 = 0, v2 = 0;
+    if (opnd1 != NULL) memcpy(&v1, opnd1, 4);
+    if (opnd2 != NULL) memcpy(&v2, opnd2, 4);
+    amo_local_32(op, isReal, (uint32_t*) obj, v1, v2, (uint32_t*) result);
+  } else {
+    uint64_t v1 = 0, v2 = 0;
+    if (opnd1 != NULL) memcpy(&v1, opnd1, 8);
+    if (opnd2 != NULL) memcpy(&v2, opnd2, 8);
+    amo_local_64(op, isReal, (uint64_t*) obj, v1, v2, (uint64_t*) result);
+  }
+}
+
+static
+void doAMO(c_nodeid_t node, void* obj, amo_op_t op, chpl_bool isReal,
+           size_t size, const void* opnd1, const void* opnd2,
+           void* result) {
+  if (node == chpl_nodeID || in_shared_heap(obj, size)) {
+    amo_local(op, isReal, size, obj, opnd1, opnd2, result);
+  } else {
+    done_t done;
+    amo_hdr_t hdr = { .ack = &done, .obj = obj, .result = result,
+                      .op = op, .size = size, .isReal = isReal };
+    if (opnd1 != NULL) memcpy(&hdr.opnd1, opnd1, size);
+    if (opnd2 != NULL) memcpy(&hdr.opnd2, opnd2, size);
+    init_done_obj(&done, 1);
+    am_send(node, DO_AMO, &hdr, sizeof(hdr), NULL, 0);
+    wait_done_obj(&done);
+  }
+}
+
+
+//
+// AM handlers
+//
+
+static void fork_wrapper(chpl_comm_on_bundle_t *f) {
+  chpl_ftable_call(f->task_bundle.requested_fid, f);
+
+  if (f->comm.ack != NULL)
+    am_signal(f->comm.caller, f->comm.ack);
+}
+
+static void AM_fork(am_slot_t* s) {
+  chpl_comm_on_bundle_t *f = (chpl_comm_on_bundle_t*) s->payload;
+
+  chpl_task_startMovedTask(f->task_bundle.requested_fid,
+                           (chpl_fn_p) fork_wrapper,
+                           f, s->size,
+                           f->task_bundle.requestedSubloc, chpl_nullTaskID);
+}
+
+static void fork_large_wrapper(large_fork_task_t* f) {
+  large_fork_t *lg = &f->large;
+  chpl_comm_on_bundle_t* arg;
+
+  // Allocate the bundle and GET it from the caller
+  arg = chpl_mem_allocMany(1, lg->arg_size,
+                           CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
+  do_get(arg, lg->caller, lg->arg, lg->arg_size);
+
+  // The caller copied a non-blocking bundle; it can free that now.
+  if (!lg->blocking)
+    am_send(lg->caller, FREE, &lg->arg, sizeof(lg->arg), NULL, 0);
+
+  // Call the on body function
+  chpl_ftable_call(lg->fid, arg);
+
+  // Signal completion
+  if (lg->ack != NULL)
+    am_signal(lg->caller, lg->ack);
+
+  chpl_mem_free(arg, 0, 0);
+}
+
+static void AM_fork_large(am_slot_t* s) {
+  large_fork_t *lg = (large_fork_t*) s->payload;
+  chpl_comm_bundleData_t comm  = { .caller = lg->caller,
+                                   .ack    = lg->ack };
+  large_fork_task_t task = { .bundle = { .kind = CHPL_ARG_BUNDLE_KIND_COMM,
+                                         .comm = comm },
+                             .large = *lg };
+
+  task.bundle.task_bundle.infoChapel = lg->infoChapel;
+  chpl_task_startMovedTask(lg->fid, (chpl_fn_p) fork_large_wrapper,
+                           &task.bundle, sizeof(task),
+                           lg->subloc, chpl_nullTaskID);
+}
+
+static void AM_fork_fast(am_slot_t* s) {
+  chpl_comm_on_bundle_t *f = (chpl_comm_on_bundle_t*) s->payload;
+
+  // Run the function
+  chpl_ftable_call(f->task_bundle.requested_fid, f);
+
+  // Signal that the handler has completed if that was requested.
+  if (f->comm.ack != NULL)
+    am_signal(s->src, f->comm.ack);
+}
+
+static void AM_signal(am_slot_t* s) {
+  signal_done(*(done_t**) s->payload);
+}
+
+static void AM_free(am_slot_t* s) {
+  chpl_mem_free(*(void**) s->payload, 0, 0);
+}
+
+static void AM_do_put(am_slot_t* s) {
+  put_hdr_t* hdr = (put_hdr_t*) s->payload;
+
+  memcpy(hdr->dst, hdr + 1, s->size - sizeof(*hdr));
+  if (hdr->ack != NULL)
+    am_signal(hdr->ack_node, hdr->ack);
+}
+
+static void AM_do_get(am_slot_t* s) {
+  get_hdr_t hdr = *(get_hdr_t*) s->payload;
+  c_nodeid_t caller = s->src;
+  size_t off;
+
+  for (off = 0; off < hdr.size; off += AM_XFER_CHUNK) {
+    size_t this_size = hdr.size - off;
+    put_hdr_t reply = { hdr.ack, caller, (char*) hdr.dst + off };
+    if (this_size > AM_XFER_CHUNK)
+      this_size = AM_XFER_CHUNK;
+    am_send(caller, DO_PUT, &reply, sizeof(reply),
+            (char*) hdr.src + off, this_size);
+  }
+}
+
+static void AM_do_amo(am_slot_t* s) {
+  amo_hdr_t* hdr = (amo_hdr_t*) s->payload;
+  uint64_t result;
+
+  amo_local(hdr->op, hdr->isReal, hdr->size, hdr->obj,
+            &hdr->opnd1, &hdr->opnd2, &result);
+  if (hdr->result != NULL) {
+    put_hdr_t reply = { hdr->ack, s->src, hdr->result };
+    am_send(s->src, DO_PUT, &reply, sizeof(reply), &result, hdr->size);
+  } else {
+    am_signal(s->src, hdr->ack);
+  }
+}
+
+static void AM_shutdown(am_slot_t* s) {
+  chpl_signal_shutdown();
+}
+
+static void am_handle(am_slot_t* s) {
+  switch ((am_type_t) s->type) {
+  case FORK:       AM_fork(s);       break;
+  case FORK_LARGE: AM_fork_large(s); break;
+  case FORK_FAST:  AM_fork_fast(s);  break;
+  case SIGNAL:     AM_signal(s);     break;
+  case FREE:       AM_free(s);       break;
+  case DO_PUT:     AM_do_put(s);     break;
+  case DO_GET:     AM_do_get(s);     break;
+  case DO_AMO:     AM_do_amo(s);     break;
+  case SHUTDOWN:   AM_shutdown(s);   break;
+  default:
+    chpl_internal_error_v("unknown shmem AM type %d", (int) s->type);
+  }
+}
+
+//
+// Handle one message from our queue, if there is one.  Only the polling
+// task calls this.  The dequeue position moves past a slot before its
+// handler runs so that a handler which has to poll while waiting for
+// room in some other queue doesn't see the same message again.
+//
+static chpl_bool am_poll_one(void) {
+  am_queue_t* q = &am_queues[chpl_nodeID];
+  uint64_t pos = q->deq_pos;
+  am_slot_t* s = &q->slots[pos & (AM_QUEUE_LEN - 1)];
+
+  if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != pos + 1)
+    return false;
+
+  q->deq_pos = pos + 1;
+  am_handle(s);
+  __atomic_store_n(&s->seq, pos + AM_QUEUE_LEN, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void am_poll(void) {
+  while (am_poll_one())
+    ;
+}
+
+
+//
+// On all locales, we do the polling in a thread of control managed by
+// the tasking layer, as the other comm layers do.
+//
+static volatile int pollingRunning;
+static volatile int pollingQuit;
+
+static void polling(void* x) {
+  am_queue_t* q = &am_queues[chpl_nodeID];
+  int idle = 0;
+
+  isAmHandler = true;
+  pollingRunning = 1;
+
+  while (!pollingQuit) {
+    if (am_poll_one()) {
+      idle = 0;
+    } else if (++idle < AM_IDLE_SPINS) {
+      sched_yield();
+    } else {
+      uint32_t bell = __atomic_load_n(&q->doorbell, __ATOMIC_ACQUIRE);
+      __atomic_store_n(&q->sleeping, 1, __ATOMIC_SEQ_CST);
+      if (!am_poll_one() && !pollingQuit)
+        futex_wait(&q->doorbell, bell, AM_SLEEP_NS);
+      __atomic_store_n(&q->sleeping, 0, __ATOMIC_SEQ_CST);
+      idle = 0;
+    }
+  }
+
+  pollingRunning = 0;
+}
+
+static void start_polling(void) {
+  pollingRunning = 0;
+  pollingQuit = 0;
+
+  if (chpl_task_createCommTask(polling, NULL)) {
+    chpl_internal_error("unable to start polling task for shmem");
+  }
+
+  while (!pollingRunning) {
+    sched_yield();
+  }
+}
+
+static void stop_polling(chpl_bool wait) {
+  am_queue_t* q;
+
+  if (am_queues == NULL || !taskingReady)
+    return;
+
+  q = &am_queues[chpl_nodeID];
+  pollingQuit = 1;
+  __atomic_fetch_add(&q->doorbell, 1, __ATOMIC_SEQ_CST);
+  futex_wake(&q->doorbell);
+
+  if (wait) {
+    while (pollingRunning) {
+      sched_yield();
+    }
+  }
+}
+
+static void shmem_yield(void) {
+  if (taskingReady)
+    chpl_task_yield();
+  else
+    sched_yield();
+}
+
+
+//
+// Startup
+//
+
+static void* map_shared(size_t size, chpl_bool noreserve) {
+  int flags = MAP_SHARED | MAP_ANONYMOUS;
+  void* p;
+
+#ifdef MAP_NORESERVE
+  if (noreserve)
+    flags |= MAP_NORESERVE;
+#endif
+  p = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  return (p == MAP_FAILED) ? NULL : p;
+}
+
+static size_t round_up(size_t n, size_t align) {
+  return (n + align - 1) / align * align;
+}
+
+//
+// The shared heap segment is only useful with a memory layer that can
+// manage a fixed heap.  Each locale gets an equal share of either the
+// CHPL_RT_MAX_HEAP_SIZE total or of physical memory.
+//
+static void setup_shared_heap(void) {
+  const size_t align = 2 * 1024 * 1024;
+  size_t total;
+  size_t per;
+  char* base;
+
+  if (chpl_numNodes == 1 || strcmp(CHPL_MEM, "jemalloc") != 0
+      || !chpl_env_rt_get_bool("COMM_SHMEM_SHARED_HEAP", true)) {
+    return;
+  }
+
+  if ((total = chpl_comm_getenvMaxHeapSize()) == 0)
+    total = chpl_sys_physicalMemoryBytes();
+  per = total / chpl_numNodes / align * align;
+  if (per == 0)
+    return;
+
+  if ((base = map_shared(per * chpl_numNodes, true)) == NULL) {
+    chpl_warning("could not map a shared heap; "
+                 "remote memory will be reached more slowly", 0, 0);
+    return;
+  }
+
+  ctl->heap_base = base;
+  ctl->heap_size = per;
+  shared_heap_lo = base;
+  shared_heap_hi = base + per * chpl_numNodes;
+}
+
+//
+// The monitor process waits for the locales.  If one exits before an
+// orderly whole-program exit has started, the program is over: the
+// others are killed and that locale's status becomes the program's.
+// Otherwise the program's status is node 0's.
+//
+static int status_of(int wstatus) {
+  if (WIFEXITED(wstatus))
+    return WEXITSTATUS(wstatus);
+  if (WIFSIGNALED(wstatus))
+    return 128 + WTERMSIG(wstatus);
+  return 1;
+}
+
+static void monitor_locales(void) {
+  int remaining = chpl_numNodes;
+  chpl_bool killed = false;
+  int status = 0;
+
+  signal(SIGINT, SIG_IGN);
+
+  while (remaining > 0) {
+    int wstatus;
+    pid_t pid = waitpid(-1, &wstatus, 0);
+    c_nodeid_t node;
+
+    if (pid < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    for (node = 0; node < chpl_numNodes && pids[node] != pid; node++)
+      ;
+    if (node == chpl_numNodes)
+      continue;
+    remaining--;
+
+    if (!killed && !__atomic_load_n(&ctl->exiting, __ATOMIC_ACQUIRE)) {
+      status = status_of(wstatus);
+      killed = true;
+      for (c_nodeid_t i = 0; i < chpl_numNodes; i++) {
+        if (i != node)
+          (void) kill(pids[i], SIGKILL);
+      }
+    } else if (!killed && node == 0) {
+      status = status_of(wstatus);
+    }
+  }
+
+  fflush(stdout);
+  fflush(stderr);
+  _exit(status);
+}
+
+void chpl_comm_init(int *argc_p, char ***argv_p) {
+  int64_t numLocales;
+  size_t ctlSize, pidsOff, queuesOff;
+  char* region;
+
+  numLocales = chpl_env_rt_get_int("COMM_SHMEM_NUM_LOCALES", 1);
+  if (numLocales < 1 || numLocales > INT32_MAX) {
+    chpl_error("CHPL_RT_COMM_SHMEM_NUM_LOCALES must be a positive number",
+               0, 0);
+  }
+  chpl_numNodes = (int32_t) numLocales;
+
+  //
+  // Lay out and map the control region.
+  //
+  pidsOff = round_up(sizeof(shmem_ctl_t), CACHE_LINE_SIZE);
+  queuesOff = round_up(pidsOff + chpl_numNodes * sizeof(pid_t),
+                       CACHE_LINE_SIZE);
+  ctlSize = queuesOff + chpl_numNodes * sizeof(am_queue_t);
+  if ((region = map_shared(ctlSize, false)) == NULL) {
+    chpl_internal_error_v("cannot map shmem control region: %s",
+                          strerror(errno));
+  }
+
+  ctl = (shmem_ctl_t*) region;
+  pids = (pid_t*) (region + pidsOff);
+  am_queues = (am_queue_t*) (region + queuesOff);
+
+  for (c_nodeid_t node = 0; node < chpl_numNodes; node++) {
+    for (uint64_t i = 0; i < AM_QUEUE_LEN; i++)
+      am_queues[node].slots[i].seq = i;
+  }
+  ctl->cma_ok = chpl_env_rt_get_bool("COMM_SHMEM_USE_CMA", true);
+
+  setup_shared_heap();
+
+  //
+  // Start the locales.  Each child learns its node ID from the loop
+  // index and returns from here; the parent stays behind to monitor.
+  //
+  fflush(stdout);
+  fflush(stderr);
+  for (c_nodeid_t node = 0; node < chpl_numNodes; node++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      int err = errno;
+      for (c_nodeid_t i = 0; i < node; i++)
+        (void) kill(pids[i], SIGKILL);
+      chpl_internal_error_v("cannot start locale %d: %s",
+                            (int) node, strerror(err));
+    }
+
+    if (pid == 0) {
+      chpl_nodeID = node;
+      pids[node] = getpid();
+#ifdef __linux__
+      // Die with the monitor, and let our siblings attach to us.
+      (void) prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (getppid() == 1)
+        _exit(1);
+#ifdef PR_SET_PTRACER
+      (void) prctl(PR_SET_PTRACER, PR_SET_PTRACER_ANY);
+#endif
+#endif
+      return;
+    }
+
+    pids[node] = pid;
+  }
+
+  monitor_locales();
+}
+
+//
+// Check that every locale can reach its neighbor with cross-memory
+// attach, and fall back to AM-based transfers everywhere if not.
+//
+static volatile int cma_probe_word;
+
+static void check_cma(void) {
+  c_nodeid_t nbr = (chpl_nodeID + 1) % chpl_numNodes;
+  int expect = nbr + 1;
+  int val = 0;
+
+  cma_probe_word = chpl_nodeID + 1;
+  chpl_comm_barrier("set cma probe word");
+
+  if (__atomic_load_n(&ctl->cma_ok, __ATOMIC_ACQUIRE)
+      && (!cma_xfer(nbr, false, &val, (void*) &cma_probe_word, sizeof(val))
+          || val != expect)) {
+    __atomic_store_n(&ctl->cma_ok, 0, __ATOMIC_RELEASE);
+  }
+
+  chpl_comm_barrier("cma probe done");
+}
+
+void chpl_comm_post_mem_init(void) {
+  chpl_comm_init_prv_bcast_tab();
+
+  if (chpl_numNodes > 1)
+    check_cma();
+}
+
+//
+// No support for gdb for now
+//
+int chpl_comm_run_in_gdb(int argc, char* argv[], int gdbArgnum, int* status) {
+  return 0;
+}
+
+//
+// No support for lldb for now
+//
+int chpl_comm_run_in_lldb(int argc, char* argv[], int lldbArgnum, int* status) {
+  return 0;
+}
+
+void chpl_comm_post_task_init(void) {
+  taskingReady = true;
+  start_polling();
+}
+
+void chpl_comm_rollcall(void) {
+  // Initialize diags
+  chpl_comm_diags_init();
+
+  chpl_msg(2, "executing on node %d of %d node(s): %s\n", chpl_nodeID,
+           chpl_numNodes, chpl_nodeName());
+  if (chpl_nodeID == 0) {
+    chpl_msg(2, "shmem: %s heap, %s for other remote memory\n",
+             (shared_heap_lo != NULL) ? "shared" : "private",
+             ctl->cma_ok ? "cross-memory attach" : "active messages");
+  }
+}
+
+void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p) {
+  if (shared_heap_lo != NULL) {
+    *start_p = shared_heap_lo + chpl_nodeID * ctl->heap_size;
+    *size_p  = ctl->heap_size;
+  } else {
+    *start_p = NULL;
+    *size_p  = 0;
+  }
+}
+
+wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) {
+  //
+  // Gather the global variables' wide pointers on node 0 and publish
+  // the buffer address in the control region.  The other nodes GET the
+  // contents from there.
+  //
+  if (chpl_nodeID == 0) {
+    wide_ptr_t* buf = NULL;
+    if (chpl_numGlobalsOnHeap > 0) {
+      buf = chpl_mem_allocMany(chpl_numGlobalsOnHeap, sizeof(*buf),
+                               CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+      for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
+        buf[i] = *chpl_globals_registry[i];
+      }
+    }
+    ctl->globals_buf = buf;
+    chpl_comm_barrier("fill node 0 globals buf");
+    return buf;
+  } else {
+    chpl_comm_barrier("fill node 0 globals buf");
+    return (wide_ptr_t*) ctl->globals_buf;
+  }
+}
+
+void chpl_comm_broadcast_private(int id, size_t size) {
+  //
+  // All the locales are forked from one process, so a runtime-private
+  // variable has the same address in each of them.
+  //
+  for (c_nodeid_t node = 0; node < chpl_numNodes; node++) {
+    if (node != chpl_nodeID) {
+      do_put(chpl_rt_priv_bcast_tab[id], node, chpl_rt_priv_bcast_tab[id],
+             size);
+    }
+  }
+}
+
+void chpl_comm_barrier(const char *msg) {
+  uint64_t gen;
+
+#ifdef CHPL_COMM_DEBUG
+  chpl_msg(2, "%d: enter barrier for '%s'\n", chpl_nodeID, msg);
+#endif
+
+  if (chpl_numNodes == 1)
+    return;
+
+  //
+  // A central sense-reversing barrier in the control region.  We are
+  // required to yield while waiting; see chpl-comm.h.
+  //
+  gen = __atomic_load_n(&ctl->barrier_gen, __ATOMIC_ACQUIRE);
+  if (__atomic_add_fetch(&ctl->barrier_count, 1, __ATOMIC_ACQ_REL)
+      == (uint64_t) chpl_numNodes) {
+    __atomic_store_n(&ctl->barrier_count, 0, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctl->barrier_gen, 1, __ATOMIC_RELEASE);
+  } else {
+    while (__atomic_load_n(&ctl->barrier_gen, __ATOMIC_ACQUIRE) == gen) {
+      shmem_yield();
+    }
+  }
+}
+
+void chpl_comm_pre_task_exit(int all) {
+  if (all) {
+    if (chpl_nodeID == 0) {
+      __atomic_store_n(&ctl->exiting, 1, __ATOMIC_RELEASE);
+      for (c_nodeid_t node = 1; node < chpl_numNodes; node++) {
+        am_send(node, SHUTDOWN, NULL, 0, NULL, 0);
+      }
+    } else {
+      chpl_wait_for_shutdown();
+    }
+
+    chpl_comm_barrier("stop polling");
+
+    //
+    // Tell the polling task to stop, then wait for it to do so.
+    //
+    stop_polling(/*wait*/ true);
+  }
+}
+
+void chpl_comm_exit(int all, int status) {
+  stop_polling(/*wait*/ false);
+
+  if (all) {
+    __atomic_store_n(&ctl->exiting, 1, __ATOMIC_RELEASE);
+    chpl_comm_barrier("exit_comm_shmem");
+  }
+}
+
+
+//
+// Chapel interface: PUT and GET
+//
+
+void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
+                    size_t size, int32_t commID, int ln, int32_t fn) {
+  if (size == 0)
+    return;
+
+  if (chpl_nodeID == node) {
+    memmove(raddr, addr, size);
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
+         .iu.comm={addr, raddr, size, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_rdma("put", node, size, ln, fn, commID);
+    chpl_comm_diags_incr(put);
+
+    do_put(addr, node, raddr, size);
+  }
+}
+
+void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
+                    size_t size, int32_t commID, int ln, int32_t fn) {
+  if (size == 0)
+    return;
+
+  if (chpl_nodeID == node) {
+    memmove(addr, raddr, size);
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
+         .iu.comm={addr, raddr, size, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_rdma("get", node, size, ln, fn, commID);
+    chpl_comm_diags_incr(get);
+
+    do_get(addr, node, raddr, size);
+  }
+}
+
+//
+// Transfers complete before these return, so there are never any
+// outstanding handles.
+//
+chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
+                                       size_t size, int32_t commID,
+                                       int ln, int32_t fn) {
+  chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
+                                       size_t size, int32_t commID,
+                                       int ln, int32_t fn) {
+  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+  return NULL;
+}
+
+int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h) {
+  return ((void*) h) == NULL;
+}
+
+void chpl_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
+}
+
+int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
+  return 0;
+}
+
+int chpl_comm_addr_gettable(c_nodeid_t node, void* start, size_t len) {
+  return in_shared_heap(start, len);
+}
+
+int32_t chpl_comm_getMaxThreads(void) {
+  return 0;
+}
+
+//
+// Strided transfers walk the contiguous runs and move each one with the
+// same mechanism as a PUT or GET; they count as a single operation.
+// Strides and count[0] are converted to bytes on the way in.
+//
+static
+void strd_xfer(chpl_bool isPut, c_nodeid_t node,
+               char* dst, size_t* dststr, char* src, size_t* srcstr,
+               size_t* cnt, int lvl) {
+  if (lvl == 0) {
+    if (isPut)
+      do_put(src, node, dst, cnt[0]);
+    else
+      do_get(dst, node, src, cnt[0]);
+  } else {
+    for (size_t i = 0; i < cnt[lvl]; i++) {
+      strd_xfer(isPut, node, dst + i * dststr[lvl - 1], dststr,
+                src + i * srcstr[lvl - 1], srcstr, cnt, lvl - 1);
+    }
+  }
+}
+
+static
+void strd_common(chpl_bool isPut, void* dstaddr, size_t* dststrides,
+                 c_nodeid_t node, void* srcaddr, size_t* srcstrides,
+                 size_t* count, int32_t stridelevels, size_t elemSize) {
+  const size_t strlvls = (size_t) stridelevels;
+  size_t dststr[strlvls + 1];
+  size_t srcstr[strlvls + 1];
+  size_t cnt[strlvls + 1];
+
+  cnt[0] = count[0] * elemSize;
+  for (size_t i = 0; i < strlvls; i++) {
+    dststr[i] = dststrides[i] * elemSize;
+    srcstr[i] = srcstrides[i] * elemSize;
+    cnt[i + 1] = count[i + 1];
+  }
+
+  strd_xfer(isPut, node, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls);
+}
+
+void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode,
+                         void* srcaddr, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn) {
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put_strd, chpl_nodeID, dstnode,
+         .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
+                        stridelevels, elemSize, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdmaStrd("put", dstnode, ln, fn, commID);
+  if (chpl_nodeID != dstnode) {
+    chpl_comm_diags_incr(put);
+  }
+
+  strd_common(true, dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+              count, stridelevels, elemSize);
+}
+
+void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode,
+                         void* srcaddr, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn) {
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_get_strd, chpl_nodeID, srcnode,
+       .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
+                      stridelevels, elemSize, commID, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdmaStrd("get", srcnode, ln, fn, commID);
+  if (chpl_nodeID != srcnode) {
+    chpl_comm_diags_incr(get);
+  }
+
+  strd_common(false, dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+              count, stridelevels, elemSize);
+}
+
+//
+// Vectored transfers just move each piece in turn, but count as a single
+// operation.
+//
+void chpl_comm_put_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn) {
+  if (chpl_nodeID != node) {
+    chpl_comm_diags_verbose_rdmaV("put", node, n, ln, fn, commID);
+    chpl_comm_diags_incr(put);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    if (sizes[i] > 0)
+      do_put(addrs[i], node, raddrs[i], sizes[i]);
+  }
+}
+
+void chpl_comm_get_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn) {
+  if (chpl_nodeID != node) {
+    chpl_comm_diags_verbose_rdmaV("get", node, n, ln, fn, commID);
+    chpl_comm_diags_incr(get);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    if (sizes[i] > 0)
+      do_get(addrs[i], node, raddrs[i], sizes[i]);
+  }
+}
+
+#define MAX_UNORDERED_TRANS_SZ 1024
+void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
+                                c_nodeid_t srcnode, void* srcaddr,
+                                size_t size, int32_t commID,
+                                int ln, int32_t fn) {
+  assert(dstaddr != NULL);
+  assert(srcaddr != NULL);
+
+  if (size == 0)
+    return;
+
+  if (dstnode == chpl_nodeID && srcnode == chpl_nodeID) {
+    memmove(dstaddr, srcaddr, size);
+    return;
+  }
+
+  if (dstnode == chpl_nodeID) {
+    chpl_comm_get(dstaddr, srcnode, srcaddr, size, commID, ln, fn);
+  } else if (srcnode == chpl_nodeID) {
+    chpl_comm_put(srcaddr, dstnode, dstaddr, size, commID, ln, fn);
+  } else if (in_shared_heap(dstaddr, size) && in_shared_heap(srcaddr, size)) {
+    memmove(dstaddr, srcaddr, size);
+  } else {
+    if (size <= MAX_UNORDERED_TRANS_SZ) {
+      char buf[MAX_UNORDERED_TRANS_SZ];
+      chpl_comm_get(buf, srcnode, srcaddr, size, commID, ln, fn);
+      chpl_comm_put(buf, dstnode, dstaddr, size, commID, ln, fn);
+    } else {
+      char* buf = chpl_mem_alloc(size, CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+      chpl_comm_get(buf, srcnode, srcaddr, size, commID, ln, fn);
+      chpl_comm_put(buf, dstnode, dstaddr, size, commID, ln, fn);
+      chpl_mem_free(buf, 0, 0);
+    }
+  }
+}
+
+void chpl_comm_get_unordered(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size, int32_t commID, int ln, int32_t fn) {
+  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+}
+
+void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size, int32_t commID, int ln, int32_t fn) {
+  chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+}
+
+void chpl_comm_getput_unordered_task_fence(void) { }
+
+
+//
+// Chapel interface: executeOn
+//
+
+static inline
+void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
+                        chpl_fn_int_t fid,
+                        chpl_comm_on_bundle_t *arg, size_t arg_size,
+                        chpl_bool fast, chpl_bool blocking) {
+  done_t done;
+
+  if (blocking)
+    init_done_obj(&done, 1);
+
+  arg->kind = CHPL_ARG_BUNDLE_KIND_COMM;
+  arg->task_bundle.infoChapel = *chpl_task_getInfoChapel();
+  arg->task_bundle.requestedSubloc = subloc;
+  arg->task_bundle.requested_fid = fid;
+  arg->comm.caller = chpl_nodeID;
+  arg->comm.ack = blocking ? &done : NULL;
+
+  if (arg_size <= AM_MAX_PAYLOAD) {
+    am_send(node, fast ? FORK_FAST : FORK, arg, arg_size, NULL, 0);
+  } else {
+    //
+    // Too big for a message: send a description, and the handler will
+    // GET the bundle.  A non-blocking caller may reuse its argument as
+    // soon as we return, so we copy that one and the target frees the
+    // copy once it has it.  Don't consider a large fork fast, because
+    // the handler has to GET the bundle.
+    //
+    large_fork_t lg = { .caller = chpl_nodeID, .subloc = subloc,
+                        .ack = arg->comm.ack, .fid = fid,
+                        .infoChapel = arg->task_bundle.infoChapel,
+                        .arg = arg, .arg_size = arg_size,
+                        .blocking = blocking };
+    if (!blocking) {
+      lg.arg = chpl_mem_allocMany(1, arg_size,
+                                  CHPL_RT_MD_COMM_FRK_SND_ARG, 0, 0);
+      chpl_memcpy(lg.arg, arg, arg_size);
+    }
+    am_send(node, FORK_LARGE, &lg, sizeof(lg), NULL, 0);
+  }
+
+  if (blocking)
+    wait_done_obj(&done);
+}
+
+void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
+                           chpl_fn_int_t fid,
+                           chpl_comm_on_bundle_t *arg, size_t arg_size,
+                           int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    assert(0);
+    chpl_ftable_call(fid, arg);
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_executeOn, chpl_nodeID, node,
+         .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_executeOn("", node, ln, fn);
+    chpl_comm_diags_incr(execute_on);
+
+    execute_on_common(node, subloc, fid, arg, arg_size,
+                      /*fast*/ false, /*blocking*/ true);
+  }
+}
+
+void  chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
+                              chpl_fn_int_t fid,
+                              chpl_comm_on_bundle_t *arg, size_t arg_size,
+                              int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    assert(0); // locale model code should prevent this...
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_nb)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_executeOn_nb, chpl_nodeID, node,
+         .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_executeOn("non-blocking", node, ln, fn);
+    chpl_comm_diags_incr(execute_on_nb);
+
+    execute_on_common(node, subloc, fid, arg, arg_size,
+                      /*fast*/ false, /*blocking*/ false);
+  }
+}
+
+// should only be called for "small" functions
+void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
+                                chpl_fn_int_t fid,
+                                chpl_comm_on_bundle_t *arg, size_t arg_size,
+                                int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    assert(0);
+    chpl_ftable_call(fid, arg);
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, node,
+         .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_executeOn("fast", node, ln, fn);
+    chpl_comm_diags_incr(execute_on_fast);
+
+    execute_on_common(node, subloc, fid, arg, arg_size,
+                      /*fast*/ true, /*blocking*/ true);
+  }
+}
+
+
+//
+// Interface: network atomics
+//
+
+#define DEFN_CHPL_COMM_ATOMIC_WRITE(fnType, Type, isReal)               \
+  void chpl_comm_atomic_write_##fnType                                  \
+         (void* desired, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo write", node, ln, fn);             \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, AMO_WRITE, isReal, sizeof(Type),                \
+          desired, NULL, NULL);                                         \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_WRITE(int32, int32_t, false)
+DEFN_CHPL_COMM_ATOMIC_WRITE(int64, int64_t, false)
+DEFN_CHPL_COMM_ATOMIC_WRITE(uint32, uint32_t, false)
+DEFN_CHPL_COMM_ATOMIC_WRITE(uint64, uint64_t, false)
+DEFN_CHPL_COMM_ATOMIC_WRITE(real32, _real32, true)
+DEFN_CHPL_COMM_ATOMIC_WRITE(real64, _real64, true)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_READ(fnType, Type, isReal)                \
+  void chpl_comm_atomic_read_##fnType                                   \
+         (void* result, c_nodeid_t node, void* object,                  \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo read", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, AMO_READ, isReal, sizeof(Type),                 \
+          NULL, NULL, result);                                          \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_READ(int32, int32_t, false)
+DEFN_CHPL_COMM_ATOMIC_READ(int64, int64_t, false)
+DEFN_CHPL_COMM_ATOMIC_READ(uint32, uint32_t, false)
+DEFN_CHPL_COMM_ATOMIC_READ(uint64, uint64_t, false)
+DEFN_CHPL_COMM_ATOMIC_READ(real32, _real32, true)
+DEFN_CHPL_COMM_ATOMIC_READ(real64, _real64, true)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_XCHG(fnType, Type, isReal)                \
+  void chpl_comm_atomic_xchg_##fnType                                   \
+         (void* desired, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo xchg", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, AMO_XCHG, isReal, sizeof(Type),                 \
+          desired, NULL, result);                                       \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_XCHG(int32, int32_t, false)
+DEFN_CHPL_COMM_ATOMIC_XCHG(int64, int64_t, false)
+DEFN_CHPL_COMM_ATOMIC_XCHG(uint32, uint32_t, false)
+DEFN_CHPL_COMM_ATOMIC_XCHG(uint64, uint64_t, false)
+DEFN_CHPL_COMM_ATOMIC_XCHG(real32, _real32, true)
+DEFN_CHPL_COMM_ATOMIC_XCHG(real64, _real64, true)
+
+
+//
+// Compare-and-swap compares bit patterns, as the network-atomic comm
+// layers do.
+//
+#define DEFN_CHPL_COMM_ATOMIC_CMPXCHG(fnType, Type, isReal)             \
+  void chpl_comm_atomic_cmpxchg_##fnType                                \
+         (void* expected, void* desired, c_nodeid_t node, void* object, \
+          chpl_bool32* result, memory_order succ, memory_order fail,    \
+          int ln, int32_t fn) {                                         \
+    Type old_value;                                                     \
+    chpl_comm_diags_verbose_amo("amo cmpxchg", node, ln, fn);           \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, AMO_CMPXCHG, isReal, sizeof(Type),              \
+          expected, desired, &old_value);                               \
+    *result = (chpl_bool32) (memcmp(&old_value, expected,               \
+                                    sizeof(Type)) == 0);                \
+    if (!*result) memcpy(expected, &old_value, sizeof(Type));           \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(int32, int32_t, false)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(int64, int64_t, false)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(uint32, uint32_t, false)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(uint64, uint64_t, false)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(real32, _real32, true)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(real64, _real64, true)
+
+
+#define DEFN_IFACE_AMO_SIMPLE_OP(fnOp, amoOp, fnType, Type, isReal)     \
+  void chpl_comm_atomic_##fnOp##_##fnType                               \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo " #fnOp, node, ln, fn);            \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, amoOp, isReal, sizeof(Type),                    \
+          operand, NULL, NULL);                                         \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_##fnOp##_unordered_##fnType                     \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo unord_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, amoOp, isReal, sizeof(Type),                    \
+          operand, NULL, NULL);                                         \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_##fnOp##_##fnType                         \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo fetch_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, amoOp, isReal, sizeof(Type),                    \
+          operand, NULL, result);                                       \
+  }
+
+DEFN_IFACE_AMO_SIMPLE_OP(and, AMO_AND, int32, int32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(and, AMO_AND, int64, int64_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(and, AMO_AND, uint32, uint32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(and, AMO_AND, uint64, uint64_t, false)
+
+DEFN_IFACE_AMO_SIMPLE_OP(or, AMO_OR, int32, int32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(or, AMO_OR, int64, int64_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(or, AMO_OR, uint32, uint32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(or, AMO_OR, uint64, uint64_t, false)
+
+DEFN_IFACE_AMO_SIMPLE_OP(xor, AMO_XOR, int32, int32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, AMO_XOR, int64, int64_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, AMO_XOR, uint32, uint32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, AMO_XOR, uint64, uint64_t, false)
+
+DEFN_IFACE_AMO_SIMPLE_OP(add, AMO_ADD, int32, int32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(add, AMO_ADD, int64, int64_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(add, AMO_ADD, uint32, uint32_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(add, AMO_ADD, uint64, uint64_t, false)
+DEFN_IFACE_AMO_SIMPLE_OP(add, AMO_ADD, real32, _real32, true)
+DEFN_IFACE_AMO_SIMPLE_OP(add, AMO_ADD, real64, _real64, true)
+
+
+//
+// Subtraction is addition of the negated operand.
+//
+#define DEFN_IFACE_AMO_SUB(fnType, Type, isReal, negate)                \
+  void chpl_comm_atomic_sub_##fnType                                    \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    Type myOpnd = negate(*(Type*) operand);                             \
+    chpl_comm_diags_verbose_amo("amo sub", node, ln, fn);               \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, AMO_ADD, isReal, sizeof(Type),                  \
+          &myOpnd, NULL, NULL);                                         \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_sub_unordered_##fnType                          \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          int ln, int32_t fn) {                                         \
+    Type myOpnd = negate(*(Type*) operand);                             \
+    chpl_comm_diags_verbose_amo("amo unord_sub", node, ln, fn);         \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, AMO_ADD, isReal, sizeof(Type),                  \
+          &myOpnd, NULL, NULL);                                         \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_sub_##fnType                              \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    Type myOpnd = negate(*(Type*) operand);                             \
+    chpl_comm_diags_verbose_amo("amo fetch_sub", node, ln, fn);         \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, AMO_ADD, isReal, sizeof(Type),                  \
+          &myOpnd, NULL, result);                                       \
+  }
+
+#define NEGATE_I32(x) ((x) == INT32_MIN ? (x) : -(x))
+#define NEGATE_I64(x) ((x) == INT64_MIN ? (x) : -(x))
+#define NEGATE_U_OR_R(x) (-(x))
+
+DEFN_IFACE_AMO_SUB(int32, int32_t, false, NEGATE_I32)
+DEFN_IFACE_AMO_SUB(int64, int64_t, false, NEGATE_I64)
+DEFN_IFACE_AMO_SUB(uint32, uint32_t, false, NEGATE_U_OR_R)
+DEFN_IFACE_AMO_SUB(uint64, uint64_t, false, NEGATE_U_OR_R)
+DEFN_IFACE_AMO_SUB(real32, _real32, true, NEGATE_U_OR_R)
+DEFN_IFACE_AMO_SUB(real64, _real64, true, NEGATE_U_OR_R)
+
+//
+// Unordered atomics are done immediately, so there is nothing to flush.
+//
+void chpl_comm_atomic_unordered_task_fence(void) { }
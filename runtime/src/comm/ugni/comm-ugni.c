@@ -6083,6 +6083,24 @@ void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
 }
 
 
+void chpl_comm_put_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn)
+{
+  put_v_common(n, addrs, node, raddrs, sizes,
+               strd_maxHandles, local_yield,
+               commID, ln, fn);
+}
+
+
+void chpl_comm_get_v(size_t n, void** addrs, c_nodeid_t node, void** raddrs,
+                     size_t* sizes, int32_t commID, int ln, int32_t fn)
+{
+  get_v_common(n, addrs, node, raddrs, sizes,
+               strd_maxHandles, local_yield,
+               commID, ln, fn);
+}
+
+
 //
 // Non-blocking get interface
 //
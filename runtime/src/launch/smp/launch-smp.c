@@ -24,12 +24,14 @@
 #include "chpllaunch.h"
 
 
-// Simple launcher that just sets GASNET_PSHM_NODES and launchers the _real
+// Simple launcher that just sets GASNET_PSHM_NODES (and its equivalent
+// for CHPL_COMM=shmem) and launches the _real
 
 int chpl_launch(int argc, char* argv[], int32_t numLocales) {
   char baseCommand[4096];
 
   chpl_env_set_uint("GASNET_PSHM_NODES", numLocales, 1);
+  chpl_env_set_uint("CHPL_RT_COMM_SHMEM_NUM_LOCALES", numLocales, 1);
 
   chpl_compute_real_binary_name(argv[0]);
   snprintf(baseCommand, sizeof(baseCommand), "%s", chpl_get_real_binary_name());
@@ -26,12 +26,14 @@
 #include "chpl_rt_utils_static.h"
 #include "chplcgfns.h"
 #include "chpl-arg-bundle.h"
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
 #include "chplexit.h"
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks-internal.h"
+#include "chpl-tasks-diags.h"
 #include "chpl-topo.h"
 #include "chpltypes.h"
 #include "chpl-linefile-support.h"
@@ -49,7 +51,8 @@
 
 
 //
-// task pool: linked list of tasks
+// task pool: per-thread work-stealing deques of tasks, plus a global
+// overflow queue
 //
 typedef struct task_pool_struct* task_pool_p;
 
@@ -61,8 +64,9 @@ typedef struct task_pool_struct {
   task_pool_p*     p_list_head;  // task list we're on, if any
   task_pool_p      list_next;    // double-link pointers for list
   task_pool_p      list_prev;
-  task_pool_p      next;         // double-link pointers for pool
-  task_pool_p      prev;
+  chpl_bool        claimed;      // taken to be run; protected by list lock
+  atomic_int_least32_t refs;     // pool and list references, if on a list
+  task_pool_p      next;         // link in overflow queue
 
   chpl_task_prvDataImpl_t chpl_data;
 
@@ -80,30 +84,61 @@ typedef struct lockReport {
 } lockReport_t;
 
 
+//
+// Chase-Lev work-stealing deque.  The owning thread pushes and pops
+// tasks at the bottom; other threads steal them from the top.  The
+// deque doesn't grow: when it is full, new tasks go to the overflow
+// queue instead.
+//
+#define TASK_DEQUE_SIZE 1024    // must be a power of 2
+
+typedef struct {
+  atomic_int_least64_t top;
+  char                 pad[64];  // keep thieves and owner apart
+  atomic_int_least64_t bottom;
+  atomic_uintptr_t     buf[TASK_DEQUE_SIZE];
+} task_deque_t;
+
+
 // This is the data that is private to each thread.
 typedef struct {
   task_pool_p   ptask;
   lockReport_t* lockRprt;
+  task_deque_t* deque;          // tasks created by this thread, or NULL
+  uint64_t      rand_state;     // for choosing victims to steal from
 } thread_private_data_t;
 
 
 static chpl_bool        initialized = false;
 
-static chpl_thread_mutex_t threading_lock;     // critical section lock
+static chpl_thread_mutex_t threading_lock;     // thread creation lock
 static chpl_thread_mutex_t extra_task_lock;    // critical section lock
-static chpl_thread_mutex_t task_id_lock;       // critical section lock
-static chpl_thread_mutex_t task_list_lock;     // critical section lock
-static volatile task_pool_p
-                           task_pool_head;     // head of task pool
-static volatile task_pool_p
-                           task_pool_tail;     // tail of task pool
+static chpl_thread_mutex_t overflow_lock;      // overflow queue lock
+
+#define NUM_TASK_LIST_LOCKS 64                 // task list locks, chosen
+static chpl_thread_mutex_t                     //   by list head address
+                           task_list_locks[NUM_TASK_LIST_LOCKS];
 
-static int                 queued_task_cnt;    // number of tasks in task pool
+#define MAX_TASK_DEQUES 1024
+static atomic_uintptr_t    task_deques[MAX_TASK_DEQUES]; // all deques
+static atomic_int_least32_t
+                           num_task_deques;    // deques handed out so far
+
+static volatile task_pool_p
+                           overflow_head;      // head of overflow queue
+static task_pool_p         overflow_tail;      // tail of overflow queue
+
+static atomic_uint_least64_t
+                           next_task_id;       // next task ID to hand out
+static atomic_int_least64_t
+                           queued_task_cnt;    // number of tasks waiting
+                                               //   to be run
 static int64_t             extra_task_cnt;     // number of tasks being run by
                                                //   threads occupied already
 static int                 blocked_thread_cnt; // number of threads that
                                                //   cannot make progress
-static int                 idle_thread_cnt;    // number of threads looking
+static atomic_int_least32_t
+                           idle_thread_cnt;    // number of threads looking
                                                //   for work
 static uint64_t            progress_cnt;       // number of unblock operations,
                                                //   as a proxy for progress
@@ -120,8 +155,11 @@ static chpl_fn_p comm_task_fn;
 //
 // Internal functions.
 //
+static task_deque_t*           alloc_task_deque(void);
 static void                    enqueue_task(task_pool_p, task_pool_p*);
-static void                    dequeue_task(task_pool_p);
+static task_pool_p             find_task(thread_private_data_t*);
+static chpl_bool               claim_task(task_pool_p);
+static void                    release_task(task_pool_p);
 static void                    comm_task_wrapper(void*);
 static void                    taskCallBody(chpl_fn_int_t, chpl_fn_p,
                                             void*, size_t,
@@ -141,7 +179,7 @@ static void                    check_for_deadlock(void);
 static void                    thread_begin(void*);
 static void                    thread_end(void);
 static void                    maybe_add_thread(void);
-static task_pool_p             add_to_task_pool(chpl_fn_int_t, chpl_fn_p,
+static void                    add_to_task_pool(chpl_fn_int_t, chpl_fn_p,
                                                 void*, size_t,
                                                 chpl_bool, task_pool_p*,
                                                 chpl_bool, int, int32_t);
@@ -163,34 +201,35 @@ static void chpl_thread_sync_awaken(chpl_sync_aux_t *s);
 static void sync_wait_and_lock(chpl_sync_aux_t *s,
                                chpl_bool want_full,
                                int32_t lineno, int32_t filename) {
-  chpl_bool suspend_using_cond;
-
   chpl_thread_mutexLock(&s->lock);
 
-  // If we're oversubscribing the hardware, we wait using conditionals
-  // in order to ensure fairness and thus progress.  If we're not, we
-  // can spin-wait.
-  suspend_using_cond = (chpl_thread_getNumThreads() >=
-                        chpl_topo_getNumCPUsLogical(true));
+  // If we're not oversubscribing the hardware, we first spin and yield
+  // for a while with the lock released, in case the variable changes
+  // soon.  After that, or right away if we are oversubscribing, we wait
+  // using conditionals, which doesn't keep a CPU busy and ensures
+  // fairness and thus progress.
+  if (s->is_full != want_full
+      && chpl_thread_getNumThreads() < chpl_topo_getNumCPUsLogical(true)) {
+    uint32_t backoff = 0;
+    uint64_t diagsWait = chpl_task_diags_waitBegin();
+    chpl_thread_mutexUnlock(&s->lock);
+    while (s->is_full != want_full && chpl_task_waitBackoff(&backoff))
+      ;
+    chpl_thread_mutexLock(&s->lock);
+    chpl_task_diags_waitEnd(diagsWait);
+  }
 
   while (s->is_full != want_full) {
-    if (!suspend_using_cond) {
-      chpl_thread_mutexUnlock(&s->lock);
-    }
+    uint64_t diagsWait = chpl_task_diags_waitBegin();
     if (set_block_loc(lineno, filename)) {
       // all other tasks appear to be blocked
       struct timeval deadline, now;
       chpl_bool timed_out = false;
-      // default value so that always allows condition to be true if not
-      // using conditionals
 
       gettimeofday(&deadline, NULL);
       deadline.tv_sec += 1;
       do {
-        if (suspend_using_cond)
-          timed_out = chpl_thread_sync_suspend(s, &deadline);
-        else
-          chpl_thread_yield();
+        timed_out = chpl_thread_sync_suspend(s, &deadline);
 
         if (s->is_full != want_full && !timed_out)
           gettimeofday(&now, NULL);
@@ -204,15 +243,11 @@ static void sync_wait_and_lock(chpl_sync_aux_t *s,
     }
     else {
       do {
-        if (suspend_using_cond)
-          (void) chpl_thread_sync_suspend(s, NULL);
-        else
-          chpl_thread_yield();
+        (void) chpl_thread_sync_suspend(s, NULL);
       } while (s->is_full != want_full);
     }
     unset_block_loc();
-    if (!suspend_using_cond)
-      chpl_thread_mutexLock(&s->lock);
+    chpl_task_diags_waitEnd(diagsWait);
   }
 
   if (blockreport)
@@ -313,6 +348,7 @@ static void setup_main_thread_private_data(void)
   tp = (thread_private_data_t*) chpl_mem_calloc(1, sizeof(thread_private_data_t),
                                                 CHPL_RT_MD_THREAD_PRV_DATA,
                                                 0, 0);
+  tp->deque = alloc_task_deque();
 
   tp->ptask = (task_pool_p) chpl_mem_calloc(1,
                                             (offsetof(task_pool_t, bundle)
@@ -341,13 +377,20 @@ static void setup_main_thread_private_data(void)
 void chpl_task_init(void) {
   chpl_thread_mutexInit(&threading_lock);
   chpl_thread_mutexInit(&extra_task_lock);
-  chpl_thread_mutexInit(&task_id_lock);
-  chpl_thread_mutexInit(&task_list_lock);
-  queued_task_cnt = 0;
+  chpl_thread_mutexInit(&overflow_lock);
+  for (int i = 0; i < NUM_TASK_LIST_LOCKS; i++) {
+    chpl_thread_mutexInit(&task_list_locks[i]);
+  }
+  for (int i = 0; i < MAX_TASK_DEQUES; i++) {
+    atomic_init_uintptr_t(&task_deques[i], (uintptr_t) NULL);
+  }
+  atomic_init_int_least32_t(&num_task_deques, 0);
+  atomic_init_uint_least64_t(&next_task_id, chpl_nullTaskID + 1);
+  atomic_init_int_least64_t(&queued_task_cnt, 0);
   blocked_thread_cnt = 0;
-  idle_thread_cnt = 0;
+  atomic_init_int_least32_t(&idle_thread_cnt, 0);
   extra_task_cnt = 0;
-  task_pool_head = task_pool_tail = NULL;
+  overflow_head = overflow_tail = NULL;
 
   chpl_thread_init(thread_begin, thread_end);
 
@@ -508,6 +551,7 @@ static void comm_task_wrapper(void* arg) {
   tp = (thread_private_data_t*) chpl_mem_calloc(1, sizeof(thread_private_data_t),
                                                 CHPL_RT_MD_THREAD_PRV_DATA,
                                                 0, 0);
+  tp->deque = alloc_task_deque();
 
   tp->ptask = (task_pool_p) chpl_mem_calloc(1,
                                             (offsetof(task_pool_t, bundle)
@@ -534,21 +578,160 @@ static void comm_task_wrapper(void* arg) {
 
 
 //
-// Enqueue and dequeue tasks from the pool.
+// Work-stealing deque operations.  These follow the C11 formulation in
+// Le, Pop, Cohen, and Zappa Nardelli, "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (PPoPP '13).
 //
+static
+task_deque_t* alloc_task_deque(void) {
+  task_deque_t* d;
+  int32_t i;
+
+  i = atomic_fetch_add_int_least32_t(&num_task_deques, 1);
+  if (i >= MAX_TASK_DEQUES)
+    return NULL;
+
+  d = (task_deque_t*) chpl_mem_alloc(sizeof(task_deque_t),
+                                     CHPL_RT_MD_THREAD_PRV_DATA, 0, 0);
+  atomic_init_int_least64_t(&d->top, 0);
+  atomic_init_int_least64_t(&d->bottom, 0);
+  for (int j = 0; j < TASK_DEQUE_SIZE; j++)
+    atomic_init_uintptr_t(&d->buf[j], (uintptr_t) NULL);
+
+  atomic_store_uintptr_t(&task_deques[i], (uintptr_t) d);
+  return d;
+}
+
+
 static inline
-void enqueue_task(task_pool_p ptask, task_pool_p* p_task_list_head) {
-  queued_task_cnt++;
+chpl_bool deque_push(task_deque_t* d, task_pool_p ptask) {
+  int_least64_t b, t;
 
-  //
-  // Add to pool.
-  //
-  if (task_pool_tail)
-    task_pool_tail->next = ptask;
+  b = atomic_load_explicit_int_least64_t(&d->bottom, memory_order_relaxed);
+  t = atomic_load_explicit_int_least64_t(&d->top, memory_order_acquire);
+  if (b - t >= TASK_DEQUE_SIZE)
+    return false;
+
+  atomic_store_explicit_uintptr_t(&d->buf[b & (TASK_DEQUE_SIZE - 1)],
+                                  (uintptr_t) ptask, memory_order_relaxed);
+  chpl_atomic_thread_fence(memory_order_release);
+  atomic_store_explicit_int_least64_t(&d->bottom, b + 1, memory_order_relaxed);
+  return true;
+}
+
+
+static inline
+task_pool_p deque_pop(task_deque_t* d) {
+  task_pool_p ptask = NULL;
+  int_least64_t b, t;
+
+  b = atomic_load_explicit_int_least64_t(&d->bottom, memory_order_relaxed) - 1;
+  atomic_store_explicit_int_least64_t(&d->bottom, b, memory_order_relaxed);
+  chpl_atomic_thread_fence(memory_order_seq_cst);
+  t = atomic_load_explicit_int_least64_t(&d->top, memory_order_relaxed);
+
+  if (t <= b) {
+    ptask = (task_pool_p)
+            atomic_load_explicit_uintptr_t(&d->buf[b & (TASK_DEQUE_SIZE - 1)],
+                                           memory_order_relaxed);
+    if (t == b) {
+      // last one; race thieves for it
+      if (!atomic_compare_exchange_strong_explicit_int_least64_t(
+             &d->top, &t, t + 1,
+             memory_order_seq_cst, memory_order_relaxed))
+        ptask = NULL;
+      atomic_store_explicit_int_least64_t(&d->bottom, b + 1,
+                                          memory_order_relaxed);
+    }
+  }
+  else {
+    atomic_store_explicit_int_least64_t(&d->bottom, b + 1,
+                                        memory_order_relaxed);
+  }
+
+  return ptask;
+}
+
+
+//
+// Cheap check so we needn't pay for the fences in deque_pop() and
+// deque_steal() on deques that are clearly empty.  It can be wrong in
+// either direction, so a deque that looks nonempty may still turn out
+// to be empty, and one that looks empty will be looked at again later.
+//
+static inline
+chpl_bool deque_looks_empty(task_deque_t* d) {
+  return (atomic_load_explicit_int_least64_t(&d->top, memory_order_relaxed)
+          >= atomic_load_explicit_int_least64_t(&d->bottom,
+                                                memory_order_relaxed));
+}
+
+
+static inline
+task_pool_p deque_steal(task_deque_t* d) {
+  int_least64_t b, t;
+
+  t = atomic_load_explicit_int_least64_t(&d->top, memory_order_acquire);
+  chpl_atomic_thread_fence(memory_order_seq_cst);
+  b = atomic_load_explicit_int_least64_t(&d->bottom, memory_order_acquire);
+
+  if (t < b) {
+    task_pool_p ptask = (task_pool_p)
+      atomic_load_explicit_uintptr_t(&d->buf[t & (TASK_DEQUE_SIZE - 1)],
+                                     memory_order_relaxed);
+    if (atomic_compare_exchange_strong_explicit_int_least64_t(
+          &d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+      return ptask;
+  }
+
+  return NULL;
+}
+
+
+//
+// Task lists (for cobegins and coforalls) are protected by one of a
+// set of locks, chosen by the address of the list head.
+//
+static inline
+chpl_thread_mutex_t* task_list_lock(task_pool_p* p_task_list_head) {
+  return &task_list_locks[((uintptr_t) p_task_list_head >> 4)
+                          % NUM_TASK_LIST_LOCKS];
+}
+
+
+//
+// Remove a task from its list.  The caller must hold the list lock.
+//
+static inline
+void unlink_from_task_list(task_pool_p ptask) {
+  if (ptask == *(ptask->p_list_head))
+    *(ptask->p_list_head) = ptask->list_next;
   else
-    task_pool_head = ptask;
-  ptask->prev = task_pool_tail;
-  task_pool_tail = ptask;
+    ptask->list_prev->list_next = ptask->list_next;
+  if (ptask->list_next != NULL)
+    ptask->list_next->list_prev = ptask->list_prev;
+}
+
+
+//
+// Add a task to the pool and, if given one, a task list.  The task
+// goes on the creating thread's deque if it has one with room, and
+// otherwise on the overflow queue.
+//
+// A task that is on a list can be run either by a pool thread or by
+// the list owner, in chpl_task_executeTasksInList().  Whichever one
+// claims it first runs it.  The task descriptor is referenced from
+// both the pool and the list, and is freed when both references are
+// gone.
+//
+static inline
+void enqueue_task(task_pool_p ptask, task_pool_p* p_task_list_head) {
+  thread_private_data_t* tp;
+
+  chpl_task_diags_spawn();
+
+  ptask->claimed = false;
+  ptask->next = NULL;
 
   //
   // Add to list, if any.
@@ -557,47 +740,138 @@ void enqueue_task(task_pool_p ptask, task_pool_p* p_task_list_head) {
     ptask->p_list_head = NULL;
   }
   else {
+    chpl_thread_mutex_t* lock = task_list_lock(p_task_list_head);
+
+    atomic_init_int_least32_t(&ptask->refs, 2);
     ptask->p_list_head = p_task_list_head;
+
+    chpl_thread_mutexLock(lock);
     ptask->list_next = *p_task_list_head;
     if (*p_task_list_head != NULL)
       (*p_task_list_head)->list_prev = ptask;
     ptask->list_prev = NULL;
     *p_task_list_head = ptask;
+    chpl_thread_mutexUnlock(lock);
   }
-}
-
 
-static inline
-void dequeue_task(task_pool_p ptask) {
-  assert(queued_task_cnt > 0);
-  queued_task_cnt--;
+  (void) atomic_fetch_add_int_least64_t(&queued_task_cnt, 1);
 
   //
-  // Remove from pool.
+  // Add to pool.
   //
-  if (ptask == task_pool_head) {
-    if ((task_pool_head = task_pool_head->next) == NULL)
-      task_pool_tail = NULL;
+  tp = (thread_private_data_t*) chpl_thread_getPrivateData();
+  if (tp == NULL || tp->deque == NULL || !deque_push(tp->deque, ptask)) {
+    chpl_thread_mutexLock(&overflow_lock);
+    if (overflow_tail)
+      overflow_tail->next = ptask;
     else
-      task_pool_head->prev = NULL;
+      overflow_head = ptask;
+    overflow_tail = ptask;
+    chpl_thread_mutexUnlock(&overflow_lock);
+  }
+}
+
+
+//
+// Find a task in the pool: first in our own deque, then in the
+// overflow queue, then in other threads' deques starting at a random
+// one.  The result may already have been claimed via its task list;
+// the caller needs to call claim_task() to find out.
+//
+static
+task_pool_p find_task(thread_private_data_t* tp) {
+  task_pool_p ptask;
+  int32_t num_deques;
+  int32_t start;
+
+  if (tp->deque != NULL
+      && !deque_looks_empty(tp->deque)
+      && (ptask = deque_pop(tp->deque)) != NULL)
+    return ptask;
+
+  if (overflow_head != NULL) {
+    chpl_thread_mutexLock(&overflow_lock);
+    if ((ptask = overflow_head) != NULL) {
+      if ((overflow_head = ptask->next) == NULL)
+        overflow_tail = NULL;
+    }
+    chpl_thread_mutexUnlock(&overflow_lock);
+    if (ptask != NULL)
+      return ptask;
+  }
+
+  num_deques = atomic_load_int_least32_t(&num_task_deques);
+  if (num_deques > MAX_TASK_DEQUES)
+    num_deques = MAX_TASK_DEQUES;
+  if (num_deques == 0)
+    return NULL;
+
+  // xorshift64
+  tp->rand_state ^= tp->rand_state << 13;
+  tp->rand_state ^= tp->rand_state >> 7;
+  tp->rand_state ^= tp->rand_state << 17;
+  start = (int32_t) (tp->rand_state % (uint64_t) num_deques);
+
+  for (int32_t i = 0; i < num_deques; i++) {
+    task_deque_t* d;
+
+    d = (task_deque_t*)
+        atomic_load_uintptr_t(&task_deques[(start + i) % num_deques]);
+    if (d == NULL || d == tp->deque || deque_looks_empty(d))
+      continue;
+    if ((ptask = deque_steal(d)) != NULL) {
+      chpl_task_diags_steal();
+      return ptask;
+    }
+  }
+
+  return NULL;
+}
+
+
+//
+// Claim a task just taken from the pool.  Returns true if the caller
+// should run it, and false if the list owner already claimed it.
+//
+static
+chpl_bool claim_task(task_pool_p ptask) {
+  chpl_bool mine;
+
+  if (ptask->p_list_head == NULL) {
+    mine = true;
   }
   else {
-    if ((ptask->prev->next = ptask->next) == NULL)
-      task_pool_tail = ptask->prev;
-    else
-      ptask->next->prev = ptask->prev;
+    chpl_thread_mutex_t* lock = task_list_lock(ptask->p_list_head);
+
+    chpl_thread_mutexLock(lock);
+    if ((mine = !ptask->claimed)) {
+      ptask->claimed = true;
+      unlink_from_task_list(ptask);
+    }
+    chpl_thread_mutexUnlock(lock);
+
+    // drop the list reference if we claimed it, otherwise the pool one
+    release_task(ptask);
   }
 
-  //
-  // Remove from list, if on one.
-  //
-  if (ptask->p_list_head != NULL) {
-    if (ptask == *(ptask->p_list_head))
-      *(ptask->p_list_head) = ptask->list_next;
-    else
-      ptask->list_prev->list_next = ptask->list_next;
-    if (ptask->list_next != NULL)
-      ptask->list_next->list_prev = ptask->list_prev;
+  if (mine)
+    (void) atomic_fetch_sub_int_least64_t(&queued_task_cnt, 1);
+
+  return mine;
+}
+
+
+//
+// Drop a reference to a task, and free it if that was the last one.
+//
+static
+void release_task(task_pool_p ptask) {
+  if (ptask->p_list_head == NULL) {
+    chpl_mem_free(ptask, 0, 0);
+  }
+  else if (atomic_fetch_sub_int_least32_t(&ptask->refs, 1) == 1) {
+    atomic_destroy_int_least32_t(&ptask->refs);
+    chpl_mem_free(ptask, 0, 0);
   }
 }
 
@@ -614,13 +888,10 @@ void chpl_task_addToTaskList(chpl_fn_int_t fid,
 
   arg->kind = CHPL_ARG_BUNDLE_KIND_TASK;
 
-  // begin critical section
-  chpl_thread_mutexLock(&threading_lock);
-
   if (task_list_locale == chpl_nodeID) {
-    (void) add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
-                            false, (task_pool_p*) p_task_list_void,
-                            is_begin_stmt, lineno, filename);
+    add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
+                     false, (task_pool_p*) p_task_list_void,
+                     is_begin_stmt, lineno, filename);
 
   }
   else {
@@ -630,12 +901,34 @@ void chpl_task_addToTaskList(chpl_fn_int_t fid,
     // the context of a cobegin or coforall statement.
     //
     assert(is_begin_stmt);
-    (void) add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
-                            false, NULL, true, 0, CHPL_FILE_IDX_UNKNOWN);
+    add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
+                     false, NULL, true, 0, CHPL_FILE_IDX_UNKNOWN);
   }
+}
 
-  // end critical section
-  chpl_thread_mutexUnlock(&threading_lock);
+
+//
+// Tasks here already run on the stacks of pooled threads, one after
+// another, so tasks that run to completion are treated like any other.
+//
+void chpl_task_addStacklessToTaskList(chpl_fn_int_t fid,
+                                      chpl_task_bundle_t* arg,
+                                      size_t arg_size,
+                                      c_sublocid_t subloc,
+                                      void** p_task_list_void,
+                                      int32_t task_list_locale,
+                                      chpl_bool is_begin_stmt,
+                                      int lineno,
+                                      int32_t filename) {
+  chpl_task_addToTaskList(fid, arg, arg_size, subloc, p_task_list_void,
+                          task_list_locale, is_begin_stmt, lineno, filename);
+}
+
+
+//
+// Tasks added here are always made available to run right away.
+//
+void chpl_task_deferTasksInList(void** p_task_list_void) {
 }
 
 
@@ -650,22 +943,27 @@ void chpl_task_executeTasksInList(void** p_task_list_void) {
   curr_ptask = get_current_ptask(true /*must_be_task*/);
 
   while (*p_task_list_head != NULL) {
+    chpl_thread_mutex_t* lock = task_list_lock(p_task_list_head);
     chpl_fn_p task_to_run_fun = NULL;
+    int queue_depth = 0;
 
     // begin critical section
-    chpl_thread_mutexLock(&threading_lock);
+    chpl_thread_mutexLock(lock);
 
     if ((child_ptask = *p_task_list_head) != NULL) {
       task_to_run_fun = child_ptask->taskBundle->requested_fn;
-      dequeue_task(child_ptask);
+      child_ptask->claimed = true;
+      unlink_from_task_list(child_ptask);
     }
 
     // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+    chpl_thread_mutexUnlock(lock);
 
     if (task_to_run_fun == NULL)
       continue;
 
+    queue_depth = atomic_fetch_sub_int_least64_t(&queued_task_cnt, 1) - 1;
+
     set_current_ptask(child_ptask);
 
     // begin critical section
@@ -693,7 +991,9 @@ void chpl_task_executeTasksInList(void** p_task_list_void) {
                            child_ptask->taskBundle->id,
                            child_ptask->taskBundle->is_executeOn);
 
+    chpl_task_diags_taskBegin(queue_depth);
     (*task_to_run_fun)(&child_ptask->bundle);
+    chpl_task_diags_taskEnd();
 
     chpl_task_do_callbacks(chpl_task_cb_event_kind_end,
                            child_ptask->taskBundle->requested_fid,
@@ -718,7 +1018,7 @@ void chpl_task_executeTasksInList(void** p_task_list_void) {
     chpl_thread_mutexUnlock(&extra_task_lock);
 
     set_current_ptask(curr_ptask);
-    chpl_mem_free(child_ptask, 0, 0);
+    release_task(child_ptask);
 
   }
 }
@@ -737,14 +1037,8 @@ void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                   void* arg, size_t arg_size,
                   c_sublocid_t subloc,
                   int lineno, int32_t filename) {
-  // begin critical section
-  chpl_thread_mutexLock(&threading_lock);
-
-  (void) add_to_task_pool(fid, fp, arg, arg_size, true,
-                          NULL, false, lineno, filename);
-
-  // end critical section
-  chpl_thread_mutexUnlock(&threading_lock);
+  add_to_task_pool(fid, fp, arg, arg_size, true,
+                   NULL, false, lineno, filename);
 }
 
 
@@ -864,7 +1158,7 @@ chpl_bool chpl_task_guardPagesInUse(void) {
 }
 
 uint32_t chpl_task_getNumQueuedTasks(void) {
-  return queued_task_cnt;
+  return (uint32_t) atomic_load_int_least64_t(&queued_task_cnt);
 }
 
 int32_t chpl_task_getNumBlockedTasks(void) {
@@ -872,14 +1166,13 @@ int32_t chpl_task_getNumBlockedTasks(void) {
     int numBlockedTasks;
 
     // begin critical section
-    chpl_thread_mutexLock(&threading_lock);
     chpl_thread_mutexLock(&block_report_lock);
 
-    numBlockedTasks = blocked_thread_cnt - idle_thread_cnt;
+    numBlockedTasks = blocked_thread_cnt
+                      - atomic_load_int_least32_t(&idle_thread_cnt);
 
     // end critical section
     chpl_thread_mutexUnlock(&block_report_lock);
-    chpl_thread_mutexUnlock(&threading_lock);
 
     assert(numBlockedTasks >= 0);
     return numBlockedTasks;
@@ -895,15 +1188,7 @@ int32_t chpl_task_getNumBlockedTasks(void) {
 // Get a new task ID.
 //
 static chpl_taskID_t get_next_task_id(void) {
-  static chpl_taskID_t       id = chpl_nullTaskID + 1;
-
-  chpl_taskID_t              next_id;
-
-  chpl_thread_mutexLock(&task_id_lock);
-  next_id = id++;
-  chpl_thread_mutexUnlock(&task_id_lock);
-
-  return next_id;
+  return (chpl_taskID_t) atomic_fetch_add_uint_least64_t(&next_task_id, 1);
 }
 
 
@@ -977,18 +1262,47 @@ static void report_locked_threads(void) {
 // This signal handler prints an overall task report, containing
 // pending tasks and those that are running.
 //
+static void print_pending_task(task_pool_p pendingTask) {
+  if (pendingTask->p_list_head != NULL && pendingTask->claimed)
+    return;
+  printf("- %s:%d\n", chpl_lookupFilename(pendingTask->taskBundle->filename),
+         pendingTask->taskBundle->lineno);
+}
+
 static void report_all_tasks(void) {
-  task_pool_p pendingTask = task_pool_head;
+  task_pool_p pendingTask;
+  int32_t num_deques;
 
   printf("Task report\n");
   printf("--------------------------------\n");
 
-  // print out pending tasks
+  //
+  // Print out pending tasks.  We don't lock anything here, so this is
+  // only accurate if the other threads aren't making progress.  That's
+  // true in the deadlock case, and close enough for ^C.
+  //
   printf("Pending tasks:\n");
-  while (pendingTask != NULL) {
-    printf("- %s:%d\n", chpl_lookupFilename(pendingTask->taskBundle->filename),
-           pendingTask->taskBundle->lineno);
-    pendingTask = pendingTask->next;
+  for (pendingTask = overflow_head;
+       pendingTask != NULL;
+       pendingTask = pendingTask->next) {
+    print_pending_task(pendingTask);
+  }
+  num_deques = atomic_load_int_least32_t(&num_task_deques);
+  if (num_deques > MAX_TASK_DEQUES)
+    num_deques = MAX_TASK_DEQUES;
+  for (int32_t i = 0; i < num_deques; i++) {
+    task_deque_t* d = (task_deque_t*) atomic_load_uintptr_t(&task_deques[i]);
+    int_least64_t t, b;
+
+    if (d == NULL)
+      continue;
+    t = atomic_load_int_least64_t(&d->top);
+    b = atomic_load_int_least64_t(&d->bottom);
+    for ( ; t < b; t++) {
+      pendingTask = (task_pool_p)
+                    atomic_load_uintptr_t(&d->buf[t & (TASK_DEQUE_SIZE - 1)]);
+      print_pending_task(pendingTask);
+    }
   }
   printf("\n");
 
@@ -1151,10 +1465,17 @@ thread_begin(void* ptask_void) {
 
   tp->ptask = NULL;
   tp->lockRprt = NULL;
+  tp->deque = alloc_task_deque();
+  tp->rand_state = ((uint64_t) (uintptr_t) tp * UINT64_C(0x9e3779b97f4a7c15))
+                   | 1;
   if (blockreport)
     initializeLockReportForThread();
 
   while (true) {
+    int queue_depth;
+
+    chpl_task_diags_idleBegin();
+
     //
     // wait for a task to be present in the task pool
     //
@@ -1169,62 +1490,66 @@ thread_begin(void* ptask_void) {
     // that were waiting on the signal, but since there was a performance
     // impact from keeping it as a hybrid as opposed to merely yielding,
     // it was decided that we would return to the simple yield case.
-    while (!task_pool_head) {
-      if (set_block_loc(0, CHPL_FILE_IDX_IDLE_TASK)) {
-        // all other tasks appear to be blocked
-        struct timeval deadline, now;
-        gettimeofday(&deadline, NULL);
-        deadline.tv_sec += 1;
-        do {
-          chpl_thread_yield();
-          if (!task_pool_head)
-            gettimeofday(&now, NULL);
-        } while (!task_pool_head
-                 && (now.tv_sec < deadline.tv_sec
-                     || (now.tv_sec == deadline.tv_sec
-                         && now.tv_usec < deadline.tv_usec)));
-        if (!task_pool_head) {
-          check_for_deadlock();
+    while (true) {
+      while (atomic_load_int_least64_t(&queued_task_cnt) == 0) {
+        if (set_block_loc(0, CHPL_FILE_IDX_IDLE_TASK)) {
+          // all other tasks appear to be blocked
+          struct timeval deadline, now;
+          gettimeofday(&deadline, NULL);
+          deadline.tv_sec += 1;
+          do {
+            chpl_thread_yield();
+            if (atomic_load_int_least64_t(&queued_task_cnt) == 0)
+              gettimeofday(&now, NULL);
+          } while (atomic_load_int_least64_t(&queued_task_cnt) == 0
+                   && (now.tv_sec < deadline.tv_sec
+                       || (now.tv_sec == deadline.tv_sec
+                           && now.tv_usec < deadline.tv_usec)));
+          if (atomic_load_int_least64_t(&queued_task_cnt) == 0) {
+            check_for_deadlock();
+          }
+        }
+        else {
+          do {
+            chpl_thread_yield();
+          } while (atomic_load_int_least64_t(&queued_task_cnt) == 0);
         }
-      }
-      else {
-        do {
-          chpl_thread_yield();
-        } while (!task_pool_head);
-      }
 
-      unset_block_loc();
-    }
+        unset_block_loc();
+      }
 
-    //
-    // Just now the pool had at least one task in it.  Lock and see if
-    // there's something still there.
-    //
-    chpl_thread_mutexLock(&threading_lock);
-    if (!task_pool_head) {
-      chpl_thread_mutexUnlock(&threading_lock);
-      continue;
+      //
+      // Just now the pool had at least one task in it.  See if we can
+      // find one that nobody else has claimed.
+      //
+      if ((ptask = find_task(tp)) != NULL && claim_task(ptask))
+        break;
+
+      //
+      // Someone else got there first.  Let them get on with it.
+      //
+      chpl_thread_yield();
     }
 
     //
     // We've found a task to run.
     //
 
-    if (blockreport)
+    if (blockreport) {
+      chpl_thread_mutexLock(&block_report_lock);
       progress_cnt++;
+      chpl_thread_mutexUnlock(&block_report_lock);
+    }
 
     //
-    // start new task; remove task from pool also add to task to task-table
-    // (structure in ChapelRuntime that keeps track of currently running tasks
-    // for task-reports on deadlock or Ctrl+C).
+    // start new task; also add to task to task-table (structure in
+    // ChapelRuntime that keeps track of currently running tasks for
+    // task-reports on deadlock or Ctrl+C).
     //
-    ptask = task_pool_head;
-    idle_thread_cnt--;
-
-    dequeue_task(ptask);
+    (void) atomic_fetch_sub_int_least32_t(&idle_thread_cnt, 1);
+    queue_depth = atomic_load_int_least64_t(&queued_task_cnt);
 
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+    chpl_task_diags_idleEnd();
 
     tp->ptask = ptask;
 
@@ -1241,7 +1566,9 @@ thread_begin(void* ptask_void) {
                            ptask->taskBundle->id,
                            ptask->taskBundle->is_executeOn);
 
+    chpl_task_diags_taskBegin(queue_depth);
     (ptask->taskBundle->requested_fn)(&ptask->bundle);
+    chpl_task_diags_taskEnd();
 
     chpl_task_do_callbacks(chpl_task_cb_event_kind_end,
                            ptask->taskBundle->requested_fid,
@@ -1257,18 +1584,12 @@ thread_begin(void* ptask_void) {
     }
 
     tp->ptask = NULL;
-    chpl_mem_free(ptask, 0, 0);
-
-    // begin critical section
-    chpl_thread_mutexLock(&threading_lock);
+    release_task(ptask);
 
     //
     // finished task; increment idle count
     //
-    idle_thread_cnt++;
-
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+    (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
   }
 }
 
@@ -1300,7 +1621,7 @@ static void maybe_add_thread(void) {
 
   if (!warning_issued && chpl_thread_canCreate()) {
     if (chpl_thread_create(NULL) == 0) {
-      idle_thread_cnt++;
+      (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
     }
     else {
       int32_t max_threads = chpl_thread_getMaxThreads();
@@ -1324,10 +1645,9 @@ static void maybe_add_thread(void) {
 
 
 // create a task from the given function pointer and arguments
-// and append it to the end of the task pool
-// assumes threading_lock has already been acquired!
+// and add it to the task pool
 static inline
-task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
+void add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
                              void* a, size_t a_size,
                              chpl_bool is_executeOn,
                              task_pool_p* p_task_list_head,
@@ -1356,7 +1676,6 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
   ptask->list_next              = NULL;
   ptask->list_prev              = NULL;
   ptask->next                   = NULL;
-  ptask->prev                   = NULL;
   ptask->chpl_data              = pv;
 
   *ptask->taskBundle =
@@ -1371,8 +1690,6 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
       .infoChapel      = ptask->taskBundle->infoChapel,// retain; set by caller
     };
 
-  enqueue_task(ptask, p_task_list_head);
-
   chpl_task_do_callbacks(chpl_task_cb_event_kind_create,
                          ptask->taskBundle->requested_fid,
                          ptask->taskBundle->filename,
@@ -1389,13 +1706,23 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
     chpl_thread_mutexUnlock(&taskTable_lock);
   }
 
+  //
+  // Once the task is in the pool another thread may run it at any time,
+  // so we mustn't refer to it after this.
+  //
+  enqueue_task(ptask, p_task_list_head);
+
   // If we now have more tasks than threads to run them on, try to start
   // another thread
-  if (queued_task_cnt > idle_thread_cnt) {
-    maybe_add_thread();
+  if (atomic_load_int_least64_t(&queued_task_cnt)
+      > atomic_load_int_least32_t(&idle_thread_cnt)) {
+    chpl_thread_mutexLock(&threading_lock);
+    if (atomic_load_int_least64_t(&queued_task_cnt)
+        > atomic_load_int_least32_t(&idle_thread_cnt)) {
+      maybe_add_thread();
+    }
+    chpl_thread_mutexUnlock(&threading_lock);
   }
-
-  return ptask;
 }
 
 
@@ -1406,5 +1733,5 @@ uint32_t chpl_task_getNumThreads(void) {
 }
 
 uint32_t chpl_task_getNumIdleThreads(void) {
-  return idle_thread_cnt;
+  return (uint32_t) atomic_load_int_least32_t(&idle_thread_cnt);
 }
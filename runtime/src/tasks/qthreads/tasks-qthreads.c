@@ -37,6 +37,7 @@
 #include "error.h"
 #include "chplcgfns.h"
 #include "chpl-arg-bundle.h"
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
 #include "chpl-env.h"
 #include "chplexit.h"
@@ -46,6 +47,7 @@
 #include "chpl-linefile-support.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks-internal.h"
+#include "chpl-tasks-diags.h"
 #include "chpl-tasks-impl.h"
 #include "chpl-topo.h"
 #include "chpltypes.h"
@@ -134,14 +136,86 @@ static pthread_mutex_t init_mutex = PTHREAD_MUTEX_INITIALIZER;
 #define QT_ENV_S 100
 
 // aka chpl_task_list_p
+//
+// The tasks of a cobegin or bounded coforall statement whose parent has
+// called chpl_task_deferTasksInList(), collected by
+// chpl_task_addToTaskList() and spawned as a tree by
+// chpl_task_executeTasksInList().  The argument bundles are copied into
+// buf back to back, and task i's bundle starts at offsets[i].  The list
+// is freed when the parent and all the spawner tasks are done with it.
+//
 struct chpl_task_list {
-    chpl_fn_p        fun;
-    void            *arg;
-    int32_t          filename;
-    int              lineno;
-    chpl_task_list_p next;
+    size_t        num_tasks;
+    size_t        max_tasks;
+    size_t       *offsets;   // offsets[num_tasks] is the end of the data
+    c_sublocid_t *sublocs;   // execution sublocale of each task
+    char         *buf;
+    size_t        buf_size;
+    aligned_t     refs;
 };
 
+//
+// Tree spawning.  A list with more than treeSpawnLeafSize tasks is split
+// in half repeatedly, a spawner task being forked for each upper half,
+// until the remainder is small enough to fork directly.  The spawners
+// do the same with their ranges, so the tasks of a large coforall are
+// created by many workers in O(log n) steps instead of one by one by
+// the parent.
+//
+static const size_t treeSpawnLeafSize = 8;
+
+typedef struct {
+    chpl_task_list_p list;
+    size_t           lo;
+    size_t           hi;
+} tree_spawn_args_t;
+
+static void spawnTaskRange(chpl_task_list_p list, size_t lo, size_t hi);
+
+//
+// A deferred list with no tasks yet is emptyTaskList, so that nothing
+// is allocated for a cobegin or coforall run serially.  Once a list
+// holds taskListBatchSize tasks they are spawned and a new list is
+// started, so only the tasks added since are held back.
+//
+static struct chpl_task_list emptyTaskList;
+static const size_t taskListBatchSize = 1024;
+
+//
+// Stackless tasks.  Tasks added by chpl_task_addStacklessToTaskList()
+// run to completion once started, so rather than forking a qthread,
+// with a stack of its own, for each of them we queue their bundles.
+// Each shepherd has its own queue, which tasks added there go on, and
+// at most one runner task for it.  The runner takes tasks off that queue
+// and calls them one after another on its own stack, and when the queue
+// is empty it steals from the other shepherds' queues before it ends.
+// A runner yields now and then so that it doesn't hold up the other
+// tasks on its worker while the queues are being refilled.  This is off
+// unless CHPL_RT_STACKLESS_TASKS is set to a true value.
+//
+typedef struct stackless_task_s {
+    struct stackless_task_s *next;
+    // the task's argument bundle follows, at stacklessTaskArgOffset
+} stackless_task_t;
+
+#define stacklessTaskArgOffset ALIGN_UP(sizeof(stackless_task_t), 16)
+
+typedef union {
+    struct {
+        atomic_spinlock_t lock;
+        stackless_task_t *head;
+        stackless_task_t *tail;
+        chpl_bool         hasRunner;
+    } q;
+    char pad[64];                   // keep each queue on its own cache line
+} stackless_queue_t;
+
+static stackless_queue_t *stacklessQueues;
+static qthread_shepherd_id_t numStacklessQueues;
+
+static chpl_bool stacklessTasksEnabled = false;
+static const unsigned int stacklessRunnerYieldInterval = 64;
+
 static aligned_t next_task_id = 1;
 
 static pthread_t initer;
@@ -194,6 +268,13 @@ void chpl_task_yield(void)
 }
 
 // Sync variables
+//
+// A task waiting for a sync variable first spins and yields for a while
+// without holding the lock, in case the variable changes soon, and only
+// then blocks on the FEB that signals the change.  A stale signal left
+// over from an earlier change just sends it around the loop again, and
+// by then it has used up its backoff and blocks right away.
+//
 void chpl_sync_lock(chpl_sync_aux_t *s)
 {
     PROFILE_INCR(profile_sync_lock, 1);
@@ -212,13 +293,20 @@ void chpl_sync_waitFullAndLock(chpl_sync_aux_t *s,
                                int32_t          lineno,
                                int32_t         filename)
 {
+    uint32_t backoff = 0;
+
     PROFILE_INCR(profile_sync_waitFullAndLock, 1);
 
     chpl_sync_lock(s);
     while (s->is_full == 0) {
+        uint64_t diagsWait = chpl_task_diags_waitBegin();
         chpl_sync_unlock(s);
-        qthread_readFE(NULL, &(s->signal_full));
+        while (s->is_full == 0 && chpl_task_waitBackoff(&backoff))
+            ;
+        if (s->is_full == 0)
+            qthread_readFE(NULL, &(s->signal_full));
         chpl_sync_lock(s);
+        chpl_task_diags_waitEnd(diagsWait);
     }
 }
 
@@ -226,13 +314,20 @@ void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
                                 int32_t          lineno,
                                 int32_t         filename)
 {
+    uint32_t backoff = 0;
+
     PROFILE_INCR(profile_sync_waitEmptyAndLock, 1);
 
     chpl_sync_lock(s);
     while (s->is_full != 0) {
+        uint64_t diagsWait = chpl_task_diags_waitBegin();
         chpl_sync_unlock(s);
-        qthread_readFE(NULL, &(s->signal_empty));
+        while (s->is_full != 0 && chpl_task_waitBackoff(&backoff))
+            ;
+        if (s->is_full != 0)
+            qthread_readFE(NULL, &(s->signal_empty));
         chpl_sync_lock(s);
+        chpl_task_diags_waitEnd(diagsWait);
     }
 }
 
@@ -663,11 +758,19 @@ static void setupTasklocalStorage(void) {
 
 static void setupWorkStealing(void) {
     // In our experience the current work stealing implementation hurts
-    // performance, so disable it. Note that we don't override, so a user could
-    // try working stealing out by setting {QT,QTHREAD}_STEAL_RATIO. Also note
+    // performance, so disable it by default. Note that we don't override,
+    // so a user could try working stealing out by setting
+    // {QT,QTHREAD}_STEAL_RATIO, or just CHPL_RT_WORK_STEALING to get the
+    // Qthreads default ratio. When the topology comes from our runtime,
+    // victims are tried in order of how much hardware they share with the
+    // thief (same L2, then same L3 or NUMA domain, then anywhere). Also note
     // that not all schedulers support work stealing, but it doesn't hurt to
     // set this env var for those configs anyways.
-    chpl_qt_setenv("STEAL_RATIO", "0", 0);
+    if (chpl_env_rt_get_bool("WORK_STEALING", false)) {
+        chpl_qt_setenv("STEAL_RATIO", "8", 0);
+    } else {
+        chpl_qt_setenv("STEAL_RATIO", "0", 0);
+    }
 }
 
 static void setupSpinWaiting(void) {
@@ -685,9 +788,15 @@ static void setupAffinity(void) {
   }
 }
 
+static void noteSteal(void)
+{
+    chpl_task_diags_steal();
+}
+
 void chpl_task_init(void)
 {
     int32_t   commMaxThreads;
+    qthread_shepherd_id_t i;
 
     chpl_qthread_process_pthread = pthread_self();
     chpl_qthread_process_bundle.id = qthread_incr(&next_task_id, 1);
@@ -717,6 +826,19 @@ void chpl_task_init(void)
     // the number of threads qthreads creates beforehand
     assert(0 == commMaxThreads || qthread_num_workers() < commMaxThreads);
 
+    qthread_chpl_set_steal_hook(noteSteal);
+
+    stacklessTasksEnabled = chpl_env_rt_get_bool("STACKLESS_TASKS", false);
+    if (stacklessTasksEnabled) {
+        numStacklessQueues = qthread_num_shepherds();
+        stacklessQueues = chpl_mem_allocManyZero(numStacklessQueues,
+                                                 sizeof(stacklessQueues[0]),
+                                                 CHPL_RT_MD_TASK_LIST_DESC,
+                                                 0, 0);
+        for (i = 0; i < numStacklessQueues; i++)
+            atomic_init_spinlock_t(&stacklessQueues[i].q.lock);
+    }
+
     if (blockreport || taskreport) {
         if (signal(SIGINT, SIGINT_handler) == SIG_ERR) {
             perror("Could not register SIGINT handler");
@@ -757,9 +879,8 @@ static inline void wrap_callbacks(chpl_task_cb_event_kind_t event_kind,
 }
 
 
-static aligned_t chapel_wrapper(void *arg)
+static inline void runTask(chpl_qthread_tls_t *tls, void *arg)
 {
-    chpl_qthread_tls_t    *tls = chpl_qthread_get_tasklocal();
     chpl_task_bundle_t *bundle = chpl_argBundleTaskArgBundle(arg);
     chpl_qthread_tls_t      pv = {.bundle = bundle};
 
@@ -767,9 +888,79 @@ static aligned_t chapel_wrapper(void *arg)
 
     wrap_callbacks(chpl_task_cb_event_kind_begin, bundle);
 
+    chpl_task_diags_taskBegin(qthread_readstate(BUSYNESS) - 1);
     (bundle->requested_fn)(arg);
+    chpl_task_diags_taskEnd();
 
     wrap_callbacks(chpl_task_cb_event_kind_end, bundle);
+}
+
+static aligned_t chapel_wrapper(void *arg)
+{
+    runTask(chpl_qthread_get_tasklocal(), arg);
+    return 0;
+}
+
+//
+// Take the first task off a stackless queue.  When stealing, give up
+// rather than wait if the queue is busy.
+//
+static stackless_task_t *popStacklessTask(stackless_queue_t *queue,
+                                          chpl_bool steal)
+{
+    stackless_task_t *task;
+
+    if (!steal)
+        atomic_lock_spinlock_t(&queue->q.lock);
+    else if (!atomic_try_lock_spinlock_t(&queue->q.lock))
+        return NULL;
+
+    task = queue->q.head;
+    if (task != NULL) {
+        queue->q.head = task->next;
+        if (queue->q.head == NULL)
+            queue->q.tail = NULL;
+    }
+    atomic_unlock_spinlock_t(&queue->q.lock);
+
+    return task;
+}
+
+static aligned_t stackless_runner(void *arg)
+{
+    chpl_qthread_tls_t   *tls = chpl_qthread_get_tasklocal();
+    qthread_shepherd_id_t mine = (qthread_shepherd_id_t) (intptr_t) arg;
+    stackless_queue_t    *queue = &stacklessQueues[mine];
+    unsigned int          count = 0;
+
+    while (true) {
+        stackless_task_t     *task = popStacklessTask(queue, false);
+        qthread_shepherd_id_t i;
+
+        for (i = 1; task == NULL && i < numStacklessQueues; i++) {
+            task = popStacklessTask(&stacklessQueues[(mine + i)
+                                                     % numStacklessQueues],
+                                    true);
+        }
+
+        if (task == NULL) {
+            // only stop once nothing can have been added to our queue
+            atomic_lock_spinlock_t(&queue->q.lock);
+            if (queue->q.head == NULL) {
+                queue->q.hasRunner = false;
+                atomic_unlock_spinlock_t(&queue->q.lock);
+                break;
+            }
+            atomic_unlock_spinlock_t(&queue->q.lock);
+            continue;
+        }
+
+        runTask(tls, (char*) task + stacklessTaskArgOffset);
+        chpl_mem_free(task, 0, 0);
+
+        if (++count % stacklessRunnerYieldInterval == 0)
+            qthread_yield();
+    }
 
     return 0;
 }
@@ -830,6 +1021,101 @@ int chpl_task_createCommTask(chpl_fn_p fn,
                           NULL, comm_task_wrapper, &wrapper_info);
 }
 
+static inline void forkTask(void *arg, size_t arg_size,
+                            c_sublocid_t execution_subloc)
+{
+    if (execution_subloc == c_sublocid_any) {
+        qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
+    } else {
+        qthread_fork_copyargs_to(chapel_wrapper, arg, arg_size, NULL,
+                                 (qthread_shepherd_id_t) execution_subloc);
+    }
+}
+
+static void releaseTaskList(chpl_task_list_p list)
+{
+    if (qthread_incr(&list->refs, -1) == 1) {
+        chpl_mem_free(list->buf, 0, 0);
+        chpl_mem_free(list->sublocs, 0, 0);
+        chpl_mem_free(list->offsets, 0, 0);
+        chpl_mem_free(list, 0, 0);
+    }
+}
+
+static void appendToTaskList(void **task_list,
+                             void *arg, size_t arg_size,
+                             c_sublocid_t execution_subloc,
+                             int lineno, int32_t filename)
+{
+    chpl_task_list_p list = (chpl_task_list_p) *task_list;
+    size_t offset;
+
+    if (list == &emptyTaskList) {
+        list = chpl_mem_alloc(sizeof(*list), CHPL_RT_MD_TASK_LIST_DESC,
+                              lineno, filename);
+        *list = (struct chpl_task_list) { .refs = 1 };
+        *task_list = list;
+    }
+
+    if (list->num_tasks == list->max_tasks) {
+        list->max_tasks = (list->max_tasks == 0) ? 16 : 2 * list->max_tasks;
+        list->offsets = chpl_mem_realloc(list->offsets,
+                                         (list->max_tasks + 1)
+                                         * sizeof(list->offsets[0]),
+                                         CHPL_RT_MD_TASK_LIST_DESC,
+                                         lineno, filename);
+        list->sublocs = chpl_mem_realloc(list->sublocs,
+                                         list->max_tasks
+                                         * sizeof(list->sublocs[0]),
+                                         CHPL_RT_MD_TASK_LIST_DESC,
+                                         lineno, filename);
+        if (list->num_tasks == 0)
+            list->offsets[0] = 0;
+    }
+
+    // keep the bundles aligned as if each had been allocated separately
+    offset = list->offsets[list->num_tasks];
+    if (offset + arg_size > list->buf_size) {
+        list->buf_size = 2 * (offset + arg_size);
+        list->buf = chpl_mem_realloc(list->buf, list->buf_size,
+                                     CHPL_RT_MD_TASK_ARG,
+                                     lineno, filename);
+    }
+    memcpy(list->buf + offset, arg, arg_size);
+
+    list->sublocs[list->num_tasks] = execution_subloc;
+    list->num_tasks++;
+    list->offsets[list->num_tasks] = offset + ((arg_size + 15) & ~(size_t) 15);
+
+    if (list->num_tasks == taskListBatchSize) {
+        *task_list = &emptyTaskList;
+        spawnTaskRange(list, 0, list->num_tasks);
+        releaseTaskList(list);
+    }
+}
+
+static inline void setupTaskBundle(chpl_fn_int_t       fid,
+                                   chpl_task_bundle_t *arg,
+                                   c_sublocid_t        full_subloc,
+                                   int                 lineno,
+                                   int32_t             filename)
+{
+    *arg = (chpl_task_bundle_t)
+           { .kind            = CHPL_ARG_BUNDLE_KIND_TASK,
+             .is_executeOn    = false,
+             .lineno          = lineno,
+             .filename        = filename,
+             .requestedSubloc = full_subloc,
+             .requested_fid   = fid,
+             .requested_fn    = chpl_ftable[fid],
+             .id              = chpl_nullTaskID,
+             .infoChapel      = arg->infoChapel, // retain; set by caller
+           };
+
+    wrap_callbacks(chpl_task_cb_event_kind_create, arg);
+    chpl_task_diags_spawn();
+}
+
 void chpl_task_addToTaskList(chpl_fn_int_t       fid,
                              chpl_task_bundle_t *arg,
                              size_t              arg_size,
@@ -840,8 +1126,6 @@ void chpl_task_addToTaskList(chpl_fn_int_t       fid,
                              int                 lineno,
                              int32_t             filename)
 {
-    chpl_fn_p requested_fn = chpl_ftable[fid];
-
     assert(isActualSublocID(full_subloc) || full_subloc == c_sublocid_any);
 
     PROFILE_INCR(profile_task_addToTaskList,1);
@@ -849,31 +1133,128 @@ void chpl_task_addToTaskList(chpl_fn_int_t       fid,
     c_sublocid_t execution_subloc =
       chpl_localeModel_sublocToExecutionSubloc(full_subloc);
 
-    *arg = (chpl_task_bundle_t)
-           { .kind            = CHPL_ARG_BUNDLE_KIND_TASK,
-             .is_executeOn    = false,
-             .lineno          = lineno,
-             .filename        = filename,
-             .requestedSubloc = full_subloc,
-             .requested_fid   = fid,
-             .requested_fn    = requested_fn,
-             .id              = chpl_nullTaskID,
-             .infoChapel      = arg->infoChapel, // retain; set by caller
-           };
+    setupTaskBundle(fid, arg, full_subloc, lineno, filename);
 
-    wrap_callbacks(chpl_task_cb_event_kind_create, arg);
+    //
+    // If the parent of a cobegin or coforall has said it will not block
+    // before it calls chpl_task_executeTasksInList(), collect its tasks
+    // to spawn them all at once there.  Otherwise, as for begin tasks and
+    // lists that live on another node, fork the task right away.
+    //
+    if (!is_begin_stmt && task_list != NULL &&
+        task_list_locale == chpl_nodeID && *task_list != NULL) {
+        appendToTaskList(task_list, arg, arg_size, execution_subloc,
+                         lineno, filename);
+        return;
+    }
 
-    if (execution_subloc == c_sublocid_any) {
-        qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
-    } else {
-        qthread_fork_copyargs_to(chapel_wrapper, arg, arg_size, NULL,
-                                 (qthread_shepherd_id_t) execution_subloc);
+    forkTask(arg, arg_size, execution_subloc);
+}
+
+void chpl_task_addStacklessToTaskList(chpl_fn_int_t       fid,
+                                      chpl_task_bundle_t *arg,
+                                      size_t              arg_size,
+                                      c_sublocid_t        full_subloc,
+                                      void              **task_list,
+                                      int32_t             task_list_locale,
+                                      chpl_bool           is_begin_stmt,
+                                      int                 lineno,
+                                      int32_t             filename)
+{
+    stackless_task_t     *task;
+    qthread_shepherd_id_t shep;
+    stackless_queue_t    *queue;
+    chpl_bool             needRunner = false;
+
+    // tasks for a particular sublocale need a qthread placed there
+    if (!stacklessTasksEnabled || full_subloc != c_sublocid_any) {
+        chpl_task_addToTaskList(fid, arg, arg_size, full_subloc, task_list,
+                                task_list_locale, is_begin_stmt,
+                                lineno, filename);
+        return;
+    }
+
+    PROFILE_INCR(profile_task_addToTaskList,1);
+
+    setupTaskBundle(fid, arg, full_subloc, lineno, filename);
+
+    task = chpl_mem_alloc(stacklessTaskArgOffset + arg_size,
+                          CHPL_RT_MD_TASK_ARG, lineno, filename);
+    task->next = NULL;
+    memcpy((char*) task + stacklessTaskArgOffset, arg, arg_size);
+
+    // callers that aren't qthreads use the first shepherd's queue
+    shep = qthread_shep();
+    if (shep >= numStacklessQueues)
+        shep = 0;
+    queue = &stacklessQueues[shep];
+
+    atomic_lock_spinlock_t(&queue->q.lock);
+    if (queue->q.tail == NULL)
+        queue->q.head = task;
+    else
+        queue->q.tail->next = task;
+    queue->q.tail = task;
+    if (!queue->q.hasRunner) {
+        queue->q.hasRunner = true;
+        needRunner = true;
+    }
+    atomic_unlock_spinlock_t(&queue->q.lock);
+
+    if (needRunner)
+        qthread_fork_to(stackless_runner, (void*) (intptr_t) shep, NULL, shep);
+}
+
+static aligned_t tree_spawn_wrapper(void *arg)
+{
+    tree_spawn_args_t *rarg = arg;
+
+    spawnTaskRange(rarg->list, rarg->lo, rarg->hi);
+    releaseTaskList(rarg->list);
+    return 0;
+}
+
+static void spawnTaskRange(chpl_task_list_p list, size_t lo, size_t hi)
+{
+    size_t i;
+
+    while (hi - lo > treeSpawnLeafSize) {
+        tree_spawn_args_t args = { .list = list,
+                                   .lo = lo + (hi - lo) / 2,
+                                   .hi = hi };
+
+        (void) qthread_incr(&list->refs, 1);
+        qthread_fork_copyargs(tree_spawn_wrapper, &args, sizeof(args), NULL);
+        hi = args.lo;
     }
+
+    for (i = lo; i < hi; i++) {
+        forkTask(list->buf + list->offsets[i],
+                 list->offsets[i + 1] - list->offsets[i],
+                 list->sublocs[i]);
+    }
+}
+
+void chpl_task_deferTasksInList(void **task_list)
+{
+    if (*task_list == NULL)
+        *task_list = &emptyTaskList;
 }
 
 void chpl_task_executeTasksInList(void **task_list)
 {
+    chpl_task_list_p list = (chpl_task_list_p) *task_list;
+
     PROFILE_INCR(profile_task_executeTasksInList,1);
+
+    if (list == NULL)
+        return;
+    *task_list = NULL;
+    if (list == &emptyTaskList)
+        return;
+
+    spawnTaskRange(list, 0, list->num_tasks);
+    releaseTaskList(list);
 }
 
 static inline void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
@@ -898,6 +1279,7 @@ static inline void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
               };
 
     wrap_callbacks(chpl_task_cb_event_kind_create, bundle);
+    chpl_task_diags_spawn();
 
     if (execution_subloc < 0) {
         qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
@@ -26,6 +26,7 @@
 #include "chpl-align.h"
 #include "chpl-env.h"
 #include "chpl-env-gen.h"
+#include "chpl-mem-array.h"
 #include "chplcgfns.h"
 #include "chplsys.h"
 #include "chpl-topo.h"
@@ -64,7 +65,12 @@ static int topoDepth;
 static int numaLevel;
 static int numNumaDomains;
 
+static int numCacheLevels;
+static chpl_topo_cacheInfo_t cacheInfo[CHPL_TOPO_MAX_CACHE_LEVELS];
 
+
+static void getCacheInfoFromSys(void);
+static void getCacheInfoFromHwloc(void);
 static hwloc_obj_t getNumaObj(c_sublocid_t);
 static void alignAddrSize(void*, size_t, chpl_bool,
                           size_t*, unsigned char**, size_t*);
@@ -94,14 +100,17 @@ void chpl_topo_init(void) {
   //
   // We only load hwloc topology information in configurations where
   // the locale model is other than "flat" or the tasking is based on
-  // Qthreads (which will use the topology we load).  We don't use
-  // it otherwise (so far) because loading it is somewhat expensive.
+  // Qthreads (which will use the topology we load), or when the array
+  // memory policy wants to place memory across NUMA domains.  We don't
+  // use it otherwise (so far) because loading it is somewhat expensive.
   //
   if (strcmp(CHPL_LOCALE_MODEL, "flat") != 0
-      || strcmp(CHPL_TASKS, "qthreads") == 0) {
+      || strcmp(CHPL_TASKS, "qthreads") == 0
+      || chpl_mem_array_policy_needsTopo()) {
     haveTopology = true;
   } else {
     haveTopology = false;
+    getCacheInfoFromSys();
     return;
   }
 
@@ -190,6 +199,11 @@ void chpl_topo_init(void) {
     numNumaDomains =
       hwloc_get_nbobjs_inside_cpuset_by_depth(topology, cpusetAll, numaLevel);
   }
+
+  //
+  // What do the caches look like?
+  //
+  getCacheInfoFromHwloc();
 }
 
 
@@ -313,6 +327,119 @@ int chpl_topo_getNumNumaDomains(void) {
 }
 
 
+//
+// What does the data cache hierarchy look like?
+//
+int chpl_topo_getNumCacheLevels(void) {
+  return numCacheLevels;
+}
+
+
+void chpl_topo_getCacheInfo(int level, chpl_topo_cacheInfo_t* info) {
+  if (level >= 1 && level <= numCacheLevels) {
+    *info = cacheInfo[level - 1];
+  } else {
+    memset(info, 0, sizeof(*info));
+  }
+}
+
+
+//
+// Without a loaded topology, ask the OS about the caches.
+//
+static
+void getCacheInfoFromSys(void) {
+  numCacheLevels = 0;
+  for (int level = 1; level <= CHPL_TOPO_MAX_CACHE_LEVELS; level++) {
+    chpl_topo_cacheInfo_t* ci = &cacheInfo[level - 1];
+    if (!chpl_sys_getCacheInfo(level, &ci->size, &ci->lineSize,
+                               &ci->associativity, &ci->numSharingPUs)) {
+      break;
+    }
+    numCacheLevels = level;
+  }
+}
+
+
+//
+// With a topology, take the cache info from the first data (or
+// unified) cache object at each level.  The number of PUs in that
+// object's cpuset tells us how many PUs share it.
+//
+static
+void getCacheInfoFromHwloc(void) {
+  numCacheLevels = 0;
+  for (int level = 1; level <= CHPL_TOPO_MAX_CACHE_LEVELS; level++) {
+    int depth = hwloc_get_cache_type_depth(topology, level,
+                                           HWLOC_OBJ_CACHE_DATA);
+    if (depth < 0) {
+      depth = hwloc_get_cache_type_depth(topology, level,
+                                         HWLOC_OBJ_CACHE_UNIFIED);
+    }
+    if (depth < 0) {
+      break;
+    }
+
+    hwloc_obj_t obj = hwloc_get_obj_by_depth(topology, depth, 0);
+    if (obj == NULL || obj->attr == NULL) {
+      break;
+    }
+
+    chpl_topo_cacheInfo_t* ci = &cacheInfo[level - 1];
+    ci->size = (size_t) obj->attr->cache.size;
+    ci->lineSize = (size_t) obj->attr->cache.linesize;
+    ci->associativity = obj->attr->cache.associativity;
+    ci->numSharingPUs = (obj->cpuset == NULL)
+                        ? 0
+                        : hwloc_bitmap_weight(obj->cpuset);
+    numCacheLevels = level;
+  }
+
+  //
+  // If hwloc didn't find any caches, the OS might know better.
+  //
+  if (numCacheLevels == 0) {
+    getCacheInfoFromSys();
+  }
+}
+
+
+chpl_topo_puDistance_t chpl_topo_getPUDistance(int pu1, int pu2) {
+  hwloc_obj_t obj1, obj2, ancestor, cache;
+
+  if (pu1 == pu2) {
+    return chpl_topo_pu_same;
+  }
+
+  if (!haveTopology
+      || (obj1 = hwloc_get_pu_obj_by_os_index(topology, pu1)) == NULL
+      || (obj2 = hwloc_get_pu_obj_by_os_index(topology, pu2)) == NULL) {
+    return chpl_topo_pu_remote;
+  }
+
+  //
+  // The closest cache covering both PUs tells us how much they share.
+  // Without one, being in the same NUMA domain counts the same as
+  // sharing a last-level cache.
+  //
+  ancestor = hwloc_get_common_ancestor_obj(topology, obj1, obj2);
+  if ((cache = hwloc_get_cache_covering_cpuset(topology, ancestor->cpuset))
+      != NULL) {
+    return (cache->attr->cache.depth <= 2)
+           ? chpl_topo_pu_sharesL2
+           : chpl_topo_pu_sharesL3;
+  }
+
+  if (hwloc_get_next_obj_covering_cpuset_by_type(topology, ancestor->cpuset,
+                                                 HWLOC_OBJ_NUMANODE, NULL)
+      != NULL) {
+    return chpl_topo_pu_sharesL3;
+  }
+
+  return chpl_topo_pu_remote;
+}
+
+
 void chpl_topo_setThreadLocality(c_sublocid_t subloc) {
   hwloc_cpuset_t cpuset;
   int flags;
@@ -433,6 +560,50 @@ void chpl_topo_setMemSubchunkLocality(void* p, size_t size,
 }
 
 
+chpl_bool chpl_topo_interleaveMemLocality(void* p, size_t size,
+                                          chpl_bool onlyInside) {
+  size_t pgSize;
+  unsigned char* pPgLo;
+  size_t nPages;
+  int flags;
+
+  _DBG_P("chpl_topo_interleaveMemLocality(%p, %#zx, onlyIn=%s)\n",
+         p, size, (onlyInside ? "T" : "F"));
+
+  if (!haveTopology
+      || numNumaDomains <= 1
+      || !topoSupport->membind->set_area_membind
+      || !topoSupport->membind->interleave_membind
+      || !do_set_area_membind) {
+    return false;
+  }
+
+  alignAddrSize(p, size, onlyInside, &pgSize, &pPgLo, &nPages);
+
+  _DBG_P("    interleave %p, %#zx bytes (%#zx pages)\n",
+         pPgLo, nPages * pgSize, nPages);
+
+  if (nPages == 0)
+    return false;
+
+  //
+  // Unlike the locality-setting functions above this is a placement
+  // preference rather than a requirement, so don't insist on it.
+  //
+  flags = HWLOC_MEMBIND_MIGRATE;
+  if (hwloc_set_area_membind_nodeset(topology, pPgLo, nPages * pgSize,
+                                     hwloc_get_root_obj(topology)->nodeset,
+                                     HWLOC_MEMBIND_INTERLEAVE, flags)
+      != 0) {
+    _DBG_P("    hwloc_set_area_membind_nodeset() failed: %s\n",
+           strerror(errno));
+    return false;
+  }
+
+  return true;
+}
+
+
 void chpl_topo_touchMemFromSubloc(void* p, size_t size, chpl_bool onlyInside,
                                   c_sublocid_t subloc) {
   size_t pgSize;
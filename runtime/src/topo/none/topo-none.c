@@ -29,9 +29,27 @@
 #include "error.h"
 
 #include <stdint.h>
-
-
-void chpl_topo_init(void) { }
+#include <string.h>
+
+
+static int numCacheLevels;
+static chpl_topo_cacheInfo_t cacheInfo[CHPL_TOPO_MAX_CACHE_LEVELS];
+
+
+void chpl_topo_init(void) {
+  //
+  // Without a topology library, the OS is our only source of cache info.
+  //
+  numCacheLevels = 0;
+  for (int level = 1; level <= CHPL_TOPO_MAX_CACHE_LEVELS; level++) {
+    chpl_topo_cacheInfo_t* ci = &cacheInfo[level - 1];
+    if (!chpl_sys_getCacheInfo(level, &ci->size, &ci->lineSize,
+                               &ci->associativity, &ci->numSharingPUs)) {
+      break;
+    }
+    numCacheLevels = level;
+  }
+}
 
 
 void chpl_topo_exit(void) { }
@@ -57,6 +75,25 @@ int chpl_topo_getNumNumaDomains(void) {
 }
 
 
+int chpl_topo_getNumCacheLevels(void) {
+  return numCacheLevels;
+}
+
+
+void chpl_topo_getCacheInfo(int level, chpl_topo_cacheInfo_t* info) {
+  if (level >= 1 && level <= numCacheLevels) {
+    *info = cacheInfo[level - 1];
+  } else {
+    memset(info, 0, sizeof(*info));
+  }
+}
+
+
+chpl_topo_puDistance_t chpl_topo_getPUDistance(int pu1, int pu2) {
+  return (pu1 == pu2) ? chpl_topo_pu_same : chpl_topo_pu_remote;
+}
+
+
 void chpl_topo_setThreadLocality(c_sublocid_t subloc) { }
 
 
@@ -74,6 +111,12 @@ void chpl_topo_setMemSubchunkLocality(void* p, size_t size,
                                       size_t* subchunkSizes) { }
 
 
+chpl_bool chpl_topo_interleaveMemLocality(void* p, size_t size,
+                                          chpl_bool onlyInside) {
+  return false;
+}
+
+
 void chpl_topo_touchMemFromSubloc(void* p, size_t size, chpl_bool onlyInside,
                                   c_sublocid_t subloc) { }
 
@@ -0,0 +1,30 @@
+// Record VisualDebug data in the binary format.  The .prediff converts it
+// with tools/chplvis/vdebug2trace.py and checks the trace it produces.
+
+use VisualDebug;
+
+config const n = 100;
+
+var A: [1..n] int;
+
+startVdebug("binaryTrace");
+
+tagVdebug("tasks");
+coforall i in 1..4 do
+  A[i] = i;
+
+tagVdebug("on");
+for loc in Locales do on loc {
+  var x = A[n/2];
+  A[here.id+1] += x;
+}
+
+pauseVdebug();
+A = 1;
+
+tagVdebug("again");
+forall a in A do a += 1;
+
+stopVdebug();
+
+writeln(+ reduce A);
@@ -0,0 +1,84 @@
+use StencilDist;
+
+config const n = 12;
+
+proc value(idx, gen) {
+  const (i, j) = idx;
+  return gen*10000 + i*100 + j;
+}
+
+// Check that every cached element on every locale holds the value written in
+// generation 'newGen' if an update limited by 'depth', 'low' and 'high'
+// should have refreshed it, or the value from 'oldGen' otherwise.
+proc check(A: [], oldGen, newGen, depth, low, high, periodic) {
+  for loc in Locales do on loc {
+    const Local = A.localSubdomain();
+    const Cached = Local.expand(A._value.dom.fluff);
+    for idx in Cached {
+      const inside = {1..n, 1..n}.contains(idx);
+      if Local.contains(idx) || !(periodic || inside) then continue;
+
+      var selected = true, src = idx;
+      for param d in 0..1 {
+        const r = Local.dim(d);
+        if idx(d) < r.low then
+          selected &&= low(d) && r.low - idx(d) <= depth(d);
+        else if idx(d) > r.high then
+          selected &&= high(d) && idx(d) - r.high <= depth(d);
+        if src(d) < 1 then src(d) += n;
+        if src(d) > n then src(d) -= n;
+      }
+      const expected = value(src, if selected then newGen else oldGen);
+      if A[idx] != expected {
+        writeln("Mismatch on ", here, " at ", idx, ": ", A[idx], " != ",
+                expected);
+        halt();
+      }
+    }
+  }
+}
+
+proc test(periodic: bool) {
+  const D = {1..n, 1..n};
+  const Space = D dmapped Stencil(D, fluff=(2,2), periodic=periodic);
+  var A: [Space] int;
+  const all = (true, true);
+
+  proc reset(gen) {
+    forall idx in Space do A[idx] = value(idx, gen);
+    A.updateFluff();
+    check(A, gen, gen, (2,2), all, all, periodic);
+    forall idx in Space do A[idx] = value(idx, gen+1);
+  }
+
+  // Only the first layer above each block in the first dimension.
+  reset(1);
+  A.updateFluff(depth=(1,0), low=(false,false));
+  check(A, 1, 2, (1,0), (false,false), all, periodic);
+
+  // One layer in both dimensions except on the low side of the second,
+  // overlapping interior work with the exchange.
+  reset(3);
+  A.startFluffUpdate(depth=(1,1), low=(true,false));
+  var sum = 0;
+  forall a in A with (+ reduce sum) do sum += a % 10000;
+  A.waitFluffUpdate();
+  check(A, 3, 4, (1,1), (true,false), all, periodic);
+
+  // The full depth on the high side only.
+  reset(5);
+  A.startFluffUpdate(low=(false,false));
+  A.waitFluffUpdate();
+  check(A, 5, 6, (2,2), (false,false), all, periodic);
+
+  // A full split-phase update.
+  reset(7);
+  A.startFluffUpdate();
+  A.waitFluffUpdate();
+  check(A, 7, 8, (2,2), all, all, periodic);
+
+  writeln("periodic=", periodic, ": sum=", sum);
+}
+
+test(false);
+test(true);
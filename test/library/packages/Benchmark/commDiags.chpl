@@ -0,0 +1,18 @@
+use Benchmark;
+
+// Each iteration moves to the last locale and increments a counter that
+// lives on locale 0, so the communication per iteration is exact.
+
+proc benchRemoteIncrement(b: borrowed Bench) {
+  var count = 0;
+  for 1..b.iterations do
+    on Locales[numLocales-1] do count += 1;
+  b.keep(count);
+}
+
+const r = runBenchmark("remoteIncrement", benchRemoteIncrement);
+writeln("on-statements per iteration = ",
+        r.commPerIteration("execute_on") +
+        r.commPerIteration("execute_on_fast"));
+writeln("get per iteration = ", r.commPerIteration("get"));
+writeln("put per iteration = ", r.commPerIteration("put"));
@@ -0,0 +1,15 @@
+use Benchmark;
+
+// With a fixed iteration count there is no calibration, so the benchmark
+// is called once per warm-up run and once per timed run.
+
+var calls, total: int;
+
+proc benchCount(b: borrowed Bench) {
+  calls += 1;
+  for 1..b.iterations do total += 1;
+}
+
+const r = runBenchmark("count", benchCount);
+writeln("calls = ", calls, ", iterations = ", total);
+writeln("runs = ", r.runs, ", iterations per run = ", r.iterations);
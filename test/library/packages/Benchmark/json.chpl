@@ -0,0 +1,18 @@
+use Benchmark;
+
+config const n = 100;
+
+proc benchFill(b: borrowed Bench) {
+  var A: [1..n] real;
+  b.setBytes(n * numBytes(real));
+  for i in 1..b.iterations do
+    A = i;
+  b.keep(A[n]);
+}
+
+proc benchSkipped(b: borrowed Bench) {
+  halt("filtered out");
+}
+
+const results = runBenchmarks(benchFill, benchSkipped);
+writeln(results.size, " benchmark run");
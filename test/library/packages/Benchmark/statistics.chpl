@@ -0,0 +1,45 @@
+use Benchmark;
+
+// The timings vary from run to run, so check the invariants of the
+// reported statistics rather than their values.
+
+config const n = 1000;
+
+proc benchSum(b: borrowed Bench) {
+  var A: [1..n] int = 1;
+  b.setBytes(n * numBytes(int));
+  b.resetTimer();
+  for 1..b.iterations do
+    b.keep(+ reduce A);
+}
+
+proc benchPaused(b: borrowed Bench) {
+  for 1..b.iterations {
+    b.stopTimer();
+    var A: [1..n] int = 2;
+    b.startTimer();
+    b.keep(A[1]);
+  }
+}
+
+proc check(r: BenchResult) {
+  writeln(r.name, ": calibrated = ", r.iterations > 1, ", runs = ", r.runs);
+  assert(r.min <= r.p90 && r.p90 <= r.p99 && r.p99 <= r.max);
+  assert(r.min <= r.median && r.median <= r.max);
+  assert(r.min <= r.mean && r.mean <= r.max);
+  assert(r.stddev >= 0.0);
+  assert(!r.hasComm && !r.hasMemory);
+  for s in r.samples do assert(s > 0.0);
+}
+
+const sum = runBenchmark("sum", benchSum);
+check(sum);
+writeln("bytesPerIteration = ", sum.bytesPerIter);
+writeln("throughput > 0: ", sum.bytesPerSecond() > 0.0);
+
+check(runBenchmark("paused", benchPaused));
+
+// Percentiles interpolate linearly between neighboring sorted samples.
+var s = [1.0, 2.0, 3.0, 4.0, 5.0];
+writeln(percentile(s, 0), " ", percentile(s, 50), " ", percentile(s, 90),
+        " ", percentile(s, 100));
@@ -0,0 +1,57 @@
+use DistributedBag;
+
+config const nElems = 10000;
+config const depth = 10;
+
+// Place all of the work on a single node up front; the other nodes have to
+// steal to get any of it, and every element must be removed exactly once.
+{
+  var bag = new DistBag(int);
+  writeln(bag.addBulk(1..nElems));
+
+  var removed : [1..nElems] atomic int;
+  var nRemoved : atomic int;
+  coforall loc in Locales do on loc {
+    coforall tid in 0..#here.maxTaskPar {
+      while true {
+        const elts = bag.removeBulk(16);
+        if elts.size == 0 then break;
+        for elt in elts do removed[elt].add(1);
+        nRemoved.add(elts.size);
+      }
+    }
+  }
+
+  writeln(nRemoved.read());
+  writeln(&& reduce [r in removed] r.read() == 1);
+  writeln(bag.getSize());
+}
+
+// Use the bag as the work pool of an irregular search: count the nodes of a
+// binary tree that is only ever expanded from the node holding its root.
+{
+  var bag = new DistBag(int);
+  bag.add(0);
+
+  const nNodes = 2**(depth+1) - 1;
+  var nVisited : atomic int;
+  coforall loc in Locales do on loc {
+    coforall tid in 0..#here.maxTaskPar {
+      while nVisited.read() < nNodes {
+        const nodes = bag.removeBulk(8);
+        if nodes.size == 0 {
+          chpl_task_yield();
+          continue;
+        }
+
+        for level in nodes {
+          if level < depth then bag.addBulk([level+1, level+1]);
+        }
+        nVisited.add(nodes.size);
+      }
+    }
+  }
+
+  writeln(nVisited.read() == nNodes);
+  writeln(bag.getSize());
+}
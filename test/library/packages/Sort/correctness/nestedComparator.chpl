@@ -0,0 +1,23 @@
+use Sort;
+
+// A comparator declared inside a function that refers to the function's
+// locals must work with the sorts that call it from parallel tasks.
+
+config const n = 20000;
+
+proc rank(A: [] int) {
+  var weight: [0..#7] int = [6, 0, 5, 1, 4, 2, 3];
+  record WeightComparator { }
+  proc WeightComparator.compare(a: int, b: int) {
+    const wa = weight[a % 7], wb = weight[b % 7];
+    return if wa != wb then wa - wb else a - b;
+  }
+  var ranked = A;
+  sort(ranked, comparator=new WeightComparator());
+  const sorted = isSorted(ranked, comparator=new WeightComparator());
+  const topk = topK(A, 3, comparator=new WeightComparator());
+  return (sorted, ranked[ranked.domain.low..#3], topk);
+}
+
+var A = [i in 1..n] (i * 7919) % n;
+writeln(rank(A));
@@ -0,0 +1,82 @@
+use Sort;
+use Random;
+use BlockDist;
+
+config const n = 300000;
+config const k = 1000;
+config const seed = 31;
+
+record AbsCompare {
+  proc compare(a: int, b: int) {
+    return abs(a) - abs(b);
+  }
+}
+
+// Elements that compare equal may come out in any order.
+proc check(name, A, Expect, comparator) {
+  var same = A.size == Expect.size;
+  for (a, e) in zip(A, Expect) do
+    same &&= chpl_compare(a, e, comparator) == 0;
+  writeln(name, ": ", same);
+}
+
+proc test(comparator) {
+  var A: [1..n] int;
+  fillRandom(A, seed=seed);
+  A = A % 10000;
+  var Sorted = A;
+  sort(Sorted, comparator);
+
+  var P = A;
+  partialSort(P, k, comparator);
+  check("partialSort", P[1..k], Sorted[1..k], comparator);
+
+  var S = A;
+  const mid = (n+1)/2;
+  selectKth(S, mid, comparator);
+  var ok = chpl_compare(S[mid], Sorted[mid], comparator) == 0;
+  for i in 1..<mid do
+    ok &&= chpl_compare(S[i], S[mid], comparator) <= 0;
+  for i in mid+1..n do
+    ok &&= chpl_compare(S[i], S[mid], comparator) >= 0;
+  writeln("selectKth: ", ok);
+
+  const T = topK(A, k, comparator);
+  check("topK", T, Sorted[1..k], comparator);
+
+  var B = newBlockArr(1..n, int);
+  B = A;
+  const TB = topK(B, k, comparator);
+  check("topK distributed", TB, Sorted[1..k], comparator);
+
+  const TAll = topK(A, n+1, comparator);
+  check("topK all", TAll, Sorted, comparator);
+
+  var Q = A;
+  QuickSort.quickSort(Q, comparator=comparator);
+  check("quickSort", Q, Sorted, comparator);
+}
+
+test(defaultComparator);
+test(new ReverseComparator());
+test(new AbsCompare());
+
+// strided arrays and small sizes
+{
+  var A: [1..20 by 2] int = [9, 3, 7, 1, 5, 8, 2, 6, 4, 0];
+  var P = A;
+  partialSort(P, 3);
+  writeln(P[1..5 by 2]);
+  selectKth(A, 10);
+  writeln(A[19]);
+  writeln(topK(A, 4));
+}
+
+// all equal elements
+{
+  var A: [0..#n] int = 7;
+  QuickSort.quickSort(A);
+  partialSort(A, k);
+  selectKth(A, n/3);
+  writeln(isSorted(A), " ", topK(A, 2));
+}
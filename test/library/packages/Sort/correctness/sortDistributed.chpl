@@ -0,0 +1,62 @@
+use Sort;
+use BlockDist;
+use Random;
+
+config const n = 100000;
+config const seed = 17;
+
+record KeyComparator {
+  proc key(x: (int, int)) {
+    return x(0);
+  }
+}
+
+proc isStable(A) {
+  for i in A.domain.low+1..A.domain.high {
+    if A[i-1](0) == A[i](0) && A[i-1](1) > A[i](1) then
+      return false;
+  }
+  return true;
+}
+
+proc testInts(n) {
+  var A = newBlockArr(0..#n, int);
+  fillRandom(A, seed=seed);
+  A = abs(A) % 1000;
+  var Expect: [0..#n] int = A;
+  sort(Expect);
+  sort(A);
+  writeln("ints, n=", n, ": sorted? ", isSorted(A),
+          ", matches local sort? ", && reduce (A == Expect));
+}
+
+proc testStable(n) {
+  var A = newBlockArr(1..n, (int, int));
+  forall i in A.domain do
+    A[i] = ((i * 7919) % 37, i);
+  sort(A, new KeyComparator(), stable=true);
+  writeln("stable tuples, n=", n, ": sorted? ",
+          isSorted(A, new KeyComparator()), ", stable? ", isStable(A));
+
+  var L: [1..n] (int, int);
+  forall i in L.domain do
+    L[i] = ((i * 7919) % 37, i);
+  sort(L, new KeyComparator(), stable=true);
+  writeln("stable local tuples, n=", n, ": sorted? ",
+          isSorted(L, new KeyComparator()), ", stable? ", isStable(L),
+          ", matches distributed sort? ", && reduce (A == L));
+}
+
+proc testStrings(n) {
+  var A = newBlockArr(1..n, string);
+  forall i in A.domain do
+    A[i] = ((i * 31) % 101):string;
+  sort(A);
+  writeln("strings, n=", n, ": sorted? ", isSorted(A));
+}
+
+for size in [n, 3, 2] {
+  testInts(size);
+  testStable(size);
+  testStrings(size);
+}
@@ -0,0 +1,40 @@
+use CommDiagnostics;
+
+var x: int;
+var t: 64*int;
+
+proc showProfile() {
+  for e in getCommProfile() do
+    if e.op == "get" || e.op == "put" then
+      writeln((e.op, e.srcLocale, e.dstLocale, e.file, e.line, e.count, e.numBytes),
+              " ", e.sizeBins);
+}
+
+proc showTimed() {
+  for e in getCommProfile() do
+    if e.op == "get" || e.op == "put" then
+      writeln((e.op, e.line), " timed all: ", e.timedCount == e.count,
+              ", max >= avg: ", e.maxLatencyNs * e.timedCount >= e.latencyNs);
+}
+
+on Locales[numLocales-1] {
+  resetCommProfile();
+  startCommProfile();
+  for 1..10 do
+    x += 1;
+  var u = t;
+  t = u;
+  stopCommProfile();
+}
+showProfile();
+writeln();
+
+resetCommProfile();
+startCommProfile(latency=true);
+on Locales[numLocales-1] {
+  for 1..5 do
+    x += 1;
+}
+stopCommProfile();
+showTimed();
+writeln(x);
@@ -0,0 +1,41 @@
+use TaskDiagnostics, Time;
+
+config const n = 10;
+
+var s$: sync int;
+
+resetTaskDiagnostics();
+startTaskDiagnostics();
+
+coforall i in 1..n { }
+
+// the main task should block here until the begin fills s$
+begin {
+  sleep(0.1);
+  s$.writeEF(1);
+}
+s$.readFE();
+
+stopTaskDiagnostics();
+
+const td = getTaskDiagnosticsHere();
+writeln("spawned >= n: ", td.tasks_spawned >= n);
+writeln("run >= n: ", td.tasks_run >= n);
+writeln("sync waits: ", td.sync_waits >= 1);
+writeln("wait time: ", td.sync_wait_ns > 0);
+
+var spawned, run: uint;
+for w in getWorkerTaskDiagnosticsHere() {
+  spawned += w.tasks_spawned;
+  run += w.tasks_run;
+}
+writeln("workers sum to total: ", spawned == td.tasks_spawned &&
+                                  run == td.tasks_run);
+
+// nothing should be counted while stopped
+coforall i in 1..n { }
+writeln("stopped: ", getTaskDiagnosticsHere().tasks_spawned ==
+                     td.tasks_spawned);
+
+resetTaskDiagnostics();
+writeln("reset: ", getTaskDiagnosticsHere().tasks_spawned == 0);
@@ -0,0 +1,33 @@
+// The actual values depend on the machine, so just check that what we
+// get back is self-consistent.
+proc isPow2(x: int) return x > 0 && (x & (x - 1)) == 0;
+
+for loc in Locales do on loc {
+  const n = here.numCacheLevels;
+  writeln("levels in range: ", n >= 0 && n <= 5);
+
+  var prevSize = 0;
+  for level in 1..n {
+    const size = here.cacheSize(level),
+          lineSize = here.cacheLineSize(level),
+          assoc = here.cacheAssociativity(level),
+          sharers = here.numPUsSharingCache(level);
+    if size <= 0 then
+      writeln("level ", level, ": bad size ", size);
+    if size < prevSize then
+      writeln("level ", level, ": smaller than level ", level-1);
+    if lineSize != 0 && !isPow2(lineSize) then
+      writeln("level ", level, ": bad line size ", lineSize);
+    if assoc < -1 then
+      writeln("level ", level, ": bad associativity ", assoc);
+    if sharers < 0 || sharers > here.numPUs(logical=true, accessible=false) then
+      writeln("level ", level, ": bad sharing count ", sharers);
+    prevSize = size;
+  }
+
+  // out-of-range levels report nothing
+  writeln("beyond last level: ",
+          here.cacheSize(n+1), " ", here.cacheLineSize(n+1), " ",
+          here.cacheAssociativity(n+1), " ", here.numPUsSharingCache(n+1));
+  writeln("level 0: ", here.cacheSize(0));
+}
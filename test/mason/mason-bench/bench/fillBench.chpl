@@ -0,0 +1,12 @@
+use Benchmark;
+use benchModule;
+
+proc benchFill(b: borrowed Bench) {
+  var A: [1..1000] int;
+  b.setBytes(1000 * numBytes(int));
+  for i in 1..b.iterations do
+    fill(A, i);
+  b.keep(A[1]);
+}
+
+runBenchmarks(benchFill);
@@ -0,0 +1,8 @@
+use MasonBench;
+use FileSystem;
+
+proc main() {
+  const args = ["mason", "bench", "--benchIterations=2", "--benchRuns=3"];
+  masonBench(args);
+  writeln("JSON results: ", isFile("target/bench/fillBench.json"));
+}
@@ -0,0 +1,6 @@
+/* Documentation for benchModule */
+module benchModule {
+  proc fill(ref A: [] int, x: int) {
+    A = x;
+  }
+}
@@ -0,0 +1,32 @@
+// Check that a coforall whose iterator or locale expression waits for an
+// earlier iteration does not deadlock, and that large bounded coforalls,
+// whose tasks may be started in batches, run every iteration.
+
+var s: sync int;
+
+iter it() {
+  yield 1;
+  const x = s.readFE();
+  yield x;
+}
+
+coforall i in it() {
+  if i == 1 then s.writeEF(5);
+}
+writeln("iterator done");
+
+var done: [0..#20] sync bool;
+
+proc afterPrevious(i) {
+  if i > 0 then done[i-1].readFE();
+  return Locales[i % numLocales];
+}
+
+coforall i in 0..#20 do on afterPrevious(i) {
+  done[i].writeEF(true);
+}
+writeln("locale expression done");
+
+var counter: atomic int;
+coforall i in 1..3000 do counter.add(i);
+writeln(counter.read());
@@ -0,0 +1,46 @@
+// Check that large coforall+on loops, whose iterations may be launched as
+// a tree, run every iteration once and on the right locale, including
+// when they are nested, serialized or unbounded, or when the parent task
+// does more per iteration than launch the on-statement.
+
+config const n = 1000;
+
+var counter: atomic int;
+var ranOn: [0..#n] int;
+
+coforall i in 0..#n do on Locales[i % numLocales] {
+  counter.add(1);
+  ranOn[i] = here.id;
+}
+writeln(counter.read(), " ", && reduce [i in 0..#n] ranOn[i] == i % numLocales);
+
+counter.write(0);
+coforall loc in Locales do on loc do counter.add(1);
+writeln(counter.read() == numLocales);
+
+counter.write(0);
+coforall i in 0..#20 do on Locales[i % numLocales] {
+  coforall j in 0..#20 do on Locales[j % numLocales] do counter.add(1);
+}
+writeln(counter.read());
+
+counter.write(0);
+serial {
+  coforall i in 0..#30 do on Locales[i % numLocales] do counter.add(1);
+}
+writeln(counter.read());
+
+counter.write(0);
+coforall i in 0..#30 {
+  const x = i;
+  on Locales[x % numLocales] do counter.add(x);
+}
+writeln(counter.read());
+
+iter unboundedIter() {
+  for i in 0..#40 do yield i;
+}
+
+counter.write(0);
+coforall i in unboundedIter() do on Locales[i % numLocales] do counter.add(1);
+writeln(counter.read());
@@ -0,0 +1,30 @@
+// Hand values through a pipeline of sync variables and back and forth
+// through an atomic variable, with the wait backoff set by the .execenv
+// to spin and then block right away rather than yield first.
+
+config const n = 10000,
+             numStages = 4;
+
+var stages: [0..numStages] sync int;
+var sum: int;
+
+cobegin with (ref sum) {
+  for i in 1..n do stages[0].writeEF(i);
+  coforall s in 1..numStages do
+    for 1..n do stages[s].writeEF(stages[s-1].readFE() + 1);
+  for 1..n do sum += stages[numStages].readFE();
+}
+writeln(sum == n * (n + 1) / 2 + n * numStages);
+
+var turn: atomic int;
+cobegin {
+  for i in 0..#n by 2 {
+    turn.waitFor(i);
+    turn.write(i + 1);
+  }
+  for i in 1..#n by 2 {
+    turn.waitFor(i);
+    turn.write(i + 1);
+  }
+}
+writeln(turn.read());
@@ -0,0 +1,43 @@
+// Many short tasks that run to completion, which the qthreads tasking
+// layer runs without stacks of their own, mixed with tasks that block.
+
+config const n = 100000;
+
+var a: [0..#n] int;
+sync {
+  for i in 0..#n do begin a[i] = 2 * i;
+}
+writeln(+ reduce a == n * (n - 1));
+
+// A task that waits on a sync variable needs a stack of its own, and
+// must still be able to run while short tasks are queued.
+var s$: sync int;
+var x: atomic int;
+sync {
+  begin x.add(s$.readFE());
+  for i in 0..#1000 do begin a[i] = -1;
+  begin s$.writeEF(1);
+}
+writeln(x.read(), " ", + reduce a[0..#1000]);
+
+var b: [0..#4] int;
+cobegin {
+  b[0] = 1;
+  b[1] = 2;
+  b[2] = 3;
+  b[3] = 4;
+}
+writeln(b);
+
+coforall i in 0..#1000 with (ref a) do a[i] = i;
+writeln(+ reduce a[0..#1000]);
+
+proc f(i: int) throws {
+  if i == 3 then throw new Error("task " + i:string);
+}
+
+try {
+  coforall i in 0..#8 do f(i);
+} catch e {
+  writeln(e.message());
+}
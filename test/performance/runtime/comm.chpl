@@ -0,0 +1,142 @@
+//
+// Microbenchmarks of the runtime's communication interfaces: GETs and PUTs
+// across transfer sizes, the three flavors of remote execution, and remote
+// atomic operations.  Every operation targets locale 1, or locale 0 when run
+// on a single locale, so the same program measures the local paths with
+// CHPL_COMM=none.  See the README for how to run and compare the results.
+//
+use Benchmark;
+use CPtr;
+use List;
+
+// The largest GET/PUT size, in bytes.  Sizes grow by 8x starting at 8 bytes.
+config const maxCommSize = 2**21;
+
+const target = Locales[if numLocales > 1 then 1 else 0];
+
+extern proc emptyFn();
+
+class Counter {
+  var x: atomic int;
+}
+
+var counter: unmanaged Counter?;
+on target do counter = new unmanaged Counter();
+
+record GetBench {
+  const size: int;
+
+  proc this(b: borrowed Bench) {
+    const n = size;
+    var buf = c_calloc(uint(8), n);
+    var remote: c_ptr(uint(8));
+    on target do remote = c_calloc(uint(8), n);
+
+    b.setBytes(n);
+    b.resetTimer();
+    for 1..b.iterations do
+      __primitive("chpl_comm_array_get", buf[0], target.id, remote[0], n);
+    b.stopTimer();
+
+    on target do c_free(remote);
+    c_free(buf);
+  }
+}
+
+record PutBench {
+  const size: int;
+
+  proc this(b: borrowed Bench) {
+    const n = size;
+    var buf = c_calloc(uint(8), n);
+    var remote: c_ptr(uint(8));
+    on target do remote = c_calloc(uint(8), n);
+
+    b.setBytes(n);
+    b.resetTimer();
+    for 1..b.iterations do
+      __primitive("chpl_comm_array_put", buf[0], target.id, remote[0], n);
+    b.stopTimer();
+
+    on target do c_free(remote);
+    c_free(buf);
+  }
+}
+
+// A blocking on-statement whose body has to run in a task of its own
+proc onBlocking(b: borrowed Bench) {
+  for 1..b.iterations do
+    on target do emptyFn();
+}
+
+// A blocking on-statement that is run directly by the communication layer
+proc onFast(b: borrowed Bench) {
+  for 1..b.iterations do
+    on target do ;
+}
+
+// Non-blocking on-statements, all waited for at the end of the run
+proc onNonBlocking(b: borrowed Bench) {
+  sync {
+    for 1..b.iterations do
+      begin on target do ;
+  }
+}
+
+proc amoAdd(b: borrowed Bench) {
+  for 1..b.iterations do
+    counter!.x.add(1);
+}
+
+proc amoFetchAdd(b: borrowed Bench) {
+  for 1..b.iterations do
+    b.keep(counter!.x.fetchAdd(1));
+}
+
+proc amoCompareAndSwap(b: borrowed Bench) {
+  counter!.x.write(0);
+  b.resetTimer();
+  for 1..b.iterations do
+    b.keep(counter!.x.compareAndSwap(0, 0));
+}
+
+// Adds issued by here.maxTaskPar tasks at once, reported per add
+proc amoAddParallel(b: borrowed Bench) {
+  const nTasks = here.maxTaskPar;
+  coforall tid in 0..#nTasks do
+    for tid..<b.iterations by nTasks do
+      counter!.x.add(1);
+}
+
+proc run(ref results: list(BenchResult), name: string, fn) throws {
+  if isSelected(name) then
+    results.append(runBenchmark(name, fn));
+}
+
+var results: list(BenchResult);
+
+var size = 8;
+while size <= maxCommSize {
+  run(results, "get/" + size:string, new GetBench(size));
+  size *= 8;
+}
+size = 8;
+while size <= maxCommSize {
+  run(results, "put/" + size:string, new PutBench(size));
+  size *= 8;
+}
+
+run(results, "executeOn", onBlocking);
+run(results, "executeOnFast", onFast);
+run(results, "executeOnNB", onNonBlocking);
+
+run(results, "amo/add", amoAdd);
+run(results, "amo/fetchAdd", amoFetchAdd);
+run(results, "amo/compareAndSwap", amoCompareAndSwap);
+run(results, "amo/add-parallel", amoAddParallel);
+
+printResults(results);
+if !benchJSON.isEmpty() then
+  writeJSON(results, benchJSON);
+
+delete counter;
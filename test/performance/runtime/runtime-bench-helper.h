@@ -0,0 +1,3 @@
+// An opaque call, so that the compiler can neither remove the task or
+// on-statement bodies containing it nor run them as fast on-statements.
+static inline void emptyFn(void) { }
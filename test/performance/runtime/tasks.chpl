@@ -0,0 +1,119 @@
+//
+// Microbenchmarks of the runtime's tasking interfaces: the cost of spawning
+// and joining tasks with coforall, begin and cobegin, of handing a value
+// from one task to another through sync variables, and of barriers.  The
+// remote variants use locale 1, or locale 0 when run on a single locale.
+// See the README for how to run and compare the results.
+//
+use Benchmark;
+use Barriers;
+use AllLocalesBarriers;
+use List;
+
+// The number of tasks per locale used by the coforall and barrier benchmarks
+config const numTasks = here.maxTaskPar;
+
+const target = Locales[if numLocales > 1 then 1 else 0];
+
+extern proc emptyFn();
+
+proc coforallTasks(b: borrowed Bench) {
+  for 1..b.iterations do
+    coforall 1..numTasks do emptyFn();
+}
+
+proc coforallLocales(b: borrowed Bench) {
+  for 1..b.iterations do
+    coforall loc in Locales do on loc do emptyFn();
+}
+
+// Spawn one task and wait for it
+proc beginJoin(b: borrowed Bench) {
+  for 1..b.iterations do
+    sync begin emptyFn();
+}
+
+// Spawn all of the run's tasks before waiting for any of them
+proc beginBatch(b: borrowed Bench) {
+  sync {
+    for 1..b.iterations do
+      begin emptyFn();
+  }
+}
+
+proc cobeginPair(b: borrowed Bench) {
+  for 1..b.iterations do
+    cobegin {
+      emptyFn();
+      emptyFn();
+    }
+}
+
+// A round trip of two handoffs between tasks through a pair of sync
+// variables, with the second task running on 'loc'
+proc syncPingPong(b: borrowed Bench, loc: locale) {
+  var ping, pong: sync int;
+  const n = b.iterations;
+  cobegin with (ref ping, ref pong) {
+    for i in 1..n {
+      ping.writeEF(i);
+      b.keep(pong.readFE());
+    }
+    on loc do
+      for 1..n do
+        pong.writeEF(ping.readFE());
+  }
+}
+
+proc syncPingPongLocal(b: borrowed Bench) {
+  syncPingPong(b, here);
+}
+
+proc syncPingPongRemote(b: borrowed Bench) {
+  syncPingPong(b, target);
+}
+
+proc barrierAtomic(b: borrowed Bench) {
+  var bar = new Barrier(numTasks, BarrierType.Atomic);
+  coforall 1..numTasks do
+    for 1..b.iterations do
+      bar.barrier();
+}
+
+proc barrierSync(b: borrowed Bench) {
+  var bar = new Barrier(numTasks, BarrierType.Sync);
+  coforall 1..numTasks do
+    for 1..b.iterations do
+      bar.barrier();
+}
+
+proc barrierAllLocales(b: borrowed Bench) {
+  const nTasks = numTasks;
+  allLocalesBarrier.reset(nTasks);
+  coforall loc in Locales do on loc do
+    coforall 1..nTasks do
+      for 1..b.iterations do
+        allLocalesBarrier.barrier();
+}
+
+proc run(ref results: list(BenchResult), name: string, fn) throws {
+  if isSelected(name) then
+    results.append(runBenchmark(name, fn));
+}
+
+var results: list(BenchResult);
+
+run(results, "coforall/tasks", coforallTasks);
+run(results, "coforall/locales", coforallLocales);
+run(results, "begin/join", beginJoin);
+run(results, "begin/batch", beginBatch);
+run(results, "cobegin/pair", cobeginPair);
+run(results, "sync/pingpong", syncPingPongLocal);
+run(results, "sync/pingpong-remote", syncPingPongRemote);
+run(results, "barrier/atomic", barrierAtomic);
+run(results, "barrier/sync", barrierSync);
+run(results, "barrier/all-locales", barrierAllLocales);
+
+printResults(results);
+if !benchJSON.isEmpty() then
+  writeJSON(results, benchJSON);
@@ -0,0 +1,47 @@
+//
+// This test checks the comm=shmem transfers that go through active
+// messages, which are used when cross-memory attach isn't available
+// and the target memory isn't in the shared heap segment.  The
+// transfers are large enough to take several messages each.
+//
+use BlockDist;
+
+config const n = 10000;
+
+const D = {1..n} dmapped Block({1..n});
+var A: [D] int;
+forall i in D do A[i] = i;
+
+var B: [1..n] int;
+B = A;
+writeln(+ reduce B == n*(n+1)/2);
+
+on Locales[numLocales-1] {
+  var C: [1..n] int = B;
+  C += 1;
+  B = C;
+}
+writeln(+ reduce B == n*(n+1)/2 + n);
+
+var M: [1..20, 1..20] real = 1.0;
+on Locales[numLocales-1] {
+  var L: [1..10, 1..10] real;
+  L = M[1..20 by 2, 1..20 by 2];
+  writeln(+ reduce L);
+  M[1..20 by 2, 1..1] = 2.0;
+}
+writeln(+ reduce M);
+
+var a: atomic int;
+var r: atomic real;
+coforall loc in Locales do on loc {
+  for 1..100 { a.add(2); r.add(0.5); }
+  a.sub(1);
+}
+writeln(a.read() == 199*numLocales, " ", r.read() == 50.0*numLocales);
+
+var t: 100*int;
+for i in 0..<100 do t(i) = i;
+var s: atomic int;
+coforall loc in Locales do on loc do s.add(+ reduce t);
+writeln(s.read() == 4950*numLocales);
@@ -0,0 +1,5 @@
+//
+// A locale other than 0 halting must end the whole program.
+//
+on Locales[numLocales-1] do halt("halting on a non-zero locale");
+writeln("should not get here");
@@ -0,0 +1,23 @@
+use Memory.Placement;
+
+config const n = 1024 * 1024;
+
+// Policy-placed array, zero initialized
+var A: [1..n] real;
+A = 1.0;
+writeln(+ reduce A);
+
+// Policy-placed array, first touched by the runtime
+var B: [1..n] int = noinit;
+forall i in B.domain do B[i] = i;
+writeln(+ reduce B);
+
+// Explicitly advised array
+var C: [1..n, 1..4] real = noinit;
+adviseArrayMemory(C, hugePages=true, interleave=true);
+C = 2.0;
+writeln(+ reduce C);
+
+// Advising an already-touched array is allowed too
+adviseArrayMemory(A, hugePages=true);
+writeln(+ reduce A);
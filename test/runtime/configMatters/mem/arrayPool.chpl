@@ -0,0 +1,36 @@
+// Same-shaped temporaries created in a loop should reuse pooled array
+// storage, and must still come back properly initialized.
+
+extern proc chpl_mem_array_pool_getCounts(ref hits: uint(64),
+                                          ref misses: uint(64));
+
+config const n = 256 * 1024;
+config const numSteps = 10;
+
+const D = {1..n};
+var A: [D] real = 1.0;
+
+var hits0, misses0: uint(64);
+chpl_mem_array_pool_getCounts(hits0, misses0);
+
+for step in 1..numSteps {
+  var tmp: [D] real;
+  if + reduce tmp != 0.0 then
+    writeln("step ", step, ": tmp was not zero initialized");
+  tmp = A + step;
+  A = tmp - step + 1.0;
+
+  var idx: [D] int = noinit;
+  forall i in D do idx[i] = i + step;
+  if idx[n] != n + step then
+    writeln("step ", step, ": bad noinit array contents");
+}
+
+writeln(+ reduce A);
+
+// The first step allocates tmp and idx fresh; every later step should
+// get both from the pool.
+var hits, misses: uint(64);
+chpl_mem_array_pool_getCounts(hits, misses);
+assert(misses - misses0 == 2);
+assert(hits - hits0 == 2 * (numSteps - 1));
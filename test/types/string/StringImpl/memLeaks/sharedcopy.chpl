@@ -0,0 +1,87 @@
+module unitTest {
+  use main;
+
+  proc copyThenAppend(type t) {
+    writeln("=== copy then append");
+    const m0 = allMemoryUsed();
+    {
+      var s0: t = "s0":t;
+      var s1 = s0;
+      var s2 = s1;
+      s1 += "s1";
+      s2 += "s2";
+      if doCorrectnessTest then writeln(s0, " ", s1, " ", s2);
+    }
+    checkMemLeaks(m0);
+  }
+
+  proc assignThenAppend(type t) {
+    writeln("=== assign then append");
+    const m0 = allMemoryUsed();
+    {
+      var s0: t = "s0":t;
+      var s1 = s0;
+      var s2: t = "s2long":t;
+      s2 = s1;
+      s2 += "s2";
+      s1 = "s1":t;
+      if doCorrectnessTest then writeln(s0, " ", s1, " ", s2);
+    }
+    checkMemLeaks(m0);
+  }
+
+  proc copyOutlivesOriginal(type t) {
+    writeln("=== copy outlives original");
+    const m0 = allMemoryUsed();
+    {
+      var s1: t;
+      {
+        var s0: t = "s0":t;
+        s0 += "s0";
+        s1 = s0;
+        var s2 = s0;
+        s1 = s2;
+      }
+      s1 += "s1";
+      if doCorrectnessTest then writeln(s1);
+    }
+    checkMemLeaks(m0);
+  }
+
+  proc parallelCopies(type t) {
+    writeln("=== parallel copies");
+    const m0 = allMemoryUsed();
+    {
+      var s0: t = "s0":t;
+      var A: [1..100] t;
+      forall a in A do a = s0;
+      forall a in A do a += "x";
+      if doCorrectnessTest then writeln(s0, " ", A[1], " ", A[100]);
+    }
+    checkMemLeaks(m0);
+  }
+
+  proc remoteCopy(type t) {
+    writeln("=== remote copy");
+    const m0 = allMemoryUsed();
+    {
+      var s0: t = "s0":t;
+      on Locales[numLocales-1] {
+        var s1 = s0;
+        var s2 = s1;
+        s2 += "s2";
+        if doCorrectnessTest then writeln(s1, " ", s2);
+      }
+    }
+    checkMemLeaks(m0);
+  }
+
+  proc doIt(type t) {
+    copyThenAppend(t);
+    assignThenAppend(t);
+    copyOutlivesOriginal(t);
+    parallelCopies(t);
+    remoteCopy(t);
+  }
+
+}
@@ -0,0 +1,33 @@
+// Codepoint indexing and slicing of long non-ASCII strings, which may use
+// an index cached with the string's buffer
+config const n = 3000;
+
+const unit = "aé€😀";
+var s = unit * n;
+var t = s;  // shares s's buffer
+
+proc check(const ref x: string, cpLen: int) {
+  for i in [0, 1, 255, 256, 257, 1023, 1024, 5000, cpLen-1] {
+    const expect = unit[i % 4];
+    if x[i] != expect then
+      writeln("wrong codepoint at ", i, ": ", x[i]);
+  }
+  const sl = x[1020..1031];
+  if sl != unit * 3 then writeln("wrong slice at 1020: ", sl);
+  const tail = x[cpLen-3..];
+  if tail != unit[1..] then writeln("wrong tail: ", tail);
+  const head = x[..2];
+  if head != unit[..2] then writeln("wrong head: ", head);
+}
+
+writeln(s.size, " ", s.numBytes);
+check(s, s.size);
+check(t, t.size);
+
+// appending in place must not reuse an index built for the old contents
+var u = unit * n;
+check(u, u.size);
+u += "z";
+writeln(u[u.size-1], " ", u[u.size-2]);
+u = "é" * (n * 4);
+writeln(u[n*4-1], " ", u[n*4-1..].size);
@@ -0,0 +1,60 @@
+// Validate buffers long enough to take the vectorized paths, with the
+// invalid or multibyte sequence at every offset in and around a vector
+use CPtr, SysCTypes;
+
+const ascii = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" * 2;
+
+proc check(prefixLen: int, seq: bytes) {
+  var b = b"";
+  for i in 0..<prefixLen do b += b"x";
+  b += seq;
+  b += ascii: bytes;
+  try {
+    var s = createStringWithNewBuffer(b.c_str(), length=b.size);
+    return s.size;
+  } catch e: DecodeError {
+    return -1;
+  } catch {
+    return -2;
+  }
+}
+
+const tests = [(b"\xc3\xa9", "2-byte"),
+               (b"\xe2\x82\xac", "3-byte"),
+               (b"\xf0\x9f\x98\x80", "4-byte"),
+               (b"\xc0\x80", "overlong 2-byte"),
+               (b"\xe0\x80\x80", "overlong 3-byte"),
+               (b"\xed\xa0\x80", "surrogate"),
+               (b"\xf4\x90\x80\x80", "past U+10FFFF"),
+               (b"\x80", "stray continuation"),
+               (b"\xe2\x82", "truncated")];
+
+for (seq, name) in tests {
+  var sizes: [0..70] int;
+  for p in 0..70 do sizes[p] = check(p, seq);
+  const valid = sizes[0] != -1;
+  var consistent = true;
+  for p in 0..70 do
+    if sizes[p] != (if valid then sizes[0] + p else -1) then
+      consistent = false;
+  writeln(name, ": ", if valid then "valid, " + sizes[0]:string + " codepoints"
+                                else "invalid",
+          if consistent then "" else " (inconsistent)");
+}
+
+// strings made from other strings' buffers may hold escaped bytes, but
+// decoding a buffer doesn't accept them
+var escaped = b"\xff\xfe".decode(policy=decodePolicy.escape) + ascii;
+var fromBuf = createStringWithBorrowedBuffer(escaped.c_str():c_ptr(c_char),
+                                             length=escaped.numBytes,
+                                             size=escaped.numBytes+1);
+writeln(fromBuf.size, " ", fromBuf == escaped);
+try {
+  var decoded = createStringWithNewBuffer(escaped.c_str(),
+                                          length=escaped.numBytes);
+  writeln("decoded escapes: ", decoded.size);
+} catch e: DecodeError {
+  writeln("escapes rejected when decoding");
+} catch {
+  writeln("unexpected error");
+}
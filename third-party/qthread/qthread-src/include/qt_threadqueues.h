@@ -21,6 +21,8 @@ typedef struct _qt_threadqueue_pools {
 
 void INTERNAL qt_threadqueue_subsystem_init(void);
 
+extern void (*qt_chpl_steal_hook)(void);
+
 qt_threadqueue_t INTERNAL *qt_threadqueue_new(void);
 void INTERNAL              qt_threadqueue_free(qt_threadqueue_t *q);
 
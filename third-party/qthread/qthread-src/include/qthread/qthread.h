@@ -289,6 +289,7 @@ enum _qthread_features {
 #define QTHREAD_SPAWN_NETWORK (1 << SPAWN_NETWORK)
 
 void qthread_chpl_reset_spawn_order(void);
+void qthread_chpl_set_steal_hook(void (*hook)(void));
 
 int qthread_spawn(qthread_f             f,
                   const void           *arg,
@@ -619,24 +619,34 @@ int INTERNAL qt_affinity_gendists(qthread_shepherd_t   *sheps,
         qthread_debug(AFFINITY_DETAILS, "obj %i maps to node %i\n", i, node_to_NUMAnode[i]);
     }
 #endif /* ifdef QTHREAD_HAVE_HWLOC_DISTS */
+    /* Ask the Chapel runtime how much hardware (L2, L3/NUMA) the first
+     * PUs of each pair of shepherd objects share, so that the sorted
+     * shepherd lists, and thus work stealing, prefer nearby victims. */
+    int shep_pu[num_extant_objs];
+    for (size_t i = 0; i < num_extant_objs; ++i) {
+        hwloc_obj_t obj = hwloc_get_obj_inside_cpuset_by_depth(topology, allowed_cpuset, shep_depth, i);
+        shep_pu[i] = hwloc_bitmap_first(obj->cpuset);
+    }
     for (size_t i = 0; i < nshepherds; ++i) {
         for (size_t j = 0, k = 0; j < nshepherds; ++j) {
             if (j != i) {
+                unsigned int locality = 1 + (unsigned int)chpl_topo_getPUDistance(shep_pu[sheps[i].node], shep_pu[sheps[j].node]);
 #ifdef QTHREAD_HAVE_HWLOC_DISTS
                 if (matrix) {
-                    sheps[i].shep_dists[j] = matrix->latency[node_to_NUMAnode[sheps[i].node] + matrix->nbobjs * node_to_NUMAnode[sheps[j].node]] * 10;
+                    /* NUMA latency dominates; cache sharing breaks ties */
+                    sheps[i].shep_dists[j] = matrix->latency[node_to_NUMAnode[sheps[i].node] + matrix->nbobjs * node_to_NUMAnode[sheps[j].node]] * 10 + locality;
                     qthread_debug(AFFINITY_DETAILS, "distance from %i(%i) to %i(%i) is %i\n",
                                   (int)i, (int)sheps[i].node,
                                   (int)j, (int)sheps[j].node,
                                   (int)(sheps[i].shep_dists[j]));
                 } else {
                     // handle what is fundamentally a bug in old versions of hwloc
-                    sheps[i].shep_dists[j] = 10;
-                    qthread_debug(AFFINITY_DETAILS, "pretending distance from %i to %i is %i\n", (int)i, (int)j, (int)(sheps[i].shep_dists[j]));
+                    sheps[i].shep_dists[j] = 10 * locality;
+                    qthread_debug(AFFINITY_DETAILS, "distance from %i to %i by locality is %i\n", (int)i, (int)j, (int)(sheps[i].shep_dists[j]));
                 }
 #else          /* ifdef QTHREAD_HAVE_HWLOC_DISTS */
-                sheps[i].shep_dists[j] = 10;
-                qthread_debug(AFFINITY_DETAILS, "pretending distance from %i to %i is %i\n", (int)i, (int)j, (int)(sheps[i].shep_dists[j]));
+                sheps[i].shep_dists[j] = 10 * locality;
+                qthread_debug(AFFINITY_DETAILS, "distance from %i to %i by locality is %i\n", (int)i, (int)j, (int)(sheps[i].shep_dists[j]));
 #endif         /* ifdef QTHREAD_HAVE_HWLOC_DISTS */
                 sheps[i].sorted_sheplist[k++] = j;
             }
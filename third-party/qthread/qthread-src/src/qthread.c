@@ -2416,6 +2416,15 @@ void API_FUNC qthread_chpl_reset_spawn_order(void) {
     }
 }
 
+/* Called by schedulers that steal, each time a worker takes a task
+ * from another shepherd's queue. */
+void (*qt_chpl_steal_hook)(void) = NULL;
+
+void API_FUNC qthread_chpl_set_steal_hook(void (*hook)(void)) {
+    qt_chpl_steal_hook = hook;
+    MACHINE_FENCE;
+}
+
 int API_FUNC qthread_spawn(qthread_f             f,
                            const void           *arg,
                            size_t                arg_size,
@@ -355,14 +355,20 @@ qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t         *qe,
   for(int numwaits = 0; !node; numwaits ++){
     node = qt_threadqueue_dequeue_tail(qe);
 
-    // If we've done QT_STEAL_RATIO waits on local queue, try to steal 
+    // If we've done QT_STEAL_RATIO waits on local queue, try to steal,
+    // nearest shepherds first when we know the distances
     if(!node && steal_ratio > 0 && numwaits % steal_ratio == 0) {
-      for(int i=0; i < qlib->nshepherds; i++){
-        qt_threadqueue_t *victim_queue = qlib->shepherds[i].ready;
+      qthread_shepherd_id_t *victims = my_shepherd->sorted_sheplist;
+      int nvictims = victims ? qlib->nshepherds - 1 : qlib->nshepherds;
+      for(int i=0; i < nvictims; i++){
+        qthread_shepherd_id_t v = victims ? victims[i] : i;
+        qt_threadqueue_t *victim_queue = qlib->shepherds[v].ready;
         node = qt_threadqueue_dequeue_head(victim_queue);
         if (node){
           t = node->value;
           free_tqnode(node);
+          if (qt_chpl_steal_hook && v != my_shepherd->shepherd_id)
+            qt_chpl_steal_hook();
           return t;
         }
       }
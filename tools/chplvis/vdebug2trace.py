@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+
+#
+# Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+# Copyright 2004-2019 Cray Inc.
+# Other additional copyright holders may be indicated within.
+#
+# The entirety of this work is licensed under the Apache License,
+# Version 2.0 (the "License"); you may not use this file except
+# in compliance with the License.
+#
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+""" Convert binary VisualDebug data to a Chrome trace-event JSON file.
+
+Run a program that uses the VisualDebug module with
+--VisualDebugBinary=true, then give this script the directory named in
+startVdebug().  The result can be loaded into Perfetto
+(https://ui.perfetto.dev) or chrome://tracing.
+
+Each locale is a process and each of its threads is a track.  Tasks are
+slices on the thread that began them, with flows from the task that
+created them.  On-statements and communication are short slices on the
+issuing task with a flow to the target locale: to the on-body task when
+it can be found and otherwise to that locale's "incoming" track.
+
+Events for the VisualDebug routines themselves are left out, as chplvis
+does.
+
+The binary record layout must match runtime/src/chpl-visual-debug.c.
+"""
+
+import argparse
+import collections
+import glob
+import json
+import os
+import struct
+import sys
+
+MAGIC = b'chplvdb1'
+REC_FORMAT = 'IiqQQQiiiiii'
+
+(VDB_START, VDB_STOP, VDB_FNAME, VDB_FIDNAME, VDB_TAGNAME, VDB_TAG, VDB_PAUSE,
+ VDB_MARK, VDB_TASK_CREATE, VDB_TASK_BEGIN, VDB_TASK_END, VDB_PUT, VDB_GET,
+ VDB_PUT_NB, VDB_GET_NB, VDB_PUT_STRD, VDB_GET_STRD, VDB_FORK, VDB_FORK_NB,
+ VDB_FORK_FAST) = range(1, 21)
+
+NAME_KINDS = (VDB_FNAME, VDB_FIDNAME, VDB_TAGNAME)
+COMM_NAMES = {VDB_PUT: 'put', VDB_GET: 'get', VDB_PUT_NB: 'nb_put',
+              VDB_GET_NB: 'nb_get', VDB_PUT_STRD: 'st_put',
+              VDB_GET_STRD: 'st_get'}
+FORK_NAMES = {VDB_FORK: 'on', VDB_FORK_NB: 'on_nb', VDB_FORK_FAST: 'on_fast'}
+
+# tid of the per-locale track that receives communication
+INCOMING_TID = 1 << 30
+
+# duration, in microseconds, given to instantaneous operations
+TICK = 0.001
+
+Record = collections.namedtuple(
+    'Record', 'kind thread time task id size node sub lineno fileno fid '
+              'name')
+
+
+def read_file(path):
+    """ Return the records in one binary VisualDebug file. """
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError('{0}: not a binary VisualDebug file'.format(path))
+
+    # The size field of the leading start record tells us the byte order.
+    fmt = None
+    for order in '<>':
+        rec = struct.Struct(order + REC_FORMAT)
+        fields = rec.unpack_from(data, len(MAGIC))
+        if fields[0] == VDB_START and fields[5] == rec.size:
+            fmt = rec
+            break
+    if fmt is None:
+        raise ValueError('{0}: bad start record'.format(path))
+
+    records = []
+    pos = len(MAGIC)
+    while pos + fmt.size <= len(data):
+        fields = fmt.unpack_from(data, pos)
+        pos += fmt.size
+        name = None
+        if fields[0] in NAME_KINDS:
+            name = data[pos:pos + fields[5]].decode('utf-8', 'replace')
+            pos += fields[5]
+        records.append(Record(*(fields[:-1] + (name,))))
+    return records
+
+
+def vdebug_files(paths):
+    files = []
+    for p in paths:
+        if os.path.isdir(p):
+            files.extend(sorted(glob.glob(os.path.join(p, '*.bin'))))
+        else:
+            files.append(p)
+    return files
+
+
+class Converter(object):
+
+    def __init__(self, show_vdebug, show_comm):
+        self.show_vdebug = show_vdebug
+        self.show_comm = show_comm
+        self.fnames = {}
+        self.fidnames = {}
+        self.tagnames = {}
+        self.nodes = {}     # node -> time-ordered records
+        self.events = []
+        self.flow_id = 0
+        self.t0 = None
+
+    def add(self, records):
+        start = records[0]
+        node = start.node
+        for r in records:
+            if r.kind == VDB_FNAME:
+                self.fnames[r.id] = r.name
+            elif r.kind == VDB_FIDNAME:
+                self.fidnames[r.fid] = r.name
+            elif r.kind == VDB_TAGNAME:
+                self.tagnames[r.id] = r.name
+        # Each thread's records are in order, but the threads' buffers
+        # were written out whenever they filled up.
+        self.nodes[node] = sorted((r for r in records
+                                   if r.kind not in NAME_KINDS),
+                                  key=lambda r: r.time)
+        if self.t0 is None or start.time < self.t0:
+            self.t0 = start.time
+
+    def ts(self, t):
+        return (t - self.t0) / 1000.0
+
+    def site(self, r):
+        fname = self.fnames.get(r.fileno, '')
+        return '{0}:{1}'.format(fname, r.lineno) if fname else str(r.lineno)
+
+    def new_flow(self, name, cat, src, dst):
+        """ Connect two (pid, tid, time) points with a flow. """
+        self.flow_id += 1
+        self.events.append({'ph': 's', 'id': self.flow_id, 'name': name,
+                            'cat': cat, 'pid': src[0], 'tid': src[1],
+                            'ts': src[2]})
+        self.events.append({'ph': 'f', 'bp': 'e', 'id': self.flow_id,
+                            'name': name, 'cat': cat, 'pid': dst[0],
+                            'tid': dst[1], 'ts': dst[2]})
+
+    def vdebug_tasks(self, node, recs):
+        """ Find the tasks running VisualDebug routines, as chplvis does. """
+        vdb = set()
+        active = None   # on locale 0 the user's task is marked until a tag
+        for r in recs:
+            if r.kind == VDB_MARK:
+                if node == 0:
+                    active = r.task
+                else:
+                    vdb.add(r.task)
+            elif r.kind in (VDB_TAG, VDB_PAUSE, VDB_STOP) and node == 0:
+                active = None
+            elif r.kind == VDB_TASK_CREATE and not r.sub:
+                if r.task in vdb or (active is not None and r.task == active):
+                    vdb.add(r.id)
+        return vdb
+
+    def match_forks(self):
+        """ Pair on-statements with the on-body tasks they created.
+
+        The records don't say which on-statement created an on-body
+        task, so pair them in time order by target locale and function.
+        """
+        forks = collections.defaultdict(collections.deque)
+        bodies = collections.defaultdict(collections.deque)
+        for node, recs in self.nodes.items():
+            for r in recs:
+                if r.kind in (VDB_FORK, VDB_FORK_NB):
+                    forks[(r.node, r.fid)].append((r.time, node, r))
+                elif r.kind == VDB_TASK_CREATE and r.sub:
+                    bodies[(node, r.fid)].append((r.time, r.id))
+        matches = {}
+        for key, fq in forks.items():
+            bq = sorted(bodies.get(key, ()))
+            for (_, node, r), (_, task) in zip(sorted(fq, key=lambda x: x[0]),
+                                               bq):
+                matches[(node, id(r))] = (key[0], task)
+        return matches
+
+    def convert(self):
+        vdb = {}
+        for node, recs in self.nodes.items():
+            vdb[node] = (set() if self.show_vdebug
+                         else self.vdebug_tasks(node, recs))
+            self.events.append({'ph': 'M', 'name': 'process_name',
+                                'pid': node,
+                                'args': {'name': 'Locale {0}'.format(node)}})
+            self.events.append({'ph': 'M', 'name': 'process_sort_index',
+                                'pid': node, 'args': {'sort_index': node}})
+            self.events.append({'ph': 'M', 'name': 'thread_name',
+                                'pid': node, 'tid': INCOMING_TID,
+                                'args': {'name': 'incoming'}})
+
+        # Where and when each task ran: (thread, begin, end)
+        spans = {}
+        for node, recs in self.nodes.items():
+            first, last = recs[0].time, recs[-1].time
+            threads = set()
+            open_spans = []
+            for r in recs:
+                threads.add(r.thread)
+                key = (node, r.task)
+                if r.kind == VDB_TASK_BEGIN:
+                    spans[key] = [r.thread, r.time, None, r]
+                    open_spans.append(spans[key])
+                elif r.kind == VDB_TASK_END:
+                    if key not in spans:
+                        spans[key] = [r.thread, first, None, None]
+                    spans[key][2] = r.time
+                elif r.kind in (VDB_START, VDB_STOP, VDB_TAG, VDB_PAUSE):
+                    pass
+                elif key not in spans:
+                    # A task that was already running when tracing began
+                    spans[key] = [r.thread, first, None, None]
+                    open_spans.append(spans[key])
+            for s in open_spans:
+                if s[2] is None:
+                    s[2] = last
+            for t in threads:
+                self.events.append({'ph': 'M', 'name': 'thread_name',
+                                    'pid': node, 'tid': t,
+                                    'args': {'name': 'thread {0}'.format(t)}})
+
+        for (node, task), (thread, begin, end, r) in spans.items():
+            if task in vdb[node]:
+                continue
+            if r is not None:
+                name = self.fidnames.get(r.fid, 'task')
+                args = {'task': task, 'site': self.site(r),
+                        'on-body': bool(r.sub)}
+            else:
+                name = 'task {0}'.format(task)
+                args = {'task': task}
+            self.events.append({'ph': 'X', 'name': name, 'cat': 'task',
+                                'pid': node, 'tid': thread,
+                                'ts': self.ts(begin),
+                                'dur': max((end - begin) / 1000.0, TICK),
+                                'args': args})
+
+        matches = self.match_forks()
+        for node, recs in self.nodes.items():
+            for r in recs:
+                if r.task in vdb[node] and r.kind not in (VDB_TAG, VDB_PAUSE):
+                    continue
+                ts = self.ts(r.time)
+                here = (node, r.thread, ts)
+                if r.kind == VDB_TASK_CREATE and not r.sub:
+                    child = spans.get((node, r.id))
+                    if child is not None and r.id not in vdb[node]:
+                        self.new_flow('spawn', 'task', here,
+                                      (node, child[0], self.ts(child[1])))
+                elif r.kind in FORK_NAMES:
+                    self.events.append({
+                        'ph': 'X', 'name': '{0} {1}'.format(FORK_NAMES[r.kind],
+                                                             r.node),
+                        'cat': 'on', 'pid': node, 'tid': r.thread, 'ts': ts,
+                        'dur': TICK,
+                        'args': {'locale': r.node, 'site': self.site(r),
+                                 'function': self.fidnames.get(r.fid, r.fid),
+                                 'bytes': r.size}})
+                    m = matches.get((node, id(r)))
+                    body = spans.get(m) if m is not None else None
+                    if body is not None and m[1] not in vdb[m[0]]:
+                        self.new_flow('on', 'on', here,
+                                      (m[0], body[0], self.ts(body[1])))
+                    elif body is None:
+                        self.incoming(r, here, 'on', ts)
+                elif r.kind in COMM_NAMES and self.show_comm:
+                    self.events.append({
+                        'ph': 'X', 'name': '{0} {1}'.format(COMM_NAMES[r.kind],
+                                                             r.node),
+                        'cat': 'comm', 'pid': node, 'tid': r.thread,
+                        'ts': ts, 'dur': TICK,
+                        'args': {'locale': r.node, 'bytes': r.size,
+                                 'site': self.site(r)}})
+                    self.incoming(r, here, 'comm', ts)
+                elif r.kind in (VDB_TAG, VDB_PAUSE) and node == 0:
+                    name = (self.tagnames.get(r.id, str(r.id))
+                            if r.kind == VDB_TAG else 'pause')
+                    self.events.append({'ph': 'i', 's': 'g', 'name': name,
+                                        'cat': 'tag', 'pid': node,
+                                        'tid': r.thread, 'ts': ts})
+        return {'traceEvents': self.events, 'displayTimeUnit': 'ns'}
+
+    def incoming(self, r, here, cat, ts):
+        """ Show an operation on its target locale's incoming track. """
+        if r.node not in self.nodes:
+            return
+        self.events.append({'ph': 'X',
+                            'name': '{0} from {1}'.format(cat, here[0]),
+                            'cat': cat, 'pid': r.node, 'tid': INCOMING_TID,
+                            'ts': ts, 'dur': TICK,
+                            'args': {'bytes': r.size}})
+        self.new_flow(cat, cat, here, (r.node, INCOMING_TID, ts))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert binary VisualDebug data to Chrome trace-event '
+                    'JSON.')
+    parser.add_argument('paths', nargs='+', metavar='PATH',
+                        help='VisualDebug directory or .bin files')
+    parser.add_argument('-o', '--output',
+                        help='output file (default: PATH.json for the first '
+                             'PATH)')
+    parser.add_argument('--no-comm', action='store_true',
+                        help='leave out GETs and PUTs')
+    parser.add_argument('--show-vdebug', action='store_true',
+                        help='keep events for the VisualDebug routines')
+    args = parser.parse_args()
+
+    files = vdebug_files(args.paths)
+    if not files:
+        sys.stderr.write('No binary VisualDebug files found\n')
+        return 1
+
+    conv = Converter(args.show_vdebug, not args.no_comm)
+    try:
+        for f in files:
+            conv.add(read_file(f))
+    except (IOError, ValueError) as e:
+        sys.stderr.write('{0}\n'.format(e))
+        return 1
+
+    out = args.output or os.path.normpath(args.paths[0]) + '.json'
+    with open(out, 'w') as f:
+        json.dump(conv.convert(), f, separators=(',', ':'))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
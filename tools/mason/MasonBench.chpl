@@ -0,0 +1,165 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+private use List;
+use TOML;
+use MasonUtils;
+use MasonEnv;
+use MasonHelp;
+use MasonUpdate;
+use MasonBuild;
+use Path;
+use FileSystem;
+
+/* Compiles the .chpl files found within the bench/ directory of a Mason
+   package with --fast, runs them and stores their results as JSON files in
+   target/bench/.  The programs are expected to use the Benchmark module.
+*/
+proc masonBench(args: [] string) throws {
+
+  var show = false;
+  var run = true;
+  var skipUpdate = MASON_OFFLINE;
+  var compopts: list(string);
+  var execopts: list(string);
+  var searchSubStrings: list(string);
+
+  for arg in args[args.indices.low+2..args.indices.high] {
+    select (arg) {
+      when '-h' {
+        masonBenchHelp();
+        exit(0);
+      }
+      when '--help' {
+        masonBenchHelp();
+        exit(0);
+      }
+      when '--show' {
+        show = true;
+      }
+      when '--no-run' {
+        run = false;
+      }
+      when '--update' {
+        skipUpdate = false;
+      }
+      when '--no-update' {
+        skipUpdate = true;
+      }
+      otherwise {
+        // the Benchmark module's settings go to the benchmark programs
+        if arg.startsWith('--bench') then
+          execopts.append(arg);
+        else if arg.startsWith('-') then
+          compopts.append(arg);
+        else
+          searchSubStrings.append(arg);
+      }
+    }
+  }
+
+  try! {
+    const cwd = here.cwd();
+    const projectHome = getProjectHome(cwd);
+    updateLock(skipUpdate);
+    runBenchmarks(projectHome, show, run, searchSubStrings, compopts,
+                  execopts);
+  }
+  catch e: MasonError {
+    stderr.writeln(e.message());
+    exit(1);
+  }
+}
+
+private proc runBenchmarks(projectHome: string, show: bool, run: bool,
+                           const ref searchSubStrings: list(string),
+                           ref cmdLineCompopts: list(string),
+                           const ref execopts: list(string)) throws {
+
+  const toParse = open(projectHome + "/Mason.lock", iomode.r);
+  const lockFile = owned.create(parseToml(toParse));
+
+  const sourceList = genSourceList(lockFile);
+  getSrcCode(sourceList, show);
+  const project = lockFile["root"]!["name"]!.s;
+  const projectPath = "".join(projectHome, "/src/", project, ".chpl");
+
+  cmdLineCompopts.append("--fast");
+  const compopts = " ".join(getTomlCompopts(lockFile, cmdLineCompopts).these());
+
+  var benches: list(string);
+  const benchPath = joinPath(projectHome, "bench");
+  if isDir(benchPath) {
+    for bench in findfiles(startdir=benchPath, recursive=true, hidden=false) {
+      if !bench.endsWith(".chpl") then continue;
+      var selected = searchSubStrings.isEmpty();
+      for subString in searchSubStrings do
+        if bench.find(subString) != -1 then selected = true;
+      if selected then benches.append(bench);
+    }
+  }
+  if benches.isEmpty() then
+    throw new owned MasonError("No benchmarks were found in /bench");
+
+  makeTargetFiles("release", projectHome);
+  const targetPath = joinPath(projectHome, "target", "bench");
+  if !isDir(targetPath) then mkdir(targetPath);
+
+  var failures = 0;
+  for bench in benches {
+    const benchName = basename(stripExt(bench, ".chpl"));
+    const outputLoc = joinPath(targetPath, benchName);
+
+    // name the benchmark as the main module and add the dependencies
+    var depCompopts = " ".join(" --main-module", benchName, " ");
+    for (_, name, version) in sourceList {
+      depCompopts += "".join(' ', MASON_HOME, "/src/", name, "-", version,
+                             '/src/', name, ".chpl");
+    }
+    const compCommand = " ".join("chpl", bench, projectPath, "-o", outputLoc,
+                                 compopts, depCompopts);
+    if show then writeln(compCommand);
+    if runWithStatus(compCommand, show) != 0 {
+      stderr.writeln("compilation failed for " + bench);
+      failures += 1;
+      continue;
+    }
+    if !run {
+      writeln("Compiled '", bench, "' successfully");
+      continue;
+    }
+
+    const jsonLoc = outputLoc + ".json";
+    const execCommand = " ".join(outputLoc, "--benchJSON=" + jsonLoc,
+                                 " ".join(execopts.these()));
+    writeln("Running ", benchName);
+    if runWithStatus(execCommand, true) != 0 {
+      stderr.writeln(benchName + " returned a non-zero exit code");
+      failures += 1;
+    }
+    else {
+      writeln("Results written to ", jsonLoc);
+    }
+  }
+  toParse.close();
+
+  if failures > 0 then
+    throw new owned MasonError(failures:string + " benchmark(s) failed");
+}
@@ -50,6 +50,7 @@ proc masonHelp() {
   writeln('    doc         Build this project\'s documentation');
   writeln('    system      Integrate with system packages found via pkg-config');
   writeln('    test        Compile and run tests found in /test');
+  writeln('    bench       Compile and run benchmarks found in /bench');
   writeln('    external    Integrate external dependencies into mason packages');
   writeln('    publish     Publish package to mason-registry');
 }
@@ -371,6 +372,25 @@ proc masonTestHelp() {
   writeln("Tests pass if they exit with status code 0");
 }
 
+proc masonBenchHelp() {
+  writeln("Compile the programs found in bench/ with --fast and run them.");
+  writeln("Benchmarks are expected to use the Benchmark module; the results of each");
+  writeln("program are written to target/bench/<name>.json.");
+  writeln();
+  writeln("Usage:");
+  writeln("    mason bench [options] [<name>...]");
+  writeln();
+  writeln("Options:");
+  writeln("    -h, --help                  Display this message");
+  writeln("        --show                  Display the compilation commands and output");
+  writeln("        --no-run                Compile benchmarks without running them");
+  writeln("        --[no]-update           [Do not] update the mason-registry when benchmarking");
+  writeln();
+  writeln("Only the benchmarks whose path contains one of the given names are run.");
+  writeln("Settings of the Benchmark module, e.g. --benchMinTime=2.0, are passed to the");
+  writeln("benchmark programs, and other options starting with '-' to the compiler.");
+}
+
 proc masonSystemHelp() {
   writeln("Integrate a Mason package with system packages found via pkg-config");
   writeln();
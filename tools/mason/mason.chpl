@@ -33,6 +33,7 @@ use MasonBuild;
 use MasonUpdate;
 use MasonSearch;
 use MasonTest;
+use MasonBench;
 use MasonRun;
 use MasonSystem;
 use MasonExternal;
@@ -91,6 +92,7 @@ proc main(args: [] string) throws {
       when 'system' do masonSystem(args);
       when 'external' do masonExternal(args);
       when 'test' do masonTest(args);
+      when 'bench' do masonBench(args);
       when 'env' do masonEnv(args);
       when 'doc' do masonDoc(args);
       when 'publish' do masonPublish(args);
@@ -13,7 +13,7 @@ def get(flag='target'):
         atomics_val = overrides.get('CHPL_NETWORK_ATOMICS')
         if not atomics_val:
             comm_val = chpl_comm.get()
-            if comm_val in ['ofi', 'ugni'] and get('target') != 'locks':
+            if comm_val in ['ofi', 'ugni', 'shmem'] and get('target') != 'locks':
                 atomics_val = comm_val
             else:
                 atomics_val = 'none'
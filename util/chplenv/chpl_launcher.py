@@ -52,6 +52,8 @@ def get():
                 launcher_val = 'gasnetrun_psm'
         elif comm_val == 'mpi':
             launcher_val = 'mpirun'
+        elif comm_val == 'shmem':
+            launcher_val = 'smp'
         else:
             launcher_val = 'none'
 